@@ -0,0 +1,332 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+
+#pragma once
+#include "aacenc_lib.h"
+#include "AACDecoder.h"
+#include "wavfile.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+/*! \file aac_bench.h
+ *
+ * The FDK-AAC encoder set up for DAB+ as odr-audioenc does it, the input
+ * signals of the encoder benchmarks, and the segmental SNR of the decoded
+ * output. All signals are 48 kHz stereo.
+ */
+
+namespace bench {
+
+struct AacConfig {
+    int aot = AOT_DABPLUS_AAC_LC;
+    int subchannel_index = 12;
+    bool parallel_psy = false;
+    bool scf_cache = false;
+    int complexity = 0;
+};
+
+class AacEncoder {
+    public:
+        AacEncoder(const AacConfig& config)
+        {
+            if (aacEncOpen(&m_encoder, 0x01|0x02|0x04, 2) != AACENC_OK) {
+                throw std::runtime_error("Unable to open encoder");
+            }
+
+            set(AACENC_AOT, config.aot);
+            set(AACENC_SAMPLERATE, 48000);
+            set(AACENC_CHANNELMODE, MODE_2);
+            set(AACENC_CHANNELORDER, 1);
+            set(AACENC_GRANULE_LENGTH, 960);
+            set(AACENC_TRANSMUX, TT_DABPLUS);
+            set(AACENC_BITRATE, config.subchannel_index * 8000);
+            set(AACENC_AFTERBURNER, 1);
+            set(AACENC_PARALLEL_PSY, config.parallel_psy ? 1 : 0);
+            set(AACENC_SCF_CACHE, config.scf_cache ? 1 : 0);
+            set(AACENC_COMPLEXITY, config.complexity);
+
+            if (aacEncEncode(m_encoder, nullptr, nullptr, nullptr, nullptr) != AACENC_OK) {
+                throw std::runtime_error("Unable to initialize the encoder");
+            }
+
+            AACENC_InfoStruct info = {};
+            if (aacEncInfo(m_encoder, &info) != AACENC_OK) {
+                throw std::runtime_error("Unable to get the encoder info");
+            }
+            m_frame_length = info.frameLength;
+            m_outbuf.resize(20480);
+        }
+
+        ~AacEncoder() { aacEncClose(&m_encoder); }
+        AacEncoder(const AacEncoder&) = delete;
+        AacEncoder& operator=(const AacEncoder&) = delete;
+
+        /*! Number of sample frames every call to encode() takes */
+        size_t frame_length() const { return m_frame_length; }
+
+        /*! Encode frame_length() interleaved stereo sample frames, and append
+         * the superframe to out once it is complete. */
+        void encode(const int16_t *pcm, std::vector<uint8_t>& out)
+        {
+            AACENC_BufDesc in_buf = {}, out_buf = {};
+            AACENC_InArgs in_args = {};
+            AACENC_OutArgs out_args = {};
+
+            void *in_ptr = const_cast<int16_t*>(pcm);
+            int in_identifier = IN_AUDIO_DATA;
+            int in_size = m_frame_length * 2 * sizeof(int16_t);
+            int in_elem_size = sizeof(int16_t);
+            in_args.numInSamples = m_frame_length * 2;
+            in_buf.numBufs = 1;
+            in_buf.bufs = &in_ptr;
+            in_buf.bufferIdentifiers = &in_identifier;
+            in_buf.bufSizes = &in_size;
+            in_buf.bufElSizes = &in_elem_size;
+
+            void *out_ptr = m_outbuf.data();
+            int out_identifier = OUT_BITSTREAM_DATA;
+            int out_size = m_outbuf.size();
+            int out_elem_size = 1;
+            out_buf.numBufs = 1;
+            out_buf.bufs = &out_ptr;
+            out_buf.bufferIdentifiers = &out_identifier;
+            out_buf.bufSizes = &out_size;
+            out_buf.bufElSizes = &out_elem_size;
+
+            if (aacEncEncode(m_encoder, &in_buf, &out_buf, &in_args, &out_args) != AACENC_OK) {
+                throw std::runtime_error("Encoding failed");
+            }
+            out.insert(out.end(), m_outbuf.begin(),
+                    m_outbuf.begin() + out_args.numOutBytes);
+        }
+
+    private:
+        void set(AACENC_PARAM param, UINT value)
+        {
+            if (aacEncoder_SetParam(m_encoder, param, value) != AACENC_OK) {
+                throw std::runtime_error("Unable to set encoder parameter " +
+                        std::to_string(param));
+            }
+        }
+
+        HANDLE_AACENCODER m_encoder = nullptr;
+        size_t m_frame_length = 0;
+        std::vector<uint8_t> m_outbuf;
+};
+
+/*! A named input signal, interleaved stereo at 48 kHz */
+struct Signal {
+    std::string name;
+    std::vector<int16_t> samples;
+};
+
+/*! Encode the whole signal once into out, and keep the fastest time of
+ * every frame in frame_times. Over several runs, the sum of frame_times
+ * leaves out most of the interruptions by other processes, which makes
+ * it repeatable to about 1% even on a busy machine. */
+inline void encode_timed(const AacConfig& config, const Signal& signal,
+        std::vector<uint8_t>& out, std::vector<double>& frame_times)
+{
+    using clock_type = std::chrono::steady_clock;
+    AacEncoder encoder(config);
+    const size_t frame_samples = 2 * encoder.frame_length();
+
+    out.clear();
+    for (size_t pos = 0, frame = 0; pos + frame_samples <= signal.samples.size();
+            pos += frame_samples, frame++) {
+        const auto start = clock_type::now();
+        encoder.encode(signal.samples.data() + pos, out);
+        const std::chrono::duration<double> elapsed = clock_type::now() - start;
+
+        if (frame_times.size() <= frame) {
+            frame_times.push_back(elapsed.count());
+        }
+        else {
+            frame_times[frame] = std::min(frame_times[frame], elapsed.count());
+        }
+    }
+}
+
+inline double sum(const std::vector<double>& v)
+{
+    double s = 0;
+    for (double x : v) {
+        s += x;
+    }
+    return s;
+}
+
+/*! Ten seconds of a synthetic signal: a few sustained tones with vibrato,
+ * noise of different level in both channels, and a click every 700 ms,
+ * which makes the encoder switch to short blocks. */
+inline Signal synthetic_signal()
+{
+    const size_t rate = 48000, len = 10 * rate;
+    std::mt19937 gen(42);
+    std::normal_distribution<double> noise(0.0, 1.0);
+
+    Signal s;
+    s.name = "synthetic";
+    s.samples.resize(2 * len);
+    const double freqs[] = { 220.0, 554.4, 1318.5, 3520.0 };
+    for (size_t i = 0; i < len; i++) {
+        const double t = (double)i / rate;
+        double tone = 0;
+        for (double f : freqs) {
+            tone += sin(2 * M_PI * f * t + 0.3 * sin(2 * M_PI * 5 * t)) / f;
+        }
+        const double click = (i % (rate * 7 / 10) < 48) ? 0.5 : 0.0;
+        const double l = 40 * tone + 0.03 * noise(gen) + click;
+        const double r = 35 * tone + 0.05 * noise(gen) + click;
+        s.samples[2*i]   = (int16_t)lrint(std::max(-1.0, std::min(1.0, l)) * 16000);
+        s.samples[2*i+1] = (int16_t)lrint(std::max(-1.0, std::min(1.0, r)) * 16000);
+    }
+    return s;
+}
+
+/*! Read a 48 kHz stereo wav file */
+inline Signal read_signal(const char *filename)
+{
+    void *wav = wav_read_open(filename);
+    if (wav == nullptr) {
+        throw std::runtime_error(std::string("Cannot open ") + filename);
+    }
+    int format, channels, sample_rate, bits_per_sample;
+    uint64_t data_length;
+    if (not wav_get_header(wav, &format, &channels, &sample_rate,
+                &bits_per_sample, &data_length) or
+            channels != 2 or sample_rate != 48000 or
+            not wav_s16_supported(wav)) {
+        wav_read_close(wav);
+        throw std::runtime_error(std::string(filename) +
+                " is not a 48 kHz stereo wav file");
+    }
+
+    Signal s;
+    s.name = filename;
+    std::vector<int16_t> buf(4096);
+    int n;
+    while ((n = wav_read_s16(wav, buf.data(), buf.size())) > 0) {
+        s.samples.insert(s.samples.end(), buf.begin(), buf.begin() + n);
+    }
+    wav_read_close(wav);
+    return s;
+}
+
+/*! The files given on the command line, or the synthetic signal */
+inline std::vector<Signal> signals(int argc, char **argv)
+{
+    std::vector<Signal> s;
+    for (int i = 1; i < argc; i++) {
+        s.push_back(read_signal(argv[i]));
+    }
+    if (s.empty()) {
+        s.push_back(synthetic_signal());
+    }
+    return s;
+}
+
+/*! Decode the superframes of a subchannel with the decoder of the --decode
+ * option, which writes a wav file, and read the signal back. */
+inline Signal decode(const std::vector<uint8_t>& superframes, int subchannel_index)
+{
+    const size_t superframe_size = subchannel_index * 110;
+    if (superframes.size() % superframe_size != 0) {
+        throw std::runtime_error("Incomplete superframe");
+    }
+
+    char filename[] = "/tmp/aac_bench_XXXXXX";
+    const int fd = mkstemp(filename);
+    if (fd == -1) {
+        throw std::runtime_error("Cannot create a temporary file");
+    }
+    close(fd);
+
+    Signal s;
+    try {
+        {
+            AACDecoder decoder(filename);
+            std::vector<uint8_t> sf(superframe_size);
+            for (size_t pos = 0; pos < superframes.size(); pos += superframe_size) {
+                std::copy(superframes.begin() + pos,
+                        superframes.begin() + pos + superframe_size, sf.begin());
+                decoder.decode_frame(sf.data(), sf.size());
+            }
+        }
+        s = read_signal(filename);
+    }
+    catch (...) {
+        unlink(filename);
+        throw;
+    }
+    unlink(filename);
+    return s;
+}
+
+/*! Segmental SNR in dB of the decoded signal against the input, over
+ * segments of 1024 sample frames. The delay of the codec is found by
+ * correlating the second second of both, and silent segments are skipped.
+ * Each segment is clamped to [-10, 60] dB, so that a few segments cannot
+ * dominate the mean. */
+inline double seg_snr(const Signal& input, const Signal& decoded)
+{
+    const auto& x = input.samples;
+    const auto& y = decoded.samples;
+    const size_t rate = 48000, max_delay = 8000, seg = 1024;
+
+    size_t delay = 0;
+    double best = -1e300;
+    for (size_t d = 0; d < max_delay; d++) {
+        double corr = 0;
+        for (size_t i = 2 * rate; i < 4 * rate and 2 * (i + d) < y.size(); i++) {
+            corr += (double)x[i] * y[i + 2 * d];
+        }
+        if (corr > best) {
+            best = corr;
+            delay = d;
+        }
+    }
+
+    const size_t frames = std::min(x.size() / 2, y.size() / 2 - delay);
+    const double silence = seg * 2 * std::pow(32768 * 0.001, 2);
+    double sum = 0;
+    size_t segments = 0;
+    for (size_t start = 0; start + seg <= frames; start += seg) {
+        double signal = 0, error = 0;
+        for (size_t i = 2 * start; i < 2 * (start + seg); i++) {
+            const double e = (double)x[i] - y[i + 2 * delay];
+            signal += (double)x[i] * x[i];
+            error += e * e;
+        }
+        if (signal > silence) {
+            sum += std::min(60.0, std::max(-10.0, 10 * log10(signal / (error + 1e-9))));
+            segments++;
+        }
+    }
+    return segments ? sum / segments : 0.0;
+}
+
+} // namespace bench
@@ -0,0 +1,82 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+/*! \file bench.h
+ *
+ * Helpers shared by the microbenchmarks in bench/.
+ *
+ * Timings on a busy machine are noisy, so every measurement is repeated
+ * and the fastest run is reported.
+ */
+
+namespace bench {
+
+/*! Run f() repeatedly for about min_seconds, and return the time of
+ * one call in seconds. The best of `runs` such measurements is kept. */
+template<typename F>
+double seconds_per_call(F f, double min_seconds = 0.2, int runs = 5)
+{
+    using clock = std::chrono::steady_clock;
+
+    // Warm up the caches and the branch predictors
+    f();
+
+    double best = 1e9;
+    for (int run = 0; run < runs; run++) {
+        size_t calls = 0;
+        const auto start = clock::now();
+        std::chrono::duration<double> elapsed;
+        do {
+            f();
+            calls++;
+            elapsed = clock::now() - start;
+        } while (elapsed.count() < min_seconds / runs);
+
+        best = std::min(best, elapsed.count() / calls);
+    }
+    return best;
+}
+
+/*! Deterministic random bytes, so that all runs see the same data */
+inline std::vector<uint8_t> random_bytes(size_t len, uint32_t seed = 42)
+{
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> dist(0, 255);
+    std::vector<uint8_t> v(len);
+    for (auto& b : v) {
+        b = dist(gen);
+    }
+    return v;
+}
+
+/*! Print one line of results: throughput in MB/s and time per call */
+inline void report(const char *name, double seconds, size_t bytes_per_call)
+{
+    printf("  %-28s %10.1f MB/s %12.3f us/call\n", name,
+            bytes_per_call / seconds / 1e6, seconds * 1e6);
+}
+
+} // namespace bench
@@ -0,0 +1,202 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+
+/* Huffman bit counting benchmark of the FDK-AAC encoder.
+ *
+ * For every mode, the input is encoded once with a FDKaacEnc_bitCount()
+ * that records the quantized spectrum of every band the encoder counts,
+ * see FDKaacEnc_setBitCountFn(). The recorded bands are then counted with
+ * each of the versions the CPU supports, see FDKaacEnc_getBitCountKernels(),
+ * and the time per band is reported. The whole encode is timed with each
+ * of them too, see bench::encode_timed().
+ *
+ * The counts must be identical to the ones of the scalar version, on the
+ * recorded bands and on random ones, as well as the encoder output, and
+ * the program fails if they differ.
+ *
+ * Usage: bitcount_bench [file.wav...], 48 kHz stereo files. Without
+ * arguments, a synthetic signal is used. */
+
+#include "bit_cnt.h"
+
+#include "bench.h"
+#include "aac_bench.h"
+#include <string>
+
+using namespace std;
+
+struct Bands {
+    struct Band {
+        size_t offset;
+        INT width;
+        INT max_val;
+    };
+    vector<Band> bands;
+    vector<SHORT> values;
+};
+
+static const BIT_COUNT_KERNEL *kernels = nullptr;
+static int num_kernels = 0;
+static Bands *recording = nullptr;
+
+static INT record_bit_count(const SHORT *const values, const INT width,
+        const INT maxVal, INT *const bitCount)
+{
+    recording->bands.push_back({recording->values.size(), width, maxVal});
+    recording->values.insert(recording->values.end(), values, values + width);
+    return kernels[0].bitCount(values, width, maxVal, bitCount);
+}
+
+static bool same_counts(const BIT_COUNT_KERNEL& k, const SHORT *values,
+        INT width, INT max_val)
+{
+    INT expected[CODE_BOOK_ESC_NO + 1], got[CODE_BOOK_ESC_NO + 1];
+    kernels[0].bitCount(values, width, max_val, expected);
+    k.bitCount(values, width, max_val, got);
+    return equal(expected, expected + CODE_BOOK_ESC_NO + 1, got);
+}
+
+/* Bands of 4 to 128 lines with values up to 7, the ones the SIMD versions
+ * count, also with a maxVal above the largest value of the band */
+static bool verify_random(const BIT_COUNT_KERNEL& k)
+{
+    mt19937 gen(42);
+    uniform_int_distribution<int> width_dist(1, 32);
+    uniform_int_distribution<int> lav_dist(0, 7);
+    vector<SHORT> values(128);
+
+    for (int i = 0; i < 300000; i++) {
+        const INT width = 4 * width_dist(gen);
+        const INT lav = lav_dist(gen);
+        uniform_int_distribution<int> value_dist(-lav, lav);
+        INT max_val = 0;
+        for (INT n = 0; n < width; n++) {
+            values[n] = value_dist(gen);
+            max_val = max<INT>(max_val, abs(values[n]));
+        }
+        if (i & 1) {
+            max_val = max(max_val, lav);
+        }
+        if (not same_counts(k, values.data(), width, max_val)) {
+            fprintf(stderr, "%s bit counts differ, width %d, maxVal %d\n",
+                    k.name, width, max_val);
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool run(const char *name, const bench::AacConfig& config,
+        const bench::Signal& signal)
+{
+    bool ok = true;
+
+    Bands recorded;
+    vector<uint8_t> recorded_out;
+    vector<double> recorded_times;
+    recording = &recorded;
+    FDKaacEnc_setBitCountFn(record_bit_count);
+    bench::encode_timed(config, signal, recorded_out, recorded_times);
+    recording = nullptr;
+
+    printf("%s, %s, %zu bands\n", signal.name.c_str(), name, recorded.bands.size());
+
+    // The encodes run in turns, so that all versions see the same load of
+    // the machine
+    vector<vector<uint8_t>> out(num_kernels);
+    vector<vector<double>> frame_times(num_kernels);
+    for (int run = 0; run < 5; run++) {
+        for (int i = 0; i < num_kernels; i++) {
+            FDKaacEnc_setBitCountFn(kernels[i].bitCount);
+            bench::encode_timed(config, signal, out[i], frame_times[i]);
+        }
+    }
+
+    INT bit_count[CODE_BOOK_ESC_NO + 1];
+    double scalar_band = 0;
+    const double scalar_encode = bench::sum(frame_times[0]);
+    for (int i = 0; i < num_kernels; i++) {
+        const auto& k = kernels[i];
+        for (const auto& b : recorded.bands) {
+            if (not same_counts(k, &recorded.values[b.offset], b.width, b.max_val)) {
+                fprintf(stderr, "%s bit counts of a recorded band differ\n", k.name);
+                ok = false;
+                break;
+            }
+        }
+        if (out[i] != recorded_out) {
+            fprintf(stderr, "%s encoder output differs\n", k.name);
+            ok = false;
+        }
+
+        const double band = bench::seconds_per_call([&]() {
+                for (const auto& b : recorded.bands) {
+                    k.bitCount(&recorded.values[b.offset], b.width, b.max_val,
+                            bit_count);
+                }
+            }) / recorded.bands.size();
+        const double encode = bench::sum(frame_times[i]);
+        if (i == 0) {
+            scalar_band = band;
+        }
+
+        // The time the version saves in the encoder, from the bands counted
+        // per encode, as a share of the encode time
+        const double saved = (scalar_band - band) * recorded.bands.size();
+        printf("  %-8s %6.1f ns/band x%.2f  encode %7.3f s %+5.1f%%"
+                "  counting saves %4.1f%%\n",
+                k.name, band * 1e9, scalar_band / band, encode,
+                (encode / scalar_encode - 1.0) * 100, saved / scalar_encode * 100);
+    }
+    FDKaacEnc_setBitCountFn(kernels[num_kernels - 1].bitCount);
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    struct {
+        const char *name;
+        int aot;
+        int subchannel_index;
+    } modes[] = {
+        { "HE-AAC 48 kbps", AOT_DABPLUS_SBR, 6 },
+        { "HE-AAC 64 kbps", AOT_DABPLUS_SBR, 8 },
+        { "AAC-LC 96 kbps", AOT_DABPLUS_AAC_LC, 12 },
+        { "AAC-LC 128 kbps", AOT_DABPLUS_AAC_LC, 16 },
+    };
+
+    num_kernels = FDKaacEnc_getBitCountKernels(&kernels);
+
+    bool ok = true;
+    for (int i = 1; i < num_kernels; i++) {
+        ok &= verify_random(kernels[i]);
+    }
+    if (not ok) {
+        return 1;
+    }
+
+    for (const auto& signal : bench::signals(argc, argv)) {
+        for (const auto& mode : modes) {
+            bench::AacConfig config;
+            config.aot = mode.aot;
+            config.subchannel_index = mode.subchannel_index;
+            ok &= run(mode.name, config, signal);
+        }
+    }
+    return ok ? 0 : 1;
+}
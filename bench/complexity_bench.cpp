@@ -0,0 +1,75 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+
+/* Encode time and quality of the FDK-AAC encoder at each complexity level
+ * (AACENC_COMPLEXITY, --complexity).
+ *
+ * The levels run five times in turns. Their encode time, see
+ * bench::encode_timed(), is reported relative to level 0, with the
+ * segmental SNR of the decoded output. No perceptual measure like ODG is
+ * available here, so the SNR only gives an idea of the quality cost.
+ *
+ * Usage: complexity_bench [file.wav...], 48 kHz stereo files. Without
+ * arguments, a synthetic signal is used. */
+
+#include "bench.h"
+#include "aac_bench.h"
+
+using namespace std;
+
+static const int num_levels = 4;
+
+int main(int argc, char **argv)
+{
+    struct {
+        const char *name;
+        int aot;
+        int subchannel_index;
+    } modes[] = {
+        { "AAC-LC 96 kbps", AOT_DABPLUS_AAC_LC, 12 },
+        { "HE-AAC 64 kbps", AOT_DABPLUS_SBR, 8 },
+    };
+
+    for (const auto& signal : bench::signals(argc, argv)) {
+        for (const auto& mode : modes) {
+            bench::AacConfig config;
+            config.aot = mode.aot;
+            config.subchannel_index = mode.subchannel_index;
+
+            vector<uint8_t> out[num_levels];
+            vector<double> frame_times[num_levels];
+            for (int run = 0; run < 5; run++) {
+                for (int level = 0; level < num_levels; level++) {
+                    config.complexity = level;
+                    bench::encode_timed(config, signal, out[level], frame_times[level]);
+                }
+            }
+
+            printf("%s, %s\n", signal.name.c_str(), mode.name);
+            const double full = bench::sum(frame_times[0]);
+            for (int level = 0; level < num_levels; level++) {
+                const auto decoded = bench::decode(out[level], mode.subchannel_index);
+                const double seconds = bench::sum(frame_times[level]);
+                printf("  level %d  %7.3f s  %+6.1f%%  segSNR %6.2f dB\n",
+                        level, seconds, (seconds / full - 1.0) * 100,
+                        bench::seg_snr(signal, decoded));
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,135 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+
+/* CRC benchmark.
+ *
+ * Compares the byte-wise table loop CrcEngine replaced with its
+ * slicing-by-8 and PCLMULQDQ paths, for the CRC-16 CCITT of EDI, and the
+ * bit-wise loop of toolame's update_CRC() with crc16_mpa_bits() for the
+ * 4-bit fields of the bit allocation. The results are checked against the
+ * old loops. */
+
+#include "bench.h"
+#include "crc.h"
+#include "CrcEngine.h"
+#include <array>
+
+using namespace std;
+
+static array<uint16_t, 256> make_crc16tab()
+{
+    array<uint16_t, 256> table;
+    for (unsigned i = 0; i < 256; i++) {
+        uint16_t c = i << 8;
+        for (int j = 0; j < 8; j++) {
+            c = (c & 0x8000) ? (uint16_t)((c << 1) ^ 0x1021) : (uint16_t)(c << 1);
+        }
+        table[i] = c;
+    }
+    return table;
+}
+
+static const auto crc16tab = make_crc16tab();
+
+/* The loop of the removed contrib/crc.c */
+static uint16_t crc16_bytewise(uint16_t l_crc, const uint8_t *data, unsigned l_nb)
+{
+    while (l_nb--) {
+        l_crc = (l_crc << 8) ^ crc16tab[(l_crc >> 8) ^ *(data++)];
+    }
+    return l_crc;
+}
+
+/* The removed body of toolame's update_CRC() */
+static void update_CRC_bitwise(unsigned int data, unsigned int length,
+        unsigned int *crc)
+{
+    unsigned int masking, carry;
+
+    masking = 1 << length;
+
+    while ((masking >>= 1)) {
+        carry = *crc & 0x8000;
+        *crc <<= 1;
+        if (!carry ^ !(data & masking))
+            *crc ^= 0x8005;
+    }
+    *crc &= 0xffff;
+}
+
+/* Keeps the compiler from dropping the timed calls */
+static volatile uint32_t sink;
+
+int main()
+{
+    bool ok = true;
+
+    for (size_t len : {64, 256, 1024}) {
+        const auto data = bench::random_bytes(len);
+        printf("CRC-16 CCITT, %zu bytes\n", len);
+
+        const uint16_t expected = crc16_bytewise(0xffff, data.data(), len);
+
+        bench::report("bytewise", bench::seconds_per_call([&]() {
+                    sink = crc16_bytewise(0xffff, data.data(), len); }), len);
+
+        bench::report("slice-by-8", bench::seconds_per_call([&]() {
+                    sink = CrcCCITT::updateTable(0xffff, data.data(), len); }), len);
+        ok &= CrcCCITT::updateTable(0xffff, data.data(), len) == expected;
+
+#if defined(CRC_ENGINE_PCLMUL)
+        if (CrcCCITT::haveClmul()) {
+            bench::report("pclmul", bench::seconds_per_call([&]() {
+                        sink = CrcCCITT::updateClmul(0xffff, data.data(), len); }), len);
+            ok &= CrcCCITT::updateClmul(0xffff, data.data(), len) == expected;
+        }
+#endif
+        ok &= crc16(0xffff, data.data(), len) == expected;
+    }
+
+    // One bit allocation of a 32-subband stereo frame, in 4-bit fields
+    const size_t fields = 64;
+    const auto data = bench::random_bytes(fields);
+    printf("toolame CRC, %zu fields of 4 bits\n", fields);
+
+    auto bitwise = [&]() {
+        unsigned int crc = 0xffff;
+        for (size_t i = 0; i < fields; i++) {
+            update_CRC_bitwise(data[i], 4, &crc);
+        }
+        return crc;
+    };
+    auto engine = [&]() {
+        uint16_t crc = 0xffff;
+        for (size_t i = 0; i < fields; i++) {
+            crc = crc16_mpa_bits(crc, data[i], 4);
+        }
+        return crc;
+    };
+    bench::report("bitwise", bench::seconds_per_call([&]() { sink = bitwise(); }),
+            fields / 2);
+    bench::report("crc16_mpa_bits", bench::seconds_per_call([&]() { sink = engine(); }),
+            fields / 2);
+    ok &= bitwise() == engine();
+
+    if (not ok) {
+        fprintf(stderr, "CRC mismatch against the byte-wise or bit-wise loop\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,162 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+
+/* Gain and level metering benchmark.
+ *
+ * Compares the gain loop the capture stage used before GainStage with
+ * every GainStage kernel the CPU supports, on blocks of 4608 stereo
+ * frames, with and without a gain, RMS and true peak measurement.
+ *
+ * The kernels must give the same samples and peaks as the scalar one, and
+ * about the same RMS and true peak. Without a gain, the samples must be
+ * left untouched, as the old loop did. With a gain, they must be within
+ * one LSB of the old loop, which truncated instead of rounding. */
+
+#include "bench.h"
+#include "GainStage.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+using namespace std;
+
+static const size_t num_frames = 4608;
+static const size_t block_bytes = num_frames * 2 * sizeof(int16_t);
+
+/* The loop of the capture stage before GainStage, gain computation
+ * included */
+static void old_gain_loop(uint8_t *input_buf, size_t read_bytes, double gain_dB,
+        int16_t& peak_left, int16_t& peak_right)
+{
+    peak_left  = 0;
+    peak_right = 0;
+
+    const double linear_gain_correction = pow(10.0, gain_dB / 20.0);
+
+    for (size_t i = 0; i < read_bytes; i+=4) {
+        int16_t l = input_buf[i] | (input_buf[i+1] << 8);
+        int16_t r = input_buf[i+2] | (input_buf[i+3] << 8);
+
+        if (linear_gain_correction != 1.0) {
+            l *= linear_gain_correction;
+            r *= linear_gain_correction;
+
+            input_buf[i] = l & 0x00FF;
+            input_buf[i+1] = (l & 0xFF00) >> 8;
+            input_buf[i+2] = r & 0x00FF;
+            input_buf[i+3] = (r & 0xFF00) >> 8;
+        }
+
+        peak_left  = std::max(peak_left,  l);
+        peak_right = std::max(peak_right, r);
+    }
+}
+
+/* The RMS and the true peak are sums of floats, which the kernels add in
+ * another order, so they only have to be close */
+static bool same_levels(const audio_levels_t& a, const audio_levels_t& b)
+{
+    auto close = [](double x, double y) { return fabs(x - y) <= 1e-5 * fabs(y); };
+    const int peak_tolerance = a.true_peak_measured ? 1 : 0;
+    return abs(a.peak_left - b.peak_left) <= peak_tolerance and
+        abs(a.peak_right - b.peak_right) <= peak_tolerance and
+        close(a.rms_left, b.rms_left) and close(a.rms_right, b.rms_right) and
+        close(a.true_peak_left, b.true_peak_left) and
+        close(a.true_peak_right, b.true_peak_right);
+}
+
+static bool run(const char *title, double gain_dB, bool rms, bool true_peak,
+        const vector<uint8_t>& input)
+{
+    printf("%s\n", title);
+    vector<uint8_t> buf(block_bytes);
+    bool ok = true;
+
+    vector<uint8_t> old_out = input;
+    int16_t peak_left, peak_right;
+    old_gain_loop(old_out.data(), block_bytes, gain_dB, peak_left, peak_right);
+    if (not rms and not true_peak) {
+        bench::report("old loop", bench::seconds_per_call([&]() {
+                    memcpy(buf.data(), input.data(), block_bytes);
+                    old_gain_loop(buf.data(), block_bytes, gain_dB,
+                        peak_left, peak_right); }), block_bytes);
+    }
+
+    vector<uint8_t> reference;
+    audio_levels_t reference_levels;
+    for (const auto& kernel : GainStage::kernels()) {
+        GainStage gain_stage(2, gain_dB, rms, true_peak);
+        gain_stage.set_kernel(kernel);
+
+        audio_levels_t levels;
+        bench::report(kernel.c_str(), bench::seconds_per_call([&]() {
+                    memcpy(buf.data(), input.data(), block_bytes);
+                    gain_stage.process(buf.data(), block_bytes, levels); }),
+                block_bytes);
+
+        // Check the output of a fresh instance, whose true peak history
+        // is empty
+        GainStage check(2, gain_dB, rms, true_peak);
+        check.set_kernel(kernel);
+        memcpy(buf.data(), input.data(), block_bytes);
+        check.process(buf.data(), block_bytes, levels);
+
+        if (reference.empty()) {
+            reference = buf;
+            reference_levels = levels;
+        }
+        else if (buf != reference or not same_levels(levels, reference_levels)) {
+            fprintf(stderr, "%s differs from the scalar kernel\n", kernel.c_str());
+            ok = false;
+        }
+    }
+
+    const int16_t *a = reinterpret_cast<const int16_t*>(reference.data());
+    const int16_t *b = reinterpret_cast<const int16_t*>(old_out.data());
+    const int tolerance = (gain_dB == 0.0) ? 0 : 1;
+    for (size_t i = 0; i < 2 * num_frames; i++) {
+        if (abs(a[i] - b[i]) > tolerance) {
+            fprintf(stderr, "Sample %zu differs from the old loop: %d, %d\n",
+                    i, a[i], b[i]);
+            ok = false;
+            break;
+        }
+    }
+    return ok;
+}
+
+int main()
+{
+    // Noise at half of full scale
+    const auto bytes = bench::random_bytes(block_bytes);
+    vector<uint8_t> input(block_bytes);
+    for (size_t i = 0; i < block_bytes; i += 2) {
+        const int16_t s = (int16_t)(bytes[i] | bytes[i+1] << 8) / 2;
+        input[i] = s & 0xFF;
+        input[i+1] = (s >> 8) & 0xFF;
+    }
+
+    bool ok = true;
+    ok &= run("0 dB, 4608 stereo frames", 0.0, false, false, input);
+    ok &= run("0 dB, RMS", 0.0, true, false, input);
+    ok &= run("0 dB, true peak", 0.0, false, true, input);
+    ok &= run("-3 dB, 4608 stereo frames", -3.0, false, false, input);
+    ok &= run("-3 dB, RMS", -3.0, true, false, input);
+    return ok ? 0 : 1;
+}
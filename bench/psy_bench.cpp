@@ -0,0 +1,125 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+
+/* Per-frame latency of the FDK-AAC encoder with and without the parallel
+ * psychoacoustic model (AACENC_PARALLEL_PSY, --parallel-channels).
+ *
+ * Every call to aacEncEncode() is timed, and the mean, median and 99th
+ * percentile are reported for both modes. The two bitstreams must be
+ * identical, and the program fails if they differ.
+ *
+ * The helper thread is only started on systems with more than one
+ * processor, so this only shows a difference there.
+ *
+ * Usage: psy_bench [file.wav...], 48 kHz stereo files. Without arguments,
+ * a synthetic signal is used. */
+
+#include "bench.h"
+#include "aac_bench.h"
+#include <unistd.h>
+
+using namespace std;
+using clock_type = chrono::steady_clock;
+
+struct Latency {
+    double mean = 0, median = 0, p99 = 0;
+};
+
+/* Encode the signal, and return the latency of the calls to the encoder.
+ * The best of five runs is kept. */
+static Latency encode(const bench::AacConfig& config, const bench::Signal& signal,
+        vector<uint8_t>& out)
+{
+    Latency best;
+    best.mean = 1e9;
+
+    for (int run = 0; run < 5; run++) {
+        bench::AacEncoder encoder(config);
+        const size_t frame_samples = 2 * encoder.frame_length();
+
+        out.clear();
+        vector<double> times;
+        for (size_t pos = 0; pos + frame_samples <= signal.samples.size();
+                pos += frame_samples) {
+            const auto start = clock_type::now();
+            encoder.encode(signal.samples.data() + pos, out);
+            const chrono::duration<double> elapsed = clock_type::now() - start;
+            times.push_back(elapsed.count());
+        }
+
+        sort(times.begin(), times.end());
+        Latency l;
+        for (double t : times) {
+            l.mean += t;
+        }
+        l.mean /= times.size();
+        l.median = times[times.size() / 2];
+        l.p99 = times[times.size() * 99 / 100];
+        if (l.mean < best.mean) {
+            best = l;
+        }
+    }
+    return best;
+}
+
+static void report(const char *name, const Latency& l)
+{
+    printf("  %-12s mean %7.1f us  median %7.1f us  p99 %7.1f us per frame\n",
+            name, l.mean * 1e6, l.median * 1e6, l.p99 * 1e6);
+}
+
+int main(int argc, char **argv)
+{
+    struct {
+        const char *name;
+        int aot;
+        int subchannel_index;
+    } modes[] = {
+        { "AAC-LC 128 kbps", AOT_DABPLUS_AAC_LC, 16 },
+        { "AAC-LC 64 kbps", AOT_DABPLUS_AAC_LC, 8 },
+        { "HE-AAC 64 kbps", AOT_DABPLUS_SBR, 8 },
+    };
+
+    const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    printf("%ld processor(s) online%s\n", cpus,
+            cpus < 2 ? ", the helper thread is not started" : "");
+
+    bool ok = true;
+    for (const auto& signal : bench::signals(argc, argv)) {
+        for (const auto& mode : modes) {
+            printf("%s, %s\n", signal.name.c_str(), mode.name);
+
+            bench::AacConfig config;
+            config.aot = mode.aot;
+            config.subchannel_index = mode.subchannel_index;
+
+            vector<uint8_t> serial_out, parallel_out;
+            report("serial", encode(config, signal, serial_out));
+
+            config.parallel_psy = true;
+            report("parallel", encode(config, signal, parallel_out));
+
+            if (serial_out != parallel_out) {
+                fprintf(stderr, "The parallel encoder output differs\n");
+                ok = false;
+            }
+        }
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,148 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+
+/* Quantizer benchmark of the FDK-AAC encoder.
+ *
+ * Times the versions of the band quantizer the CPU supports, see
+ * FDKaacEnc_getQuantizeBandKernels(), and FDKaacEnc_calcSfbDist(), which
+ * uses them, with each of them.
+ *
+ * Before timing, every version is compared with the scalar one on random
+ * lines with gains from -80 to 80, including lines beyond MAX_QUANT. The
+ * program fails on the first mismatch. */
+
+#include "quantize.h"
+
+#include "bench.h"
+#include <string>
+
+using namespace std;
+
+/* Lines of a band, with magnitudes spread over the range of an MDCT
+ * spectrum */
+static vector<FIXP_DBL> random_lines(mt19937& gen, size_t n)
+{
+    uniform_int_distribution<int> shift(1, 24);
+    uniform_int_distribution<int32_t> value(INT32_MIN, INT32_MAX);
+    vector<FIXP_DBL> lines(n);
+    for (auto& l : lines) {
+        l = value(gen) >> shift(gen);
+    }
+    return lines;
+}
+
+static bool verify(const QUANTIZE_BAND_KERNEL& scalar,
+        const QUANTIZE_BAND_KERNEL& k)
+{
+    mt19937 gen(42);
+    uniform_int_distribution<int> gain_dist(-80, 80);
+    uniform_int_distribution<int> len_dist(1, 96);
+    vector<SHORT> expected(96), got(96);
+
+    for (int i = 0; i < 100000; i++) {
+        const int n = len_dist(gen);
+        const int gain = gain_dist(gen);
+        const int dzone = i & 1;
+        const auto lines = random_lines(gen, n);
+        scalar.quantizeBand(gain, n, lines.data(), expected.data(), dzone);
+        k.quantizeBand(gain, n, lines.data(), got.data(), dzone);
+        if (not equal(expected.begin(), expected.begin() + n, got.begin())) {
+            fprintf(stderr, "%s quantization differs, gain %d\n", k.name, gain);
+            return false;
+        }
+    }
+    return true;
+}
+
+static void report(const string& name, double seconds, size_t lines)
+{
+    printf("  %-28s %8.2f ns/line\n", name.c_str(), seconds / lines * 1e9);
+}
+
+int main()
+{
+    const QUANTIZE_BAND_KERNEL *kernels = nullptr;
+    const int num_kernels = FDKaacEnc_getQuantizeBandKernels(&kernels);
+
+    bool ok = true;
+    for (int i = 1; i < num_kernels; i++) {
+        ok &= verify(kernels[0], kernels[i]);
+    }
+    if (not ok) {
+        return 1;
+    }
+
+    // One long block of 1024 lines in bands of 4 to 32 lines, as the
+    // afterburner quantizes them, with the gains of a 128 kbps encode
+    mt19937 gen(1);
+    const size_t num_lines = 1024;
+    const auto spectrum = random_lines(gen, num_lines);
+    vector<int> band_offsets;
+    for (size_t offset = 0; offset < num_lines; offset += 4 + (offset / 32) * 4) {
+        band_offsets.push_back(offset);
+    }
+    band_offsets.push_back(num_lines);
+    const int gains[] = { -8, -4, 0, 4, 8, 12, 16, 20 };
+    const size_t lines_per_call = num_lines * (sizeof(gains) / sizeof(gains[0]));
+
+    vector<SHORT> quantized(num_lines);
+
+    printf("Quantization\n");
+    for (int i = 0; i < num_kernels; i++) {
+        const auto& k = kernels[i];
+        report(k.name, bench::seconds_per_call([&]() {
+                    for (int gain : gains) {
+                        for (size_t b = 0; b + 1 < band_offsets.size(); b++) {
+                            const int o = band_offsets[b];
+                            k.quantizeBand(gain, band_offsets[b+1] - o,
+                                    &spectrum[o], &quantized[o], 1);
+                        }
+                    }
+                }), lines_per_call);
+    }
+
+    // calcSfbDist() uses the version the encoder is set to
+    printf("FDKaacEnc_calcSfbDist()\n");
+    FIXP_DBL expected_dist = 0;
+    for (int i = 0; i < num_kernels; i++) {
+        FDKaacEnc_setQuantizeBandKernel(i);
+
+        FIXP_DBL dist = 0;
+        report(kernels[i].name, bench::seconds_per_call([&]() {
+                    dist = 0;
+                    for (int gain : gains) {
+                        for (size_t b = 0; b + 1 < band_offsets.size(); b++) {
+                            const int o = band_offsets[b];
+                            dist += FDKaacEnc_calcSfbDist(&spectrum[o], &quantized[o],
+                                    band_offsets[b+1] - o, gain, 1) >> 8;
+                        }
+                    }
+                }), lines_per_call);
+
+        if (i == 0) {
+            expected_dist = dist;
+        }
+        else if (dist != expected_dist) {
+            fprintf(stderr, "%s calcSfbDist() differs\n", kernels[i].name);
+            ok = false;
+        }
+    }
+    FDKaacEnc_setQuantizeBandKernel(num_kernels - 1);
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,163 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+
+/* Resampler throughput benchmark.
+ *
+ * Converts one second of stereo noise with every dot product kernel the
+ * CPU supports, for the input rates the encoder meets and every quality
+ * setting, and reports the speed as a multiple of real time. The
+ * VariableResampler of the drift compensation is timed too. The SIMD
+ * kernels sum in another order than the scalar one, and the program fails
+ * if their output differs from it by more than one LSB. */
+
+#include "bench.h"
+#include "Resampler.h"
+#include <cstdlib>
+#include <string>
+
+using namespace std;
+
+static const unsigned channels = 2;
+
+/* One second of stereo noise, rate frames */
+static vector<int16_t> input_signal(unsigned rate)
+{
+    const auto bytes = bench::random_bytes(2 * channels * rate);
+    vector<int16_t> samples(channels * rate);
+    for (size_t i = 0; i < samples.size(); i++) {
+        // Keep some headroom, so that the filter ripple does not clip
+        samples[i] = (int16_t)(bytes[2*i] | bytes[2*i+1] << 8) / 2;
+    }
+    return samples;
+}
+
+static int max_difference(const vector<int16_t>& a, const vector<int16_t>& b)
+{
+    if (a.size() != b.size()) {
+        return 65536;
+    }
+    int diff = 0;
+    for (size_t i = 0; i < a.size(); i++) {
+        diff = max(diff, abs(a[i] - b[i]));
+    }
+    return diff;
+}
+
+static void report(const string& name, double seconds)
+{
+    printf("  %-28s %8.1fx real time %10.3f ms per second of audio\n",
+            name.c_str(), 1.0 / seconds, seconds * 1e3);
+}
+
+static bool run_fixed(unsigned in_rate, unsigned out_rate)
+{
+    const auto in = input_signal(in_rate);
+    const size_t chunk = in_rate / 100; // 10 ms, like the inputs deliver it
+
+    struct {
+        const char *name;
+        resampler_quality_t quality;
+    } qualities[] = {
+        { "fast", resampler_quality_t::Fast },
+        { "medium", resampler_quality_t::Medium },
+        { "best", resampler_quality_t::Best },
+    };
+
+    bool ok = true;
+    printf("Resampler %u -> %u Hz, stereo\n", in_rate, out_rate);
+    for (const auto& q : qualities) {
+        vector<int16_t> reference;
+        for (const auto& kernel : Resampler::kernels()) {
+            vector<int16_t> out, all;
+            Resampler resampler(in_rate, out_rate, channels, q.quality);
+            resampler.set_kernel(kernel);
+            auto convert = [&]() {
+                all.clear();
+                for (size_t pos = 0; pos < in.size(); pos += channels * chunk) {
+                    resampler.process(in.data() + pos, chunk, out);
+                    all.insert(all.end(), out.begin(), out.end());
+                }
+            };
+
+            // The first second from the initial state is compared
+            convert();
+            if (reference.empty()) {
+                reference = all;
+            }
+            else if (max_difference(all, reference) > 1) {
+                fprintf(stderr, "%s %s differs from the scalar kernel\n",
+                        q.name, kernel.c_str());
+                ok = false;
+            }
+
+            report(string(q.name) + " " + kernel,
+                    bench::seconds_per_call(convert, 0.5, 3));
+        }
+    }
+    return ok;
+}
+
+static bool run_variable()
+{
+    const unsigned rate = 48000;
+    const auto in = input_signal(rate + 4096);
+    const size_t chunk = rate / 100;
+    const double ratio = 1.0001;
+
+    bool ok = true;
+    printf("VariableResampler, ratio %.4f, stereo\n", ratio);
+    vector<int16_t> reference;
+    for (const auto& kernel : Resampler::kernels()) {
+        vector<int16_t> out(channels * rate);
+        VariableResampler resampler(channels, resampler_quality_t::Medium);
+        resampler.set_kernel(kernel);
+        resampler.set_ratio(ratio);
+        auto convert = [&]() {
+            size_t pos = 0;
+            for (size_t n = 0; n < rate; n += chunk) {
+                const size_t num_in = resampler.input_frames_for(chunk);
+                resampler.process(in.data() + channels * pos, num_in,
+                        out.data() + channels * n, chunk);
+                pos += num_in;
+            }
+        };
+
+        convert();
+        if (reference.empty()) {
+            reference = out;
+        }
+        else if (max_difference(out, reference) > 1) {
+            fprintf(stderr, "VariableResampler %s differs from the scalar kernel\n",
+                    kernel.c_str());
+            ok = false;
+        }
+
+        report(string("medium ") + kernel, bench::seconds_per_call(convert, 0.5, 3));
+    }
+    return ok;
+}
+
+int main()
+{
+    bool ok = true;
+    ok &= run_fixed(44100, 48000);
+    ok &= run_fixed(96000, 48000);
+    ok &= run_fixed(96000, 24000);
+    ok &= run_variable();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,86 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+
+/* Encode time and quality of the FDK-AAC encoder with and without the
+ * scalefactor cache of the afterburner (AACENC_SCF_CACHE, --scf-cache).
+ *
+ * Both encodes run seven times in turns. Their encode time, see
+ * bench::encode_timed(), is reported with the segmental SNR of the decoded
+ * output. No perceptual measure like ODG is available here, so the SNR
+ * only shows whether the quality drops.
+ *
+ * The cache is ignored with SBR, and the program fails if the output of
+ * HE-AAC changes with it.
+ *
+ * Usage: scf_cache_bench [file.wav...], 48 kHz stereo files. Without
+ * arguments, a synthetic signal is used. */
+
+#include "bench.h"
+#include "aac_bench.h"
+
+using namespace std;
+
+int main(int argc, char **argv)
+{
+    struct {
+        const char *name;
+        int aot;
+        int subchannel_index;
+    } modes[] = {
+        { "AAC-LC 96 kbps", AOT_DABPLUS_AAC_LC, 12 },
+        { "AAC-LC 128 kbps", AOT_DABPLUS_AAC_LC, 16 },
+        { "HE-AAC 64 kbps", AOT_DABPLUS_SBR, 8 },
+    };
+
+    bool ok = true;
+    for (const auto& signal : bench::signals(argc, argv)) {
+        for (const auto& mode : modes) {
+            bench::AacConfig config;
+            config.aot = mode.aot;
+            config.subchannel_index = mode.subchannel_index;
+
+            vector<uint8_t> out[2];
+            vector<double> frame_times[2];
+            for (int run = 0; run < 7; run++) {
+                for (int cache = 0; cache < 2; cache++) {
+                    config.scf_cache = cache;
+                    bench::encode_timed(config, signal, out[cache], frame_times[cache]);
+                }
+            }
+            const double seconds[2] = {
+                bench::sum(frame_times[0]), bench::sum(frame_times[1]) };
+
+            printf("%s, %s\n", signal.name.c_str(), mode.name);
+            if (mode.aot != AOT_DABPLUS_AAC_LC) {
+                printf("  the cache is ignored, %s\n",
+                        out[0] == out[1] ? "same output" : "the output differs");
+                ok &= (out[0] == out[1]);
+                continue;
+            }
+
+            for (int cache = 0; cache < 2; cache++) {
+                const auto decoded = bench::decode(out[cache], mode.subchannel_index);
+                printf("  %-12s %7.3f s  segSNR %6.2f dB\n",
+                        cache ? "cache" : "no cache", seconds[cache],
+                        bench::seg_snr(signal, decoded));
+            }
+            printf("  %+.1f%% encode time\n", (seconds[1] / seconds[0] - 1.0) * 100);
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,327 @@
+/*
+   Copyright (C) 2026
+   agent, agent@local
+
+    http://www.opendigitalradio.org
+
+   CRC engine shared by the EDI output and toolame
+   */
+/*
+   This file is part of the ODR-mmbTools.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define CRC_ENGINE_PCLMUL
+#  include <immintrin.h>
+#endif
+
+namespace crc_engine_detail {
+
+/* tables[k][b] is b * x^(width + 8k) mod P, which is what byte b adds
+ * to the CRC when it is followed by k other bytes */
+template<typename T, T Poly>
+constexpr std::array<std::array<T, 256>, 8> makeTables()
+{
+    constexpr unsigned width = 8 * sizeof(T);
+    constexpr uint64_t mask = (1ull << width) - 1;
+
+    std::array<std::array<T, 256>, 8> t{};
+    for (unsigned b = 0; b < 256; b++) {
+        uint64_t c = (uint64_t)b << (width - 8);
+        for (int i = 0; i < 8; i++) {
+            const bool msb = (c >> (width - 1)) & 1;
+            c = (c << 1) & mask;
+            if (msb) {
+                c ^= Poly;
+            }
+        }
+        t[0][b] = (T)c;
+    }
+
+    for (unsigned k = 1; k < 8; k++) {
+        for (unsigned b = 0; b < 256; b++) {
+            const uint64_t prev = t[k-1][b];
+            t[k][b] = (T)(((prev << 8) & mask) ^ t[0][prev >> (width - 8)]);
+        }
+    }
+    return t;
+}
+
+#if defined(CRC_ENGINE_PCLMUL)
+/* Load 16 bytes with the first bit of the first byte as bit 127 */
+__attribute__((target("pclmul,ssse3")))
+inline __m128i load(const uint8_t* p)
+{
+    const __m128i bswap = _mm_set_epi8(
+            0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    return _mm_shuffle_epi8(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), bswap);
+}
+
+/* x * x^D mod P, given k = { x^D mod P, x^(D+64) mod P } */
+__attribute__((target("pclmul,ssse3")))
+inline __m128i fold(__m128i x, __m128i k)
+{
+    return _mm_xor_si128(
+            _mm_clmulepi64_si128(x, k, 0x11),
+            _mm_clmulepi64_si128(x, k, 0x00));
+}
+#endif
+
+/* x^n mod P, with P including its x^width term */
+template<typename T, T Poly>
+constexpr uint64_t xpowMod(unsigned n)
+{
+    constexpr unsigned width = 8 * sizeof(T);
+    const uint64_t p = (1ull << width) | Poly;
+    uint64_t r = 1;
+    for (unsigned i = 0; i < n; i++) {
+        r <<= 1;
+        if (r & (1ull << width)) {
+            r ^= p;
+        }
+    }
+    return r;
+}
+
+}
+
+/* Most significant bit first (not reflected) CRC of 8, 16 or 32 bits, with
+ * the generator polynomial Poly given without its x^width term.
+ *
+ * The functions take the CRC register and return the updated one. Initial
+ * value and final inversion are left to the caller, because every user
+ * handles them differently.
+ *
+ * The lookup tables are generated at compile time. Byte buffers are processed
+ * eight bytes at a time (slicing-by-8), or with carry-less multiplication
+ * when the CPU supports PCLMULQDQ and the buffer is long enough. */
+template<typename T, T Poly>
+class CrcEngine
+{
+public:
+    static constexpr unsigned width = 8 * sizeof(T);
+
+    /* Process len bytes */
+    static T update(T crc, const uint8_t* data, size_t len);
+
+    /* Process the eight bytes of v, most significant byte first */
+    static T update64(T crc, uint64_t v)
+    {
+        v ^= (uint64_t)crc << (64 - width);
+        return tables[7][v >> 56] ^
+               tables[6][(v >> 48) & 0xFF] ^
+               tables[5][(v >> 40) & 0xFF] ^
+               tables[4][(v >> 32) & 0xFF] ^
+               tables[3][(v >> 24) & 0xFF] ^
+               tables[2][(v >> 16) & 0xFF] ^
+               tables[1][(v >> 8) & 0xFF] ^
+               tables[0][v & 0xFF];
+    }
+
+    /* Process one byte */
+    static T update8(T crc, uint8_t byte)
+    {
+        return (T)(crc << 8) ^ tables[0][((crc >> (width - 8)) ^ byte) & 0xFF];
+    }
+
+    /* Process the nbits (at most 32) least significant bits of data,
+     * most significant bit first */
+    static T updateBits(T crc, uint32_t data, unsigned nbits)
+    {
+        while (nbits > 8) {
+            nbits -= 8;
+            crc = update8(crc, data >> nbits);
+        }
+
+        if (nbits > 0) {
+            // The table entry for an n-bit value is that value times x^width,
+            // which is all that n steps of the shift register add
+            const uint32_t mask = (1u << nbits) - 1;
+            crc = (T)(crc << nbits) ^
+                tables[0][((crc >> (width - nbits)) ^ data) & mask];
+        }
+        return crc;
+    }
+
+    /* Process nbytes zero bytes */
+    static T updateZeros(T crc, size_t nbytes)
+    {
+        for (; nbytes >= 8; nbytes -= 8) {
+            crc = update64(crc, 0);
+        }
+        for (; nbytes > 0; nbytes--) {
+            crc = update8(crc, 0);
+        }
+        return crc;
+    }
+
+    /* Process len bytes with the lookup tables only */
+    static T updateTable(T crc, const uint8_t* data, size_t len)
+    {
+        for (; len >= 8; len -= 8, data += 8) {
+            const uint64_t v =
+                (uint64_t)data[0] << 56 | (uint64_t)data[1] << 48 |
+                (uint64_t)data[2] << 40 | (uint64_t)data[3] << 32 |
+                (uint64_t)data[4] << 24 | (uint64_t)data[5] << 16 |
+                (uint64_t)data[6] << 8 | (uint64_t)data[7];
+            crc = update64(crc, v);
+        }
+        for (; len > 0; len--) {
+            crc = update8(crc, *data++);
+        }
+        return crc;
+    }
+
+#if defined(CRC_ENGINE_PCLMUL)
+    /* Process len (at least 16) bytes with PCLMULQDQ. Only call this if
+     * haveClmul() returns true. */
+    __attribute__((target("pclmul,ssse3")))
+    static T updateClmul(T crc, const uint8_t* data, size_t len);
+#endif
+
+    static bool haveClmul()
+    {
+#if defined(CRC_ENGINE_PCLMUL)
+        static const bool have = []() {
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("pclmul") and
+                __builtin_cpu_supports("ssse3");
+        }();
+        return have;
+#else
+        return false;
+#endif
+    }
+
+    /* Below this length, setting up the carry-less multiplication costs
+     * more than it saves */
+    static constexpr size_t clmul_min_len = 32;
+
+private:
+    static_assert(width == 8 or width == 16 or width == 32,
+            "CrcEngine supports 8, 16 and 32 bit CRCs");
+
+    using tables_t = std::array<std::array<T, 256>, 8>;
+
+    static constexpr tables_t tables = crc_engine_detail::makeTables<T, Poly>();
+};
+
+template<typename T, T Poly>
+inline T CrcEngine<T, Poly>::update(T crc, const uint8_t* data, size_t len)
+{
+#if defined(CRC_ENGINE_PCLMUL)
+    if (len >= clmul_min_len and haveClmul()) {
+        return updateClmul(crc, data, len);
+    }
+#endif
+    return updateTable(crc, data, len);
+}
+
+#if defined(CRC_ENGINE_PCLMUL)
+/* The buffer is read as one polynomial in 128-bit blocks. Folding replaces a
+ * block X, which is followed by D bits, with a value of at most 96 bits
+ * that is congruent to X * x^D mod P:
+ *
+ *   X * x^D = Xhi * x^(D+64) + Xlo * x^D
+ *          == Xhi * (x^(D+64) mod P) + Xlo * (x^D mod P)
+ *
+ * Four blocks are folded in parallel over 64-byte strides, then folded
+ * together. The last 128-bit remainder and the tail that does not fill a
+ * block are reduced with the lookup tables. */
+template<typename T, T Poly>
+__attribute__((target("pclmul,ssse3")))
+T CrcEngine<T, Poly>::updateClmul(T crc, const uint8_t* data, size_t len)
+{
+    using crc_engine_detail::load;
+    using crc_engine_detail::fold;
+    using crc_engine_detail::xpowMod;
+    constexpr uint64_t k128_lo = xpowMod<T, Poly>(128);
+    constexpr uint64_t k128_hi = xpowMod<T, Poly>(128 + 64);
+    constexpr uint64_t k512_lo = xpowMod<T, Poly>(512);
+    constexpr uint64_t k512_hi = xpowMod<T, Poly>(512 + 64);
+    const __m128i k128 = _mm_set_epi64x(k128_hi, k128_lo);
+    const __m128i k512 = _mm_set_epi64x(k512_hi, k512_lo);
+
+    // The CRC register is added to the first width bits of the message
+    __m128i acc = _mm_xor_si128(load(data),
+            _mm_set_epi64x((uint64_t)crc << (64 - width), 0));
+    data += 16;
+    len -= 16;
+
+    if (len >= 64) {
+        __m128i acc1 = load(data);
+        __m128i acc2 = load(data + 16);
+        __m128i acc3 = load(data + 32);
+        data += 48;
+        len -= 48;
+
+        for (; len >= 64; len -= 64, data += 64) {
+            acc  = _mm_xor_si128(fold(acc,  k512), load(data));
+            acc1 = _mm_xor_si128(fold(acc1, k512), load(data + 16));
+            acc2 = _mm_xor_si128(fold(acc2, k512), load(data + 32));
+            acc3 = _mm_xor_si128(fold(acc3, k512), load(data + 48));
+        }
+
+        acc = _mm_xor_si128(fold(acc, k128), acc1);
+        acc = _mm_xor_si128(fold(acc, k128), acc2);
+        acc = _mm_xor_si128(fold(acc, k128), acc3);
+    }
+
+    for (; len >= 16; len -= 16, data += 16) {
+        acc = _mm_xor_si128(fold(acc, k128), load(data));
+    }
+
+    // acc is congruent to the message read so far, starting from a zero
+    // register. Its CRC is the one of the message.
+    alignas(16) uint64_t words[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(words), acc);
+    crc = update64(0, words[1]);
+    crc = update64(crc, words[0]);
+
+    return updateTable(crc, data, len);
+}
+#endif
+
+/* The CRCs used in this project */
+
+// ITU-T X.25, x^16 + x^12 + x^5 + 1: EDI, DAB+ access unit CRC
+using CrcCCITT = CrcEngine<uint16_t, 0x1021>;
+
+// x^16 + x^15 + x^2 + 1: MPEG Audio header CRC
+using Crc16_8005 = CrcEngine<uint16_t, 0x8005>;
+
+// x^16 + x^15 + x^5 + 1
+using Crc16_8021 = CrcEngine<uint16_t, 0x8021>;
+
+// x^16 + x^14 + x^13 + x^12 + x^11 + x^5 + x^3 + x^2 + x + 1: DAB+ firecode
+using CrcFirecode = CrcEngine<uint16_t, 0x782f>;
+
+// x^8 + x^2 + x + 1
+using Crc8_07 = CrcEngine<uint8_t, 0x07>;
+
+// x^8 + x^4 + x^3 + x^2 + 1: DAB ScF-CRC
+using Crc8_1D = CrcEngine<uint8_t, 0x1d>;
+
+// x^32 + x^26 + x^23 + ... + 1, not reflected
+using Crc32_04C11DB7 = CrcEngine<uint32_t, 0x04c11db7>;
+
@@ -37,8 +37,304 @@ extern "C" {
 }
 #include <assert.h>
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define RS_X86
+#  include <immintrin.h>
+#elif defined(__aarch64__)
+#  define RS_NEON
+#  include <arm_neon.h>
+#endif
+
 #define SYMSIZE     8
 
+/* All encoders below run the same LFSR as libfec's encode_rs_char(): for
+ * each data byte, the feedback fb = data ^ parity[0] is computed, the
+ * parity register is shifted by one byte and the products of fb with the
+ * generator polynomial coefficients are XORed into it. Instead of two
+ * log/antilog lookups per parity byte, the products come from
+ * precomputed tables. */
+
+static void encode_interleaved_scalar(
+        const uint8_t* products,
+        const uint8_t* /*nibble_lo*/, const uint8_t* /*nibble_hi*/,
+        int nroots, int k,
+        const uint8_t* data, uint8_t* fec, size_t count)
+{
+    uint8_t parity[255];
+
+    for (size_t c = 0; c < count; c++) {
+        memset(parity, 0, nroots);
+
+        for (int i = 0; i < k; i++) {
+            const uint8_t fb = data[i * count + c] ^ parity[0];
+            const uint8_t* row = products + fb * nroots;
+            for (int j = 0; j < nroots - 1; j++) {
+                parity[j] = parity[j + 1] ^ row[j];
+            }
+            parity[nroots - 1] = row[nroots - 1];
+        }
+
+        for (int j = 0; j < nroots; j++) {
+            fec[j * count + c] = parity[j];
+        }
+    }
+}
+
+/* The SIMD kernels encode one codeword per byte lane. The GF(256) products
+ * are computed with a 16-entry table lookup per nibble of the feedback
+ * byte. When fewer codewords than lanes remain, they go through a zero
+ * padded scratch block. */
+
+#if defined(RS_X86)
+__attribute__((target("ssse3")))
+static void encode_interleaved_ssse3(
+        const uint8_t* /*products*/,
+        const uint8_t* nibble_lo, const uint8_t* nibble_hi,
+        int nroots, int k,
+        const uint8_t* data, uint8_t* fec, size_t count)
+{
+    const size_t L = 16;
+    __m128i tlo[255], thi[255], par[255];
+    uint8_t scratch_in[255 * 16], scratch_out[255 * 16];
+
+    for (int j = 0; j < nroots; j++) {
+        tlo[j] = _mm_loadu_si128((const __m128i*)(nibble_lo + 16 * j));
+        thi[j] = _mm_loadu_si128((const __m128i*)(nibble_hi + 16 * j));
+    }
+
+    const __m128i mask = _mm_set1_epi8(0x0F);
+
+    for (size_t c = 0; c < count; c += L) {
+        const size_t lanes = std::min(L, count - c);
+        const uint8_t* in = data + c;
+        size_t in_stride = count;
+        uint8_t* out = fec + c;
+        size_t out_stride = count;
+
+        if (lanes < L) {
+            memset(scratch_in, 0, sizeof(scratch_in));
+            for (int i = 0; i < k; i++) {
+                memcpy(scratch_in + i * L, data + i * count + c, lanes);
+            }
+            in = scratch_in;
+            in_stride = L;
+            out = scratch_out;
+            out_stride = L;
+        }
+
+        for (int j = 0; j < nroots; j++) {
+            par[j] = _mm_setzero_si128();
+        }
+
+        for (int i = 0; i < k; i++) {
+            const __m128i d = _mm_loadu_si128((const __m128i*)(in + i * in_stride));
+            const __m128i fb = _mm_xor_si128(d, par[0]);
+            const __m128i lo = _mm_and_si128(fb, mask);
+            const __m128i hi = _mm_and_si128(_mm_srli_epi16(fb, 4), mask);
+            for (int j = 0; j < nroots - 1; j++) {
+                const __m128i prod = _mm_xor_si128(
+                        _mm_shuffle_epi8(tlo[j], lo),
+                        _mm_shuffle_epi8(thi[j], hi));
+                par[j] = _mm_xor_si128(par[j + 1], prod);
+            }
+            par[nroots - 1] = _mm_xor_si128(
+                    _mm_shuffle_epi8(tlo[nroots - 1], lo),
+                    _mm_shuffle_epi8(thi[nroots - 1], hi));
+        }
+
+        for (int j = 0; j < nroots; j++) {
+            _mm_storeu_si128((__m128i*)(out + j * out_stride), par[j]);
+        }
+
+        if (lanes < L) {
+            for (int j = 0; j < nroots; j++) {
+                memcpy(fec + j * count + c, scratch_out + j * L, lanes);
+            }
+        }
+    }
+}
+
+__attribute__((target("avx2")))
+static void encode_interleaved_avx2(
+        const uint8_t* /*products*/,
+        const uint8_t* nibble_lo, const uint8_t* nibble_hi,
+        int nroots, int k,
+        const uint8_t* data, uint8_t* fec, size_t count)
+{
+    const size_t L = 32;
+    __m256i tlo[255], thi[255], par[255];
+    uint8_t scratch_in[255 * 32], scratch_out[255 * 32];
+
+    for (int j = 0; j < nroots; j++) {
+        tlo[j] = _mm256_broadcastsi128_si256(
+                _mm_loadu_si128((const __m128i*)(nibble_lo + 16 * j)));
+        thi[j] = _mm256_broadcastsi128_si256(
+                _mm_loadu_si128((const __m128i*)(nibble_hi + 16 * j)));
+    }
+
+    const __m256i mask = _mm256_set1_epi8(0x0F);
+
+    for (size_t c = 0; c < count; c += L) {
+        const size_t lanes = std::min(L, count - c);
+        const uint8_t* in = data + c;
+        size_t in_stride = count;
+        uint8_t* out = fec + c;
+        size_t out_stride = count;
+
+        if (lanes < L) {
+            memset(scratch_in, 0, sizeof(scratch_in));
+            for (int i = 0; i < k; i++) {
+                memcpy(scratch_in + i * L, data + i * count + c, lanes);
+            }
+            in = scratch_in;
+            in_stride = L;
+            out = scratch_out;
+            out_stride = L;
+        }
+
+        for (int j = 0; j < nroots; j++) {
+            par[j] = _mm256_setzero_si256();
+        }
+
+        for (int i = 0; i < k; i++) {
+            const __m256i d = _mm256_loadu_si256((const __m256i*)(in + i * in_stride));
+            const __m256i fb = _mm256_xor_si256(d, par[0]);
+            const __m256i lo = _mm256_and_si256(fb, mask);
+            const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(fb, 4), mask);
+            for (int j = 0; j < nroots - 1; j++) {
+                const __m256i prod = _mm256_xor_si256(
+                        _mm256_shuffle_epi8(tlo[j], lo),
+                        _mm256_shuffle_epi8(thi[j], hi));
+                par[j] = _mm256_xor_si256(par[j + 1], prod);
+            }
+            par[nroots - 1] = _mm256_xor_si256(
+                    _mm256_shuffle_epi8(tlo[nroots - 1], lo),
+                    _mm256_shuffle_epi8(thi[nroots - 1], hi));
+        }
+
+        for (int j = 0; j < nroots; j++) {
+            _mm256_storeu_si256((__m256i*)(out + j * out_stride), par[j]);
+        }
+
+        if (lanes < L) {
+            for (int j = 0; j < nroots; j++) {
+                memcpy(fec + j * count + c, scratch_out + j * L, lanes);
+            }
+        }
+    }
+}
+#endif // RS_X86
+
+#if defined(RS_NEON)
+static void encode_interleaved_neon(
+        const uint8_t* /*products*/,
+        const uint8_t* nibble_lo, const uint8_t* nibble_hi,
+        int nroots, int k,
+        const uint8_t* data, uint8_t* fec, size_t count)
+{
+    const size_t L = 16;
+    uint8x16_t tlo[255], thi[255], par[255];
+    uint8_t scratch_in[255 * 16], scratch_out[255 * 16];
+
+    for (int j = 0; j < nroots; j++) {
+        tlo[j] = vld1q_u8(nibble_lo + 16 * j);
+        thi[j] = vld1q_u8(nibble_hi + 16 * j);
+    }
+
+    const uint8x16_t mask = vdupq_n_u8(0x0F);
+
+    for (size_t c = 0; c < count; c += L) {
+        const size_t lanes = std::min(L, count - c);
+        const uint8_t* in = data + c;
+        size_t in_stride = count;
+        uint8_t* out = fec + c;
+        size_t out_stride = count;
+
+        if (lanes < L) {
+            memset(scratch_in, 0, sizeof(scratch_in));
+            for (int i = 0; i < k; i++) {
+                memcpy(scratch_in + i * L, data + i * count + c, lanes);
+            }
+            in = scratch_in;
+            in_stride = L;
+            out = scratch_out;
+            out_stride = L;
+        }
+
+        for (int j = 0; j < nroots; j++) {
+            par[j] = vdupq_n_u8(0);
+        }
+
+        for (int i = 0; i < k; i++) {
+            const uint8x16_t fb = veorq_u8(vld1q_u8(in + i * in_stride), par[0]);
+            const uint8x16_t lo = vandq_u8(fb, mask);
+            const uint8x16_t hi = vshrq_n_u8(fb, 4);
+            for (int j = 0; j < nroots - 1; j++) {
+                const uint8x16_t prod = veorq_u8(
+                        vqtbl1q_u8(tlo[j], lo), vqtbl1q_u8(thi[j], hi));
+                par[j] = veorq_u8(par[j + 1], prod);
+            }
+            par[nroots - 1] = veorq_u8(
+                    vqtbl1q_u8(tlo[nroots - 1], lo),
+                    vqtbl1q_u8(thi[nroots - 1], hi));
+        }
+
+        for (int j = 0; j < nroots; j++) {
+            vst1q_u8(out + j * out_stride, par[j]);
+        }
+
+        if (lanes < L) {
+            for (int j = 0; j < nroots; j++) {
+                memcpy(fec + j * count + c, scratch_out + j * L, lanes);
+            }
+        }
+    }
+}
+#endif // RS_NEON
+
+
+std::vector<std::pair<std::string, ReedSolomon::interleaved_kernel_t> >
+ReedSolomon::availableKernels()
+{
+    std::vector<std::pair<std::string, interleaved_kernel_t> > kernels;
+    kernels.emplace_back("table", encode_interleaved_scalar);
+#if defined(RS_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("ssse3")) {
+        kernels.emplace_back("ssse3", encode_interleaved_ssse3);
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        kernels.emplace_back("avx2", encode_interleaved_avx2);
+    }
+#elif defined(RS_NEON)
+    kernels.emplace_back("neon", encode_interleaved_neon);
+#endif
+    return kernels;
+}
+
+
+std::vector<std::string> ReedSolomon::kernels()
+{
+    std::vector<std::string> names;
+    for (const auto& k : availableKernels()) {
+        names.push_back(k.first);
+    }
+    return names;
+}
+
+
+void ReedSolomon::setKernel(const std::string& name)
+{
+    for (const auto& k : availableKernels()) {
+        if (k.first == name) {
+            m_interleaved_kernel = k.second;
+            return;
+        }
+    }
+    throw std::invalid_argument("Reed-Solomon kernel " + name +
+            " is not supported on this CPU");
+}
+
 
 ReedSolomon::ReedSolomon(int N, int K, bool reverse, int gfpoly, int firstRoot, int primElem)
 {
@@ -59,6 +355,37 @@ ReedSolomon::ReedSolomon(int N, int K, bool reverse, int gfpoly, int firstRoot,
             "N=" << N << " ; K=" << K << " ; pad=" << pad;
         throw std::invalid_argument(ss.str());
     }
+
+    m_nroots = nroots;
+
+    /* Build the product tables from the libfec control block, so that
+     * they use exactly the same field and generator polynomial. */
+    const struct rs* rs = reinterpret_cast<const struct rs*>(rsData);
+    auto product = [&](int fb, int j) -> uint8_t {
+        if (fb == 0) {
+            return 0;
+        }
+        return rs->alpha_to[modnn(const_cast<struct rs*>(rs),
+                rs->index_of[fb] + rs->genpoly[nroots - 1 - j])];
+    };
+
+    m_products.resize(256 * nroots);
+    for (int fb = 0; fb < 256; fb++) {
+        for (int j = 0; j < nroots; j++) {
+            m_products[fb * nroots + j] = product(fb, j);
+        }
+    }
+
+    m_nibble_lo.resize(16 * nroots);
+    m_nibble_hi.resize(16 * nroots);
+    for (int j = 0; j < nroots; j++) {
+        for (int n = 0; n < 16; n++) {
+            m_nibble_lo[16 * j + n] = product(n, j);
+            m_nibble_hi[16 * j + n] = product(n << 4, j);
+        }
+    }
+
+    m_interleaved_kernel = availableKernels().back().second;
 }
 
 
@@ -95,7 +422,7 @@ int ReedSolomon::encode(void* data, void* fec, size_t size)
         }
     }
     else {
-        encode_rs_char(rsData, input, output);
+        encodeSingle(input, output);
     }
 
     return ret;
@@ -111,8 +438,23 @@ int ReedSolomon::encode(void* data, size_t size)
         ret = decode_rs_char(rsData, input, nullptr, 0);
     }
     else {
-        encode_rs_char(rsData, input, &input[m_K]);
+        encodeSingle(input, &input[m_K]);
     }
 
     return ret;
 }
+
+
+void ReedSolomon::encodeInterleaved(const uint8_t* data, uint8_t* fec, size_t count) const
+{
+    m_interleaved_kernel(m_products.data(),
+            m_nibble_lo.data(), m_nibble_hi.data(),
+            m_nroots, m_K, data, fec, count);
+}
+
+
+void ReedSolomon::encodeSingle(const uint8_t* data, uint8_t* fec) const
+{
+    encode_interleaved_scalar(m_products.data(), nullptr, nullptr,
+            m_nroots, m_K, data, fec, 1);
+}
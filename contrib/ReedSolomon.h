@@ -32,6 +32,8 @@
 
 #include <cstdlib>
 #include <cstdint>
+#include <string>
+#include <vector>
 
 class ReedSolomon
 {
@@ -47,11 +49,51 @@ public:
     int encode(void* data, void* fec, size_t size);
     int encode(void* data, size_t size);
 
+    /* Encode count codewords stored byte-interleaved: byte i of
+     * codeword c is at data[i * count + c], and parity byte j of codeword c
+     * is written to fec[j * count + c]. This is the layout of the DAB+
+     * superframe, and lets the encoder work on many codewords in parallel.
+     * Output is identical to calling encode() on each codeword. */
+    void encodeInterleaved(const uint8_t* data, uint8_t* fec, size_t count) const;
+
+    /* Names of the encodeInterleaved() kernels the CPU supports, the
+     * portable table-driven one first and the fastest last. */
+    static std::vector<std::string> kernels();
+
+    /* Use the named kernel instead of the fastest one, for tests and
+     * benchmarks. Throws std::invalid_argument for unsupported kernels. */
+    void setKernel(const std::string& name);
+
 private:
+    typedef void (*interleaved_kernel_t)(
+            const uint8_t* products,
+            const uint8_t* nibble_lo, const uint8_t* nibble_hi,
+            int nroots, int k,
+            const uint8_t* data, uint8_t* fec, size_t count);
+
+    void encodeSingle(const uint8_t* data, uint8_t* fec) const;
+
+    static std::vector<std::pair<std::string, interleaved_kernel_t> >
+        availableKernels();
+
     int m_N;
     int m_K;
+    int m_nroots;
 
     void* rsData;
     bool reverse;
-};
 
+    /* Products of the generator polynomial coefficients, in the order
+     * they are applied to the LFSR. m_products[fb * m_nroots + j] is the
+     * value XORed into parity register j when the feedback byte is fb. */
+    std::vector<uint8_t> m_products;
+
+    /* The same products split in 4-bit halves for the SIMD kernels:
+     * coefficient j times n is m_nibble_lo[j*16 + (n & 0xF)] ^
+     * m_nibble_hi[j*16 + (n >> 4)]. */
+    std::vector<uint8_t> m_nibble_lo;
+    std::vector<uint8_t> m_nibble_hi;
+
+    /* Selected at construction according to the CPU features */
+    interleaved_kernel_t m_interleaved_kernel;
+};
@@ -31,6 +31,13 @@
 #include <fcntl.h>
 #include <poll.h>
 #include <netinet/tcp.h>
+#include <sys/uio.h>
+#if defined(HAVE_UDP_SEGMENT)
+#  include <netinet/udp.h>
+#endif
+#if defined(HAVE_SO_TXTIME)
+#  include <linux/net_tstamp.h>
+#endif
 
 namespace Socket {
 
@@ -107,6 +114,8 @@ UDPSocket::UDPSocket(UDPSocket&& other)
     m_sock = other.m_sock;
     m_port = other.m_port;
     m_multicast_source = other.m_multicast_source;
+    m_gso_supported.store(other.m_gso_supported.load(std::memory_order_relaxed),
+            std::memory_order_relaxed);
     other.m_port = 0;
     other.m_sock = INVALID_SOCKET;
     other.m_multicast_source = "";
@@ -117,6 +126,8 @@ const UDPSocket& UDPSocket::operator=(UDPSocket&& other)
     m_sock = other.m_sock;
     m_port = other.m_port;
     m_multicast_source = other.m_multicast_source;
+    m_gso_supported.store(other.m_gso_supported.load(std::memory_order_relaxed),
+            std::memory_order_relaxed);
     other.m_port = 0;
     other.m_sock = INVALID_SOCKET;
     other.m_multicast_source = "";
@@ -352,6 +363,149 @@ void UDPSocket::send(const std::string& data, InetAddress destination)
     }
 }
 
+void UDPSocket::send(const std::vector<std::vector<uint8_t> >& packets,
+        InetAddress destination, bool use_gso, const uint64_t *txtimes_ns)
+{
+#if defined(HAVE_SENDMMSG)
+    // Everything lives on the stack, this is called for every EDI frame
+    constexpr size_t MAX_BATCH = 64;
+    struct mmsghdr msgs[MAX_BATCH];
+    struct iovec iovs[MAX_BATCH];
+    // Index of the first packet of each message, and one past the last
+    size_t msg_first[MAX_BATCH + 1];
+#if defined(HAVE_UDP_SEGMENT) || defined(HAVE_SO_TXTIME)
+    // Holds either the GSO segment size or the transmit time
+    union {
+        char buf[CMSG_SPACE(sizeof(uint64_t))];
+        struct cmsghdr align;
+    } control[MAX_BATCH];
+#endif
+#if defined(HAVE_UDP_SEGMENT)
+    // Payload limit of one GSO buffer, headers excluded
+    constexpr size_t MAX_GSO_BYTES = 65000;
+#else
+    (void)use_gso;
+#endif
+#if !defined(HAVE_SO_TXTIME)
+    if (txtimes_ns) {
+        throw logic_error("SO_TXTIME not supported");
+    }
+#endif
+
+    size_t next = 0;
+    while (next < packets.size()) {
+        size_t num_msgs = 0;
+        size_t num_iovs = 0;
+
+        while (next < packets.size() and num_iovs < MAX_BATCH) {
+            struct msghdr& hdr = msgs[num_msgs].msg_hdr;
+            memset(&hdr, 0, sizeof(hdr));
+            hdr.msg_name = destination.as_sockaddr();
+            hdr.msg_namelen = sizeof(struct sockaddr_in);
+            hdr.msg_iov = &iovs[num_iovs];
+            msg_first[num_msgs] = next;
+
+            const size_t segment_size = packets[next].size();
+            size_t total_size = segment_size;
+            iovs[num_iovs].iov_base = const_cast<uint8_t*>(packets[next].data());
+            iovs[num_iovs].iov_len = segment_size;
+            num_iovs++;
+            next++;
+
+#if defined(HAVE_SO_TXTIME)
+            if (txtimes_ns) {
+                hdr.msg_control = control[num_msgs].buf;
+                hdr.msg_controllen = CMSG_SPACE(sizeof(uint64_t));
+                struct cmsghdr *cm = CMSG_FIRSTHDR(&hdr);
+                cm->cmsg_level = SOL_SOCKET;
+                cm->cmsg_type = SCM_TXTIME;
+                cm->cmsg_len = CMSG_LEN(sizeof(uint64_t));
+                memcpy(CMSG_DATA(cm), &txtimes_ns[next - 1], sizeof(uint64_t));
+            }
+#endif
+#if defined(HAVE_UDP_SEGMENT)
+            if (use_gso and m_gso_supported.load(std::memory_order_relaxed) and
+                    not txtimes_ns) {
+                while (next < packets.size() and
+                        num_iovs < MAX_BATCH and
+                        packets[next - 1].size() == segment_size and
+                        packets[next].size() <= segment_size and
+                        total_size + packets[next].size() <= MAX_GSO_BYTES) {
+                    iovs[num_iovs].iov_base = const_cast<uint8_t*>(packets[next].data());
+                    iovs[num_iovs].iov_len = packets[next].size();
+                    total_size += packets[next].size();
+                    num_iovs++;
+                    next++;
+                }
+
+                if (next - msg_first[num_msgs] > 1) {
+                    hdr.msg_control = control[num_msgs].buf;
+                    hdr.msg_controllen = CMSG_SPACE(sizeof(uint16_t));
+                    struct cmsghdr *cm = CMSG_FIRSTHDR(&hdr);
+                    cm->cmsg_level = SOL_UDP;
+                    cm->cmsg_type = UDP_SEGMENT;
+                    cm->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+                    const uint16_t gso_size = segment_size;
+                    memcpy(CMSG_DATA(cm), &gso_size, sizeof(gso_size));
+                }
+            }
+#endif
+            hdr.msg_iovlen = next - msg_first[num_msgs];
+            num_msgs++;
+        }
+        msg_first[num_msgs] = next;
+
+        size_t msg_ix = 0;
+        while (msg_ix < num_msgs) {
+            const int ret = sendmmsg(m_sock, &msgs[msg_ix], num_msgs - msg_ix, 0);
+            if (ret > 0) {
+                msg_ix += ret;
+            }
+            else if (errno == ECONNREFUSED) {
+                // Same as send(), skip the message
+                msg_ix++;
+            }
+#if defined(HAVE_UDP_SEGMENT)
+            else if (msgs[msg_ix].msg_hdr.msg_iovlen > 1 and
+                    (errno == EIO or errno == EINVAL or errno == ENOPROTOOPT)) {
+                if (m_gso_supported.exchange(false, std::memory_order_relaxed)) {
+                    fprintf(stderr, "UDP GSO not supported (%s), disabling it\n", strerror(errno));
+                }
+                // Rebuild the batch from the failed message on, without GSO
+                next = msg_first[msg_ix];
+                break;
+            }
+#endif
+            else {
+                throw runtime_error(string("Can't send UDP packets: ") + strerror(errno));
+            }
+        }
+    }
+#else
+    if (txtimes_ns) {
+        throw logic_error("SO_TXTIME requires sendmmsg");
+    }
+
+    for (const auto& packet : packets) {
+        send(packet, destination);
+    }
+#endif
+}
+
+void UDPSocket::enableTxTime()
+{
+#if defined(HAVE_SO_TXTIME)
+    struct sock_txtime txtime = {};
+    txtime.clockid = CLOCK_MONOTONIC;
+    txtime.flags = 0;
+    if (setsockopt(m_sock, SOL_SOCKET, SO_TXTIME, &txtime, sizeof(txtime)) == SOCKET_ERROR) {
+        throw runtime_error(string("Can't enable SO_TXTIME: ") + strerror(errno));
+    }
+#else
+    throw runtime_error("SO_TXTIME not supported on this system");
+#endif
+}
+
 void UDPSocket::join_group(const char* groupname, const char* if_addr)
 {
     ip_mreqn group;
@@ -117,10 +117,30 @@ class UDPSocket
         void send(UDPPacket& packet);
         void send(const std::vector<uint8_t>& data, InetAddress destination);
         void send(const std::string& data, InetAddress destination);
+
+        /** Send several packets to the same destination, with one sendmmsg()
+         *  call per batch of packets when available.
+         *  @param use_gso If set and supported, consecutive packets of equal
+         *         size are given to the kernel as one UDP GSO buffer, that is
+         *         split into individual datagrams by the kernel or the NIC.
+         *         Only the last packet of such a run may be shorter.
+         *  @param txtimes_ns If not null, one CLOCK_MONOTONIC transmit time
+         *         per packet, in nanoseconds, for sockets set up with
+         *         enableTxTime(). GSO is not used in that case.
+         */
+        void send(const std::vector<std::vector<uint8_t> >& packets,
+                InetAddress destination, bool use_gso = false,
+                const uint64_t *txtimes_ns = nullptr);
         UDPPacket receive(size_t max_size);
         void setMulticastSource(const char* source_addr);
         void setMulticastTTL(int ttl);
 
+        /** Enable SO_TXTIME, so that packets sent with a transmit time
+         * are held back by the fq qdisc until that time.
+         * Throws a runtime_error if not supported.
+         */
+        void enableTxTime();
+
         /** Set blocking mode. By default, the socket is blocking.
          * throws a runtime_error on error.
          */
@@ -137,6 +157,10 @@ class UDPSocket
         SOCKET m_sock = INVALID_SOCKET;
         int m_port = 0;
         std::string m_multicast_source = "";
+
+        // Cleared when the kernel refuses UDP GSO, to fall back to sendmmsg alone.
+        // Atomic because the Senders of a shared socket run in several threads.
+        std::atomic<bool> m_gso_supported{true};
 };
 
 /* UDP packet receiver supporting receiving from several ports at once */
@@ -0,0 +1,52 @@
+/*
+   Copyright (C) 2003, 2004, 2005, 2006, 2007, 2008, 2009 Her Majesty the
+   Queen in Right of Canada (Communications Research Center Canada)
+   */
+/*
+   This file is part of ODR-DabMux.
+
+   ODR-DabMux is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the
+   License, or (at your option) any later version.
+
+   ODR-DabMux is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with ODR-DabMux.  If not, see <http://www.gnu.org/licenses/>.
+   */
+
+#include "crc.h"
+#include "CrcEngine.h"
+
+uint8_t crc8(uint8_t l_crc, const void *lp_data, unsigned l_nb)
+{
+    return Crc8_07::update(l_crc, (const uint8_t*)lp_data, l_nb);
+}
+
+
+uint16_t crc16(uint16_t l_crc, const void *lp_data, unsigned l_nb)
+{
+    return CrcCCITT::update(l_crc, (const uint8_t*)lp_data, l_nb);
+}
+
+
+uint32_t crc32(uint32_t l_crc, const void *lp_data, unsigned l_nb)
+{
+    return Crc32_04C11DB7::update(l_crc, (const uint8_t*)lp_data, l_nb);
+}
+
+
+uint16_t crc16_mpa_bits(uint16_t l_crc, uint32_t data, unsigned nbits)
+{
+    return Crc16_8005::updateBits(l_crc, data, nbits);
+}
+
+
+uint8_t crc8_scf_bits(uint8_t l_crc, uint32_t data, unsigned nbits)
+{
+    return Crc8_1D::updateBits(l_crc, data, nbits);
+}
@@ -40,17 +40,22 @@
 extern "C" { // }
 #endif
 
-void init_crc8tab(uint8_t l_code, uint8_t l_init);
+/* Most significant bit first CRCs. The register is passed in and returned,
+ * initial value and final inversion are up to the caller.
+ * crc8:  x^8 + x^2 + x + 1
+ * crc16: x^16 + x^12 + x^5 + 1 (CCITT)
+ * crc32: x^32 + x^26 + x^23 + x^22 + x^16 + x^12 + x^11 + x^10 + x^8
+ *        + x^7 + x^5 + x^4 + x^2 + x + 1, not reflected */
 uint8_t crc8(uint8_t l_crc, const void *lp_data, unsigned l_nb);
-extern uint8_t crc8tab[];
-
-void init_crc16tab(uint16_t l_code, uint16_t l_init);
 uint16_t crc16(uint16_t l_crc, const void *lp_data, unsigned l_nb);
-extern uint16_t crc16tab[];
-
-void init_crc32tab(uint32_t l_code, uint32_t l_init);
 uint32_t crc32(uint32_t l_crc, const void *lp_data, unsigned l_nb);
-extern uint32_t crc32tab[];
+
+/* Process the nbits (at most 32) least significant bits of data, for the
+ * CRCs that toolame computes over bitstream fields.
+ * crc16_mpa_bits: x^16 + x^15 + x^2 + 1, MPEG Audio header CRC
+ * crc8_scf_bits:  x^8 + x^4 + x^3 + x^2 + 1, DAB ScF-CRC */
+uint16_t crc16_mpa_bits(uint16_t l_crc, uint32_t data, unsigned nbits);
+uint8_t crc8_scf_bits(uint8_t l_crc, uint32_t data, unsigned nbits);
 
 #ifdef __cplusplus
 }
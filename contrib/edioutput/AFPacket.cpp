@@ -44,40 +44,51 @@ const uint8_t AFHEADER_PT_TAG = 'T';
 // AF Packet Major (3 bits) and Minor (4 bits) version
 const uint8_t AFHEADER_VERSION = 0x10; // MAJ=1, MIN=0
 
-AFPacket AFPacketiser::Assemble(TagPacket tag_packet)
+// SYNC, LEN, SEQ, AR and PT
+const size_t AFHEADER_LEN = 10;
+
+AFPacket AFPacketiser::Assemble(const TagPacket& tag_packet)
 {
-    std::vector<uint8_t> payload = tag_packet.Assemble();
+    AFPacket packet;
+    Assemble(tag_packet, packet);
+    return packet;
+}
 
+void AFPacketiser::Assemble(const TagPacket& tag_packet, AFPacket& packet)
+{
     if (m_verbose)
         std::cerr << "Assemble AFPacket " << m_seq << std::endl;
 
-    std::string pack_data("AF"); // SYNC
-    std::vector<uint8_t> packet(pack_data.begin(), pack_data.end());
+    // The header is filled in once the payload length is known
+    packet.resize(AFHEADER_LEN);
+
+    // insert payload, must have a length multiple of 8 bytes
+    tag_packet.AssembleInto(packet);
 
-    uint32_t taglength = payload.size();
+    uint32_t taglength = packet.size() - AFHEADER_LEN;
 
     if (m_verbose)
-        std::cerr << "         AFPacket payload size " << payload.size() << std::endl;
+        std::cerr << "         AFPacket payload size " << taglength << std::endl;
+
+    packet[0] = 'A'; // SYNC
+    packet[1] = 'F';
 
     // write length into packet
-    packet.push_back((taglength >> 24) & 0xFF);
-    packet.push_back((taglength >> 16) & 0xFF);
-    packet.push_back((taglength >> 8) & 0xFF);
-    packet.push_back(taglength & 0xFF);
+    packet[2] = (taglength >> 24) & 0xFF;
+    packet[3] = (taglength >> 16) & 0xFF;
+    packet[4] = (taglength >> 8) & 0xFF;
+    packet[5] = taglength & 0xFF;
 
     // fill rest of header
-    packet.push_back(m_seq >> 8);
-    packet.push_back(m_seq & 0xFF);
+    packet[6] = m_seq >> 8;
+    packet[7] = m_seq & 0xFF;
     m_seq++;
-    packet.push_back((m_have_crc ? 0x80 : 0) | AFHEADER_VERSION); // ar_cf: CRC=1
-    packet.push_back(AFHEADER_PT_TAG);
-
-    // insert payload, must have a length multiple of 8 bytes
-    packet.insert(packet.end(), payload.begin(), payload.end());
+    packet[8] = (m_have_crc ? 0x80 : 0) | AFHEADER_VERSION; // ar_cf: CRC=1
+    packet[9] = AFHEADER_PT_TAG;
 
     // calculate CRC over AF Header and payload
     uint16_t crc = 0xffff;
-    crc = crc16(crc, &(packet.front()), packet.size());
+    crc = crc16(crc, packet.data(), packet.size());
     crc ^= 0xffff;
 
     if (m_verbose)
@@ -88,8 +99,6 @@ AFPacket AFPacketiser::Assemble(TagPacket tag_packet)
 
     if (m_verbose)
         std::cerr << "         AFPacket length " << packet.size() << std::endl;
-
-    return packet;
 }
 
 void AFPacketiser::OverrideSeq(uint16_t seq)
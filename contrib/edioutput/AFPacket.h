@@ -46,7 +46,12 @@ class AFPacketiser
         AFPacketiser(bool verbose) :
             m_verbose(verbose) {};
 
-        AFPacket Assemble(TagPacket tag_packet);
+        AFPacket Assemble(const TagPacket& tag_packet);
+
+        // Assemble the AF packet into af_packet, replacing its contents.
+        // The TAG packet is written directly behind the AF header, and
+        // af_packet keeps its capacity, so that it can be reused.
+        void Assemble(const TagPacket& tag_packet, AFPacket& af_packet);
 
         void OverrideSeq(uint16_t seq);
 
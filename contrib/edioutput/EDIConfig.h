@@ -32,6 +32,10 @@
 #include <memory>
 #include <cstdint>
 
+namespace Socket {
+class UDPSocket;
+}
+
 namespace edi {
 
 /** Configuration for EDI output */
@@ -77,6 +81,16 @@ struct configuration_t {
     // Spread transmission of fragments in time. 1.0 = 100% means spreading over the whole duration of a frame (24ms)
     // Above 100% means that the fragments are spread over several 24ms periods, interleaving the AF packets.
 
+    // Give fragments that are due at the same time to the kernel as one UDP GSO buffer
+    bool udp_gso = false;
+
+    // Let the kernel pace the fragments using SO_TXTIME, requires the fq qdisc
+    bool udp_txtime = false;
+
+    // If set, UDP destinations without source port and multicast source use this socket
+    // instead of opening their own. Allows several senders in one process to share a socket.
+    std::shared_ptr<Socket::UDPSocket> shared_udp_socket;
+
     bool enabled() const { return destinations.size() > 0; }
 
     void print() const;
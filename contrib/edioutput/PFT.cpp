@@ -31,7 +31,7 @@
  */
 
 #include <vector>
-#include <list>
+#include <algorithm>
 #include <cstdio>
 #include <cstring>
 #include <cstdint>
@@ -72,23 +72,23 @@ PFT::PFT(const configuration_t &conf) :
         }
     }
 
-RSBlock PFT::Protect(AFPacket af_packet)
+RSBlock PFT::Protect(const uint8_t *af_packet, size_t af_packet_len)
 {
     RSBlock rs_block;
 
     // number of chunks is ceil(afpacketsize / m_k)
     // TS 102 821 7.2.2: c = ceil(l / k_max)
-    m_num_chunks = CEIL_DIV(af_packet.size(), m_k);
+    m_num_chunks = CEIL_DIV(af_packet_len, m_k);
 
     if (m_verbose) {
         fprintf(stderr, "Protect %zu chunks of size %zu\n",
-                m_num_chunks, af_packet.size());
+                m_num_chunks, af_packet_len);
     }
 
     // calculate size of chunk:
     // TS 102 821 7.2.2: k = ceil(l / c)
     // chunk_len does not include the 48 bytes of protection.
-    const size_t chunk_len = CEIL_DIV(af_packet.size(), m_num_chunks);
+    const size_t chunk_len = CEIL_DIV(af_packet_len, m_num_chunks);
     if (chunk_len > 207) {
         std::stringstream ss;
         ss << "Chunk length " << chunk_len << " too large (>207)";
@@ -97,68 +97,51 @@ RSBlock PFT::Protect(AFPacket af_packet)
 
     // The last RS chunk is zero padded
     // TS 102 821 7.2.2: z = c*k - l
-    const size_t zero_pad = m_num_chunks * chunk_len - af_packet.size();
-
-    // Create the RS(k+p,k) encoder
-    const int firstRoot = 1; // Discovered by analysing EDI dump
-    const int gfPoly = 0x11d;
-    const bool reverse = false;
-    // The encoding has to be 255, 207 always, because the chunk has to
-    // be padded at the end, and not at the beginning as libfec would
-    // do
-    ReedSolomon rs_encoder(255, 207, reverse, gfPoly, firstRoot);
-
-    // add zero padding to last chunk
-    for (size_t i = 0; i < zero_pad; i++) {
-        af_packet.push_back(0);
-    }
+    const size_t zero_pad = m_num_chunks * chunk_len - af_packet_len;
 
     if (m_verbose) {
         fprintf(stderr, "        add %zu zero padding\n", zero_pad);
     }
 
-    // Calculate RS for each chunk and assemble RS block
-    for (size_t i = 0; i < af_packet.size(); i+= chunk_len) {
-        vector<uint8_t> chunk(207);
-        vector<uint8_t> protection(PARITYBYTES);
-
-        // copy chunk_len bytes into new chunk
-        memcpy(&chunk.front(), &af_packet[i], chunk_len);
-
-        // calculate RS for chunk with padding
-        rs_encoder.encode(&chunk.front(), &protection.front(), 207);
-
-        // Drop the padding
-        chunk.resize(chunk_len);
+    // Interleave the chunks, each padded to 207 bytes, so that all of
+    // them are encoded in one pass. The bytes past the end of the AF
+    // packet are the zero padding of the last chunk.
+    const size_t num_chunks = m_num_chunks;
+    m_interleaved.assign(207 * num_chunks, 0);
+    for (size_t c = 0; c < num_chunks; c++) {
+        const size_t chunk_end = std::min((c + 1) * chunk_len, af_packet_len);
+        for (size_t ix = c * chunk_len; ix < chunk_end; ix++) {
+            m_interleaved[(ix - c * chunk_len) * num_chunks + c] = af_packet[ix];
+        }
+    }
 
-        // append new chunk and protection to the RS Packet
-        rs_block.insert(rs_block.end(), chunk.begin(), chunk.end());
-        rs_block.insert(rs_block.end(), protection.begin(), protection.end());
+    m_protection.resize(PARITYBYTES * num_chunks);
+    m_rs_encoder.encodeInterleaved(m_interleaved.data(), m_protection.data(), num_chunks);
+
+    // Assemble the RS block: each chunk without padding, followed by its
+    // protection
+    rs_block.reserve(num_chunks * (chunk_len + PARITYBYTES));
+    for (size_t c = 0; c < num_chunks; c++) {
+        const size_t chunk_start = std::min(c * chunk_len, af_packet_len);
+        const size_t chunk_end = std::min((c + 1) * chunk_len, af_packet_len);
+        rs_block.insert(rs_block.end(),
+                af_packet + chunk_start, af_packet + chunk_end);
+        rs_block.insert(rs_block.end(), chunk_len - (chunk_end - chunk_start), 0);
+        for (size_t j = 0; j < PARITYBYTES; j++) {
+            rs_block.push_back(m_protection[j * num_chunks + c]);
+        }
     }
 
     return rs_block;
 }
 
-vector< vector<uint8_t> > PFT::ProtectAndFragment(AFPacket af_packet)
+vector< vector<uint8_t> > PFT::ProtectAndFragment(
+        const uint8_t *af_packet, size_t af_packet_len, size_t header_room)
 {
     const bool enable_RS = (m_m > 0);
 
     if (enable_RS) {
-        RSBlock rs_block = Protect(af_packet);
-
-#if 0
-        fprintf(stderr, "  af_packet (%zu):", af_packet.size());
-        for (size_t i = 0; i < af_packet.size(); i++) {
-            fprintf(stderr, "%02x ", af_packet[i]);
-        }
-        fprintf(stderr, "\n");
-
-        fprintf(stderr, "  rs_block (%zu):", rs_block.size());
-        for (size_t i = 0; i < rs_block.size(); i++) {
-            fprintf(stderr, "%02x ", rs_block[i]);
-        }
-        fprintf(stderr, "\n");
-#endif
+        RSBlock rs_block = Protect(af_packet, af_packet_len);
 
         // TS 102 821 7.2.2: s_max = MIN(floor(c*p/(m+1)), MTU - h))
         const size_t max_payload_size = ( m_num_chunks * PARITYBYTES ) / (m_m + 1);
@@ -178,14 +161,15 @@ vector< vector<uint8_t> > PFT::ProtectAndFragment(AFPacket af_packet)
         vector< vector<uint8_t> > fragments(num_fragments);
 
         for (size_t i = 0; i < num_fragments; i++) {
-            fragments[i].resize(fragment_size);
+            fragments[i].resize(header_room + fragment_size);
+            uint8_t *payload = fragments[i].data() + header_room;
             for (size_t j = 0; j < fragment_size; j++) {
                 const size_t ix = j*num_fragments + i;
                 if (ix < rs_block.size()) {
-                    fragments[i][j] = rs_block[ix];
+                    payload[j] = rs_block[ix];
                 }
                 else {
-                    fragments[i][j] = 0;
+                    payload[j] = 0;
                 }
             }
         }
@@ -201,74 +185,76 @@ vector< vector<uint8_t> > PFT::ProtectAndFragment(AFPacket af_packet)
         // Calculate fragment count and size
         // TS 102 821 7.2.2: ceil((l + c*p + z) / s_max)
         // l + c*p + z = length of AF packet
-        const size_t num_fragments = CEIL_DIV(af_packet.size(), max_payload_size);
+        const size_t num_fragments = CEIL_DIV(af_packet_len, max_payload_size);
 
         // TS 102 821 7.2.2: ceil((l + c*p + z) / f)
-        const size_t fragment_size = CEIL_DIV(af_packet.size(), num_fragments);
+        const size_t fragment_size = CEIL_DIV(af_packet_len, num_fragments);
         vector< vector<uint8_t> > fragments(num_fragments);
 
         for (size_t i = 0; i < num_fragments; i++) {
-            fragments[i].reserve(fragment_size);
+            const size_t start = std::min(i * fragment_size, af_packet_len);
+            const size_t end = std::min((i + 1) * fragment_size, af_packet_len);
 
-            for (size_t j = 0; j < fragment_size; j++) {
-                const size_t ix = i*fragment_size + j;
-                if (ix < af_packet.size()) {
-                    fragments[i].push_back(af_packet.at(ix));
-                }
-                else {
-                    break;
-                }
-            }
+            fragments[i].reserve(header_room + end - start);
+            fragments[i].resize(header_room);
+            fragments[i].insert(fragments[i].end(), af_packet + start, af_packet + end);
         }
 
         return fragments;
     }
 }
 
-std::vector< PFTFragment > PFT::Assemble(AFPacket af_packet)
+std::vector< PFTFragment > PFT::Assemble(const uint8_t *af_packet, size_t af_packet_len)
 {
-    vector< vector<uint8_t> > fragments = ProtectAndFragment(af_packet);
-    vector< vector<uint8_t> > pft_fragments; // These contain PF headers
-
     const bool enable_RS = (m_m > 0);
 
+    // Psync, Pseq, Findex, Fcount, Plen, RS and transport headers, CRC
+    const size_t header_len = 2 + 2 + 3 + 3 + 2 +
+        (enable_RS ? 2 : 0) + (m_transport_header ? 4 : 0) + 2;
+
+    // The PF headers are written in front of the payload of each fragment
+    vector< PFTFragment > pft_fragments =
+        ProtectAndFragment(af_packet, af_packet_len, header_len);
+
     unsigned int findex = 0;
 
-    unsigned fcount = fragments.size();
+    unsigned fcount = pft_fragments.size();
 
     // calculate size of chunk:
     // TS 102 821 7.2.2: k = ceil(l / c)
     // chunk_len does not include the 48 bytes of protection.
     const size_t chunk_len = enable_RS ?
-        CEIL_DIV(af_packet.size(), m_num_chunks) : 0;
+        CEIL_DIV(af_packet_len, m_num_chunks) : 0;
 
     // The last RS chunk is zero padded
     // TS 102 821 7.2.2: z = c*k - l
     const size_t zero_pad = enable_RS ?
-        m_num_chunks * chunk_len - af_packet.size() : 0;
+        m_num_chunks * chunk_len - af_packet_len : 0;
+
+    for (auto &packet : pft_fragments) {
+        size_t i = 0;
 
-    for (const auto &fragment : fragments) {
         // Psync
-        std::string psync("PF");
-        std::vector<uint8_t> packet(psync.begin(), psync.end());
+        packet[i++] = 'P';
+        packet[i++] = 'F';
 
         // Pseq
-        packet.push_back(m_pseq >> 8);
-        packet.push_back(m_pseq & 0xFF);
+        packet[i++] = m_pseq >> 8;
+        packet[i++] = m_pseq & 0xFF;
 
         // Findex
-        packet.push_back(findex >> 16);
-        packet.push_back(findex >> 8);
-        packet.push_back(findex & 0xFF);
+        packet[i++] = findex >> 16;
+        packet[i++] = findex >> 8;
+        packet[i++] = findex & 0xFF;
         findex++;
 
         // Fcount
-        packet.push_back(fcount >> 16);
-        packet.push_back(fcount >> 8);
-        packet.push_back(fcount & 0xFF);
+        packet[i++] = fcount >> 16;
+        packet[i++] = fcount >> 8;
+        packet[i++] = fcount & 0xFF;
 
         // RS (1 bit), transport (1 bit) and Plen (14 bits)
-        unsigned int plen = fragment.size();
+        unsigned int plen = packet.size() - header_len;
         if (enable_RS) {
             plen |= 0x8000; // Set FEC bit
         }
@@ -277,36 +263,35 @@ std::vector< PFTFragment > PFT::Assemble(AFPacket af_packet)
             plen |= 0x4000; // Set ADDR bit
         }
 
-        packet.push_back(plen >> 8);
-        packet.push_back(plen & 0xFF);
+        packet[i++] = plen >> 8;
+        packet[i++] = plen & 0xFF;
 
         if (enable_RS) {
-            packet.push_back(chunk_len);   // RSk
-            packet.push_back(zero_pad);    // RSz
+            packet[i++] = chunk_len;   // RSk
+            packet[i++] = zero_pad;    // RSz
         }
 
         if (m_transport_header) {
             // Source (16 bits)
-            packet.push_back(m_addr_source >> 8);
-            packet.push_back(m_addr_source & 0xFF);
+            packet[i++] = m_addr_source >> 8;
+            packet[i++] = m_addr_source & 0xFF;
 
             // Dest (16 bits)
-            packet.push_back(m_dest_port >> 8);
-            packet.push_back(m_dest_port & 0xFF);
+            packet[i++] = m_dest_port >> 8;
+            packet[i++] = m_dest_port & 0xFF;
         }
 
         // calculate CRC over AF Header and payload
         uint16_t crc = 0xffff;
-        crc = crc16(crc, &(packet.front()), packet.size());
+        crc = crc16(crc, packet.data(), i);
         crc ^= 0xffff;
 
-        packet.push_back((crc >> 8) & 0xFF);
-        packet.push_back(crc & 0xFF);
-
-        // insert payload, must have a length multiple of 8 bytes
-        packet.insert(packet.end(), fragment.begin(), fragment.end());
+        packet[i++] = (crc >> 8) & 0xFF;
+        packet[i++] = crc & 0xFF;
 
-        pft_fragments.push_back(packet);
+        if (i != header_len) {
+            throw std::logic_error("PFT header length mismatch");
+        }
 
 #if 0
         fprintf(stderr, "* PFT pseq %d, findex %d, fcount %d, plen %d\n",
@@ -33,7 +33,6 @@
 #pragma once
 
 #include <vector>
-#include <list>
 #include <stdexcept>
 #include <cstdint>
 #include "AFPacket.h"
@@ -55,14 +54,21 @@ class PFT
         PFT(const configuration_t& conf);
 
         // return a list of PFT fragments with the correct
-        // PFT headers
-        std::vector< PFTFragment > Assemble(AFPacket af_packet);
+        // PFT headers. The AF packet is read in place.
+        std::vector< PFTFragment > Assemble(const uint8_t *af_packet, size_t af_packet_len);
+        std::vector< PFTFragment > Assemble(const AFPacket& af_packet) {
+            return Assemble(af_packet.data(), af_packet.size());
+        }
 
         // Apply Reed-Solomon FEC to the AF Packet
-        RSBlock Protect(AFPacket af_packet);
+        RSBlock Protect(const uint8_t *af_packet, size_t af_packet_len);
 
-        // Cut a RSBlock into several fragments that can be transmitted
-        std::vector< std::vector<uint8_t> > ProtectAndFragment(AFPacket af_packet);
+        // Cut a RSBlock into several fragments that can be transmitted.
+        // header_room bytes are left free at the start of each fragment,
+        // for the PF header.
+        std::vector< std::vector<uint8_t> > ProtectAndFragment(
+                const uint8_t *af_packet, size_t af_packet_len,
+                size_t header_room = 0);
 
         void OverridePSeq(uint16_t pseq);
 
@@ -73,6 +79,15 @@ class PFT
         size_t m_num_chunks = 0;
         bool m_verbose = false;
 
+        // The encoding has to be 255, 207 always, because the chunk has to
+        // be padded at the end, and not at the beginning as libfec would
+        // do. gfPoly=0x11d, firstRoot=1 (discovered by analysing EDI dump)
+        ReedSolomon m_rs_encoder{255, 207, false, 0x11d, 1};
+
+        // Scratch buffers for Protect(), kept to avoid reallocating them
+        std::vector<uint8_t> m_interleaved;
+        std::vector<uint8_t> m_protection;
+
         // Transport header is always deactivated
         const bool m_transport_header = false;
         const uint16_t m_addr_source = 0;
@@ -0,0 +1,242 @@
+/*
+   Copyright (C) 2026
+   agent, agent@local
+
+    http://www.opendigitalradio.org
+
+   EDI output,
+   Pacing of PFT fragments
+
+   */
+/*
+   This file is part of the ODR-mmbTools.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Pacer.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+using namespace std;
+
+namespace edi {
+
+using chrono::steady_clock;
+
+Pacer::Pacer()
+{
+    // steady_clock is CLOCK_MONOTONIC
+    m_timerfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (m_timerfd == -1) {
+        throw runtime_error(string("EDI pacer: timerfd_create failed: ") + strerror(errno));
+    }
+
+    m_eventfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_eventfd == -1) {
+        ::close(m_timerfd);
+        throw runtime_error(string("EDI pacer: eventfd failed: ") + strerror(errno));
+    }
+
+    // Enough for several AF packets with many fragments each
+    m_heap.reserve(1024);
+}
+
+Pacer::~Pacer()
+{
+    ::close(m_eventfd);
+    ::close(m_timerfd);
+}
+
+bool Pacer::later(const entry_t& a, const entry_t& b)
+{
+    if (a.deadline != b.deadline) {
+        return a.deadline > b.deadline;
+    }
+    return a.order > b.order;
+}
+
+void Pacer::wakeup()
+{
+    const uint64_t one = 1;
+    ssize_t r = ::write(m_eventfd, &one, sizeof(one));
+    (void)r; // Can only fail if the counter overflows, it is woken up anyway
+}
+
+void Pacer::schedule(vector<PFTFragment>& fragments,
+        steady_clock::time_point first, steady_clock::duration interval)
+{
+    {
+        lock_guard<mutex> lock(m_mutex);
+        const uint64_t af_index = m_next_af_index++;
+
+        auto deadline = first;
+        for (auto& fragment : fragments) {
+            entry_t entry;
+            entry.deadline = deadline;
+            entry.order = m_next_order++;
+            entry.af_index = af_index;
+            entry.fragment = move(fragment);
+            m_heap.push_back(move(entry));
+            push_heap(m_heap.begin(), m_heap.end(), later);
+
+            deadline += interval;
+        }
+    }
+
+    wakeup();
+}
+
+bool Pacer::wait_due(vector<PFTFragment>& fragments,
+        vector<paced_fragment_info_t>& info,
+        steady_clock::duration lead)
+{
+    while (true) {
+        bool timer_armed = false;
+        struct itimerspec its = {};
+
+        {
+            lock_guard<mutex> lock(m_mutex);
+            if (not m_running) {
+                return false;
+            }
+
+            const auto now = steady_clock::now();
+            while (not m_heap.empty() and m_heap.front().deadline - lead <= now) {
+                pop_heap(m_heap.begin(), m_heap.end(), later);
+                auto& entry = m_heap.back();
+
+                paced_fragment_info_t i;
+                i.deadline = entry.deadline;
+                i.af_index = entry.af_index;
+                info.push_back(i);
+                fragments.push_back(move(entry.fragment));
+                m_heap.pop_back();
+            }
+
+            if (not fragments.empty()) {
+                return true;
+            }
+
+            if (not m_heap.empty()) {
+                const auto wake_at = chrono::duration_cast<chrono::nanoseconds>(
+                        (m_heap.front().deadline - lead).time_since_epoch()).count();
+                its.it_value.tv_sec = wake_at / 1000000000;
+                its.it_value.tv_nsec = wake_at % 1000000000;
+                timer_armed = true;
+            }
+        }
+
+        // A zero it_value disarms the timer
+        if (timerfd_settime(m_timerfd, timer_armed ? TFD_TIMER_ABSTIME : 0, &its, nullptr) == -1) {
+            throw runtime_error(string("EDI pacer: timerfd_settime failed: ") + strerror(errno));
+        }
+
+        struct pollfd fds[2];
+        fds[0].fd = m_timerfd;
+        fds[0].events = POLLIN;
+        fds[1].fd = m_eventfd;
+        fds[1].events = POLLIN;
+
+        if (poll(fds, 2, -1) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw runtime_error(string("EDI pacer: poll failed: ") + strerror(errno));
+        }
+
+        uint64_t counter = 0;
+        if (fds[0].revents & POLLIN) {
+            ssize_t r = ::read(m_timerfd, &counter, sizeof(counter));
+            (void)r;
+        }
+        if (fds[1].revents & POLLIN) {
+            ssize_t r = ::read(m_eventfd, &counter, sizeof(counter));
+            (void)r;
+        }
+    }
+}
+
+void Pacer::stop()
+{
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_running = false;
+    }
+    wakeup();
+}
+
+void Pacer::record_sent(const vector<paced_fragment_info_t>& info,
+        steady_clock::time_point sent)
+{
+    using us = chrono::duration<double, micro>;
+
+    for (const auto& i : info) {
+        const double lateness = us(sent - i.deadline).count();
+        m_lateness_sum += lateness;
+        m_lateness_max = std::max(m_lateness_max, lateness);
+        m_num_fragments++;
+
+        if (m_have_last and m_last_af_index == i.af_index) {
+            const double error = us(sent - m_last_sent).count() -
+                us(i.deadline - m_last_deadline).count();
+            m_spacing_error_sum += error;
+            m_spacing_error_sq_sum += error * error;
+            m_spacing_error_max = std::max(m_spacing_error_max, fabs(error));
+            m_num_spacings++;
+        }
+
+        m_have_last = true;
+        m_last_af_index = i.af_index;
+        m_last_deadline = i.deadline;
+        m_last_sent = sent;
+    }
+}
+
+pacing_stats_t Pacer::get_stats()
+{
+    pacing_stats_t stats;
+    stats.num_fragments = m_num_fragments;
+
+    if (m_num_spacings > 0) {
+        const double mean = m_spacing_error_sum / m_num_spacings;
+        stats.spacing_error_mean_us = mean;
+        stats.spacing_error_stddev_us =
+            sqrt(std::max(0.0, m_spacing_error_sq_sum / m_num_spacings - mean * mean));
+        stats.spacing_error_max_us = m_spacing_error_max;
+    }
+
+    if (m_num_fragments > 0) {
+        stats.lateness_mean_us = m_lateness_sum / m_num_fragments;
+        stats.lateness_max_us = m_lateness_max;
+    }
+
+    m_num_fragments = 0;
+    m_num_spacings = 0;
+    m_spacing_error_sum = 0;
+    m_spacing_error_sq_sum = 0;
+    m_spacing_error_max = 0;
+    m_lateness_sum = 0;
+    m_lateness_max = 0;
+
+    return stats;
+}
+
+}
@@ -0,0 +1,136 @@
+/*
+   Copyright (C) 2026
+   agent, agent@local
+
+    http://www.opendigitalradio.org
+
+   EDI output,
+   Pacing of PFT fragments
+
+   */
+/*
+   This file is part of the ODR-mmbTools.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as
+   published by the Free Software Foundation, either version 3 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "PFT.h"
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace edi {
+
+/** Deadline of a fragment handed out by the Pacer */
+struct paced_fragment_info_t {
+    std::chrono::steady_clock::time_point deadline;
+    // Fragments of the same AF packet share the same index
+    uint64_t af_index = 0;
+};
+
+/** Achieved pacing since the last call to Pacer::get_stats() */
+struct pacing_stats_t {
+    size_t num_fragments = 0;
+
+    // Achieved minus intended spacing between consecutive
+    // fragments of one AF packet
+    double spacing_error_mean_us = 0;
+    double spacing_error_stddev_us = 0;
+    double spacing_error_max_us = 0;
+
+    // Time from the deadline until the fragment was given to the socket
+    double lateness_mean_us = 0;
+    double lateness_max_us = 0;
+};
+
+/** Holds the PFT fragments in a min-heap ordered by their deadline, and
+ * wakes up the sending thread at the earliest deadline using a timerfd
+ * armed with an absolute CLOCK_MONOTONIC time. An eventfd interrupts
+ * the wait when fragments are scheduled or the pacer is stopped.
+ */
+class Pacer {
+    public:
+        Pacer();
+        Pacer(const Pacer&) = delete;
+        Pacer& operator=(const Pacer&) = delete;
+        ~Pacer();
+
+        /** Schedule the fragments of one AF packet, the first one at
+         * first, and each following one interval later. The fragments
+         * are moved out of the vector. Can be called from any thread. */
+        void schedule(std::vector<PFTFragment>& fragments,
+                std::chrono::steady_clock::time_point first,
+                std::chrono::steady_clock::duration interval);
+
+        /** Block until at least one fragment is due lead before its
+         * deadline, and append all due fragments in deadline order.
+         *
+         * \return false once stop() has been called */
+        bool wait_due(std::vector<PFTFragment>& fragments,
+                std::vector<paced_fragment_info_t>& info,
+                std::chrono::steady_clock::duration lead);
+
+        /** Make wait_due() return false */
+        void stop();
+
+        /** Update the statistics with fragments returned by wait_due()
+         * that were given to the sockets at the time sent. Must be called
+         * from the thread calling wait_due(), as get_stats(). */
+        void record_sent(const std::vector<paced_fragment_info_t>& info,
+                std::chrono::steady_clock::time_point sent);
+
+        /** Return and clear the statistics */
+        pacing_stats_t get_stats();
+
+    private:
+        struct entry_t {
+            std::chrono::steady_clock::time_point deadline;
+            // Keeps fragments with the same deadline in scheduling order
+            uint64_t order = 0;
+            uint64_t af_index = 0;
+            PFTFragment fragment;
+        };
+
+        static bool later(const entry_t& a, const entry_t& b);
+        void wakeup();
+
+        std::mutex m_mutex;
+        std::vector<entry_t> m_heap;
+        uint64_t m_next_order = 0;
+        uint64_t m_next_af_index = 0;
+        bool m_running = true;
+
+        int m_timerfd = -1;
+        int m_eventfd = -1;
+
+        // Statistics
+        bool m_have_last = false;
+        uint64_t m_last_af_index = 0;
+        std::chrono::steady_clock::time_point m_last_deadline;
+        std::chrono::steady_clock::time_point m_last_sent;
+
+        size_t m_num_fragments = 0;
+        size_t m_num_spacings = 0;
+        double m_spacing_error_sum = 0;
+        double m_spacing_error_sq_sum = 0;
+        double m_spacing_error_max = 0;
+        double m_lateness_sum = 0;
+        double m_lateness_max = 0;
+};
+
+}
+
@@ -35,6 +35,28 @@
 
 namespace edi {
 
+// Append the four-byte TAG name and a placeholder for the TAG length,
+// and return the position of the TAG item in buf
+static size_t start_tag(std::vector<uint8_t>& buf, const char name[4])
+{
+    const size_t start = buf.size();
+    buf.insert(buf.end(), name, name + 4);
+    buf.insert(buf.end(), 4, 0);
+    return start;
+}
+
+// Write the length of the TAG item at start into its TAG length field
+static void finish_tag(std::vector<uint8_t>& buf, size_t start)
+{
+    // remove TAG name and TAG length fields and convert to bits
+    const uint32_t taglength = (buf.size() - start - 8) * 8;
+
+    buf[start + 4] = (taglength >> 24) & 0xFF;
+    buf[start + 5] = (taglength >> 16) & 0xFF;
+    buf[start + 6] = (taglength >> 8) & 0xFF;
+    buf[start + 7] = taglength & 0xFF;
+}
+
 TagStarPTR::TagStarPTR(const std::string& protocol)
     : m_protocol(protocol)
 {
@@ -43,99 +65,71 @@ TagStarPTR::TagStarPTR(const std::string& protocol)
     }
 }
 
-std::vector<uint8_t> TagStarPTR::Assemble()
+void TagStarPTR::AssembleInto(std::vector<uint8_t>& buf)
 {
-    //std::cerr << "TagItem *ptr" << std::endl;
-    std::string pack_data("*ptr");
-    std::vector<uint8_t> packet(pack_data.begin(), pack_data.end());
+    buf.insert(buf.end(), {'*', 'p', 't', 'r'});
 
-    packet.push_back(0);
-    packet.push_back(0);
-    packet.push_back(0);
-    packet.push_back(0x40);
+    buf.push_back(0);
+    buf.push_back(0);
+    buf.push_back(0);
+    buf.push_back(0x40);
 
-    packet.insert(packet.end(), m_protocol.begin(), m_protocol.end());
+    buf.insert(buf.end(), m_protocol.begin(), m_protocol.end());
 
     // Major
-    packet.push_back(0);
-    packet.push_back(0);
+    buf.push_back(0);
+    buf.push_back(0);
 
     // Minor
-    packet.push_back(0);
-    packet.push_back(0);
-    return packet;
+    buf.push_back(0);
+    buf.push_back(0);
 }
 
-std::vector<uint8_t> TagDETI::Assemble()
+void TagDETI::AssembleInto(std::vector<uint8_t>& buf)
 {
-    std::string pack_data("deti");
-    std::vector<uint8_t> packet(pack_data.begin(), pack_data.end());
-    packet.reserve(256);
-
-    // Placeholder for length
-    packet.push_back(0);
-    packet.push_back(0);
-    packet.push_back(0);
-    packet.push_back(0);
+    const size_t start = start_tag(buf, "deti");
 
     uint8_t fct  = dlfc % 250;
     uint8_t fcth = dlfc / 250;
 
 
     uint16_t detiHeader = fct | (fcth << 8) | (rfudf << 13) | (ficf << 14) | (atstf << 15);
-    packet.push_back(detiHeader >> 8);
-    packet.push_back(detiHeader & 0xFF);
+    buf.push_back(detiHeader >> 8);
+    buf.push_back(detiHeader & 0xFF);
 
     uint32_t etiHeader = mnsc | (rfu << 16) | (rfa << 17) |
                         (fp << 19) | (mid << 22) | (stat << 24);
-    packet.push_back((etiHeader >> 24) & 0xFF);
-    packet.push_back((etiHeader >> 16) & 0xFF);
-    packet.push_back((etiHeader >> 8) & 0xFF);
-    packet.push_back(etiHeader & 0xFF);
+    buf.push_back((etiHeader >> 24) & 0xFF);
+    buf.push_back((etiHeader >> 16) & 0xFF);
+    buf.push_back((etiHeader >> 8) & 0xFF);
+    buf.push_back(etiHeader & 0xFF);
 
     if (atstf) {
-        packet.push_back(utco);
+        buf.push_back(utco);
 
-        packet.push_back((seconds >> 24) & 0xFF);
-        packet.push_back((seconds >> 16) & 0xFF);
-        packet.push_back((seconds >> 8) & 0xFF);
-        packet.push_back(seconds & 0xFF);
+        buf.push_back((seconds >> 24) & 0xFF);
+        buf.push_back((seconds >> 16) & 0xFF);
+        buf.push_back((seconds >> 8) & 0xFF);
+        buf.push_back(seconds & 0xFF);
 
-        packet.push_back((tsta >> 16) & 0xFF);
-        packet.push_back((tsta >> 8) & 0xFF);
-        packet.push_back(tsta & 0xFF);
+        buf.push_back((tsta >> 16) & 0xFF);
+        buf.push_back((tsta >> 8) & 0xFF);
+        buf.push_back(tsta & 0xFF);
     }
 
     if (ficf) {
-        for (size_t i = 0; i < fic_length; i++) {
-            packet.push_back(fic_data[i]);
-        }
+        buf.insert(buf.end(), fic_data, fic_data + fic_length);
     }
 
     if (rfudf) {
-        packet.push_back((rfud >> 16) & 0xFF);
-        packet.push_back((rfud >> 8) & 0xFF);
-        packet.push_back(rfud & 0xFF);
+        buf.push_back((rfud >> 16) & 0xFF);
+        buf.push_back((rfud >> 8) & 0xFF);
+        buf.push_back(rfud & 0xFF);
     }
 
-    // calculate and update size
-    // remove TAG name and TAG length fields and convert to bits
-    uint32_t taglength = (packet.size() - 8) * 8;
-
-    // write length into packet
-    packet[4] = (taglength >> 24) & 0xFF;
-    packet[5] = (taglength >> 16) & 0xFF;
-    packet[6] = (taglength >> 8) & 0xFF;
-    packet[7] = taglength & 0xFF;
+    finish_tag(buf, start);
 
     dlfc = (dlfc+1) % 5000;
-
-    /*
-    std::cerr << "TagItem deti, packet.size " << packet.size() << std::endl;
-    std::cerr << "              fic length " << fic_length << std::endl;
-    std::cerr << "              length " << taglength / 8 << std::endl;
-    */
-    return packet;
 }
 
 void TagDETI::set_edi_time(const std::time_t t, int tai_utc_offset)
@@ -147,20 +141,8 @@ void TagDETI::set_edi_time(const std::time_t t, int tai_utc_offset)
     seconds = t - posix_timestamp_1_jan_2000 + utco;
 }
 
-std::vector<uint8_t> TagESTn::Assemble()
+void TagESTn::AssembleInto(std::vector<uint8_t>& buf)
 {
-    std::string pack_data("est");
-    std::vector<uint8_t> packet(pack_data.begin(), pack_data.end());
-    packet.reserve(mst_length*8 + 16);
-
-    packet.push_back(id);
-
-    // Placeholder for length
-    packet.push_back(0);
-    packet.push_back(0);
-    packet.push_back(0);
-    packet.push_back(0);
-
     if (tpl > 0x3F) {
         throw std::runtime_error("TagESTn: invalid TPL value");
     }
@@ -173,93 +155,57 @@ std::vector<uint8_t> TagESTn::Assemble()
         throw std::runtime_error("TagESTn: invalid SCID value");
     }
 
+    const char name[4] = {'e', 's', 't', (char)id};
+    const size_t start = start_tag(buf, name);
+
     uint32_t sstc = (scid << 18) | (sad << 8) | (tpl << 2) | rfa;
-    packet.push_back((sstc >> 16) & 0xFF);
-    packet.push_back((sstc >> 8) & 0xFF);
-    packet.push_back(sstc & 0xFF);
+    buf.push_back((sstc >> 16) & 0xFF);
+    buf.push_back((sstc >> 8) & 0xFF);
+    buf.push_back(sstc & 0xFF);
 
-    for (size_t i = 0; i < mst_length * 8; i++) {
-        packet.push_back(mst_data[i]);
-    }
+    buf.insert(buf.end(), mst_data, mst_data + mst_length * 8);
 
-    // calculate and update size
-    // remove TAG name and TAG length fields and convert to bits
-    uint32_t taglength = (packet.size() - 8) * 8;
-
-    // write length into packet
-    packet[4] = (taglength >> 24) & 0xFF;
-    packet[5] = (taglength >> 16) & 0xFF;
-    packet[6] = (taglength >> 8) & 0xFF;
-    packet[7] = taglength & 0xFF;
-
-    /*
-    std::cerr << "TagItem ESTn, length " << packet.size() << std::endl;
-    std::cerr << "              mst_length " << mst_length << std::endl;
-    */
-    return packet;
+    finish_tag(buf, start);
 }
 
-std::vector<uint8_t> TagDSTI::Assemble()
+void TagDSTI::AssembleInto(std::vector<uint8_t>& buf)
 {
-    std::string pack_data("dsti");
-    std::vector<uint8_t> packet(pack_data.begin(), pack_data.end());
-    packet.reserve(256);
-
-    // Placeholder for length
-    packet.push_back(0);
-    packet.push_back(0);
-    packet.push_back(0);
-    packet.push_back(0);
+    const size_t start = start_tag(buf, "dsti");
 
     uint8_t dfctl = dlfc % 250;
     uint8_t dfcth = dlfc / 250;
 
 
     uint16_t dstiHeader = dfctl | (dfcth << 8) | (rfadf << 13) | (atstf << 14) | (stihf << 15);
-    packet.push_back(dstiHeader >> 8);
-    packet.push_back(dstiHeader & 0xFF);
+    buf.push_back(dstiHeader >> 8);
+    buf.push_back(dstiHeader & 0xFF);
 
     if (stihf) {
-        packet.push_back(stat);
-        packet.push_back((spid >> 8) & 0xFF);
-        packet.push_back(spid & 0xFF);
+        buf.push_back(stat);
+        buf.push_back((spid >> 8) & 0xFF);
+        buf.push_back(spid & 0xFF);
     }
 
     if (atstf) {
-        packet.push_back(utco);
+        buf.push_back(utco);
 
-        packet.push_back((seconds >> 24) & 0xFF);
-        packet.push_back((seconds >> 16) & 0xFF);
-        packet.push_back((seconds >> 8) & 0xFF);
-        packet.push_back(seconds & 0xFF);
+        buf.push_back((seconds >> 24) & 0xFF);
+        buf.push_back((seconds >> 16) & 0xFF);
+        buf.push_back((seconds >> 8) & 0xFF);
+        buf.push_back(seconds & 0xFF);
 
-        packet.push_back((tsta >> 16) & 0xFF);
-        packet.push_back((tsta >> 8) & 0xFF);
-        packet.push_back(tsta & 0xFF);
+        buf.push_back((tsta >> 16) & 0xFF);
+        buf.push_back((tsta >> 8) & 0xFF);
+        buf.push_back(tsta & 0xFF);
     }
 
     if (rfadf) {
-        for (size_t i = 0; i < rfad.size(); i++) {
-            packet.push_back(rfad[i]);
-        }
+        buf.insert(buf.end(), rfad.begin(), rfad.end());
     }
-    // calculate and update size
-    // remove TAG name and TAG length fields and convert to bits
-    uint32_t taglength = (packet.size() - 8) * 8;
 
-    // write length into packet
-    packet[4] = (taglength >> 24) & 0xFF;
-    packet[5] = (taglength >> 16) & 0xFF;
-    packet[6] = (taglength >> 8) & 0xFF;
-    packet[7] = taglength & 0xFF;
+    finish_tag(buf, start);
 
     dlfc = (dlfc+1) % 5000;
-
-    /*
-    std::cerr << "TagItem dsti, packet.size " << packet.size() << std::endl;
-    std::cerr << "              length " << taglength / 8 << std::endl;
-    */
-    return packet;
 }
 
 void TagDSTI::set_edi_time(const std::time_t t, int tai_utc_offset)
@@ -301,21 +247,8 @@ void TagDSTI::set_edi_time(const std::time_t t)
 }
 #endif
 
-std::vector<uint8_t> TagSSm::Assemble()
+void TagSSm::AssembleInto(std::vector<uint8_t>& buf)
 {
-    std::string pack_data("ss");
-    std::vector<uint8_t> packet(pack_data.begin(), pack_data.end());
-    packet.reserve(istd_length + 16);
-
-    packet.push_back((id >> 8) & 0xFF);
-    packet.push_back(id & 0xFF);
-
-    // Placeholder for length
-    packet.push_back(0);
-    packet.push_back(0);
-    packet.push_back(0);
-    packet.push_back(0);
-
     if (rfa > 0x1F) {
         throw std::runtime_error("TagSSm: invalid RFA value");
     }
@@ -332,50 +265,28 @@ std::vector<uint8_t> TagSSm::Assemble()
         throw std::runtime_error("TagSSm: invalid stid value");
     }
 
+    const char name[4] = {'s', 's', (char)((id >> 8) & 0xFF), (char)(id & 0xFF)};
+    const size_t start = start_tag(buf, name);
+
     uint32_t istc = (rfa << 19) | (tid << 16) | (tidext << 13) | ((crcstf ? 1 : 0) << 12) | stid;
-    packet.push_back((istc >> 16) & 0xFF);
-    packet.push_back((istc >> 8) & 0xFF);
-    packet.push_back(istc & 0xFF);
+    buf.push_back((istc >> 16) & 0xFF);
+    buf.push_back((istc >> 8) & 0xFF);
+    buf.push_back(istc & 0xFF);
 
-    for (size_t i = 0; i < istd_length; i++) {
-        packet.push_back(istd_data[i]);
-    }
+    buf.insert(buf.end(), istd_data, istd_data + istd_length);
 
-    // calculate and update size
-    // remove TAG name and TAG length fields and convert to bits
-    uint32_t taglength = (packet.size() - 8) * 8;
-
-    // write length into packet
-    packet[4] = (taglength >> 24) & 0xFF;
-    packet[5] = (taglength >> 16) & 0xFF;
-    packet[6] = (taglength >> 8) & 0xFF;
-    packet[7] = taglength & 0xFF;
-
-    /*
-    std::cerr << "TagItem SSm, length " << packet.size() << std::endl;
-    std::cerr << "             istd_length " << istd_length << std::endl;
-    */
-    return packet;
+    finish_tag(buf, start);
 }
 
 
-std::vector<uint8_t> TagStarDMY::Assemble()
+void TagStarDMY::AssembleInto(std::vector<uint8_t>& buf)
 {
-    std::string pack_data("*dmy");
-    std::vector<uint8_t> packet(pack_data.begin(), pack_data.end());
-
-    packet.resize(4 + 4 + length_);
-
-    const uint32_t length_bits = length_ * 8;
-
-    packet[4] = (length_bits >> 24) & 0xFF;
-    packet[5] = (length_bits >> 16) & 0xFF;
-    packet[6] = (length_bits >> 8) & 0xFF;
-    packet[7] = length_bits & 0xFF;
+    const size_t start = start_tag(buf, "*dmy");
 
     // The remaining bytes in the packet are "undefined data"
+    buf.resize(buf.size() + length_);
 
-    return packet;
+    finish_tag(buf, start);
 }
 
 TagODRVersion::TagODRVersion(const std::string& version, uint32_t uptime_s) :
@@ -384,32 +295,18 @@ TagODRVersion::TagODRVersion(const std::string& version, uint32_t uptime_s) :
 {
 }
 
-std::vector<uint8_t> TagODRVersion::Assemble()
+void TagODRVersion::AssembleInto(std::vector<uint8_t>& buf)
 {
-    std::string pack_data("ODRv");
-    std::vector<uint8_t> packet(pack_data.begin(), pack_data.end());
+    const size_t start = start_tag(buf, "ODRv");
 
-    const size_t length = m_version.size() + sizeof(uint32_t);
+    buf.insert(buf.end(), m_version.cbegin(), m_version.cend());
 
-    packet.resize(4 + 4 + length);
+    buf.push_back((m_uptime >> 24) & 0xFF);
+    buf.push_back((m_uptime >> 16) & 0xFF);
+    buf.push_back((m_uptime >> 8) & 0xFF);
+    buf.push_back(m_uptime & 0xFF);
 
-    const uint32_t length_bits = length * 8;
-
-    size_t i = 4;
-    packet[i++] = (length_bits >> 24) & 0xFF;
-    packet[i++] = (length_bits >> 16) & 0xFF;
-    packet[i++] = (length_bits >> 8) & 0xFF;
-    packet[i++] = length_bits & 0xFF;
-
-    copy(m_version.cbegin(), m_version.cend(), packet.begin() + i);
-    i += m_version.size();
-
-    packet[i++] = (m_uptime >> 24) & 0xFF;
-    packet[i++] = (m_uptime >> 16) & 0xFF;
-    packet[i++] = (m_uptime >> 8) & 0xFF;
-    packet[i++] = m_uptime & 0xFF;
-
-    return packet;
+    finish_tag(buf, start);
 }
 
 TagODRAudioLevels::TagODRAudioLevels(int16_t audiolevel_left, int16_t audiolevel_right) :
@@ -418,31 +315,36 @@ TagODRAudioLevels::TagODRAudioLevels(int16_t audiolevel_left, int16_t audiolevel
 {
 }
 
-std::vector<uint8_t> TagODRAudioLevels::Assemble()
+void TagODRAudioLevels::AssembleInto(std::vector<uint8_t>& buf)
 {
-    std::string pack_data("ODRa");
-    std::vector<uint8_t> packet(pack_data.begin(), pack_data.end());
+    const size_t start = start_tag(buf, "ODRa");
 
-    constexpr size_t length = 2*sizeof(int16_t);
+    buf.push_back((m_audio_left >> 8) & 0xFF);
+    buf.push_back(m_audio_left & 0xFF);
 
-    packet.resize(4 + 4 + length);
+    buf.push_back((m_audio_right >> 8) & 0xFF);
+    buf.push_back(m_audio_right & 0xFF);
 
-    const uint32_t length_bits = length * 8;
+    finish_tag(buf, start);
+}
 
-    size_t i = 4;
-    packet[i++] = (length_bits >> 24) & 0xFF;
-    packet[i++] = (length_bits >> 16) & 0xFF;
-    packet[i++] = (length_bits >> 8) & 0xFF;
-    packet[i++] = length_bits & 0xFF;
+TagODRLoudness::TagODRLoudness(int16_t momentary, int16_t short_term, int16_t integrated) :
+    m_momentary(momentary),
+    m_short_term(short_term),
+    m_integrated(integrated)
+{
+}
 
-    packet[i++] = (m_audio_left >> 8) & 0xFF;
-    packet[i++] = m_audio_left & 0xFF;
+void TagODRLoudness::AssembleInto(std::vector<uint8_t>& buf)
+{
+    const size_t start = start_tag(buf, "ODRl");
 
-    packet[i++] = (m_audio_right >> 8) & 0xFF;
-    packet[i++] = m_audio_right & 0xFF;
+    for (const int16_t value : {m_momentary, m_short_term, m_integrated}) {
+        buf.push_back((value >> 8) & 0xFF);
+        buf.push_back(value & 0xFF);
+    }
 
-    return packet;
+    finish_tag(buf, start);
 }
 
 }
-
@@ -39,7 +39,15 @@ namespace edi {
 class TagItem
 {
     public:
-        virtual std::vector<uint8_t> Assemble() = 0;
+        // Append the TAG item to buf. Assembling all items of a TAG packet
+        // into one buffer avoids a copy and an allocation per item.
+        virtual void AssembleInto(std::vector<uint8_t>& buf) = 0;
+
+        std::vector<uint8_t> Assemble() {
+            std::vector<uint8_t> buf;
+            AssembleInto(buf);
+            return buf;
+        }
 };
 
 // ETSI TS 102 693, 5.1.1 Protocol type and revision
@@ -47,7 +55,7 @@ class TagStarPTR : public TagItem
 {
     public:
         TagStarPTR(const std::string& protocol);
-        std::vector<uint8_t> Assemble();
+        void AssembleInto(std::vector<uint8_t>& buf) override;
 
     private:
         std::string m_protocol = "";
@@ -57,7 +65,7 @@ class TagStarPTR : public TagItem
 class TagDETI : public TagItem
 {
     public:
-        std::vector<uint8_t> Assemble();
+        void AssembleInto(std::vector<uint8_t>& buf) override;
 
         /***** DATA in intermediary format ****/
         // For the ETI Header: must be defined !
@@ -121,7 +129,7 @@ class TagDETI : public TagItem
 class TagESTn : public TagItem
 {
     public:
-        std::vector<uint8_t> Assemble();
+        void AssembleInto(std::vector<uint8_t>& buf) override;
 
         // SSTCn
         uint8_t  scid;
@@ -141,7 +149,7 @@ class TagESTn : public TagItem
 class TagDSTI : public TagItem
 {
     public:
-        std::vector<uint8_t> Assemble();
+        void AssembleInto(std::vector<uint8_t>& buf) override;
 
         // dsti Header
         bool stihf = false;
@@ -197,7 +205,7 @@ class TagDSTI : public TagItem
 class TagSSm : public TagItem
 {
     public:
-        std::vector<uint8_t> Assemble();
+        void AssembleInto(std::vector<uint8_t>& buf) override;
 
         // SSTCn
         uint8_t rfa = 0;
@@ -220,7 +228,7 @@ class TagStarDMY : public TagItem
     public:
         /* length is the TAG value length in bytes */
         TagStarDMY(uint32_t length) : length_(length) {}
-        std::vector<uint8_t> Assemble();
+        void AssembleInto(std::vector<uint8_t>& buf) override;
 
     private:
         uint32_t length_;
@@ -231,7 +239,7 @@ class TagODRVersion : public TagItem
 {
     public:
         TagODRVersion(const std::string& version, uint32_t uptime_s);
-        std::vector<uint8_t> Assemble();
+        void AssembleInto(std::vector<uint8_t>& buf) override;
 
     private:
         std::string m_version;
@@ -243,12 +251,26 @@ class TagODRAudioLevels : public TagItem
 {
     public:
         TagODRAudioLevels(int16_t audiolevel_left, int16_t audiolevel_right);
-        std::vector<uint8_t> Assemble();
+        void AssembleInto(std::vector<uint8_t>& buf) override;
 
     private:
         int16_t m_audio_left;
         int16_t m_audio_right;
 };
 
+// Custom TAG that carries the momentary, short-term and integrated
+// loudness of the audio, in 1/100 LU, or INT16_MIN if not available
+class TagODRLoudness : public TagItem
+{
+    public:
+        TagODRLoudness(int16_t momentary, int16_t short_term, int16_t integrated);
+        void AssembleInto(std::vector<uint8_t>& buf) override;
+
+    private:
+        int16_t m_momentary;
+        int16_t m_short_term;
+        int16_t m_integrated;
+};
+
 }
 
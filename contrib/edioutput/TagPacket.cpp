@@ -29,7 +29,6 @@
 #include <vector>
 #include <iostream>
 #include <string>
-#include <list>
 #include <cstdint>
 #include <cassert>
 
@@ -38,42 +37,45 @@ namespace edi {
 TagPacket::TagPacket(unsigned int alignment) : m_alignment(alignment)
 { }
 
-std::vector<uint8_t> TagPacket::Assemble()
+std::vector<uint8_t> TagPacket::Assemble() const
+{
+    std::vector<uint8_t> packet;
+    AssembleInto(packet);
+    return packet;
+}
+
+void TagPacket::AssembleInto(std::vector<uint8_t>& buf) const
 {
     if (raw_tagpacket.size() > 0 and tag_items.size() > 0) {
         throw std::logic_error("TagPacket: both raw and items used!");
     }
 
     if (raw_tagpacket.size() > 0) {
-        return raw_tagpacket;
+        buf.insert(buf.end(), raw_tagpacket.begin(), raw_tagpacket.end());
+        return;
     }
 
-    std::vector<uint8_t> packet;
+    const size_t start = buf.size();
 
     for (auto tag : tag_items) {
-        std::vector<uint8_t> tag_data = tag->Assemble();
-        packet.insert(packet.end(), tag_data.begin(), tag_data.end());
+        tag->AssembleInto(buf);
     }
 
     if (m_alignment == 0) { /* no padding */ }
     else if (m_alignment == 8) {
         // Add padding inside TAG packet
-        while (packet.size() % 8 > 0) {
-            packet.push_back(0); // TS 102 821, 5.1, "padding shall be undefined"
+        while ((buf.size() - start) % 8 > 0) {
+            buf.push_back(0); // TS 102 821, 5.1, "padding shall be undefined"
         }
     }
     else if (m_alignment > 8) {
         TagStarDMY dmy(m_alignment - 8);
-        auto dmy_data = dmy.Assemble();
-        packet.insert(packet.end(), dmy_data.begin(), dmy_data.end());
+        dmy.AssembleInto(buf);
     }
     else {
         std::cerr << "Invalid alignment requirement " << m_alignment <<
             " defined in TagPacket" << std::endl;
     }
-
-    return packet;
 }
 
 }
-
@@ -29,7 +29,6 @@
 #include "TagItems.h"
 #include <vector>
 #include <string>
-#include <list>
 #include <cstdint>
 
 namespace edi {
@@ -46,9 +45,13 @@ class TagPacket
 {
     public:
         TagPacket(unsigned int alignment);
-        std::vector<uint8_t> Assemble();
+        std::vector<uint8_t> Assemble() const;
 
-        std::list<TagItem*> tag_items;
+        // Append the TAG packet to buf
+        void AssembleInto(std::vector<uint8_t>& buf) const;
+
+        // A vector, so that a TagPacket can be reused without allocations
+        std::vector<TagItem*> tag_items;
 
         std::vector<uint8_t> raw_tagpacket;
 
@@ -28,6 +28,7 @@
 #include <iterator>
 #include <cmath>
 #include <thread>
+#include <sys/prctl.h>
 
 using namespace std;
 
@@ -45,6 +46,8 @@ void configuration_t::print() const
                 etiLog.level(info) << "  ttl         " << udp_dest->ttl;
             }
             etiLog.level(info) << "  source port " << udp_dest->source_port;
+            etiLog.level(info) << "  GSO         " << udp_gso;
+            etiLog.level(info) << "  TXTIME      " << udp_txtime;
         }
         else if (auto tcp_dest = dynamic_pointer_cast<edi::tcp_server_t>(edi_dest)) {
             etiLog.level(info) << " TCP listening on port " << tcp_dest->listen_port;
@@ -71,14 +74,30 @@ Sender::Sender(const configuration_t& conf) :
 
     for (const auto& edi_dest : m_conf.destinations) {
         if (const auto udp_dest = dynamic_pointer_cast<edi::udp_destination_t>(edi_dest)) {
-            auto udp_socket = std::make_shared<Socket::UDPSocket>(udp_dest->source_port);
+            std::shared_ptr<Socket::UDPSocket> udp_socket;
 
-            if (not udp_dest->source_addr.empty()) {
-                udp_socket->setMulticastSource(udp_dest->source_addr.c_str());
-                udp_socket->setMulticastTTL(udp_dest->ttl);
+            if (m_conf.shared_udp_socket and
+                    udp_dest->source_port == 0 and
+                    udp_dest->source_addr.empty()) {
+                udp_socket = m_conf.shared_udp_socket;
+            }
+            else {
+                udp_socket = std::make_shared<Socket::UDPSocket>(udp_dest->source_port);
+
+                if (not udp_dest->source_addr.empty()) {
+                    udp_socket->setMulticastSource(udp_dest->source_addr.c_str());
+                    udp_socket->setMulticastTTL(udp_dest->ttl);
+                }
             }
 
-            udp_sockets.emplace(udp_dest.get(), udp_socket);
+            if (m_conf.udp_txtime) {
+                udp_socket->enableTxTime();
+            }
+
+            udp_sender_t sender;
+            sender.socket = udp_socket;
+            sender.address.resolveUdpDestination(udp_dest->dest_addr, udp_dest->dest_port);
+            udp_senders.emplace(udp_dest.get(), sender);
         }
         else if (auto tcp_dest = dynamic_pointer_cast<edi::tcp_server_t>(edi_dest)) {
             auto dispatcher = make_shared<Socket::TCPDataDispatcher>(
@@ -101,8 +120,6 @@ Sender::Sender(const configuration_t& conf) :
     }
 
     if (m_conf.enable_pft) {
-        unique_lock<mutex> lock(m_mutex);
-        m_running = true;
         m_thread = thread(&Sender::run, this);
     }
 
@@ -113,10 +130,7 @@ Sender::Sender(const configuration_t& conf) :
 
 Sender::~Sender()
 {
-    {
-        unique_lock<mutex> lock(m_mutex);
-        m_running = false;
-    }
+    m_pacer.stop();
 
     if (m_thread.joinable()) {
         m_thread.join();
@@ -126,16 +140,16 @@ Sender::~Sender()
 void Sender::write(const TagPacket& tagpacket)
 {
     // Assemble into one AF Packet
-    edi::AFPacket af_packet = edi_afPacketiser.Assemble(tagpacket);
+    edi_afPacketiser.Assemble(tagpacket, m_af_packet);
 
-    write(af_packet);
+    write(m_af_packet);
 }
 
 void Sender::write(const AFPacket& af_packet)
 {
     if (m_conf.enable_pft) {
         // Apply PFT layer to AF Packet (Reed Solomon FEC and Fragmentation)
-        vector<edi::PFTFragment> edi_fragments = edi_pft.Assemble(af_packet);
+        vector<edi::PFTFragment> edi_fragments = edi_pft.Assemble(af_packet.data(), af_packet.size());
 
         if (m_conf.verbose and m_last_num_pft_fragments != edi_fragments.size()) {
             etiLog.log(debug, "EDI Output: Number of PFT fragments %zu\n",
@@ -156,16 +170,8 @@ void Sender::write(const AFPacket& af_packet)
             }
         }
 
-        /* Separate insertion into map and transmission so as to make spreading possible */
-        const auto now = steady_clock::now();
-        {
-            auto tp = now;
-            unique_lock<mutex> lock(m_mutex);
-            for (auto& edi_frag : edi_fragments) {
-                m_pending_frames[tp] = move(edi_frag);
-                tp += inter_fragment_wait_time;
-            }
-        }
+        /* Separate scheduling and transmission so as to make spreading possible */
+        m_pacer.schedule(edi_fragments, steady_clock::now(), inter_fragment_wait_time);
 
         // Transmission done in run() function
     }
@@ -178,16 +184,14 @@ void Sender::write(const AFPacket& af_packet)
 
         for (auto& dest : m_conf.destinations) {
             if (const auto& udp_dest = dynamic_pointer_cast<edi::udp_destination_t>(dest)) {
-                Socket::InetAddress addr;
-                addr.resolveUdpDestination(udp_dest->dest_addr, udp_dest->dest_port);
-
                 if (af_packet.size() > 1400 and not m_udp_fragmentation_warning_printed) {
                     fprintf(stderr, "EDI Output: AF packet larger than 1400,"
                             " consider using PFT to avoid UP fragmentation.\n");
                     m_udp_fragmentation_warning_printed = true;
                 }
 
-                udp_sockets.at(udp_dest.get())->send(af_packet, addr);
+                const auto& sender = udp_senders.at(udp_dest.get());
+                sender.socket->send(af_packet, sender.address);
             }
             else if (auto tcp_dest = dynamic_pointer_cast<edi::tcp_server_t>(dest)) {
                 tcp_dispatchers.at(tcp_dest.get())->write(af_packet);
@@ -222,46 +226,83 @@ void Sender::override_pft_sequence(uint16_t pseq)
 
 void Sender::run()
 {
-    while (m_running) {
-        unique_lock<mutex> lock(m_mutex);
-        const auto now = chrono::steady_clock::now();
+    // Wake up as close to the deadlines as the timers allow, instead of
+    // the default 50us slack
+    prctl(PR_SET_TIMERSLACK, 1, 0, 0, 0);
+
+    /* With SO_TXTIME, fragments are given to the kernel this much ahead of their
+     * deadline, and the fq qdisc releases them at the transmit time */
+    const auto lead = m_conf.udp_txtime ?
+        chrono::steady_clock::duration(chrono::milliseconds(1)) :
+        chrono::steady_clock::duration::zero();
+
+    // Kept across iterations to reuse the allocations
+    vector<edi::PFTFragment> due_fragments;
+    vector<edi::paced_fragment_info_t> due_info;
+    vector<uint64_t> txtimes_ns;
+
+    auto last_stats_print = chrono::steady_clock::now();
+
+    while (m_pacer.wait_due(due_fragments, due_info, lead)) {
+        if (m_conf.udp_txtime) {
+            txtimes_ns.clear();
+            for (const auto& i : due_info) {
+                txtimes_ns.push_back(chrono::duration_cast<chrono::nanoseconds>(
+                            i.deadline.time_since_epoch()).count());
+            }
+        }
 
-        // Send over ethernet
-        for (auto it = m_pending_frames.begin(); it != m_pending_frames.end(); ) {
-            const auto& edi_frag = it->second;
+        send_fragments(due_fragments, m_conf.udp_txtime ? txtimes_ns.data() : nullptr);
 
-            if (it->first <= now) {
-                if (m_conf.dump) {
-                    ostream_iterator<uint8_t> debug_iterator(edi_debug_file);
-                    copy(edi_frag.begin(), edi_frag.end(), debug_iterator);
-                }
+        // The statistics measure when the sockets got the fragments,
+        // not when the thread woke up
+        const auto now = chrono::steady_clock::now();
+        m_pacer.record_sent(due_info, now);
+        due_fragments.clear();
+        due_info.clear();
+
+        if (m_conf.verbose and now - last_stats_print > chrono::seconds(10)) {
+            const auto stats = m_pacer.get_stats();
+            etiLog.level(info) << "EDI Output: PFT pacing of " << stats.num_fragments <<
+                " fragments: spacing error mean " << stats.spacing_error_mean_us <<
+                "us stddev " << stats.spacing_error_stddev_us <<
+                "us max " << stats.spacing_error_max_us <<
+                "us, lateness mean " << stats.lateness_mean_us <<
+                "us max " << stats.lateness_max_us << "us";
+            last_stats_print = now;
+        }
+    }
+}
 
-                for (auto& dest : m_conf.destinations) {
-                    if (const auto& udp_dest = dynamic_pointer_cast<edi::udp_destination_t>(dest)) {
-                        Socket::InetAddress addr;
-                        addr.resolveUdpDestination(udp_dest->dest_addr, udp_dest->dest_port);
-
-                        udp_sockets.at(udp_dest.get())->send(edi_frag, addr);
-                    }
-                    else if (auto tcp_dest = dynamic_pointer_cast<edi::tcp_server_t>(dest)) {
-                        tcp_dispatchers.at(tcp_dest.get())->write(edi_frag);
-                    }
-                    else if (auto tcp_dest = dynamic_pointer_cast<edi::tcp_client_t>(dest)) {
-                        tcp_senders.at(tcp_dest.get())->sendall(edi_frag);
-                    }
-                    else {
-                        throw logic_error("EDI destination not implemented");
-                    }
-                }
-                it = m_pending_frames.erase(it);
+void Sender::send_fragments(const vector<edi::PFTFragment>& fragments,
+        const uint64_t *txtimes_ns)
+{
+    if (m_conf.dump) {
+        ostream_iterator<uint8_t> debug_iterator(edi_debug_file);
+        for (const auto& edi_frag : fragments) {
+            copy(edi_frag.begin(), edi_frag.end(), debug_iterator);
+        }
+    }
+
+    // Send over ethernet
+    for (auto& dest : m_conf.destinations) {
+        if (const auto& udp_dest = dynamic_pointer_cast<edi::udp_destination_t>(dest)) {
+            const auto& sender = udp_senders.at(udp_dest.get());
+            sender.socket->send(fragments, sender.address, m_conf.udp_gso, txtimes_ns);
+        }
+        else if (auto tcp_dest = dynamic_pointer_cast<edi::tcp_server_t>(dest)) {
+            for (const auto& edi_frag : fragments) {
+                tcp_dispatchers.at(tcp_dest.get())->write(edi_frag);
             }
-            else {
-                ++it;
+        }
+        else if (auto tcp_dest = dynamic_pointer_cast<edi::tcp_client_t>(dest)) {
+            for (const auto& edi_frag : fragments) {
+                tcp_senders.at(tcp_dest.get())->sendall(edi_frag);
             }
         }
-
-        lock.unlock();
-        this_thread::sleep_for(chrono::microseconds(500));
+        else {
+            throw logic_error("EDI destination not implemented");
+        }
     }
 }
 
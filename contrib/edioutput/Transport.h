@@ -30,9 +30,9 @@
 #include "EDIConfig.h"
 #include "AFPacket.h"
 #include "PFT.h"
+#include "Pacer.h"
 #include "Socket.h"
 #include <chrono>
-#include <map>
 #include <unordered_map>
 #include <fstream>
 #include <cstdint>
@@ -67,6 +67,10 @@ class Sender {
     private:
         void run();
 
+        // Send fragments to all destinations, UDP ones in one batch
+        void send_fragments(const std::vector<edi::PFTFragment>& fragments,
+                const uint64_t *txtimes_ns);
+
         bool m_udp_fragmentation_warning_printed = false;
 
         configuration_t m_conf;
@@ -75,19 +79,25 @@ class Sender {
         // The TagPacket will then be placed into an AFPacket
         edi::AFPacketiser edi_afPacketiser;
 
+        // Reused for every write(), to avoid reallocating the AF packet
+        edi::AFPacket m_af_packet;
+
         // The AF Packet will be protected with reed-solomon and split in fragments
         edi::PFT edi_pft;
 
-        std::unordered_map<udp_destination_t*, std::shared_ptr<Socket::UDPSocket>> udp_sockets;
+        struct udp_sender_t {
+            std::shared_ptr<Socket::UDPSocket> socket;
+            // Resolved once in the constructor
+            Socket::InetAddress address;
+        };
+        std::unordered_map<udp_destination_t*, udp_sender_t> udp_senders;
         std::unordered_map<tcp_server_t*, std::shared_ptr<Socket::TCPDataDispatcher>> tcp_dispatchers;
         std::unordered_map<tcp_client_t*, std::shared_ptr<Socket::TCPSendClient>> tcp_senders;
 
         // PFT spreading requires sending UDP packets at specific time, independently of
-        // time when write() gets called
+        // time when write() gets called. The pacer wakes up run() when fragments are due.
         std::thread m_thread;
-        std::mutex m_mutex;
-        bool m_running = false;
-        std::map<std::chrono::steady_clock::time_point, edi::PFTFragment> m_pending_frames;
+        edi::Pacer m_pacer;
 
         size_t m_last_num_pft_fragments = 0;
 };
@@ -1386,6 +1386,51 @@ typedef enum {
                  bitreservoir, which would affect the audio quality by a large
                  amount. */
 
+  AACENC_PARALLEL_PSY =
+      0x0208, /*!< Run the per-channel stages of the psychoacoustic model
+                 (block switching, transform, band energies, tonality and TNS
+                 detection) for the two channels of a channel pair in two
+                 threads. The joint stereo decisions and quantization are not
+                 affected, and the bitstream is identical to the one of the
+                 serial encoder. This reduces the encoding time of a stereo
+                 frame on systems with more than one processor, and has no
+                 effect on single processor systems.
+                   - 0: Process channels one after the other (default).
+                   - 1: Process channel pairs in parallel. */
+
+  AACENC_SCF_CACHE =
+      0x0209, /*!< Let the afterburner start the scalefactor search of a band
+                 from the result of the previous frame if the band is
+                 stationary, i.e. if its estimated scalefactor and its form
+                 factor changed only slightly. If the noise to mask ratio
+                 reached with the refinement of the previous frame is still
+                 acceptable, the search of that band ends there. The result
+                 kept is the one before the scalefactor assimilation. As long as
+                 the perceptual entropy of the channel did not change by more
+                 than 10%, the scalefactor assimilation only considers the
+                 bands which were searched again. This reduces the processing
+                 power required by the afterburner on stationary signals.
+                 Without the afterburner or with SBR, this parameter has no
+                 effect.
+                   - 0: Search the scalefactors of every frame from scratch
+                 (default).
+                   - 1: Reuse the scalefactors of the previous frame. */
+
+  AACENC_COMPLEXITY =
+      0x020A, /*!< Reduce the processing power required by the encoder at the
+                 expense of audio quality. Each level includes the reductions
+                 of the levels below.
+                   - 0: Full complexity (default).
+                   - 1: The afterburner skips its last scalefactor assimilation
+                 pass, the TNS filter search on long blocks is limited to
+                 order 8 and the tonality is only calculated in the bands
+                 where PNS may be used.
+                   - 2: The afterburner only refines the scalefactors of single
+                 bands.
+                   - 3: PNS and the spectral flatness weighting of the
+                 threshold adaptation are disabled, the TNS filter search on
+                 long blocks is limited to order 4. */
+
   AACENC_TRANSMUX = 0x0300, /*!< Transport type to be used. See ::TRANSPORT_TYPE
                                in FDK_audio.h. Following types can be configured
                                in encoder library:
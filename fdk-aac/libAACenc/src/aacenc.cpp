@@ -598,11 +598,18 @@ AAC_ENCODER_ERROR FDKaacEnc_Initialize(
     if (ErrorStatus != AAC_ENC_OK) goto bail;
   }
 
+  if (config->useParallelPsy && (hAacEnc->psyKernel->hWorker == NULL)) {
+    ErrorStatus = FDKaacEnc_PsyWorkerOpen(&hAacEnc->psyKernel->hWorker);
+    if (ErrorStatus != AAC_ENC_OK) goto bail;
+  } else if (!config->useParallelPsy) {
+    FDKaacEnc_PsyWorkerClose(&hAacEnc->psyKernel->hWorker);
+  }
+
   ErrorStatus = FDKaacEnc_psyMainInit(
       hAacEnc->psyKernel, config->audioObjectType, cm, config->sampleRate,
       config->framelength, psyBitrate, tnsMask, hAacEnc->bandwidth90dB,
-      config->usePns, config->useIS, config->useMS, config->syntaxFlags,
-      initFlags);
+      config->usePns, config->useIS, config->useMS, config->complexity,
+      config->syntaxFlags, initFlags);
   if (ErrorStatus != AAC_ENC_OK) goto bail;
 
   ErrorStatus = FDKaacEnc_QCOutInit(hAacEnc->qcOut, hAacEnc->maxFrames, cm);
@@ -745,7 +752,12 @@ AAC_ENCODER_ERROR FDKaacEnc_Initialize(
       goto bail;
   }
 
-  qcInit.invQuant = (config->useRequant) ? 2 : 0;
+  /* each complexity level drops one scalefactor assimilation pass down to
+     the refinement of single bands */
+  qcInit.invQuant =
+      (config->useRequant) ? fMax(1, 3 - (INT)config->complexity) : 0;
+  qcInit.useScfCache = config->useScfCache;
+  qcInit.complexity = config->complexity;
 
   /* maxIterations should be set to the maximum number of requantization
    * iterations that are allowed before the crash recovery functionality is
@@ -844,7 +856,8 @@ AAC_ENCODER_ERROR FDKaacEnc_EncodeFrame(
           elInfo.nChannelsInEl, hAacEnc->psyKernel->psyElement[el],
           hAacEnc->psyKernel->psyDynamic, hAacEnc->psyKernel->psyConf,
           psyOut->psyOutElement[el], inputBuffer, inputBufferBufSize,
-          cm->elInfo[el].ChannelIndex, cm->nChannels);
+          cm->elInfo[el].ChannelIndex, cm->nChannels,
+          hAacEnc->psyKernel->hWorker);
 
       if (ErrorStatus != AAC_ENC_OK) return ErrorStatus;
 
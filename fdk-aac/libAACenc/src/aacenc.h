@@ -252,6 +252,14 @@ struct AACENC_CONFIG {
 
   UCHAR useRequant; /* flag: use afterburner */
 
+  UCHAR useParallelPsy; /* flag: run the per-channel psychoacoustic stages of
+                           channel pairs in two threads */
+
+  UCHAR useScfCache; /* flag: start the afterburner from the scalefactors of
+                        the previous frame */
+
+  UCHAR complexity; /* reduction of the encoder complexity, 0 (full) to 3 */
+
   UINT downscaleFactor;
 };
 
@@ -176,6 +176,9 @@ typedef struct {
   UINT userBitrateMode;
   UINT userBandwidth;
   UINT userAfterburner;
+  UINT userParallelPsy;
+  UINT userScfCache;
+  UINT userComplexity;
   UINT userFramelength;
   UINT userAncDataRate;
   UINT userPeakBitrate;
@@ -703,6 +706,9 @@ AAC_ENCODER_ERROR aacEncDefaultConfig(HANDLE_AACENC_CONFIG hAacConfig,
   config->userPns = hAacConfig->usePns;
   config->userIntensity = hAacConfig->useIS;
   config->userAfterburner = hAacConfig->useRequant;
+  config->userParallelPsy = hAacConfig->useParallelPsy;
+  config->userScfCache = hAacConfig->useScfCache;
+  config->userComplexity = hAacConfig->complexity;
   config->userFramelength = (UINT)-1;
 
   config->userDownscaleFactor = 1;
@@ -924,6 +930,9 @@ static AACENC_ERROR FDKaacEnc_AdjustEncSettings(HANDLE_AACENCODER hAacEncoder,
   hAacConfig->bitrateMode = (AACENC_BITRATE_MODE)config->userBitrateMode;
   hAacConfig->bandWidth = config->userBandwidth;
   hAacConfig->useRequant = config->userAfterburner;
+  hAacConfig->useParallelPsy = config->userParallelPsy;
+  hAacConfig->useScfCache = config->userScfCache;
+  hAacConfig->complexity = config->userComplexity;
 
   hAacConfig->anc_Rate = config->userAncDataRate;
   hAacConfig->syntaxFlags = 0;
@@ -1056,6 +1065,12 @@ static AACENC_ERROR FDKaacEnc_AdjustEncSettings(HANDLE_AACENCODER hAacEncoder,
     hAacConfig->sbrRatio = isSbrActive(hAacConfig) ? config->userSbrRatio : 0;
   }
 
+  /* The scalefactor cache is only used for AAC-LC. With SBR, it costs as much
+   * processing power as it saves on many signals. */
+  if (isSbrActive(hAacConfig)) {
+    hAacConfig->useScfCache = 0;
+  }
+
   /* Set default bitrate */
   hAacConfig->bitRate = config->userBitrate;
 
@@ -2320,6 +2335,36 @@ AACENC_ERROR aacEncoder_SetParam(const HANDLE_AACENCODER hAacEncoder,
         hAacEncoder->InitFlags |= AACENC_INIT_CONFIG;
       }
       break;
+    case AACENC_PARALLEL_PSY:
+      if (settings->userParallelPsy != value) {
+        if (!((value == 0) || (value == 1))) {
+          err = AACENC_INVALID_CONFIG;
+          break;
+        }
+        settings->userParallelPsy = value;
+        hAacEncoder->InitFlags |= AACENC_INIT_CONFIG;
+      }
+      break;
+    case AACENC_SCF_CACHE:
+      if (settings->userScfCache != value) {
+        if (!((value == 0) || (value == 1))) {
+          err = AACENC_INVALID_CONFIG;
+          break;
+        }
+        settings->userScfCache = value;
+        hAacEncoder->InitFlags |= AACENC_INIT_CONFIG;
+      }
+      break;
+    case AACENC_COMPLEXITY:
+      if (settings->userComplexity != value) {
+        if (value > 3) {
+          err = AACENC_INVALID_CONFIG;
+          break;
+        }
+        settings->userComplexity = value;
+        hAacEncoder->InitFlags |= AACENC_INIT_CONFIG;
+      }
+      break;
     case AACENC_GRANULE_LENGTH:
       if (settings->userFramelength != value) {
         switch (value) {
@@ -2523,6 +2568,15 @@ UINT aacEncoder_GetParam(const HANDLE_AACENCODER hAacEncoder,
     case AACENC_AFTERBURNER:
       value = (UINT)hAacEncoder->aacConfig.useRequant;
       break;
+    case AACENC_PARALLEL_PSY:
+      value = (UINT)hAacEncoder->aacConfig.useParallelPsy;
+      break;
+    case AACENC_SCF_CACHE:
+      value = (UINT)hAacEncoder->aacConfig.useScfCache;
+      break;
+    case AACENC_COMPLEXITY:
+      value = (UINT)hAacEncoder->aacConfig.complexity;
+      break;
     case AACENC_GRANULE_LENGTH:
       value = (UINT)hAacEncoder->aacConfig.framelength;
       break;
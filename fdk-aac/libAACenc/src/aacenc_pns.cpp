@@ -129,16 +129,22 @@ static void FDKaacEnc_CalcNoiseNrgs(const INT sfbActive, INT *pnsFlag,
     returns:      error status
     input:        PNS Config struct (modified)
                   bitrate, samplerate, usePns,
-                  number of sfb's, pointer to sfb offset
+                  number of sfb's, pointer to sfb offset,
+                  complexity level (disables PNS above 2)
     output:       error code
 
 *****************************************************************************/
 
 AAC_ENCODER_ERROR FDKaacEnc_InitPnsConfiguration(
     PNS_CONFIG *pnsConf, INT bitRate, INT sampleRate, INT usePns, INT sfbCnt,
-    const INT *sfbOffset, const INT numChan, const INT isLC) {
+    const INT *sfbOffset, const INT numChan, const INT isLC,
+    const INT complexity) {
   AAC_ENCODER_ERROR ErrorStatus;
 
+  if (complexity > 2) {
+    usePns = 0;
+  }
+
   /* init noise detection */
   ErrorStatus = FDKaacEnc_GetPnsParam(&pnsConf->np, bitRate, sampleRate, sfbCnt,
                                       sfbOffset, &usePns, numChan, isLC);
@@ -149,6 +155,13 @@ AAC_ENCODER_ERROR FDKaacEnc_InitPnsConfiguration(
 
   pnsConf->usePns = usePns;
 
+  /* The noise detection only decides on the bands from startSfb on, and on
+     the band below when it closes a hole. The tonality of the lower bands is
+     not needed. */
+  pnsConf->tonalityStartSfb = ((usePns > 0) && (complexity > 0))
+                                  ? fMax(0, pnsConf->np.startSfb - 1)
+                                  : 0;
+
   return AAC_ENC_OK;
 }
 
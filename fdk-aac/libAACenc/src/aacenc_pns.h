@@ -113,6 +113,7 @@ typedef struct {
   FIXP_DBL minCorrelationEnergy;
   FIXP_DBL noiseCorrelationThresh;
   INT usePns;
+  INT tonalityStartSfb; /* first band the tonality is calculated for */
 } PNS_CONFIG;
 
 typedef struct {
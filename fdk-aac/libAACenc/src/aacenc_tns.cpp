@@ -389,14 +389,15 @@ INT FDKaacEnc_FreqToBandWidthRounding(const INT freq, const INT fs,
                   blocktype (long or short),
                   TNS Config struct (modified),
                   psy config struct,
-                  tns active flag
+                  tns active flag,
+                  complexity level (limits the filter order of long blocks)
     output:
 
 *****************************************************************************/
 AAC_ENCODER_ERROR FDKaacEnc_InitTnsConfiguration(
     INT bitRate, INT sampleRate, INT channels, INT blockType, INT granuleLength,
     INT isLowDelay, INT ldSbrPresent, TNS_CONFIG *tC, PSY_CONFIGURATION *pC,
-    INT active, INT useTnsPeak) {
+    INT active, INT useTnsPeak, INT complexity) {
   int i;
   // float acfTimeRes   = (blockType == SHORT_WINDOW) ? 0.125f : 0.046875f;
 
@@ -409,6 +410,10 @@ AAC_ENCODER_ERROR FDKaacEnc_InitTnsConfiguration(
   tC->tnsActive = (active) ? TRUE : FALSE;
   tC->maxOrder = (blockType == SHORT_WINDOW) ? 5 : 12; /* maximum: 7, 20 */
   if (bitRate < 16000) tC->maxOrder -= 2;
+  /* the cost of the filter search on long blocks grows with the order */
+  if ((blockType != SHORT_WINDOW) && (complexity > 0)) {
+    tC->maxOrder = fMin(tC->maxOrder, (complexity > 2) ? 4 : 8);
+  }
   tC->coefRes = (blockType == SHORT_WINDOW) ? 3 : 4;
 
   /* LPC stop line: highest MDCT line to be coded, but do not go beyond
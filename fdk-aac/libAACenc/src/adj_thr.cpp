@@ -917,7 +917,8 @@ void FDKaacEnc_peCalculation(PE_DATA *const peData,
 
   /* calculate weighting factor for threshold adjustment */
   FDKaacEnc_calcWeighting(peData, psyOutChannel, qcOutChannel, toolsInfo,
-                          adjThrStateElement, nChannels, 1);
+                          adjThrStateElement, nChannels,
+                          adjThrStateElement->usePatchTool);
   {
     /* no weighting of threholds and energies for mlout */
     /* weight energies and thresholds */
@@ -2462,7 +2463,8 @@ description:  initialize ADJ_THR_STATE
 *****************************************************************************/
 void FDKaacEnc_AdjThrInit(
     ADJ_THR_STATE *const hAdjThr, const INT meanPe, const INT invQuant,
-    const CHANNEL_MAPPING *const channelMapping, const INT sampleRate,
+    const INT complexity, const CHANNEL_MAPPING *const channelMapping,
+    const INT sampleRate,
     const INT totalBitrate, const INT isLowDelay,
     const AACENC_BITRES_MODE bitResMode, const INT dZoneQuantEnable,
     const INT bitDistributionMode, const FIXP_DBL vbrQualFactor) {
@@ -2587,6 +2589,9 @@ void FDKaacEnc_AdjThrInit(
     atsElem->dynBitsLast = -1;
     atsElem->peLast = 0;
 
+    /* threshold weighting, skipped at the lowest complexity */
+    atsElem->usePatchTool = (complexity > 2) ? 0 : 1;
+
     /* init bits to pe factor */
 
     /* init bits2PeFactor */
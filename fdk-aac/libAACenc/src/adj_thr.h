@@ -132,7 +132,8 @@ description:  initialize ADJ_THR_STATE
 *****************************************************************************/
 void FDKaacEnc_AdjThrInit(
     ADJ_THR_STATE *const hAdjThr, const INT meanPe, const INT invQuant,
-    const CHANNEL_MAPPING *const channelMapping, const INT sampleRate,
+    const INT complexity, const CHANNEL_MAPPING *const channelMapping,
+    const INT sampleRate,
     const INT totalBitrate, const INT isLowDelay,
     const AACENC_BITRES_MODE bitResMode, const INT dZoneQuantEnable,
     const INT bitDistributionMode, const FIXP_DBL vbrQualFactor);
@@ -162,6 +162,7 @@ typedef struct {
   /* threshold weighting */
   FIXP_DBL chaosMeasureEnFac[(2)];
   INT lastEnFacPatch[(2)];
+  INT usePatchTool; /* weight by the flatness of the audible spectrum */
 
 } ATS_ELEMENT;
 
@@ -540,8 +540,9 @@ static const COUNT_FUNCTION countFuncTable[CODE_BOOK_ESC_LAV + 1] = {
     FDKaacEnc_countEsc                      /* 16 */
 };
 
-INT FDKaacEnc_bitCount(const SHORT *const values, const INT width,
-                       const INT maxVal, INT *const RESTRICT bitCount) {
+static INT FDKaacEnc_bitCount_scalar(const SHORT *const values, const INT width,
+                                     const INT maxVal,
+                                     INT *const RESTRICT bitCount) {
   /*
     check if we can use codebook 0
   */
@@ -554,6 +555,31 @@ INT FDKaacEnc_bitCount(const SHORT *const values, const INT width,
   return (0);
 }
 
+static BIT_COUNT_KERNEL FDKaacEnc_bitCountKernels[2] = {
+    {"scalar", FDKaacEnc_bitCount_scalar}};
+static INT FDKaacEnc_numBitCountKernels = 1;
+
+static BIT_COUNT_FN FDKaacEnc_bitCountFn = FDKaacEnc_bitCount_scalar;
+
+/* Versions that give the same counts as the function above */
+#if defined(__x86__) && defined(__GNUC__)
+#include "x86/bit_cnt_x86.cpp"
+#endif
+
+INT FDKaacEnc_bitCount(const SHORT *const values, const INT width,
+                       const INT maxVal, INT *const RESTRICT bitCount) {
+  return FDKaacEnc_bitCountFn(values, width, maxVal, bitCount);
+}
+
+INT FDKaacEnc_getBitCountKernels(const BIT_COUNT_KERNEL **kernels) {
+  *kernels = FDKaacEnc_bitCountKernels;
+  return FDKaacEnc_numBitCountKernels;
+}
+
+void FDKaacEnc_setBitCountFn(BIT_COUNT_FN bitCount) {
+  FDKaacEnc_bitCountFn = bitCount;
+}
+
 /*
   count difference between actual and zeroed lines
 */
@@ -181,6 +181,25 @@ enum codeBookLav {
 INT FDKaacEnc_bitCount(const SHORT *aQuantSpectrum, const INT noOfSpecLines,
                        INT maxVal, INT *bitCountLut);
 
+/* bit counters, for tests and benchmarks */
+
+typedef INT (*BIT_COUNT_FN)(const SHORT *const values, const INT width,
+                            const INT maxVal, INT *const bitCount);
+
+typedef struct {
+  const char *name;
+  BIT_COUNT_FN bitCount;
+} BIT_COUNT_KERNEL;
+
+/* The versions of FDKaacEnc_bitCount() the CPU supports, all with the
+   counts of the scalar one, which comes first. The encoder uses the last
+   one. Returns their number. */
+INT FDKaacEnc_getBitCountKernels(const BIT_COUNT_KERNEL **kernels);
+
+/* Makes FDKaacEnc_bitCount() call bitCount, one of the kernels or a
+   function that calls one */
+void FDKaacEnc_setBitCountFn(BIT_COUNT_FN bitCount);
+
 INT FDKaacEnc_countValues(SHORT *values, INT width, INT codeBook);
 
 INT FDKaacEnc_codeValues(SHORT *values, INT width, INT codeBook,
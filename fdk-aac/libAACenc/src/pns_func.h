@@ -109,7 +109,8 @@ amm-info@iis.fraunhofer.de
 
 AAC_ENCODER_ERROR FDKaacEnc_InitPnsConfiguration(
     PNS_CONFIG *pnsConf, INT bitRate, INT sampleRate, INT usePns, INT sfbCnt,
-    const INT *sfbOffset, const INT numChan, const INT isLC);
+    const INT *sfbOffset, const INT numChan, const INT isLC,
+    const INT complexity);
 
 void FDKaacEnc_PnsDetect(PNS_CONFIG *pnsConf, PNS_DATA *pnsData,
                          const INT lastWindowSequence, const INT sfbActive,
@@ -300,7 +300,8 @@ AAC_ENCODER_ERROR FDKaacEnc_psyInit(PSY_INTERNAL *hPsy, PSY_OUT **phpsyOut,
 AAC_ENCODER_ERROR FDKaacEnc_psyMainInit(
     PSY_INTERNAL *hPsy, AUDIO_OBJECT_TYPE audioObjectType, CHANNEL_MAPPING *cm,
     INT sampleRate, INT granuleLength, INT bitRate, INT tnsMask, INT bandwidth,
-    INT usePns, INT useIS, INT useMS, UINT syntaxFlags, ULONG initFlags) {
+    INT usePns, INT useIS, INT useMS, INT complexity, UINT syntaxFlags,
+    ULONG initFlags) {
   AAC_ENCODER_ERROR ErrorStatus;
   int i, ch;
   int channelsEff = cm->nChannelsEff;
@@ -342,7 +343,7 @@ AAC_ENCODER_ERROR FDKaacEnc_psyMainInit(
       (bitRate * tnsChannels) / channelsEff, sampleRate, tnsChannels,
       LONG_WINDOW, hPsy->granuleLength, isLowDelay(audioObjectType),
       (syntaxFlags & AC_SBR_PRESENT) ? 1 : 0, &(hPsy->psyConf[0].tnsConf),
-      &hPsy->psyConf[0], (INT)(tnsMask & 2), (INT)(tnsMask & 8));
+      &hPsy->psyConf[0], (INT)(tnsMask & 2), (INT)(tnsMask & 8), complexity);
 
   if (ErrorStatus != AAC_ENC_OK) return ErrorStatus;
 
@@ -357,7 +358,8 @@ AAC_ENCODER_ERROR FDKaacEnc_psyMainInit(
         (bitRate * tnsChannels) / channelsEff, sampleRate, tnsChannels,
         SHORT_WINDOW, hPsy->granuleLength, isLowDelay(audioObjectType),
         (syntaxFlags & AC_SBR_PRESENT) ? 1 : 0, &hPsy->psyConf[1].tnsConf,
-        &hPsy->psyConf[1], (INT)(tnsMask & 1), (INT)(tnsMask & 4));
+        &hPsy->psyConf[1], (INT)(tnsMask & 1), (INT)(tnsMask & 4),
+        complexity);
 
     if (ErrorStatus != AAC_ENC_OK) return ErrorStatus;
   }
@@ -381,20 +383,330 @@ AAC_ENCODER_ERROR FDKaacEnc_psyMainInit(
   ErrorStatus = FDKaacEnc_InitPnsConfiguration(
       &hPsy->psyConf[0].pnsConf, bitRate / channelsEff, sampleRate, usePns,
       hPsy->psyConf[0].sfbCnt, hPsy->psyConf[0].sfbOffset,
-      cm->elInfo[0].nChannelsInEl, (hPsy->psyConf[0].filterbank == FB_LC));
+      cm->elInfo[0].nChannelsInEl, (hPsy->psyConf[0].filterbank == FB_LC),
+      complexity);
   if (ErrorStatus != AAC_ENC_OK) return ErrorStatus;
 
   if (granuleLength > 512) {
     ErrorStatus = FDKaacEnc_InitPnsConfiguration(
         &hPsy->psyConf[1].pnsConf, bitRate / channelsEff, sampleRate, usePns,
         hPsy->psyConf[1].sfbCnt, hPsy->psyConf[1].sfbOffset,
-        cm->elInfo[1].nChannelsInEl, (hPsy->psyConf[1].filterbank == FB_LC));
+        cm->elInfo[1].nChannelsInEl, (hPsy->psyConf[1].filterbank == FB_LC),
+        complexity);
     if (ErrorStatus != AAC_ENC_OK) return ErrorStatus;
   }
 
   return ErrorStatus;
 }
 
+/* State of one call of FDKaacEnc_psyMain() that is shared by the per-channel
+   stages below. Each stage only writes to the entries of its channel, so the
+   two channels of a pair can be processed in parallel. */
+typedef struct {
+  PSY_STATIC **psyStatic;
+  PSY_OUT_CHANNEL **psyOutChannel;
+  PSY_CONFIGURATION *hPsyConfLong;
+  INT_PCM *pInput;
+  UINT inputBufSize;
+  INT *chIdx;
+  INT nTimeSamples;
+  INT blockSwitchingOffset;
+
+  PSY_DATA *psyData[(2)];
+  TNS_DATA *tnsData[(2)];
+  PSY_CONFIGURATION *hThisPsyConf[(2)];
+  INT windowLength[(2)];
+  INT nWindows[(2)];
+  INT maxSfb[(2)];
+  INT *pSfbMaxScaleSpec[(2)];
+  FIXP_DBL *pSfbEnergy[(2)];
+  FIXP_DBL *pSfbEnergyLdData[(2)];
+  FIXP_DBL *pSfbThreshold[(2)];
+  INT isShortWindow[(2)];
+  FIXP_SGL (*sfbTonality)[MAX_SFB_LONG];
+
+  /* results of the per-channel stages */
+  INT transformError[(2)];
+  INT zeroSpec[(2)];     /* all spectral lines of the channel are zero */
+  INT minSpecShift[(2)]; /* smallest sfbMaxScaleSpec of the channel */
+  FIXP_DBL maxNrg[(2)];  /* largest band energy of the channel */
+
+  /* decisions taken for both channels between the stages */
+  INT zeroSpecAll;
+  INT minSpecShiftAll;
+  INT finalShift;
+  INT calcTonality;
+  INT tnsDetect;
+} PSY_MAIN_FRAME;
+
+/* Block switching and update of the internal input buffer */
+static void FDKaacEnc_psyBlockSwitchingCh(void *arg, INT ch) {
+  PSY_MAIN_FRAME *f = (PSY_MAIN_FRAME *)arg;
+  PSY_STATIC *psyStatic = f->psyStatic[ch];
+  const INT nTimeSamples = f->nTimeSamples;
+
+  if (f->hPsyConfLong->filterbank != FB_ELD) {
+    C_ALLOC_SCRATCH_START(pTimeSignal, INT_PCM, (1024))
+
+    /* copy input data and use for block switching */
+    FDKmemcpy(pTimeSignal, f->pInput + f->chIdx[ch] * f->inputBufSize,
+              nTimeSamples * sizeof(INT_PCM));
+
+    FDKaacEnc_BlockSwitching(&psyStatic->blockSwitchingControl, nTimeSamples,
+                             psyStatic->isLFE, pTimeSignal);
+
+    /* fill up internal input buffer, to 2xframelength samples */
+    FDKmemcpy(psyStatic->psyInputBuffer + f->blockSwitchingOffset, pTimeSignal,
+              (2 * nTimeSamples - f->blockSwitchingOffset) * sizeof(INT_PCM));
+
+    C_ALLOC_SCRATCH_END(pTimeSignal, INT_PCM, (1024))
+  } else {
+    /* copy input data and use for block switching */
+    FDKmemcpy(psyStatic->psyInputBuffer + f->blockSwitchingOffset,
+              f->pInput + f->chIdx[ch] * f->inputBufSize,
+              nTimeSamples * sizeof(INT_PCM));
+  }
+}
+
+/* Transform, lowpass, and possible spectrum leftshift for each sfb. The
+   leftshift is also calculated when the spectrum of the channel is zero,
+   because it is still needed if the other channel is not. */
+static void FDKaacEnc_psyTransformCh(void *arg, INT ch) {
+  PSY_MAIN_FRAME *f = (PSY_MAIN_FRAME *)arg;
+  PSY_STATIC *psyStatic = f->psyStatic[ch];
+  PSY_DATA *psyData = f->psyData[ch];
+  PSY_CONFIGURATION *hThisPsyConf = f->hThisPsyConf[ch];
+  const INT nTimeSamples = f->nTimeSamples;
+  INT mdctSpectrum_e;
+  INT w, wOffset, sfb, line;
+
+  f->transformError[ch] = 0;
+  f->zeroSpec[ch] = TRUE;
+  f->minSpecShift[ch] = MAX_SHIFT_DBL;
+
+  /* update number of active bands */
+  if (psyStatic->isLFE) {
+    psyData->sfbActive = hThisPsyConf->sfbActiveLFE;
+    psyData->lowpassLine = hThisPsyConf->lowpassLineLFE;
+  } else {
+    psyData->sfbActive = hThisPsyConf->sfbActive;
+    psyData->lowpassLine = hThisPsyConf->lowpassLine;
+  }
+
+  if (hThisPsyConf->filterbank == FB_ELD) {
+    if (FDKaacEnc_Transform_Real_Eld(
+            psyStatic->psyInputBuffer, psyData->mdctSpectrum,
+            psyStatic->blockSwitchingControl.lastWindowSequence,
+            psyStatic->blockSwitchingControl.windowShape,
+            &psyStatic->blockSwitchingControl.lastWindowShape, nTimeSamples,
+            &mdctSpectrum_e, hThisPsyConf->filterbank,
+            psyStatic->overlapAddBuffer) != 0) {
+      f->transformError[ch] = 1;
+      return;
+    }
+  } else {
+    if (FDKaacEnc_Transform_Real(
+            psyStatic->psyInputBuffer, psyData->mdctSpectrum,
+            psyStatic->blockSwitchingControl.lastWindowSequence,
+            psyStatic->blockSwitchingControl.windowShape,
+            &psyStatic->blockSwitchingControl.lastWindowShape,
+            &psyStatic->mdctPers, nTimeSamples, &mdctSpectrum_e,
+            hThisPsyConf->filterbank) != 0) {
+      f->transformError[ch] = 1;
+      return;
+    }
+  }
+
+  for (w = 0; w < f->nWindows[ch]; w++) {
+    wOffset = w * f->windowLength[ch];
+
+    /* Low pass / highest sfb */
+    FDKmemclear(&psyData->mdctSpectrum[psyData->lowpassLine + wOffset],
+                (f->windowLength[ch] - psyData->lowpassLine) *
+                    sizeof(FIXP_DBL));
+
+    if ((f->hPsyConfLong->filterbank != FB_LC) &&
+        (psyData->lowpassLine >= FADE_OUT_LEN)) {
+      /* Do blending to reduce gibbs artifacts */
+      for (int i = 0; i < FADE_OUT_LEN; i++) {
+        psyData->mdctSpectrum[psyData->lowpassLine + wOffset - FADE_OUT_LEN +
+                              i] =
+            fMult(psyData->mdctSpectrum[psyData->lowpassLine + wOffset -
+                                        FADE_OUT_LEN + i],
+                  fadeOutFactor[i]);
+      }
+    }
+
+    /* Check for zero spectrum. These loops will usually terminate very, very
+     * early. */
+    for (line = 0; (line < psyData->lowpassLine) && (f->zeroSpec[ch] == TRUE);
+         line++) {
+      if (psyData->mdctSpectrum[line + wOffset] != (FIXP_DBL)0) {
+        f->zeroSpec[ch] = FALSE;
+        break;
+      }
+    }
+
+  } /* w loop */
+
+  psyData->mdctScale = mdctSpectrum_e;
+
+  /* rotate internal time samples */
+  FDKmemmove(psyStatic->psyInputBuffer,
+             psyStatic->psyInputBuffer + nTimeSamples,
+             nTimeSamples * sizeof(INT_PCM));
+
+  /* ... and get remaining samples from input buffer */
+  FDKmemcpy(psyStatic->psyInputBuffer + nTimeSamples,
+            f->pInput + (2 * nTimeSamples - f->blockSwitchingOffset) +
+                f->chIdx[ch] * f->inputBufSize,
+            (f->blockSwitchingOffset - nTimeSamples) * sizeof(INT_PCM));
+
+  /* Calc possible spectrum leftshift for each sfb (1 means: 1 bit left shift
+   * is possible without overflow) */
+  for (w = 0; w < f->nWindows[ch]; w++) {
+    INT *pSfbMaxScaleSpec = f->pSfbMaxScaleSpec[ch] + w * f->maxSfb[ch];
+    wOffset = w * f->windowLength[ch];
+    FDKaacEnc_CalcSfbMaxScaleSpec(psyData->mdctSpectrum + wOffset,
+                                  hThisPsyConf->sfbOffset, pSfbMaxScaleSpec,
+                                  psyData->sfbActive);
+
+    for (sfb = 0; sfb < psyData->sfbActive; sfb++)
+      f->minSpecShift[ch] = fixMin(f->minSpecShift[ch], pSfbMaxScaleSpec[sfb]);
+  }
+}
+
+/* Calc possible energy leftshift for each sfb (1 means: 1 bit left shift is
+ * possible without overflow) */
+static void FDKaacEnc_psyBandEnergyCh(void *arg, INT ch) {
+  PSY_MAIN_FRAME *f = (PSY_MAIN_FRAME *)arg;
+  PSY_DATA *psyData = f->psyData[ch];
+  INT w, wOffset;
+  FIXP_DBL currNrg;
+
+  f->maxNrg[ch] = 0;
+
+  if (f->zeroSpecAll) return;
+
+  for (w = 0; w < f->nWindows[ch]; w++) {
+    wOffset = w * f->windowLength[ch];
+    currNrg = FDKaacEnc_CheckBandEnergyOptim(
+        psyData->mdctSpectrum + wOffset,
+        f->pSfbMaxScaleSpec[ch] + w * f->maxSfb[ch],
+        f->hThisPsyConf[ch]->sfbOffset, psyData->sfbActive,
+        f->pSfbEnergy[ch] + w * f->maxSfb[ch],
+        f->pSfbEnergyLdData[ch] + w * f->maxSfb[ch], f->minSpecShiftAll - 4);
+
+    f->maxNrg[ch] = fixMax(f->maxNrg[ch], currNrg);
+  }
+}
+
+/* Rescaling of energies and spectrum with the shift common to both channels,
+   tonality and TNS detection */
+static void FDKaacEnc_psyTonalityCh(void *arg, INT ch) {
+  PSY_MAIN_FRAME *f = (PSY_MAIN_FRAME *)arg;
+  PSY_DATA *psyData = f->psyData[ch];
+  PSY_CONFIGURATION *hThisPsyConf = f->hThisPsyConf[ch];
+  INT *pSfbMaxScaleSpec = f->pSfbMaxScaleSpec[ch];
+  FIXP_DBL *pSfbEnergy = f->pSfbEnergy[ch];
+  FIXP_DBL *pSfbEnergyLdData = f->pSfbEnergyLdData[ch];
+  FIXP_DBL *pSfbThreshold = f->pSfbThreshold[ch];
+  const INT maxSfb = f->maxSfb[ch];
+  const INT finalShift = f->finalShift;
+  INT w, wOffset, sfb, line;
+
+  if (f->zeroSpecAll == FALSE) {
+    /* correct sfbEnergy and sfbEnergyLdData with new finalShift */
+    FIXP_DBL ldShift = finalShift * FL2FXCONST_DBL(2.0 / 64);
+    INT w_maxSfb_ch = 0;
+    for (w = 0; w < f->nWindows[ch]; w++) {
+      for (sfb = 0; sfb < psyData->sfbActive; sfb++) {
+        INT scale = fixMax(0, (pSfbMaxScaleSpec + w_maxSfb_ch)[sfb] - 4);
+        scale = fixMin((scale - finalShift) << 1, DFRACT_BITS - 1);
+        if (scale >= 0)
+          (pSfbEnergy + w_maxSfb_ch)[sfb] >>= (scale);
+        else
+          (pSfbEnergy + w_maxSfb_ch)[sfb] <<= (-scale);
+        (pSfbThreshold + w_maxSfb_ch)[sfb] =
+            fMult((pSfbEnergy + w_maxSfb_ch)[sfb], C_RATIO);
+        (pSfbEnergyLdData + w_maxSfb_ch)[sfb] += ldShift;
+      }
+      w_maxSfb_ch += maxSfb;
+    }
+
+    if (finalShift != 0) {
+      INT wLen = f->windowLength[ch];
+      INT lowpassLine = psyData->lowpassLine;
+      wOffset = 0;
+      FIXP_DBL *mdctSpectrum = &psyData->mdctSpectrum[0];
+      for (w = 0; w < f->nWindows[ch]; w++) {
+        FIXP_DBL *spectrum = &mdctSpectrum[wOffset];
+        for (line = 0; line < lowpassLine; line++) {
+          spectrum[line] <<= finalShift;
+        }
+        wOffset += wLen;
+
+        /* update sfbMaxScaleSpec */
+        for (sfb = 0; sfb < psyData->sfbActive; sfb++)
+          (pSfbMaxScaleSpec + w * maxSfb)[sfb] -= finalShift;
+      }
+      /* update mdctScale */
+      psyData->mdctScale -= finalShift;
+    }
+
+  } else {
+    /* all spectral lines are zero */
+    psyData->mdctScale =
+        0; /* otherwise mdctScale would be for example 7 and PCM quantization
+            * thresholds would be shifted 14 bits to the right causing some of
+            * them to become 0 (which causes problems later) */
+    /* clear sfbMaxScaleSpec */
+    for (w = 0; w < f->nWindows[ch]; w++) {
+      for (sfb = 0; sfb < psyData->sfbActive; sfb++) {
+        (pSfbMaxScaleSpec + w * maxSfb)[sfb] = 0;
+        (pSfbEnergy + w * maxSfb)[sfb] = (FIXP_DBL)0;
+        (pSfbEnergyLdData + w * maxSfb)[sfb] = FL2FXCONST_DBL(-1.0f);
+        (pSfbThreshold + w * maxSfb)[sfb] = (FIXP_DBL)0;
+      }
+    }
+  }
+
+  if (!f->calcTonality) return;
+
+  if (!f->isShortWindow[ch]) {
+    /* tonality */
+    FDKaacEnc_CalculateFullTonality(
+        psyData->mdctSpectrum, pSfbMaxScaleSpec, pSfbEnergyLdData,
+        f->sfbTonality[ch], psyData->sfbActive, hThisPsyConf->sfbOffset,
+        hThisPsyConf->pnsConf.usePns, hThisPsyConf->pnsConf.tonalityStartSfb);
+  }
+
+  if (f->tnsDetect) {
+    for (w = 0; w < f->nWindows[ch]; w++) {
+      wOffset = w * f->windowLength[ch];
+      /* TNS */
+      FDKaacEnc_TnsDetect(
+          f->tnsData[ch], &hThisPsyConf->tnsConf,
+          &f->psyOutChannel[ch]->tnsInfo, hThisPsyConf->sfbCnt,
+          psyData->mdctSpectrum + wOffset, w,
+          f->psyStatic[ch]->blockSwitchingControl.lastWindowSequence);
+    }
+  }
+}
+
+/* Runs one per-channel stage for all channels of the element */
+static void FDKaacEnc_psyRunChannels(HANDLE_PSY_WORKER hWorker,
+                                     PSY_WORKER_FN fn, PSY_MAIN_FRAME *f,
+                                     INT channels) {
+  INT ch;
+
+  if (channels == 2) {
+    FDKaacEnc_PsyWorkerRun(hWorker, fn, f);
+  } else {
+    for (ch = 0; ch < channels; ch++) fn(f, ch);
+  }
+}
+
 /*****************************************************************************
 
     functionname: FDKaacEnc_psyMain
@@ -402,6 +714,8 @@ AAC_ENCODER_ERROR FDKaacEnc_psyMainInit(
     returns:      an error code
 
         This function assumes that enough input data is in the modulo buffer.
+        If hWorker is not NULL, the per-channel stages of a channel pair are
+        run in parallel.
 
 *****************************************************************************/
 AAC_ENCODER_ERROR FDKaacEnc_psyMain(INT channels, PSY_ELEMENT *psyElement,
@@ -409,15 +723,17 @@ AAC_ENCODER_ERROR FDKaacEnc_psyMain(INT channels, PSY_ELEMENT *psyElement,
                                     PSY_CONFIGURATION *psyConf,
                                     PSY_OUT_ELEMENT *RESTRICT psyOutElement,
                                     INT_PCM *pInput, const UINT inputBufSize,
-                                    INT *chIdx, INT totalChannels) {
+                                    INT *chIdx, INT totalChannels,
+                                    HANDLE_PSY_WORKER hWorker) {
   const INT commonWindow = 1;
   INT maxSfbPerGroup[(2)];
-  INT mdctSpectrum_e;
   INT ch;   /* counts through channels          */
   INT w;    /* counts through windows           */
   INT sfb;  /* counts through scalefactor bands */
   INT line; /* counts through lines             */
 
+  PSY_MAIN_FRAME frame;
+
   PSY_CONFIGURATION *RESTRICT hPsyConfLong = &psyConf[0];
   PSY_CONFIGURATION *RESTRICT hPsyConfShort = &psyConf[1];
   PSY_OUT_CHANNEL **RESTRICT psyOutChannel = psyOutElement->psyOutChannel;
@@ -425,28 +741,28 @@ AAC_ENCODER_ERROR FDKaacEnc_psyMain(INT channels, PSY_ELEMENT *psyElement,
 
   PSY_STATIC **RESTRICT psyStatic = psyElement->psyStatic;
 
-  PSY_DATA *RESTRICT psyData[(2)];
-  TNS_DATA *RESTRICT tnsData[(2)];
+  PSY_DATA **const psyData = frame.psyData;
+  TNS_DATA **const tnsData = frame.tnsData;
   PNS_DATA *RESTRICT pnsData[(2)];
 
   INT zeroSpec = TRUE; /* means all spectral lines are zero */
 
   INT blockSwitchingOffset;
 
-  PSY_CONFIGURATION *RESTRICT hThisPsyConf[(2)];
-  INT windowLength[(2)];
-  INT nWindows[(2)];
+  PSY_CONFIGURATION **const hThisPsyConf = frame.hThisPsyConf;
+  INT *const windowLength = frame.windowLength;
+  INT *const nWindows = frame.nWindows;
   INT wOffset;
 
-  INT maxSfb[(2)];
-  INT *pSfbMaxScaleSpec[(2)];
-  FIXP_DBL *pSfbEnergy[(2)];
+  INT *const maxSfb = frame.maxSfb;
+  INT **const pSfbMaxScaleSpec = frame.pSfbMaxScaleSpec;
+  FIXP_DBL **const pSfbEnergy = frame.pSfbEnergy;
   FIXP_DBL *pSfbSpreadEnergy[(2)];
-  FIXP_DBL *pSfbEnergyLdData[(2)];
+  FIXP_DBL **const pSfbEnergyLdData = frame.pSfbEnergyLdData;
   FIXP_DBL *pSfbEnergyMS[(2)];
-  FIXP_DBL *pSfbThreshold[(2)];
+  FIXP_DBL **const pSfbThreshold = frame.pSfbThreshold;
 
-  INT isShortWindow[(2)];
+  INT *const isShortWindow = frame.isShortWindow;
 
   /* number of incoming time samples to be processed */
   const INT nTimeSamples = psyConf->granuleLength;
@@ -464,6 +780,16 @@ AAC_ENCODER_ERROR FDKaacEnc_psyMain(INT channels, PSY_ELEMENT *psyElement,
       return AAC_ENC_UNSUPPORTED_FILTERBANK;
   }
 
+  frame.psyStatic = psyStatic;
+  frame.psyOutChannel = psyOutChannel;
+  frame.hPsyConfLong = hPsyConfLong;
+  frame.pInput = pInput;
+  frame.inputBufSize = inputBufSize;
+  frame.chIdx = chIdx;
+  frame.nTimeSamples = nTimeSamples;
+  frame.blockSwitchingOffset = blockSwitchingOffset;
+  frame.sfbTonality = sfbTonality;
+
   for (ch = 0; ch < channels; ch++) {
     psyData[ch] = &psyDynamic->psyData[ch];
     tnsData[ch] = &psyDynamic->tnsData[ch];
@@ -473,29 +799,12 @@ AAC_ENCODER_ERROR FDKaacEnc_psyMain(INT channels, PSY_ELEMENT *psyElement,
   }
 
   /* block switching */
-  if (hPsyConfLong->filterbank != FB_ELD) {
-    int err;
-
-    for (ch = 0; ch < channels; ch++) {
-      C_ALLOC_SCRATCH_START(pTimeSignal, INT_PCM, (1024))
-
-      /* copy input data and use for block switching */
-      FDKmemcpy(pTimeSignal, pInput + chIdx[ch] * inputBufSize,
-                nTimeSamples * sizeof(INT_PCM));
-
-      FDKaacEnc_BlockSwitching(&psyStatic[ch]->blockSwitchingControl,
-                               nTimeSamples, psyStatic[ch]->isLFE, pTimeSignal);
-
-      /* fill up internal input buffer, to 2xframelength samples */
-      FDKmemcpy(psyStatic[ch]->psyInputBuffer + blockSwitchingOffset,
-                pTimeSignal,
-                (2 * nTimeSamples - blockSwitchingOffset) * sizeof(INT_PCM));
-
-      C_ALLOC_SCRATCH_END(pTimeSignal, INT_PCM, (1024))
-    }
+  FDKaacEnc_psyRunChannels(hWorker, FDKaacEnc_psyBlockSwitchingCh, &frame,
+                           channels);
 
+  if (hPsyConfLong->filterbank != FB_ELD) {
     /* synch left and right block type */
-    err = FDKaacEnc_SyncBlockSwitching(
+    int err = FDKaacEnc_SyncBlockSwitching(
         &psyStatic[0]->blockSwitchingControl,
         (channels > 1) ? &psyStatic[1]->blockSwitchingControl : NULL, channels,
         commonWindow);
@@ -503,14 +812,6 @@ AAC_ENCODER_ERROR FDKaacEnc_psyMain(INT channels, PSY_ELEMENT *psyElement,
     if (err) {
       return AAC_ENC_UNSUPPORTED_AOT; /* mixed up LC and LD */
     }
-
-  } else {
-    for (ch = 0; ch < channels; ch++) {
-      /* copy input data and use for block switching */
-      FDKmemcpy(psyStatic[ch]->psyInputBuffer + blockSwitchingOffset,
-                pInput + chIdx[ch] * inputBufSize,
-                nTimeSamples * sizeof(INT_PCM));
-    }
   }
 
   for (ch = 0; ch < channels; ch++)
@@ -549,122 +850,35 @@ AAC_ENCODER_ERROR FDKaacEnc_psyMain(INT channels, PSY_ELEMENT *psyElement,
   }
 
   /* Transform and get mdctScaling for all channels and windows. */
+  FDKaacEnc_psyRunChannels(hWorker, FDKaacEnc_psyTransformCh, &frame,
+                           channels);
+
   for (ch = 0; ch < channels; ch++) {
-    /* update number of active bands */
-    if (psyStatic[ch]->isLFE) {
-      psyData[ch]->sfbActive = hThisPsyConf[ch]->sfbActiveLFE;
-      psyData[ch]->lowpassLine = hThisPsyConf[ch]->lowpassLineLFE;
-    } else {
-      psyData[ch]->sfbActive = hThisPsyConf[ch]->sfbActive;
-      psyData[ch]->lowpassLine = hThisPsyConf[ch]->lowpassLine;
+    if (frame.transformError[ch]) {
+      return AAC_ENC_UNSUPPORTED_FILTERBANK;
     }
-
-    if (hThisPsyConf[ch]->filterbank == FB_ELD) {
-      if (FDKaacEnc_Transform_Real_Eld(
-              psyStatic[ch]->psyInputBuffer, psyData[ch]->mdctSpectrum,
-              psyStatic[ch]->blockSwitchingControl.lastWindowSequence,
-              psyStatic[ch]->blockSwitchingControl.windowShape,
-              &psyStatic[ch]->blockSwitchingControl.lastWindowShape,
-              nTimeSamples, &mdctSpectrum_e, hThisPsyConf[ch]->filterbank,
-              psyStatic[ch]->overlapAddBuffer) != 0) {
-        return AAC_ENC_UNSUPPORTED_FILTERBANK;
-      }
-    } else {
-      if (FDKaacEnc_Transform_Real(
-              psyStatic[ch]->psyInputBuffer, psyData[ch]->mdctSpectrum,
-              psyStatic[ch]->blockSwitchingControl.lastWindowSequence,
-              psyStatic[ch]->blockSwitchingControl.windowShape,
-              &psyStatic[ch]->blockSwitchingControl.lastWindowShape,
-              &psyStatic[ch]->mdctPers, nTimeSamples, &mdctSpectrum_e,
-              hThisPsyConf[ch]->filterbank) != 0) {
-        return AAC_ENC_UNSUPPORTED_FILTERBANK;
-      }
+    if (frame.zeroSpec[ch] == FALSE) {
+      zeroSpec = FALSE;
     }
-
-    for (w = 0; w < nWindows[ch]; w++) {
-      wOffset = w * windowLength[ch];
-
-      /* Low pass / highest sfb */
-      FDKmemclear(
-          &psyData[ch]->mdctSpectrum[psyData[ch]->lowpassLine + wOffset],
-          (windowLength[ch] - psyData[ch]->lowpassLine) * sizeof(FIXP_DBL));
-
-      if ((hPsyConfLong->filterbank != FB_LC) &&
-          (psyData[ch]->lowpassLine >= FADE_OUT_LEN)) {
-        /* Do blending to reduce gibbs artifacts */
-        for (int i = 0; i < FADE_OUT_LEN; i++) {
-          psyData[ch]->mdctSpectrum[psyData[ch]->lowpassLine + wOffset -
-                                    FADE_OUT_LEN + i] =
-              fMult(psyData[ch]->mdctSpectrum[psyData[ch]->lowpassLine +
-                                              wOffset - FADE_OUT_LEN + i],
-                    fadeOutFactor[i]);
-        }
-      }
-
-      /* Check for zero spectrum. These loops will usually terminate very, very
-       * early. */
-      for (line = 0; (line < psyData[ch]->lowpassLine) && (zeroSpec == TRUE);
-           line++) {
-        if (psyData[ch]->mdctSpectrum[line + wOffset] != (FIXP_DBL)0) {
-          zeroSpec = FALSE;
-          break;
-        }
-      }
-
-    } /* w loop */
-
-    psyData[ch]->mdctScale = mdctSpectrum_e;
-
-    /* rotate internal time samples */
-    FDKmemmove(psyStatic[ch]->psyInputBuffer,
-               psyStatic[ch]->psyInputBuffer + nTimeSamples,
-               nTimeSamples * sizeof(INT_PCM));
-
-    /* ... and get remaining samples from input buffer */
-    FDKmemcpy(psyStatic[ch]->psyInputBuffer + nTimeSamples,
-              pInput + (2 * nTimeSamples - blockSwitchingOffset) +
-                  chIdx[ch] * inputBufSize,
-              (blockSwitchingOffset - nTimeSamples) * sizeof(INT_PCM));
-
-  } /* ch */
+  }
+  frame.zeroSpecAll = zeroSpec;
 
   /* Do some rescaling to get maximum possible accuracy for energies */
+  frame.finalShift = 0;
   if (zeroSpec == FALSE) {
-    /* Calc possible spectrum leftshift for each sfb (1 means: 1 bit left shift
-     * is possible without overflow) */
     INT minSpecShift = MAX_SHIFT_DBL;
     INT nrgShift = MAX_SHIFT_DBL;
     INT finalShift = MAX_SHIFT_DBL;
-    FIXP_DBL currNrg = 0;
     FIXP_DBL maxNrg = 0;
 
-    for (ch = 0; ch < channels; ch++) {
-      for (w = 0; w < nWindows[ch]; w++) {
-        wOffset = w * windowLength[ch];
-        FDKaacEnc_CalcSfbMaxScaleSpec(
-            psyData[ch]->mdctSpectrum + wOffset, hThisPsyConf[ch]->sfbOffset,
-            pSfbMaxScaleSpec[ch] + w * maxSfb[ch], psyData[ch]->sfbActive);
+    for (ch = 0; ch < channels; ch++)
+      minSpecShift = fixMin(minSpecShift, frame.minSpecShift[ch]);
+    frame.minSpecShiftAll = minSpecShift;
 
-        for (sfb = 0; sfb < psyData[ch]->sfbActive; sfb++)
-          minSpecShift = fixMin(minSpecShift,
-                                (pSfbMaxScaleSpec[ch] + w * maxSfb[ch])[sfb]);
-      }
-    }
+    FDKaacEnc_psyRunChannels(hWorker, FDKaacEnc_psyBandEnergyCh, &frame,
+                             channels);
 
-    /* Calc possible energy leftshift for each sfb (1 means: 1 bit left shift is
-     * possible without overflow) */
-    for (ch = 0; ch < channels; ch++) {
-      for (w = 0; w < nWindows[ch]; w++) {
-        wOffset = w * windowLength[ch];
-        currNrg = FDKaacEnc_CheckBandEnergyOptim(
-            psyData[ch]->mdctSpectrum + wOffset,
-            pSfbMaxScaleSpec[ch] + w * maxSfb[ch], hThisPsyConf[ch]->sfbOffset,
-            psyData[ch]->sfbActive, pSfbEnergy[ch] + w * maxSfb[ch],
-            pSfbEnergyLdData[ch] + w * maxSfb[ch], minSpecShift - 4);
-
-        maxNrg = fixMax(maxNrg, currNrg);
-      }
-    }
+    for (ch = 0; ch < channels; ch++) maxNrg = fixMax(maxNrg, frame.maxNrg[ch]);
 
     if (maxNrg != (FIXP_DBL)0) {
       nrgShift = (CountLeadingBits(maxNrg) >> 1) + (minSpecShift - 4);
@@ -686,100 +900,26 @@ AAC_ENCODER_ERROR FDKaacEnc_psyMain(INT channels, PSY_ELEMENT *psyElement,
 
     FDK_ASSERT(finalShift >= 0); /* right shift is not allowed */
 
-    /* correct sfbEnergy and sfbEnergyLdData with new finalShift */
-    FIXP_DBL ldShift = finalShift * FL2FXCONST_DBL(2.0 / 64);
-    for (ch = 0; ch < channels; ch++) {
-      INT maxSfb_ch = maxSfb[ch];
-      INT w_maxSfb_ch = 0;
-      for (w = 0; w < nWindows[ch]; w++) {
-        for (sfb = 0; sfb < psyData[ch]->sfbActive; sfb++) {
-          INT scale = fixMax(0, (pSfbMaxScaleSpec[ch] + w_maxSfb_ch)[sfb] - 4);
-          scale = fixMin((scale - finalShift) << 1, DFRACT_BITS - 1);
-          if (scale >= 0)
-            (pSfbEnergy[ch] + w_maxSfb_ch)[sfb] >>= (scale);
-          else
-            (pSfbEnergy[ch] + w_maxSfb_ch)[sfb] <<= (-scale);
-          (pSfbThreshold[ch] + w_maxSfb_ch)[sfb] =
-              fMult((pSfbEnergy[ch] + w_maxSfb_ch)[sfb], C_RATIO);
-          (pSfbEnergyLdData[ch] + w_maxSfb_ch)[sfb] += ldShift;
-        }
-        w_maxSfb_ch += maxSfb_ch;
-      }
-    }
-
-    if (finalShift != 0) {
-      for (ch = 0; ch < channels; ch++) {
-        INT wLen = windowLength[ch];
-        INT lowpassLine = psyData[ch]->lowpassLine;
-        wOffset = 0;
-        FIXP_DBL *mdctSpectrum = &psyData[ch]->mdctSpectrum[0];
-        for (w = 0; w < nWindows[ch]; w++) {
-          FIXP_DBL *spectrum = &mdctSpectrum[wOffset];
-          for (line = 0; line < lowpassLine; line++) {
-            spectrum[line] <<= finalShift;
-          }
-          wOffset += wLen;
-
-          /* update sfbMaxScaleSpec */
-          for (sfb = 0; sfb < psyData[ch]->sfbActive; sfb++)
-            (pSfbMaxScaleSpec[ch] + w * maxSfb[ch])[sfb] -= finalShift;
-        }
-        /* update mdctScale */
-        psyData[ch]->mdctScale -= finalShift;
-      }
-    }
-
-  } else {
-    /* all spectral lines are zero */
-    for (ch = 0; ch < channels; ch++) {
-      psyData[ch]->mdctScale =
-          0; /* otherwise mdctScale would be for example 7 and PCM quantization
-              * thresholds would be shifted 14 bits to the right causing some of
-              * them to become 0 (which causes problems later) */
-      /* clear sfbMaxScaleSpec */
-      for (w = 0; w < nWindows[ch]; w++) {
-        for (sfb = 0; sfb < psyData[ch]->sfbActive; sfb++) {
-          (pSfbMaxScaleSpec[ch] + w * maxSfb[ch])[sfb] = 0;
-          (pSfbEnergy[ch] + w * maxSfb[ch])[sfb] = (FIXP_DBL)0;
-          (pSfbEnergyLdData[ch] + w * maxSfb[ch])[sfb] = FL2FXCONST_DBL(-1.0f);
-          (pSfbThreshold[ch] + w * maxSfb[ch])[sfb] = (FIXP_DBL)0;
-        }
-      }
-    }
+    frame.finalShift = finalShift;
   }
 
   /* Advance psychoacoustics: Tonality and TNS */
-  if ((channels >= 1) && (psyStatic[0]->isLFE)) {
+  frame.calcTonality = !((channels >= 1) && (psyStatic[0]->isLFE));
+  frame.tnsDetect =
+      hPsyConfLong->tnsConf.tnsActive || hPsyConfShort->tnsConf.tnsActive;
+
+  FDKaacEnc_psyRunChannels(hWorker, FDKaacEnc_psyTonalityCh, &frame,
+                           channels);
+
+  if (!frame.calcTonality) {
     tnsData[0]->dataRaw.Long.subBlockInfo.tnsActive[HIFILT] = 0;
     tnsData[0]->dataRaw.Long.subBlockInfo.tnsActive[LOFILT] = 0;
   } else {
-    for (ch = 0; ch < channels; ch++) {
-      if (!isShortWindow[ch]) {
-        /* tonality */
-        FDKaacEnc_CalculateFullTonality(
-            psyData[ch]->mdctSpectrum, pSfbMaxScaleSpec[ch],
-            pSfbEnergyLdData[ch], sfbTonality[ch], psyData[ch]->sfbActive,
-            hThisPsyConf[ch]->sfbOffset, hThisPsyConf[ch]->pnsConf.usePns);
-      }
-    } /* ch */
-
-    if (hPsyConfLong->tnsConf.tnsActive || hPsyConfShort->tnsConf.tnsActive) {
+    if (frame.tnsDetect) {
       INT tnsActive[TRANS_FAC] = {0};
       INT nrgScaling[2] = {0, 0};
       INT tnsSpecShift = 0;
 
-      for (ch = 0; ch < channels; ch++) {
-        for (w = 0; w < nWindows[ch]; w++) {
-          wOffset = w * windowLength[ch];
-          /* TNS */
-          FDKaacEnc_TnsDetect(
-              tnsData[ch], &hThisPsyConf[ch]->tnsConf,
-              &psyOutChannel[ch]->tnsInfo, hThisPsyConf[ch]->sfbCnt,
-              psyData[ch]->mdctSpectrum + wOffset, w,
-              psyStatic[ch]->blockSwitchingControl.lastWindowSequence);
-        }
-      }
-
       if (channels == 2) {
         FDKaacEnc_TnsSync(
             tnsData[1], tnsData[0], &psyOutChannel[1]->tnsInfo,
@@ -1304,6 +1444,8 @@ void FDKaacEnc_PsyClose(PSY_INTERNAL **phPsyInternal, PSY_OUT **phPsyOut) {
     PSY_INTERNAL *hPsyInternal = *phPsyInternal;
 
     if (hPsyInternal) {
+      FDKaacEnc_PsyWorkerClose(&hPsyInternal->hWorker);
+
       for (i = 0; i < (8); i++) {
         if (hPsyInternal->pStaticChannels[i]) {
           if (hPsyInternal->pStaticChannels[i]->psyInputBuffer)
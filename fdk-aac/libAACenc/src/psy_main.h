@@ -106,6 +106,7 @@ amm-info@iis.fraunhofer.de
 #include "psy_configuration.h"
 #include "qc_data.h"
 #include "aacenc_pns.h"
+#include "psy_worker.h"
 
 /*
   psych internal
@@ -128,6 +129,8 @@ typedef struct {
   PSY_STATIC *pStaticChannels[(8)];
   PSY_DYNAMIC *psyDynamic;
   INT granuleLength;
+  HANDLE_PSY_WORKER hWorker; /* processes the second channel of a pair, or
+                                NULL */
 
 } PSY_INTERNAL;
 
@@ -147,14 +150,16 @@ AAC_ENCODER_ERROR FDKaacEnc_psyInit(PSY_INTERNAL *hPsy, PSY_OUT **phpsyOut,
 AAC_ENCODER_ERROR FDKaacEnc_psyMainInit(
     PSY_INTERNAL *hPsy, AUDIO_OBJECT_TYPE audioObjectType, CHANNEL_MAPPING *cm,
     INT sampleRate, INT granuleLength, INT bitRate, INT tnsMask, INT bandwidth,
-    INT usePns, INT useIS, INT useMS, UINT syntaxFlags, ULONG initFlags);
+    INT usePns, INT useIS, INT useMS, INT complexity, UINT syntaxFlags,
+    ULONG initFlags);
 
 AAC_ENCODER_ERROR FDKaacEnc_psyMain(INT channels, PSY_ELEMENT *psyElement,
                                     PSY_DYNAMIC *psyDynamic,
                                     PSY_CONFIGURATION *psyConf,
                                     PSY_OUT_ELEMENT *psyOutElement,
                                     INT_PCM *pInput, const UINT inputBufSize,
-                                    INT *chIdx, INT totalChannels);
+                                    INT *chIdx, INT totalChannels,
+                                    HANDLE_PSY_WORKER hWorker);
 
 void FDKaacEnc_PsyClose(PSY_INTERNAL **phPsyInternal, PSY_OUT **phPsyOut);
 
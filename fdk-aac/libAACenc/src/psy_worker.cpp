@@ -0,0 +1,252 @@
+/* -----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK AAC Codec Library for Android
+
+© Copyright  1995 - 2018 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. All rights reserved.
+
+ 1.    INTRODUCTION
+The Fraunhofer FDK AAC Codec Library for Android ("FDK AAC Codec") is software
+that implements the MPEG Advanced Audio Coding ("AAC") encoding and decoding
+scheme for digital audio. This FDK AAC Codec software is intended to be used on
+a wide variety of Android devices.
+
+AAC's HE-AAC and HE-AAC v2 versions are regarded as today's most efficient
+general perceptual audio codecs. AAC-ELD is considered the best-performing
+full-bandwidth communications codec by independent studies and is widely
+deployed. AAC has been standardized by ISO and IEC as part of the MPEG
+specifications.
+
+Patent licenses for necessary patent claims for the FDK AAC Codec (including
+those of Fraunhofer) may be obtained through Via Licensing
+(www.vialicensing.com) or through the respective patent owners individually for
+the purpose of encoding or decoding bit streams in products that are compliant
+with the ISO/IEC MPEG audio standards. Please note that most manufacturers of
+Android devices already license these patent claims through Via Licensing or
+directly from the patent owners, and therefore FDK AAC Codec software may
+already be covered under those patent licenses when it is used for those
+licensed purposes only.
+
+Commercially-licensed AAC software libraries, including floating-point versions
+with enhanced sound quality, are also available from Fraunhofer. Users are
+encouraged to check the Fraunhofer website for additional applications
+information and documentation.
+
+2.    COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+You must retain the complete text of this software license in redistributions of
+the FDK AAC Codec or your modifications thereto in source code form.
+
+You must retain the complete text of this software license in the documentation
+and/or other materials provided with redistributions of the FDK AAC Codec or
+your modifications thereto in binary form. You must make available free of
+charge copies of the complete source code of the FDK AAC Codec and your
+modifications thereto to recipients of copies in binary form.
+
+The name of Fraunhofer may not be used to endorse or promote products derived
+from this library without prior written permission.
+
+You may not charge copyright license fees for anyone to use, copy or distribute
+the FDK AAC Codec software or your modifications thereto.
+
+Your modified versions of the FDK AAC Codec must carry prominent notices stating
+that you changed the software and the date of any change. For modified versions
+of the FDK AAC Codec, the term "Fraunhofer FDK AAC Codec Library for Android"
+must be replaced by the term "Third-Party Modified Version of the Fraunhofer FDK
+AAC Codec Library for Android."
+
+3.    NO PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software.
+
+You may use this FDK AAC Codec software or modifications thereto only for
+purposes that are authorized by appropriate patent licenses.
+
+4.    DISCLAIMER
+
+This FDK AAC Codec software is provided by Fraunhofer on behalf of the copyright
+holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED WARRANTIES,
+including but not limited to the implied warranties of merchantability and
+fitness for a particular purpose. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+CONTRIBUTORS BE LIABLE for any direct, indirect, incidental, special, exemplary,
+or consequential damages, including but not limited to procurement of substitute
+goods or services; loss of use, data, or profits, or business interruption,
+however caused and on any theory of liability, whether in contract, strict
+liability, or tort (including negligence), arising in any way out of the use of
+this software, even if advised of the possibility of such damage.
+
+5.    CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Audio and Multimedia Departments - FDK AAC LL
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+----------------------------------------------------------------------------- */
+
+/**************************** AAC encoder library ******************************
+
+   Description: Helper thread for the per-channel psychoacoustic stages of a
+                channel pair
+
+*******************************************************************************/
+
+#include "psy_worker.h"
+
+#include "genericStds.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+/* A frame calls the worker several times in short succession. Both threads
+   poll for a while before they block, so that the helper does not have to be
+   woken up by the kernel for every stage. */
+#define PSY_WORKER_SPIN 4000
+
+struct PSY_WORKER {
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t jobCond;  /* a job was posted or the worker is closed */
+  pthread_cond_t doneCond; /* the helper finished its job */
+
+  PSY_WORKER_FN fn;
+  void *arg;
+  UINT jobCount;  /* number of jobs posted, written by the caller */
+  UINT doneCount; /* number of jobs finished, written by the helper */
+  INT quit;
+};
+
+static inline void FDKaacEnc_PsyWorkerPause(void) {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  __builtin_ia32_pause();
+#endif
+}
+
+static void *FDKaacEnc_PsyWorkerThread(void *p) {
+  HANDLE_PSY_WORKER hWorker = (HANDLE_PSY_WORKER)p;
+  UINT seen = 0;
+
+  for (;;) {
+    INT spin;
+    for (spin = 0; spin < PSY_WORKER_SPIN; spin++) {
+      if (__atomic_load_n(&hWorker->jobCount, __ATOMIC_ACQUIRE) != seen) break;
+      FDKaacEnc_PsyWorkerPause();
+    }
+
+    pthread_mutex_lock(&hWorker->mutex);
+    while ((__atomic_load_n(&hWorker->jobCount, __ATOMIC_ACQUIRE) == seen) &&
+           !hWorker->quit) {
+      pthread_cond_wait(&hWorker->jobCond, &hWorker->mutex);
+    }
+    if (hWorker->quit) {
+      pthread_mutex_unlock(&hWorker->mutex);
+      break;
+    }
+    pthread_mutex_unlock(&hWorker->mutex);
+
+    seen++;
+    hWorker->fn(hWorker->arg, 1);
+
+    pthread_mutex_lock(&hWorker->mutex);
+    __atomic_store_n(&hWorker->doneCount, seen, __ATOMIC_RELEASE);
+    pthread_cond_signal(&hWorker->doneCond);
+    pthread_mutex_unlock(&hWorker->mutex);
+  }
+
+  return NULL;
+}
+
+AAC_ENCODER_ERROR FDKaacEnc_PsyWorkerOpen(HANDLE_PSY_WORKER *phWorker) {
+  HANDLE_PSY_WORKER hWorker;
+
+  *phWorker = NULL;
+
+  /* Both threads would compete for the only processor */
+  if (sysconf(_SC_NPROCESSORS_ONLN) < 2) {
+    return AAC_ENC_OK;
+  }
+
+  hWorker = (HANDLE_PSY_WORKER)FDKcalloc(1, sizeof(struct PSY_WORKER));
+  if (hWorker == NULL) {
+    return AAC_ENC_NO_MEMORY;
+  }
+
+  pthread_mutex_init(&hWorker->mutex, NULL);
+  pthread_cond_init(&hWorker->jobCond, NULL);
+  pthread_cond_init(&hWorker->doneCond, NULL);
+
+  if (pthread_create(&hWorker->thread, NULL, FDKaacEnc_PsyWorkerThread,
+                     hWorker) != 0) {
+    pthread_cond_destroy(&hWorker->doneCond);
+    pthread_cond_destroy(&hWorker->jobCond);
+    pthread_mutex_destroy(&hWorker->mutex);
+    FDKfree(hWorker);
+    return AAC_ENC_NO_MEMORY;
+  }
+
+  *phWorker = hWorker;
+  return AAC_ENC_OK;
+}
+
+void FDKaacEnc_PsyWorkerRun(HANDLE_PSY_WORKER hWorker, PSY_WORKER_FN fn,
+                            void *arg) {
+  UINT job;
+  INT spin;
+
+  if (hWorker == NULL) {
+    fn(arg, 0);
+    fn(arg, 1);
+    return;
+  }
+
+  pthread_mutex_lock(&hWorker->mutex);
+  hWorker->fn = fn;
+  hWorker->arg = arg;
+  job = hWorker->jobCount + 1;
+  __atomic_store_n(&hWorker->jobCount, job, __ATOMIC_RELEASE);
+  pthread_cond_signal(&hWorker->jobCond);
+  pthread_mutex_unlock(&hWorker->mutex);
+
+  fn(arg, 0);
+
+  for (spin = 0; spin < PSY_WORKER_SPIN; spin++) {
+    if (__atomic_load_n(&hWorker->doneCount, __ATOMIC_ACQUIRE) == job) return;
+    FDKaacEnc_PsyWorkerPause();
+  }
+
+  pthread_mutex_lock(&hWorker->mutex);
+  while (__atomic_load_n(&hWorker->doneCount, __ATOMIC_ACQUIRE) != job) {
+    pthread_cond_wait(&hWorker->doneCond, &hWorker->mutex);
+  }
+  pthread_mutex_unlock(&hWorker->mutex);
+}
+
+void FDKaacEnc_PsyWorkerClose(HANDLE_PSY_WORKER *phWorker) {
+  HANDLE_PSY_WORKER hWorker = *phWorker;
+
+  if (hWorker == NULL) {
+    return;
+  }
+
+  pthread_mutex_lock(&hWorker->mutex);
+  hWorker->quit = 1;
+  pthread_cond_signal(&hWorker->jobCond);
+  pthread_mutex_unlock(&hWorker->mutex);
+
+  pthread_join(hWorker->thread, NULL);
+
+  pthread_cond_destroy(&hWorker->doneCond);
+  pthread_cond_destroy(&hWorker->jobCond);
+  pthread_mutex_destroy(&hWorker->mutex);
+  FDKfree(hWorker);
+
+  *phWorker = NULL;
+}
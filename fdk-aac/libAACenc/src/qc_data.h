@@ -158,7 +158,10 @@ struct QC_INIT {
   QCDATA_BR_MODE bitrateMode;
   INT meanPe;
   INT chBitrate; /* Bitrate/channel */
-  INT invQuant;
+  INT invQuant; /* afterburner: 0 off, 1 single band refinement, 2 and 3 add
+                   multiple band assimilation passes */
+  INT useScfCache; /* start the afterburner from the previous frame */
+  INT complexity;  /* reduction of the encoder complexity, 0 (full) to 3 */
   INT maxIterations; /* Maximum number of allowed iterations before
                         FDKaacEnc_crashRecovery() is applied. */
   FIXP_DBL maxBitFac;
@@ -267,6 +270,17 @@ typedef struct {
   FIXP_DBL relativeBitsEl; /* Bits relative to total Bits*/
 } ELEMENT_BITS;
 
+/* Result of the afterburner for one channel, kept for the next frame */
+typedef struct {
+  INT valid; /* previous frame was a long block */
+  INT sfbCnt;
+  FIXP_DBL pe; /* estimated perceptual entropy of the scalefactors */
+  INT scfEstimated[MAX_GROUPED_SFB]; /* derived from the threshold */
+  INT scf[MAX_GROUPED_SFB];          /* after analysis by synthesis, before
+                                        the assimilation */
+  FIXP_DBL sfbFormFactorLdData[MAX_GROUPED_SFB];
+} SCF_CACHE;
+
 typedef struct {
   /* this is basically struct QC_INIT */
 
@@ -294,6 +308,9 @@ typedef struct {
 
   INT dZoneQuantEnable; /* enable dead zone quantizer */
 
+  INT useScfCache; /* start the afterburner from the previous frame */
+  SCF_CACHE scfCache[(8)];
+
 } QC_STATE;
 
 #endif /* QC_DATA_H */
@@ -373,6 +373,12 @@ AAC_ENCODER_ERROR FDKaacEnc_QCInit(QC_STATE* hQC, struct QC_INIT* init,
   hQC->invQuant = init->invQuant;
   hQC->maxIterations = init->maxIterations;
 
+  /* the scalefactors of the previous frame are only used by the afterburner */
+  hQC->useScfCache = (init->invQuant > 0) ? init->useScfCache : 0;
+  for (i = 0; i < (8); i++) {
+    hQC->scfCache[i].valid = 0;
+  }
+
   /* 0: full bitreservoir, 1: reduced bitreservoir, 2: disabled bitreservoir */
   hQC->bitResMode = init->bitResMode;
 
@@ -411,7 +417,8 @@ AAC_ENCODER_ERROR FDKaacEnc_QCInit(QC_STATE* hQC, struct QC_INIT* init,
   }
 
   FDKaacEnc_AdjThrInit(
-      hQC->hAdjThr, init->meanPe, hQC->invQuant, init->channelMapping,
+      hQC->hAdjThr, init->meanPe, hQC->invQuant, init->complexity,
+      init->channelMapping,
       init->sampleRate, /* output sample rate */
       init->bitrate,    /* total bitrate */
       init->isLowDelay, /* if set, calc bits2PE factor
@@ -866,12 +873,20 @@ AAC_ENCODER_ERROR FDKaacEnc_QCMain(QC_STATE* RESTRICT hQC, PSY_OUT** psyOut,
 
       if ((elInfo.elType == ID_SCE) || (elInfo.elType == ID_CPE) ||
           (elInfo.elType == ID_LFE)) {
+        SCF_CACHE* scfCache[(2)] = {NULL, NULL};
+
+        if (hQC->useScfCache) {
+          for (ch = 0; ch < nChannels; ch++) {
+            scfCache[ch] = &hQC->scfCache[elInfo.ChannelIndex[ch]];
+          }
+        }
+
         /* Turn thresholds into scalefactors, optimize bit consumption and
          * verify conformance */
         FDKaacEnc_EstimateScaleFactors(
             psyOut[c]->psyOutElement[i]->psyOutChannel,
-            qcElement[c][i]->qcOutChannel, hQC->invQuant, hQC->dZoneQuantEnable,
-            cm->elInfo[i].nChannelsInEl);
+            qcElement[c][i]->qcOutChannel, scfCache, hQC->invQuant,
+            hQC->dZoneQuantEnable, cm->elInfo[i].nChannelsInEl);
 
         /*-------------------------------------------- */
         constraintsFulfilled[c][i] = 1;
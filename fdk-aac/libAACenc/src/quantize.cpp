@@ -266,6 +266,36 @@ static void FDKaacEnc_invQuantizeLines(INT gain, INT noOfLines,
   }
 }
 
+/* Versions for whole bands, that give the same results as the functions
+   above */
+#if defined(__x86__) && defined(__GNUC__) && defined(ARCH_PREFER_MULT_32x16)
+#include "x86/quantize_x86.cpp"
+#endif
+
+#if !defined(FUNCTION_FDKaacEnc_quantizeBand)
+#define FDKaacEnc_quantizeBand FDKaacEnc_quantizeLines
+
+static const QUANTIZE_BAND_KERNEL FDKaacEnc_quantizeBandKernels[1] = {
+    {"scalar", FDKaacEnc_quantizeLines}};
+static const INT FDKaacEnc_numQuantizeBandKernels = 1;
+#endif
+
+INT FDKaacEnc_getQuantizeBandKernels(const QUANTIZE_BAND_KERNEL **kernels) {
+  *kernels = FDKaacEnc_quantizeBandKernels;
+  return FDKaacEnc_numQuantizeBandKernels;
+}
+
+void FDKaacEnc_setQuantizeBandKernel(INT kernel) {
+  FDK_ASSERT(kernel >= 0 && kernel < FDKaacEnc_numQuantizeBandKernels);
+#if defined(FUNCTION_FDKaacEnc_quantizeBand)
+  FDKaacEnc_quantizeBandFn = FDKaacEnc_quantizeBandKernels[kernel].quantizeBand;
+#endif
+}
+
+/* Number of lines calcSfbDist() and calcSfbQuantEnergyAndDist() process at
+   once */
+#define QUANTIZE_BLOCK_LINES 64
+
 /*****************************************************************************
 
     functionname: FDKaacEnc_QuantizeSpectrum
@@ -292,7 +322,7 @@ void FDKaacEnc_QuantizeSpectrum(INT sfbCnt, INT maxSfbPerGroup, INT sfbPerGroup,
     for (sfb = 0; sfb < maxSfbPerGroup; sfb++) {
       INT scalefactor = scalefactors[sfbOffs + sfb];
 
-      FDKaacEnc_quantizeLines(
+      FDKaacEnc_quantizeBand(
           globalGain - scalefactor, /* QSS */
           sfbOffset[sfbOffs + sfb + 1] - sfbOffset[sfbOffs + sfb],
           mdctSpectrum + sfbOffset[sfbOffs + sfb],
@@ -312,35 +342,46 @@ void FDKaacEnc_QuantizeSpectrum(INT sfbCnt, INT maxSfbPerGroup, INT sfbPerGroup,
 FIXP_DBL FDKaacEnc_calcSfbDist(const FIXP_DBL *mdctSpectrum,
                                SHORT *quantSpectrum, INT noOfLines, INT gain,
                                INT dZoneQuantEnable) {
-  INT i, scale;
+  INT i, j, n, scale;
   FIXP_DBL xfsf;
   FIXP_DBL diff;
-  FIXP_DBL invQuantSpec;
+  SHORT quantSpec[QUANTIZE_BLOCK_LINES];
+  FIXP_DBL invQuantSpec[QUANTIZE_BLOCK_LINES];
 
   xfsf = FL2FXCONST_DBL(0.0f);
 
-  for (i = 0; i < noOfLines; i++) {
-    /* quantization */
-    FDKaacEnc_quantizeLines(gain, 1, &mdctSpectrum[i], &quantSpectrum[i],
-                            dZoneQuantEnable);
+  for (i = 0; i < noOfLines; i += n) {
+    n = fixMin(noOfLines - i, QUANTIZE_BLOCK_LINES);
 
-    if (fAbs(quantSpectrum[i]) > MAX_QUANT) {
-      return FL2FXCONST_DBL(0.0f);
+    /* quantization */
+    FDKaacEnc_quantizeBand(gain, n, &mdctSpectrum[i], quantSpec,
+                           dZoneQuantEnable);
+
+    /* the lines after the first violation are left untouched */
+    for (j = 0; j < n; j++) {
+      quantSpectrum[i + j] = quantSpec[j];
+      if (fAbs(quantSpec[j]) > MAX_QUANT) {
+        return FL2FXCONST_DBL(0.0f);
+      }
     }
+
     /* inverse quantization */
-    FDKaacEnc_invQuantizeLines(gain, 1, &quantSpectrum[i], &invQuantSpec);
+    FDKaacEnc_invQuantizeLines(gain, n, quantSpec, invQuantSpec);
 
-    /* dist */
-    diff = fixp_abs(fixp_abs(invQuantSpec) - fixp_abs(mdctSpectrum[i] >> 1));
+    for (j = 0; j < n; j++) {
+      /* dist */
+      diff = fixp_abs(fixp_abs(invQuantSpec[j]) -
+                      fixp_abs(mdctSpectrum[i + j] >> 1));
 
-    scale = CountLeadingBits(diff);
-    diff = scaleValue(diff, scale);
-    diff = fPow2(diff);
-    scale = fixMin(2 * (scale - 1), DFRACT_BITS - 1);
+      scale = CountLeadingBits(diff);
+      diff = scaleValue(diff, scale);
+      diff = fPow2(diff);
+      scale = fixMin(2 * (scale - 1), DFRACT_BITS - 1);
 
-    diff = scaleValue(diff, -scale);
+      diff = scaleValue(diff, -scale);
 
-    xfsf = xfsf + diff;
+      xfsf = xfsf + diff;
+    }
   }
 
   xfsf = CalcLdData(xfsf);
@@ -362,8 +403,8 @@ void FDKaacEnc_calcSfbQuantEnergyAndDist(FIXP_DBL *mdctSpectrum,
                                          SHORT *quantSpectrum, INT noOfLines,
                                          INT gain, FIXP_DBL *en,
                                          FIXP_DBL *dist) {
-  INT i, scale;
-  FIXP_DBL invQuantSpec;
+  INT i, j, n, scale;
+  FIXP_DBL invQuantSpec[QUANTIZE_BLOCK_LINES];
   FIXP_DBL diff;
 
   FIXP_DBL energy = FL2FXCONST_DBL(0.0f);
@@ -375,25 +416,32 @@ void FDKaacEnc_calcSfbQuantEnergyAndDist(FIXP_DBL *mdctSpectrum,
       *dist = FL2FXCONST_DBL(0.0f);
       return;
     }
+  }
+
+  for (i = 0; i < noOfLines; i += n) {
+    n = fixMin(noOfLines - i, QUANTIZE_BLOCK_LINES);
 
     /* inverse quantization */
-    FDKaacEnc_invQuantizeLines(gain, 1, &quantSpectrum[i], &invQuantSpec);
+    FDKaacEnc_invQuantizeLines(gain, n, &quantSpectrum[i], invQuantSpec);
 
-    /* energy */
-    energy += fPow2(invQuantSpec);
+    for (j = 0; j < n; j++) {
+      /* energy */
+      energy += fPow2(invQuantSpec[j]);
 
-    /* dist */
-    diff = fixp_abs(fixp_abs(invQuantSpec) - fixp_abs(mdctSpectrum[i] >> 1));
+      /* dist */
+      diff = fixp_abs(fixp_abs(invQuantSpec[j]) -
+                      fixp_abs(mdctSpectrum[i + j] >> 1));
 
-    scale = CountLeadingBits(diff);
-    diff = scaleValue(diff, scale);
-    diff = fPow2(diff);
+      scale = CountLeadingBits(diff);
+      diff = scaleValue(diff, scale);
+      diff = fPow2(diff);
 
-    scale = fixMin(2 * (scale - 1), DFRACT_BITS - 1);
+      scale = fixMin(2 * (scale - 1), DFRACT_BITS - 1);
 
-    diff = scaleValue(diff, -scale);
+      diff = scaleValue(diff, -scale);
 
-    distortion += diff;
+      distortion += diff;
+    }
   }
 
   *en = CalcLdData(energy) + FL2FXCONST_DBL(0.03125f);
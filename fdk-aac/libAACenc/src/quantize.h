@@ -124,4 +124,23 @@ void FDKaacEnc_calcSfbQuantEnergyAndDist(FIXP_DBL *mdctSpectrum,
                                          INT gain, FIXP_DBL *en,
                                          FIXP_DBL *dist);
 
+/* band quantizers, for tests and benchmarks */
+
+typedef void (*QUANTIZE_BAND_FN)(INT gain, INT noOfLines,
+                                 const FIXP_DBL *mdctSpectrum,
+                                 SHORT *quaSpectrum, INT dZoneQuantEnable);
+
+typedef struct {
+  const char *name;
+  QUANTIZE_BAND_FN quantizeBand;
+} QUANTIZE_BAND_KERNEL;
+
+/* The versions of the quantizer the CPU supports, all with the results of
+   the scalar one, which comes first. The encoder uses the last one. Returns
+   their number. */
+INT FDKaacEnc_getQuantizeBandKernels(const QUANTIZE_BAND_KERNEL **kernels);
+
+/* Makes the encoder use kernels[kernel] */
+void FDKaacEnc_setQuantizeBandKernel(INT kernel);
+
 #endif /* QUANTIZE_H */
@@ -114,6 +114,16 @@ amm-info@iis.fraunhofer.de
 #define AS_PE_FAC_FLOAT (float)(1 << AS_PE_FAC_SHIFT)
 static const INT MAX_SCF_DELTA = 60;
 
+/* Largest change of the estimated scalefactor of a band which still allows to
+   take over the refinement of the previous frame */
+static const INT SCF_CACHE_MAX_SHIFT = 2;
+/* Largest change of the form factor of a band which still allows to take over
+   the refinement of the previous frame, ld64(2.0) */
+static const FIXP_DBL SCF_CACHE_FORM_FACTOR_TOL = FL2FXCONST_DBL(0.015625f);
+/* Largest relative change of the perceptual entropy of a channel for which the
+   assimilation of the previous frame is kept */
+static const FIXP_DBL SCF_CACHE_PE_TOL = FL2FXCONST_DBL(0.1f);
+
 static const FIXP_DBL PE_C1 = FL2FXCONST_DBL(
     3.0f / AS_PE_FAC_FLOAT); /* (log(8.0)/log(2)) >> AS_PE_FAC_SHIFT */
 static const FIXP_DBL PE_C2 = FL2FXCONST_DBL(
@@ -451,6 +461,75 @@ static INT FDKaacEnc_improveScf(const FIXP_DBL *spec, SHORT *quantSpec,
   return scfBest;
 }
 
+/*
+  Function: FDKaacEnc_reuseCachedScf
+
+  Description: Take over the scalefactor of the previous frame for a band whose
+  estimated scalefactor and form factor did not change. It is kept if it
+  reaches the noise to mask ratio FDKaacEnc_improveScf() aims at, otherwise
+  the band has to be searched again.
+*/
+static INT FDKaacEnc_reuseCachedScf(const SCF_CACHE *scfCache, INT sfb,
+                                    const FIXP_DBL *spec, SHORT *quantSpec,
+                                    INT sfbWidth, FIXP_DBL threshLdData,
+                                    INT scfEstimated, INT minScf,
+                                    FIXP_DBL formFactorLdData, INT *scf,
+                                    FIXP_DBL *distLdData,
+                                    INT *minScfCalculated,
+                                    INT dZoneQuantEnable) {
+  FIXP_DBL sfbDistLdData;
+  FIXP_DBL distFactorLdData = FL2FXCONST_DBL(-0.0050301265); /* ld64(1/1.25) */
+  INT scfCached;
+
+  if ((scfCache->scf[sfb] == FDK_INT_MIN) ||
+      (fixp_abs(scfEstimated - scfCache->scfEstimated[sfb]) >
+       SCF_CACHE_MAX_SHIFT) ||
+      (fixp_abs(formFactorLdData - scfCache->sfbFormFactorLdData[sfb]) >
+       SCF_CACHE_FORM_FACTOR_TOL)) {
+    return 0;
+  }
+
+  /* apply the refinement of the previous frame to the new estimate */
+  scfCached = scfEstimated + scfCache->scf[sfb] - scfCache->scfEstimated[sfb];
+  if (scfCached < minScf) {
+    return 0;
+  }
+
+  sfbDistLdData = FDKaacEnc_calcSfbDist(spec, quantSpec, sfbWidth, scfCached,
+                                        dZoneQuantEnable);
+  if (sfbDistLdData > (threshLdData - distFactorLdData)) {
+    return 0;
+  }
+
+  *scf = scfCached;
+  *distLdData = sfbDistLdData;
+  *minScfCalculated = scfCached;
+
+  return 1;
+}
+
+/*
+  Function: FDKaacEnc_regionCached
+
+  Description: Check if all relevant bands of a region took over their
+  scalefactor from the previous frame. These were assimilated already.
+*/
+static INT FDKaacEnc_regionCached(const UCHAR *sfbCached, const INT *scf,
+                                  INT startSfb, INT stopSfb) {
+  INT sfb;
+
+  if (sfbCached == NULL) {
+    return 0;
+  }
+  for (sfb = startSfb; sfb < stopSfb; sfb++) {
+    if ((scf[sfb] != FDK_INT_MIN) && !sfbCached[sfb]) {
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
 /*
   Function: FDKaacEnc_assimilateSingleScf
 
@@ -460,7 +539,7 @@ static void FDKaacEnc_assimilateSingleScf(
     SHORT *quantSpec, SHORT *quantSpecTmp, INT dZoneQuantEnable, INT *scf,
     const INT *minScf, FIXP_DBL *sfbDist, FIXP_DBL *sfbConstPePart,
     const FIXP_DBL *sfbFormFactorLdData, const FIXP_DBL *sfbNRelevantLines,
-    INT *minScfCalculated, INT restartOnSuccess) {
+    INT *minScfCalculated, const UCHAR *sfbCached, INT restartOnSuccess) {
   INT sfbLast, sfbAct, sfbNext;
   INT scfAct, *scfLast, *scfNext, scfMin, scfMax;
   INT sfbWidth, sfbOffs;
@@ -520,6 +599,7 @@ static void FDKaacEnc_assimilateSingleScf(
     if (sfbAct >= 0) scfMin = fixMax(scfMin, minScf[sfbAct]);
 
     if ((sfbAct >= 0) && (sfbLast >= 0 || sfbNext < psyOutChan->sfbCnt) &&
+        !FDKaacEnc_regionCached(sfbCached, scf, sfbAct, sfbAct + 1) &&
         (scfAct > scfMin) && (scfAct <= scfMin + MAX_SCF_DELTA) &&
         (scfAct >= scfMax - MAX_SCF_DELTA) &&
         (scfAct <=
@@ -630,7 +710,7 @@ static void FDKaacEnc_assimilateMultipleScf(
     PSY_OUT_CHANNEL *psyOutChan, QC_OUT_CHANNEL *qcOutChannel, SHORT *quantSpec,
     SHORT *quantSpecTmp, INT dZoneQuantEnable, INT *scf, const INT *minScf,
     FIXP_DBL *sfbDist, FIXP_DBL *sfbConstPePart, FIXP_DBL *sfbFormFactorLdData,
-    FIXP_DBL *sfbNRelevantLines) {
+    FIXP_DBL *sfbNRelevantLines, const UCHAR *sfbCached) {
   INT sfb, startSfb, stopSfb;
   INT scfTmp[MAX_GROUPED_SFB], scfMin, scfMax, scfAct;
   INT possibleRegionFound;
@@ -673,7 +753,8 @@ static void FDKaacEnc_assimilateMultipleScf(
 
         /* check if in all sfb of a valid region scfAct >= minScf[sfb] */
         possibleRegionFound = 0;
-        if (startSfb < sfbCnt) {
+        if (startSfb < sfbCnt &&
+            !FDKaacEnc_regionCached(sfbCached, scf, startSfb, stopSfb)) {
           possibleRegionFound = 1;
           for (sfb = startSfb; sfb < stopSfb; sfb++) {
             if (scf[sfb] != FDK_INT_MIN)
@@ -759,7 +840,7 @@ static void FDKaacEnc_FDKaacEnc_assimilateMultipleScf2(
     PSY_OUT_CHANNEL *psyOutChan, QC_OUT_CHANNEL *qcOutChannel, SHORT *quantSpec,
     SHORT *quantSpecTmp, INT dZoneQuantEnable, INT *scf, const INT *minScf,
     FIXP_DBL *sfbDist, FIXP_DBL *sfbConstPePart, FIXP_DBL *sfbFormFactorLdData,
-    FIXP_DBL *sfbNRelevantLines) {
+    FIXP_DBL *sfbNRelevantLines, const UCHAR *sfbCached) {
   INT sfb, startSfb, stopSfb;
   INT scfTmp[MAX_GROUPED_SFB], scfAct, scfNew;
   INT scfPrev, scfNext, scfPrevNextMin, scfPrevNextMax, scfLo, scfHi;
@@ -821,8 +902,9 @@ static void FDKaacEnc_FDKaacEnc_assimilateMultipleScf2(
     else
       scfLo = scfPrevNextMax;
 
-    if (startSfb < sfbCnt &&
-        scfHi - scfLo <= MAX_SCF_DELTA) { /* region found */
+    if (startSfb < sfbCnt && scfHi - scfLo <= MAX_SCF_DELTA &&
+        !FDKaacEnc_regionCached(sfbCached, scf, startSfb,
+                                stopSfb)) { /* region found */
       /* 1. try to save bits by coarser quantization */
       if (scfHi > scf[startSfb]) {
         /* calculate the allowed distortion */
@@ -1045,7 +1127,7 @@ static void FDKaacEnc_FDKaacEnc_assimilateMultipleScf2(
 
 static void FDKaacEnc_EstimateScaleFactorsChannel(
     QC_OUT_CHANNEL *qcOutChannel, PSY_OUT_CHANNEL *psyOutChannel,
-    INT *RESTRICT scf, INT *RESTRICT globalGain,
+    SCF_CACHE *scfCache, INT *RESTRICT scf, INT *RESTRICT globalGain,
     FIXP_DBL *RESTRICT sfbFormFactorLdData, const INT invQuant,
     SHORT *RESTRICT quantSpec, const INT dZoneQuantEnable) {
   INT i, j, sfb, sfbOffs;
@@ -1062,6 +1144,16 @@ static void FDKaacEnc_EstimateScaleFactorsChannel(
   FIXP_DBL sfbDistLdData[MAX_GROUPED_SFB];
   C_ALLOC_SCRATCH_START(quantSpecTmp, SHORT, (1024))
   INT minSfMaxQuant[MAX_GROUPED_SFB];
+  INT scfEstimated[MAX_GROUPED_SFB];
+  INT scfImproved[MAX_GROUPED_SFB];
+  UCHAR sfbCached[MAX_GROUPED_SFB];
+  const UCHAR *sfbAssimilated = NULL;
+  FIXP_DBL pe = FL2FXCONST_DBL(0.0f);
+
+  /* the previous frame can only be taken over between long blocks */
+  const INT useCache = (scfCache != NULL) && scfCache->valid &&
+                       (psyOutChannel->lastWindowSequence != SHORT_WINDOW) &&
+                       (scfCache->sfbCnt == psyOutChannel->sfbCnt);
 
   FIXP_DBL threshConstLdData =
       FL2FXCONST_DBL(0.04304511722f); /* log10(6.75)/log10(2.0)/64.0 */
@@ -1076,6 +1168,9 @@ static void FDKaacEnc_EstimateScaleFactorsChannel(
   /* scfs without energy or with thresh>energy are marked with FDK_INT_MIN */
   for (i = 0; i < psyOutChannel->sfbCnt; i++) {
     scf[i] = FDK_INT_MIN;
+    scfEstimated[i] = FDK_INT_MIN;
+    scfImproved[i] = FDK_INT_MIN;
+    sfbCached[i] = 0;
   }
 
   for (i = 0; i < MAX_GROUPED_SFB; i++) {
@@ -1148,9 +1243,23 @@ static void FDKaacEnc_EstimateScaleFactorsChannel(
         }
 
         scfInt = fixMax(scfInt, minSfMaxQuant[sfbOffs + sfb]);
+        scfEstimated[sfbOffs + sfb] = scfInt;
 
         /* find better scalefactor with analysis by synthesis */
-        if (invQuant > 0) {
+        if ((invQuant > 0) && useCache &&
+            FDKaacEnc_reuseCachedScf(
+                scfCache, sfbOffs + sfb,
+                qcOutChannel->mdctSpectrum +
+                    psyOutChannel->sfbOffsets[sfbOffs + sfb],
+                quantSpec + psyOutChannel->sfbOffsets[sfbOffs + sfb],
+                psyOutChannel->sfbOffsets[sfbOffs + sfb + 1] -
+                    psyOutChannel->sfbOffsets[sfbOffs + sfb],
+                threshLdData, scfInt, minSfMaxQuant[sfbOffs + sfb],
+                sfbFormFactorLdData[sfbOffs + sfb], &scfInt,
+                &sfbDistLdData[sfbOffs + sfb],
+                &minScfCalculated[sfbOffs + sfb], dZoneQuantEnable)) {
+          sfbCached[sfbOffs + sfb] = 1;
+        } else if (invQuant > 0) {
           scfInt = FDKaacEnc_improveScf(
               qcOutChannel->mdctSpectrum +
                   psyOutChannel->sfbOffsets[sfbOffs + sfb],
@@ -1163,6 +1272,7 @@ static void FDKaacEnc_EstimateScaleFactorsChannel(
               dZoneQuantEnable);
         }
         scf[sfbOffs + sfb] = scfInt;
+        scfImproved[sfbOffs + sfb] = scfInt;
       }
     }
   }
@@ -1181,21 +1291,47 @@ static void FDKaacEnc_EstimateScaleFactorsChannel(
         psyOutChannel->sfbCnt, psyOutChannel->sfbPerGroup,
         psyOutChannel->maxSfbPerGroup, sfbNRelevantLines);
 
+    if (scfCache != NULL) {
+      /* bit demand of the scalefactors before the assimilation */
+      for (i = 0; i < psyOutChannel->sfbCnt; i++) {
+        if (scf[i] != FDK_INT_MIN) {
+          sfbConstPePart[i] =
+              ((qcOutChannel->sfbEnergyLdData[i] - sfbFormFactorLdData[i] -
+                FL2FXCONST_DBL(0.09375f)) >>
+               1) +
+              FL2FXCONST_DBL(0.02152255861f);
+          pe += FDKaacEnc_calcSingleSpecPe(scf[i], sfbConstPePart[i],
+                                           sfbNRelevantLines[i]);
+        }
+      }
+    }
+
+    /* The bands which took over the scalefactor of the previous frame were
+       assimilated already. As long as the bit demand of the channel
+       converged, the assimilation only has to look at the other bands. */
+    if (useCache &&
+        (fixp_abs(pe - scfCache->pe) <=
+         fMult(SCF_CACHE_PE_TOL, scfCache->pe))) {
+      sfbAssimilated = sfbCached;
+    }
+
     FDKaacEnc_assimilateSingleScf(
         psyOutChannel, qcOutChannel, quantSpec, quantSpecTmp, dZoneQuantEnable,
         scf, minSfMaxQuant, sfbDistLdData, sfbConstPePart, sfbFormFactorLdData,
-        sfbNRelevantLines, minScfCalculated, 1);
+        sfbNRelevantLines, minScfCalculated, sfbAssimilated, 1);
 
     if (invQuant > 1) {
       FDKaacEnc_assimilateMultipleScf(
           psyOutChannel, qcOutChannel, quantSpec, quantSpecTmp,
           dZoneQuantEnable, scf, minSfMaxQuant, sfbDistLdData, sfbConstPePart,
-          sfbFormFactorLdData, sfbNRelevantLines);
+          sfbFormFactorLdData, sfbNRelevantLines, sfbAssimilated);
+    }
 
+    if (invQuant > 2) {
       FDKaacEnc_FDKaacEnc_assimilateMultipleScf2(
           psyOutChannel, qcOutChannel, quantSpec, quantSpecTmp,
           dZoneQuantEnable, scf, minSfMaxQuant, sfbDistLdData, sfbConstPePart,
-          sfbFormFactorLdData, sfbNRelevantLines);
+          sfbFormFactorLdData, sfbNRelevantLines, sfbAssimilated);
     }
   }
 
@@ -1229,6 +1365,21 @@ static void FDKaacEnc_EstimateScaleFactorsChannel(
     }
   }
 
+  /* The cache keeps the scalefactors of the analysis by synthesis. Those of
+     the assimilation suit the neighbours of each band in this frame only:
+     taken over, they spend more bits than the thresholds grant, and the
+     quantization loop has to reduce the bit consumption again. */
+  if (scfCache != NULL) {
+    scfCache->valid = (psyOutChannel->lastWindowSequence != SHORT_WINDOW);
+    scfCache->sfbCnt = psyOutChannel->sfbCnt;
+    scfCache->pe = pe;
+    for (i = 0; i < psyOutChannel->sfbCnt; i++) {
+      scfCache->scfEstimated[i] = scfEstimated[i];
+      scfCache->scf[i] = scfImproved[i];
+      scfCache->sfbFormFactorLdData[i] = sfbFormFactorLdData[i];
+    }
+  }
+
   /* get max scalefac for global gain */
   maxSf = FDK_INT_MIN;
   for (sfbOffs = 0; sfbOffs < psyOutChannel->sfbCnt;
@@ -1278,6 +1429,7 @@ static void FDKaacEnc_EstimateScaleFactorsChannel(
 
 void FDKaacEnc_EstimateScaleFactors(PSY_OUT_CHANNEL *psyOutChannel[],
                                     QC_OUT_CHANNEL *qcOutChannel[],
+                                    SCF_CACHE *scfCache[],
                                     const INT invQuant,
                                     const INT dZoneQuantEnable,
                                     const INT nChannels) {
@@ -1285,7 +1437,8 @@ void FDKaacEnc_EstimateScaleFactors(PSY_OUT_CHANNEL *psyOutChannel[],
 
   for (ch = 0; ch < nChannels; ch++) {
     FDKaacEnc_EstimateScaleFactorsChannel(
-        qcOutChannel[ch], psyOutChannel[ch], qcOutChannel[ch]->scf,
+        qcOutChannel[ch], psyOutChannel[ch], scfCache[ch],
+        qcOutChannel[ch]->scf,
         &qcOutChannel[ch]->globalGain, qcOutChannel[ch]->sfbFormFactorLdData,
         invQuant, qcOutChannel[ch]->quantSpec, dZoneQuantEnable);
   }
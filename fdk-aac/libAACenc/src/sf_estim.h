@@ -117,6 +117,7 @@ void FDKaacEnc_CalcFormFactor(QC_OUT_CHANNEL *qcOutChannel[(2)],
 
 void FDKaacEnc_EstimateScaleFactors(PSY_OUT_CHANNEL *psyOutChannel[],
                                     QC_OUT_CHANNEL *qcOutChannel[],
+                                    SCF_CACHE *scfCache[],
                                     const INT invQuant,
                                     const INT dZoneQuantEnable,
                                     const INT nChannels);
@@ -110,7 +110,7 @@ amm-info@iis.fraunhofer.de
 AAC_ENCODER_ERROR FDKaacEnc_InitTnsConfiguration(
     INT bitrate, INT samplerate, INT channels, INT blocktype, INT granuleLength,
     INT isLowDelay, INT ldSbrPresent, TNS_CONFIG *tnsConfig,
-    PSY_CONFIGURATION *psyConfig, INT active, INT useTnsPeak);
+    PSY_CONFIGURATION *psyConfig, INT active, INT useTnsPeak, INT complexity);
 
 INT FDKaacEnc_TnsDetect(TNS_DATA *tnsData, const TNS_CONFIG *tC,
                         TNS_INFO *tnsInfo, INT sfbCnt, const FIXP_DBL *spectrum,
@@ -107,6 +107,10 @@ amm-info@iis.fraunhofer.de
 #if defined(__arm__)
 #endif
 
+/* number of lines the chaos measure starts below the first band of interest,
+   the smoothing has settled after them */
+#define TONALITY_LEAD_LINES (16)
+
 static const FIXP_DBL normlog =
     (FIXP_DBL)0xd977d949; /*FL2FXCONST_DBL(-0.4342944819f *
                              FDKlog(2.0)/FDKlog(2.7182818)); */
@@ -122,21 +126,31 @@ void FDKaacEnc_CalculateFullTonality(FIXP_DBL *RESTRICT spectrum,
                                      INT *RESTRICT sfbMaxScaleSpec,
                                      FIXP_DBL *RESTRICT sfbEnergyLD64,
                                      FIXP_SGL *RESTRICT sfbTonality, INT sfbCnt,
-                                     const INT *sfbOffset, INT usePns) {
+                                     const INT *sfbOffset, INT usePns,
+                                     INT startSfb) {
   INT j;
   INT numberOfLines = sfbOffset[sfbCnt];
 
-  if (usePns) {
+  /* bands below startSfb are not evaluated and count as tonal */
+  startSfb = fMin(startSfb, sfbCnt);
+  for (j = 0; j < startSfb; j++) {
+    sfbTonality[j] = (FIXP_SGL)MAXVAL_SGL;
+  }
+
+  if (usePns && (startSfb < sfbCnt)) {
+    INT startLine = fMax(0, sfbOffset[startSfb] - TONALITY_LEAD_LINES);
+
     C_ALLOC_SCRATCH_START(chaosMeasurePerLine, FIXP_DBL, (1024))
 
     /* calculate chaos measure */
-    FDKaacEnc_CalculateChaosMeasure(spectrum, numberOfLines,
-                                    chaosMeasurePerLine);
+    FDKaacEnc_CalculateChaosMeasure(spectrum + startLine,
+                                    numberOfLines - startLine,
+                                    chaosMeasurePerLine + startLine);
 
     /* smooth ChaosMeasure */
-    FIXP_DBL left = chaosMeasurePerLine[0];
+    FIXP_DBL left = chaosMeasurePerLine[startLine];
     FIXP_DBL right;
-    for (j = 1; j < (numberOfLines - 1); j += 2) {
+    for (j = startLine + 1; j < (numberOfLines - 1); j += 2) {
       right = chaosMeasurePerLine[j];
       right = right - (right >> 2);
       left = right + (left >> 2);
@@ -154,8 +168,10 @@ void FDKaacEnc_CalculateFullTonality(FIXP_DBL *RESTRICT spectrum,
       chaosMeasurePerLine[j] = left;
     }
 
-    FDKaacEnc_CalcSfbTonality(spectrum, sfbMaxScaleSpec, chaosMeasurePerLine,
-                              sfbTonality, sfbCnt, sfbOffset, sfbEnergyLD64);
+    FDKaacEnc_CalcSfbTonality(
+        spectrum + sfbOffset[startSfb], sfbMaxScaleSpec + startSfb,
+        chaosMeasurePerLine + sfbOffset[startSfb], sfbTonality + startSfb,
+        sfbCnt - startSfb, sfbOffset + startSfb, sfbEnergyLD64 + startSfb);
 
     C_ALLOC_SCRATCH_END(chaosMeasurePerLine, FIXP_DBL, (1024))
   }
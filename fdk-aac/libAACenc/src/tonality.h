@@ -110,6 +110,7 @@ void FDKaacEnc_CalculateFullTonality(FIXP_DBL *RESTRICT spectrum,
                                      INT *RESTRICT sfbMaxScaleSpec,
                                      FIXP_DBL *RESTRICT sfbEnergyLD64,
                                      FIXP_SGL *RESTRICT sfbTonality, INT sfbCnt,
-                                     const INT *sfbOffset, INT usePns);
+                                     const INT *sfbOffset, INT usePns,
+                                     INT startSfb);
 
 #endif /* TONALITY_H */
@@ -0,0 +1,508 @@
+/* -----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK AAC Codec Library for Android
+
+© Copyright  1995 - 2018 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. All rights reserved.
+
+ 1.    INTRODUCTION
+The Fraunhofer FDK AAC Codec Library for Android ("FDK AAC Codec") is software
+that implements the MPEG Advanced Audio Coding ("AAC") encoding and decoding
+scheme for digital audio. This FDK AAC Codec software is intended to be used on
+a wide variety of Android devices.
+
+AAC's HE-AAC and HE-AAC v2 versions are regarded as today's most efficient
+general perceptual audio codecs. AAC-ELD is considered the best-performing
+full-bandwidth communications codec by independent studies and is widely
+deployed. AAC has been standardized by ISO and IEC as part of the MPEG
+specifications.
+
+Patent licenses for necessary patent claims for the FDK AAC Codec (including
+those of Fraunhofer) may be obtained through Via Licensing
+(www.vialicensing.com) or through the respective patent owners individually for
+the purpose of encoding or decoding bit streams in products that are compliant
+with the ISO/IEC MPEG audio standards. Please note that most manufacturers of
+Android devices already license these patent claims through Via Licensing or
+directly from the patent owners, and therefore FDK AAC Codec software may
+already be covered under those patent licenses when it is used for those
+licensed purposes only.
+
+Commercially-licensed AAC software libraries, including floating-point versions
+with enhanced sound quality, are also available from Fraunhofer. Users are
+encouraged to check the Fraunhofer website for additional applications
+information and documentation.
+
+2.    COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+You must retain the complete text of this software license in redistributions of
+the FDK AAC Codec or your modifications thereto in source code form.
+
+You must retain the complete text of this software license in the documentation
+and/or other materials provided with redistributions of the FDK AAC Codec or
+your modifications thereto in binary form. You must make available free of
+charge copies of the complete source code of the FDK AAC Codec and your
+modifications thereto to recipients of copies in binary form.
+
+The name of Fraunhofer may not be used to endorse or promote products derived
+from this library without prior written permission.
+
+You may not charge copyright license fees for anyone to use, copy or distribute
+the FDK AAC Codec software or your modifications thereto.
+
+Your modified versions of the FDK AAC Codec must carry prominent notices stating
+that you changed the software and the date of any change. For modified versions
+of the FDK AAC Codec, the term "Fraunhofer FDK AAC Codec Library for Android"
+must be replaced by the term "Third-Party Modified Version of the Fraunhofer FDK
+AAC Codec Library for Android."
+
+3.    NO PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software.
+
+You may use this FDK AAC Codec software or modifications thereto only for
+purposes that are authorized by appropriate patent licenses.
+
+4.    DISCLAIMER
+
+This FDK AAC Codec software is provided by Fraunhofer on behalf of the copyright
+holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED WARRANTIES,
+including but not limited to the implied warranties of merchantability and
+fitness for a particular purpose. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+CONTRIBUTORS BE LIABLE for any direct, indirect, incidental, special, exemplary,
+or consequential damages, including but not limited to procurement of substitute
+goods or services; loss of use, data, or profits, or business interruption,
+however caused and on any theory of liability, whether in contract, strict
+liability, or tort (including negligence), arising in any way out of the use of
+this software, even if advised of the possibility of such damage.
+
+5.    CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Audio and Multimedia Departments - FDK AAC LL
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+----------------------------------------------------------------------------- */
+
+/**************************** AAC encoder library ******************************
+
+   Description: Huffman bit counting of small values with SSSE3
+
+*******************************************************************************/
+
+/* The bands whose values fit the books 1 to 8 are counted 32 lines at a
+   time. The absolute values, or the values plus the largest value for the
+   signed books, are packed to bytes, and PMADDUBSW combines the lines of a
+   pair into the index of the pair. PMADDWD combines two pairs into the index
+   of a quad.
+
+   The code lengths are kept in byte tables that only cover the values that
+   can occur for the largest value of the band, so that the tables of most
+   books fit in one or a few registers. Each 16 entries of a table are looked
+   up with PSHUFB, and the lengths are summed with PSADBW. Pairs and quads
+   beyond the end of the band get the index 0xFF, which is outside of every
+   table and has the length 0.
+
+   The books 9 to 11 with values above 7 need too many shuffles to be faster
+   than the table reads of the scalar code, these bands are counted by the
+   functions above. The version is selected once, according to the CPU. */
+
+#ifndef __INCLUDE_BIT_CNT_X86__
+#define __INCLUDE_BIT_CNT_X86__
+
+#include <immintrin.h>
+
+/* Largest value of the bands counted with SSSE3, by class */
+#define HUFF_CLASSES_X86 4
+static const INT FDKaacEnc_huffLav_x86[HUFF_CLASSES_X86] = {1, 2, 4, 7};
+
+/* Code lengths by index of the pair or the quad, for one book and class */
+typedef struct {
+  UCHAR len[96];
+} HUFF_LEN_X86;
+
+static HUFF_LEN_X86 FDKaacEnc_huffLen_x86[HUFF_CLASSES_X86]
+                                         [CODE_BOOK_ESC_NO + 1];
+
+static COUNT_FUNCTION FDKaacEnc_countFuncTable_x86[CODE_BOOK_ESC_LAV + 1];
+
+/* Books that can code the values of a class */
+static inline INT FDKaacEnc_huffFirstBook(INT lav) {
+  return (lav <= CODE_BOOK_1_LAV)   ? CODE_BOOK_1_NO
+         : (lav <= CODE_BOOK_3_LAV) ? CODE_BOOK_3_NO
+         : (lav <= CODE_BOOK_5_LAV) ? CODE_BOOK_5_NO
+                                    : CODE_BOOK_7_NO;
+}
+
+static inline INT FDKaacEnc_isSigned(INT book) {
+  return (book == CODE_BOOK_1_NO) || (book == CODE_BOOK_2_NO) ||
+         (book == CODE_BOOK_5_NO) || (book == CODE_BOOK_6_NO);
+}
+
+static inline INT FDKaacEnc_tupleSize(INT book) {
+  return (book <= CODE_BOOK_4_NO) ? 4 : 2;
+}
+
+/* Number of values in one line of a pair or a quad */
+static inline INT FDKaacEnc_huffRadix(INT lav, INT book) {
+  return FDKaacEnc_isSigned(book) ? 2 * lav + 1 : lav + 1;
+}
+
+/* Number of shuffles needed to look up a table */
+static inline INT FDKaacEnc_huffChunks(INT lav, INT book) {
+  const INT radix = FDKaacEnc_huffRadix(lav, book);
+  INT entries = radix * radix;
+
+  if (FDKaacEnc_tupleSize(book) == 4) entries *= radix * radix;
+
+  return (entries + 15) >> 4;
+}
+
+/* Length of the code of a pair or a quad of signed values, without the
+   sign bits */
+static INT FDKaacEnc_huffLength(INT book, const INT *t) {
+  const INT a0 = fixp_abs(t[0]), a1 = fixp_abs(t[1]);
+
+  switch (book) {
+    case CODE_BOOK_1_NO:
+      return HI_LTAB(
+          FDKaacEnc_huff_ltab1_2[t[0] + 1][t[1] + 1][t[2] + 1][t[3] + 1]);
+    case CODE_BOOK_2_NO:
+      return LO_LTAB(
+          FDKaacEnc_huff_ltab1_2[t[0] + 1][t[1] + 1][t[2] + 1][t[3] + 1]);
+    case CODE_BOOK_3_NO:
+      return HI_LTAB(FDKaacEnc_huff_ltab3_4[a0][a1][fixp_abs(t[2])]
+                                           [fixp_abs(t[3])]);
+    case CODE_BOOK_4_NO:
+      return LO_LTAB(FDKaacEnc_huff_ltab3_4[a0][a1][fixp_abs(t[2])]
+                                           [fixp_abs(t[3])]);
+    case CODE_BOOK_5_NO:
+      return HI_LTAB(FDKaacEnc_huff_ltab5_6[t[0] + 4][t[1] + 4]);
+    case CODE_BOOK_6_NO:
+      return LO_LTAB(FDKaacEnc_huff_ltab5_6[t[0] + 4][t[1] + 4]);
+    case CODE_BOOK_7_NO:
+      return HI_LTAB(FDKaacEnc_huff_ltab7_8[a0][a1]);
+    case CODE_BOOK_8_NO:
+      return LO_LTAB(FDKaacEnc_huff_ltab7_8[a0][a1]);
+    case CODE_BOOK_9_NO:
+      return HI_LTAB(FDKaacEnc_huff_ltab9_10[a0][a1]);
+    case CODE_BOOK_10_NO:
+      return LO_LTAB(FDKaacEnc_huff_ltab9_10[a0][a1]);
+    default:
+      return FDKaacEnc_huff_ltab11[a0][a1];
+  }
+}
+
+/* Lengths of 16 entries of a table. The index is 0x70 to 0x7F for the
+   entries of this chunk, and has the top bit set for all the others, for
+   which PSHUFB gives 0. */
+#define LOOKUP_CHUNK_SSSE3(index, table, k)                             \
+  _mm_shuffle_epi8(                                                     \
+      _mm_loadu_si128((const __m128i *)((table)->len + 16 * (k))),      \
+      _mm_adds_epu8(_mm_sub_epi8(index, _mm_set1_epi8(16 * (k))),       \
+                    _mm_set1_epi8(0x70)))
+
+/* Sum of the lengths of the 16 indices, in the two 64 bit lanes */
+__attribute__((target("ssse3"), always_inline)) static inline __m128i
+FDKaacEnc_lookupLength_ssse3(__m128i index, const HUFF_LEN_X86 *table,
+                             const INT chunks) {
+  __m128i length = _mm_setzero_si128();
+
+  switch (chunks) {
+    case 6:
+      length = _mm_or_si128(length, LOOKUP_CHUNK_SSSE3(index, table, 5));
+      /* fall through */
+    case 5:
+      length = _mm_or_si128(length, LOOKUP_CHUNK_SSSE3(index, table, 4));
+      /* fall through */
+    case 4:
+      length = _mm_or_si128(length, LOOKUP_CHUNK_SSSE3(index, table, 3));
+      /* fall through */
+    case 3:
+      length = _mm_or_si128(length, LOOKUP_CHUNK_SSSE3(index, table, 2));
+      /* fall through */
+    case 2:
+      length = _mm_or_si128(length, LOOKUP_CHUNK_SSSE3(index, table, 1));
+      /* fall through */
+    default:
+      length = _mm_or_si128(length, LOOKUP_CHUNK_SSSE3(index, table, 0));
+  }
+
+  return _mm_sad_epu8(length, _mm_setzero_si128());
+}
+
+#undef LOOKUP_CHUNK_SSSE3
+
+/* Up to 8 lines, the band widths are multiples of 4 */
+__attribute__((target("ssse3"))) static inline __m128i
+FDKaacEnc_loadLines_ssse3(const SHORT *values, INT lines) {
+  if (lines >= 8) return _mm_loadu_si128((const __m128i *)values);
+  if (lines >= 4) return _mm_loadl_epi64((const __m128i *)values);
+  return _mm_setzero_si128();
+}
+
+/* Quad indices from the pair indices of 8 pairs each, in the low 8 lanes */
+__attribute__((target("ssse3"))) static inline __m128i
+FDKaacEnc_quadIndex_ssse3(__m128i pair01, __m128i pair23, INT radix) {
+  const __m128i factor = _mm_set1_epi32((1 << 16) | (radix * radix));
+
+  return _mm_packus_epi16(_mm_packs_epi32(_mm_madd_epi16(pair01, factor),
+                                          _mm_madd_epi16(pair23, factor)),
+                          _mm_setzero_si128());
+}
+
+/* Sum of the two 64 bit lanes */
+__attribute__((target("ssse3"))) static inline __m128i FDKaacEnc_sum_ssse3(
+    __m128i v) {
+  return _mm_add_epi64(v, _mm_unpackhi_epi64(v, v));
+}
+
+/* Like the scalar tables, the sums of several books share a register, in
+   16 bit fields. A band has at most 1024 lines, so they do not overflow. */
+#define COUNT_BOOK_SSSE3(bc, index, book, field)                       \
+  bc = _mm_add_epi64(                                                  \
+      bc, _mm_slli_epi64(                                              \
+              FDKaacEnc_lookupLength_ssse3(                            \
+                  index, &table[book], FDKaacEnc_huffChunks(lav, book)), \
+              16 * (field)))
+
+#define BOOK_COUNT_SSSE3(bc, field) _mm_extract_epi16(bc, field)
+
+/* Up to 32 lines */
+__attribute__((target("ssse3"), always_inline)) static inline void
+FDKaacEnc_countBlock_ssse3(const SHORT *const values, const INT lines,
+                           const INT cls, __m128i *bc1_2_3_4,
+                           __m128i *bc5_6_11, __m128i *bc7_8_9_10,
+                           __m128i *sc) {
+  const INT lav = FDKaacEnc_huffLav_x86[cls];
+  const INT radixU = lav + 1;
+  const INT radixS = 2 * lav + 1;
+  const HUFF_LEN_X86 *const table = FDKaacEnc_huffLen_x86[cls];
+  const __m128i lane =
+      _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+  const __m128i one = _mm_set1_epi8(1);
+  const __m128i v0 = FDKaacEnc_loadLines_ssse3(values, lines);
+  const __m128i v1 = FDKaacEnc_loadLines_ssse3(values + 8, lines - 8);
+  const __m128i v2 = FDKaacEnc_loadLines_ssse3(values + 16, lines - 16);
+  const __m128i v3 = FDKaacEnc_loadLines_ssse3(values + 24, lines - 24);
+  const __m128i pairEnd =
+      _mm_cmpgt_epi8(lane, _mm_set1_epi8((lines >> 1) - 1));
+  const __m128i quadEnd =
+      _mm_cmpgt_epi8(lane, _mm_set1_epi8((lines >> 2) - 1));
+
+  /* Books with unsigned values */
+  const __m128i a01 =
+      _mm_packus_epi16(_mm_abs_epi16(v0), _mm_abs_epi16(v1));
+  const __m128i a23 =
+      _mm_packus_epi16(_mm_abs_epi16(v2), _mm_abs_epi16(v3));
+  const __m128i pairU01 =
+      _mm_maddubs_epi16(a01, _mm_set1_epi16((1 << 8) | radixU));
+  const __m128i pairU23 =
+      _mm_maddubs_epi16(a23, _mm_set1_epi16((1 << 8) | radixU));
+  const __m128i pairU =
+      _mm_or_si128(_mm_packus_epi16(pairU01, pairU23), pairEnd);
+
+  *sc = _mm_add_epi64(
+      *sc, _mm_sad_epu8(_mm_add_epi8(_mm_min_epu8(a01, one),
+                                    _mm_min_epu8(a23, one)),
+                       _mm_setzero_si128()));
+
+  COUNT_BOOK_SSSE3(*bc7_8_9_10, pairU, CODE_BOOK_7_NO, 0);
+  COUNT_BOOK_SSSE3(*bc7_8_9_10, pairU, CODE_BOOK_8_NO, 1);
+  COUNT_BOOK_SSSE3(*bc7_8_9_10, pairU, CODE_BOOK_9_NO, 2);
+  COUNT_BOOK_SSSE3(*bc7_8_9_10, pairU, CODE_BOOK_10_NO, 3);
+  COUNT_BOOK_SSSE3(*bc5_6_11, pairU, CODE_BOOK_ESC_NO, 2);
+
+  if (lav <= CODE_BOOK_3_LAV) {
+    const __m128i quadU = _mm_or_si128(
+        FDKaacEnc_quadIndex_ssse3(pairU01, pairU23, radixU), quadEnd);
+
+    COUNT_BOOK_SSSE3(*bc1_2_3_4, quadU, CODE_BOOK_3_NO, 2);
+    COUNT_BOOK_SSSE3(*bc1_2_3_4, quadU, CODE_BOOK_4_NO, 3);
+  }
+
+  /* Books with signed values, offset by lav */
+  if (lav <= CODE_BOOK_5_LAV) {
+    const __m128i offset = _mm_set1_epi16(lav);
+    const __m128i s01 = _mm_packus_epi16(_mm_add_epi16(v0, offset),
+                                         _mm_add_epi16(v1, offset));
+    const __m128i s23 = _mm_packus_epi16(_mm_add_epi16(v2, offset),
+                                         _mm_add_epi16(v3, offset));
+    const __m128i pairS01 =
+        _mm_maddubs_epi16(s01, _mm_set1_epi16((1 << 8) | radixS));
+    const __m128i pairS23 =
+        _mm_maddubs_epi16(s23, _mm_set1_epi16((1 << 8) | radixS));
+    const __m128i pairS =
+        _mm_or_si128(_mm_packus_epi16(pairS01, pairS23), pairEnd);
+
+    COUNT_BOOK_SSSE3(*bc5_6_11, pairS, CODE_BOOK_5_NO, 0);
+    COUNT_BOOK_SSSE3(*bc5_6_11, pairS, CODE_BOOK_6_NO, 1);
+
+    if (lav <= CODE_BOOK_1_LAV) {
+      const __m128i quadS = _mm_or_si128(
+          FDKaacEnc_quadIndex_ssse3(pairS01, pairS23, radixS), quadEnd);
+
+      COUNT_BOOK_SSSE3(*bc1_2_3_4, quadS, CODE_BOOK_1_NO, 0);
+      COUNT_BOOK_SSSE3(*bc1_2_3_4, quadS, CODE_BOOK_2_NO, 1);
+    }
+  }
+}
+
+__attribute__((target("ssse3"), always_inline)) static inline void
+FDKaacEnc_countSmall_ssse3(const SHORT *const values, const INT width,
+                           INT *RESTRICT bitCount, const INT cls) {
+  const INT lav = FDKaacEnc_huffLav_x86[cls];
+  __m128i bc1_2_3_4 = _mm_setzero_si128();
+  __m128i bc5_6_11 = _mm_setzero_si128();
+  __m128i bc7_8_9_10 = _mm_setzero_si128();
+  __m128i sc = _mm_setzero_si128();
+  INT i, book;
+
+  /* Most bands fit in the first block. Counting it before the loop keeps
+     the compiler from loading all the tables in advance for them. */
+  FDKaacEnc_countBlock_ssse3(values, fixMin(width, 32), cls, &bc1_2_3_4,
+                             &bc5_6_11, &bc7_8_9_10, &sc);
+  for (i = 32; i < width; i += 32) {
+    FDKaacEnc_countBlock_ssse3(values + i, fixMin(width - i, 32), cls,
+                               &bc1_2_3_4, &bc5_6_11, &bc7_8_9_10, &sc);
+  }
+
+  const INT signBits = _mm_cvtsi128_si32(FDKaacEnc_sum_ssse3(sc));
+
+  bc1_2_3_4 = FDKaacEnc_sum_ssse3(bc1_2_3_4);
+  bc5_6_11 = FDKaacEnc_sum_ssse3(bc5_6_11);
+  bc7_8_9_10 = FDKaacEnc_sum_ssse3(bc7_8_9_10);
+
+  for (book = CODE_BOOK_1_NO; book <= CODE_BOOK_ESC_NO; book++) {
+    bitCount[book] = INVALID_BITCOUNT;
+  }
+  if (lav <= CODE_BOOK_1_LAV) {
+    bitCount[1] = BOOK_COUNT_SSSE3(bc1_2_3_4, 0);
+    bitCount[2] = BOOK_COUNT_SSSE3(bc1_2_3_4, 1);
+  }
+  if (lav <= CODE_BOOK_3_LAV) {
+    bitCount[3] = BOOK_COUNT_SSSE3(bc1_2_3_4, 2) + signBits;
+    bitCount[4] = BOOK_COUNT_SSSE3(bc1_2_3_4, 3) + signBits;
+  }
+  if (lav <= CODE_BOOK_5_LAV) {
+    bitCount[5] = BOOK_COUNT_SSSE3(bc5_6_11, 0);
+    bitCount[6] = BOOK_COUNT_SSSE3(bc5_6_11, 1);
+  }
+  bitCount[7] = BOOK_COUNT_SSSE3(bc7_8_9_10, 0) + signBits;
+  bitCount[8] = BOOK_COUNT_SSSE3(bc7_8_9_10, 1) + signBits;
+  bitCount[9] = BOOK_COUNT_SSSE3(bc7_8_9_10, 2) + signBits;
+  bitCount[10] = BOOK_COUNT_SSSE3(bc7_8_9_10, 3) + signBits;
+  bitCount[11] = BOOK_COUNT_SSSE3(bc5_6_11, 2) + signBits;
+}
+
+#undef COUNT_BOOK_SSSE3
+#undef BOOK_COUNT_SSSE3
+
+__attribute__((target("ssse3"))) static void FDKaacEnc_count1_ssse3(
+    const SHORT *const values, const INT width, INT *RESTRICT bitCount) {
+  FDKaacEnc_countSmall_ssse3(values, width, bitCount, 0);
+}
+
+__attribute__((target("ssse3"))) static void FDKaacEnc_count2_ssse3(
+    const SHORT *const values, const INT width, INT *RESTRICT bitCount) {
+  FDKaacEnc_countSmall_ssse3(values, width, bitCount, 1);
+}
+
+__attribute__((target("ssse3"))) static void FDKaacEnc_count4_ssse3(
+    const SHORT *const values, const INT width, INT *RESTRICT bitCount) {
+  FDKaacEnc_countSmall_ssse3(values, width, bitCount, 2);
+}
+
+__attribute__((target("ssse3"))) static void FDKaacEnc_count7_ssse3(
+    const SHORT *const values, const INT width, INT *RESTRICT bitCount) {
+  FDKaacEnc_countSmall_ssse3(values, width, bitCount, 3);
+}
+
+static INT FDKaacEnc_bitCount_ssse3(const SHORT *const values, const INT width,
+                                    const INT maxVal,
+                                    INT *const RESTRICT bitCount) {
+  /* Bands of 4 lines are counted faster by the scalar code */
+  const COUNT_FUNCTION *table =
+      (width > 4) ? FDKaacEnc_countFuncTable_x86 : countFuncTable;
+
+  bitCount[0] = (maxVal == 0) ? 0 : INVALID_BITCOUNT;
+
+  table[fixMin(maxVal, (INT)CODE_BOOK_ESC_LAV)](values, width, bitCount);
+
+  return (0);
+}
+
+/* Fill the table of one book, the index is made of the digits
+   t[0], t[1], ... in base radix, with the signed values offset by lav */
+static void FDKaacEnc_huffLenInit_x86(HUFF_LEN_X86 *table, INT lav,
+                                      INT book) {
+  const INT radix = FDKaacEnc_huffRadix(lav, book);
+  const INT size = FDKaacEnc_tupleSize(book);
+  const INT offset = FDKaacEnc_isSigned(book) ? lav : 0;
+  INT entries = 1;
+  INT i, k;
+
+  for (k = 0; k < size; k++) entries *= radix;
+
+  for (i = 0; i < entries; i++) {
+    INT t[4];
+    INT rest = i;
+
+    for (k = size - 1; k >= 0; k--) {
+      t[k] = rest % radix - offset;
+      rest /= radix;
+    }
+    table->len[i] = (UCHAR)FDKaacEnc_huffLength(book, t);
+  }
+}
+
+static void FDKaacEnc_addBitCountKernel(const char *name,
+                                        BIT_COUNT_FN bitCount) {
+  BIT_COUNT_KERNEL *kernel =
+      &FDKaacEnc_bitCountKernels[FDKaacEnc_numBitCountKernels++];
+  kernel->name = name;
+  kernel->bitCount = bitCount;
+}
+
+__attribute__((constructor)) static void FDKaacEnc_bitCountInit_x86(void) {
+  INT cls, book, i;
+
+  for (i = 0; i <= CODE_BOOK_ESC_LAV; i++) {
+    FDKaacEnc_countFuncTable_x86[i] = countFuncTable[i];
+  }
+
+  __builtin_cpu_init();
+  if (!__builtin_cpu_supports("ssse3")) return;
+
+  for (cls = 0; cls < HUFF_CLASSES_X86; cls++) {
+    const INT lav = FDKaacEnc_huffLav_x86[cls];
+
+    for (book = FDKaacEnc_huffFirstBook(lav); book <= CODE_BOOK_ESC_NO;
+         book++) {
+      FDKaacEnc_huffLenInit_x86(&FDKaacEnc_huffLen_x86[cls][book], lav, book);
+    }
+  }
+
+  FDKaacEnc_countFuncTable_x86[0] = FDKaacEnc_count1_ssse3;
+  FDKaacEnc_countFuncTable_x86[1] = FDKaacEnc_count1_ssse3;
+  FDKaacEnc_countFuncTable_x86[2] = FDKaacEnc_count2_ssse3;
+  FDKaacEnc_countFuncTable_x86[3] = FDKaacEnc_count4_ssse3;
+  FDKaacEnc_countFuncTable_x86[4] = FDKaacEnc_count4_ssse3;
+  FDKaacEnc_countFuncTable_x86[5] = FDKaacEnc_count7_ssse3;
+  FDKaacEnc_countFuncTable_x86[6] = FDKaacEnc_count7_ssse3;
+  FDKaacEnc_countFuncTable_x86[7] = FDKaacEnc_count7_ssse3;
+
+  FDKaacEnc_addBitCountKernel("ssse3", FDKaacEnc_bitCount_ssse3);
+  FDKaacEnc_bitCountFn =
+      FDKaacEnc_bitCountKernels[FDKaacEnc_numBitCountKernels - 1].bitCount;
+}
+
+#endif /* #ifndef __INCLUDE_BIT_CNT_X86__ */
@@ -0,0 +1,377 @@
+/* -----------------------------------------------------------------------------
+Software License for The Fraunhofer FDK AAC Codec Library for Android
+
+© Copyright  1995 - 2018 Fraunhofer-Gesellschaft zur Förderung der angewandten
+Forschung e.V. All rights reserved.
+
+ 1.    INTRODUCTION
+The Fraunhofer FDK AAC Codec Library for Android ("FDK AAC Codec") is software
+that implements the MPEG Advanced Audio Coding ("AAC") encoding and decoding
+scheme for digital audio. This FDK AAC Codec software is intended to be used on
+a wide variety of Android devices.
+
+AAC's HE-AAC and HE-AAC v2 versions are regarded as today's most efficient
+general perceptual audio codecs. AAC-ELD is considered the best-performing
+full-bandwidth communications codec by independent studies and is widely
+deployed. AAC has been standardized by ISO and IEC as part of the MPEG
+specifications.
+
+Patent licenses for necessary patent claims for the FDK AAC Codec (including
+those of Fraunhofer) may be obtained through Via Licensing
+(www.vialicensing.com) or through the respective patent owners individually for
+the purpose of encoding or decoding bit streams in products that are compliant
+with the ISO/IEC MPEG audio standards. Please note that most manufacturers of
+Android devices already license these patent claims through Via Licensing or
+directly from the patent owners, and therefore FDK AAC Codec software may
+already be covered under those patent licenses when it is used for those
+licensed purposes only.
+
+Commercially-licensed AAC software libraries, including floating-point versions
+with enhanced sound quality, are also available from Fraunhofer. Users are
+encouraged to check the Fraunhofer website for additional applications
+information and documentation.
+
+2.    COPYRIGHT LICENSE
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted without payment of copyright license fees provided that you
+satisfy the following conditions:
+
+You must retain the complete text of this software license in redistributions of
+the FDK AAC Codec or your modifications thereto in source code form.
+
+You must retain the complete text of this software license in the documentation
+and/or other materials provided with redistributions of the FDK AAC Codec or
+your modifications thereto in binary form. You must make available free of
+charge copies of the complete source code of the FDK AAC Codec and your
+modifications thereto to recipients of copies in binary form.
+
+The name of Fraunhofer may not be used to endorse or promote products derived
+from this library without prior written permission.
+
+You may not charge copyright license fees for anyone to use, copy or distribute
+the FDK AAC Codec software or your modifications thereto.
+
+Your modified versions of the FDK AAC Codec must carry prominent notices stating
+that you changed the software and the date of any change. For modified versions
+of the FDK AAC Codec, the term "Fraunhofer FDK AAC Codec Library for Android"
+must be replaced by the term "Third-Party Modified Version of the Fraunhofer FDK
+AAC Codec Library for Android."
+
+3.    NO PATENT LICENSE
+
+NO EXPRESS OR IMPLIED LICENSES TO ANY PATENT CLAIMS, including without
+limitation the patents of Fraunhofer, ARE GRANTED BY THIS SOFTWARE LICENSE.
+Fraunhofer provides no warranty of patent non-infringement with respect to this
+software.
+
+You may use this FDK AAC Codec software or modifications thereto only for
+purposes that are authorized by appropriate patent licenses.
+
+4.    DISCLAIMER
+
+This FDK AAC Codec software is provided by Fraunhofer on behalf of the copyright
+holders and contributors "AS IS" and WITHOUT ANY EXPRESS OR IMPLIED WARRANTIES,
+including but not limited to the implied warranties of merchantability and
+fitness for a particular purpose. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+CONTRIBUTORS BE LIABLE for any direct, indirect, incidental, special, exemplary,
+or consequential damages, including but not limited to procurement of substitute
+goods or services; loss of use, data, or profits, or business interruption,
+however caused and on any theory of liability, whether in contract, strict
+liability, or tort (including negligence), arising in any way out of the use of
+this software, even if advised of the possibility of such damage.
+
+5.    CONTACT INFORMATION
+
+Fraunhofer Institute for Integrated Circuits IIS
+Attention: Audio and Multimedia Departments - FDK AAC LL
+Am Wolfsmantel 33
+91058 Erlangen, Germany
+
+www.iis.fraunhofer.de/amm
+amm-info@iis.fraunhofer.de
+----------------------------------------------------------------------------- */
+
+/**************************** AAC encoder library ******************************
+
+   Description: Quantization of whole bands with SSE4.1 and AVX2
+
+*******************************************************************************/
+
+/* The kernels compute the same values as FDKaacEnc_quantizeLines() with the
+   x86 definition of fMultDiv2(), without branches on the sign of the lines:
+
+   - the leading bit and the table index come from the exponent and the top
+     of the mantissa of the line converted to float. The conversion is exact,
+     values that need more than 24 bits are shifted right by 8 first.
+   - variable shifts use the count modulo 32, like the shift instructions the
+     compiler emits for the scalar code, so that even lines that violate
+     MAX_QUANT give the same result.
+   - the sign of the input is applied with PSIGND, which also gives 0 for
+     lines that are 0.
+
+   The SSE4.1 version shifts with a ladder of blends, and reads the table
+   lane by lane. The version is selected once, according to the CPU.
+
+   The inverse quantization stays scalar: with three table gathers per eight
+   lines, an AVX2 version was only 10% faster than the scalar code. */
+
+#ifndef __INCLUDE_QUANTIZE_X86__
+#define __INCLUDE_QUANTIZE_X86__
+
+#include <immintrin.h>
+
+#define FUNCTION_FDKaacEnc_quantizeBand
+
+/* Table widened to 32 bits, so that it can be gathered */
+static INT FDKaacEnc_mTab_3_4_x86[MANT_SIZE];
+
+/* The scalar function, then the kernels the CPU supports */
+static QUANTIZE_BAND_KERNEL FDKaacEnc_quantizeBandKernels[3] = {
+    {"scalar", FDKaacEnc_quantizeLines}};
+static INT FDKaacEnc_numQuantizeBandKernels = 1;
+
+static QUANTIZE_BAND_FN FDKaacEnc_quantizeBandFn = FDKaacEnc_quantizeLines;
+
+static inline INT FDKaacEnc_quantizeK(INT dZoneQuantEnable) {
+  const INT kShift = 16;
+
+  if (dZoneQuantEnable)
+    return FL2FXCONST_DBL(0.23f) >> kShift;
+  else
+    return FL2FXCONST_DBL(-0.0946f + 0.5f) >> kShift;
+}
+
+/*****************************************************************************
+    SSE4.1
+*****************************************************************************/
+
+/* High 32 bits of the signed products, fMultDiv2() of two FIXP_DBL */
+__attribute__((target("sse4.1"))) static inline __m128i
+FDKaacEnc_mulHigh_sse41(__m128i a, __m128i b) {
+  const __m128i even = _mm_srli_epi64(_mm_mul_epi32(a, b), 32);
+  const __m128i odd =
+      _mm_mul_epi32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+  return _mm_blend_epi16(even, odd, 0xCC);
+}
+
+/* Take b in the lanes where bit n of count is set */
+#define SELECT_BIT_SSE41(a, b, count, n)            \
+  _mm_castps_si128(_mm_blendv_ps(                   \
+      _mm_castsi128_ps(a), _mm_castsi128_ps(b),     \
+      _mm_castsi128_ps(_mm_slli_epi32(count, 31 - (n)))))
+
+__attribute__((target("sse4.1"))) static inline __m128i
+FDKaacEnc_srav_sse41(__m128i v, __m128i count) {
+  v = SELECT_BIT_SSE41(v, _mm_srai_epi32(v, 1), count, 0);
+  v = SELECT_BIT_SSE41(v, _mm_srai_epi32(v, 2), count, 1);
+  v = SELECT_BIT_SSE41(v, _mm_srai_epi32(v, 4), count, 2);
+  v = SELECT_BIT_SSE41(v, _mm_srai_epi32(v, 8), count, 3);
+  v = SELECT_BIT_SSE41(v, _mm_srai_epi32(v, 16), count, 4);
+  return v;
+}
+
+#undef SELECT_BIT_SSE41
+
+__attribute__((target("sse4.1"))) static inline __m128i
+FDKaacEnc_lookup_sse41(const INT *table, __m128i index) {
+  return _mm_setr_epi32(table[_mm_cvtsi128_si32(index)],
+                        table[_mm_extract_epi32(index, 1)],
+                        table[_mm_extract_epi32(index, 2)],
+                        table[_mm_extract_epi32(index, 3)]);
+}
+
+/* Exponent of the leading bit and table index of positive values */
+__attribute__((target("sse4.1"))) static inline void
+FDKaacEnc_normalize_sse41(__m128i a, __m128i *exponent, __m128i *tabIndex) {
+  const __m128i big = _mm_cmpgt_epi32(a, _mm_set1_epi32(0xFFFFFF));
+  const __m128i v = _mm_blendv_epi8(a, _mm_srli_epi32(a, 8), big);
+  const __m128i bits = _mm_castps_si128(_mm_cvtepi32_ps(v));
+
+  *exponent = _mm_add_epi32(
+      _mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)),
+      _mm_and_si128(big, _mm_set1_epi32(8)));
+  *tabIndex = _mm_and_si128(_mm_srli_epi32(bits, 23 - MANT_DIGITS),
+                            _mm_set1_epi32(MANT_SIZE - 1));
+}
+
+__attribute__((target("sse4.1"))) static void FDKaacEnc_quantizeBand_sse41(
+    INT gain, INT noOfLines, const FIXP_DBL *mdctSpectrum, SHORT *quaSpectrum,
+    INT dZoneQuantEnable) {
+  const INT n = noOfLines & ~3;
+  const __m128i quantizer =
+      _mm_set1_epi32(FX_SGL2FX_DBL(FDKaacEnc_quantTableQ[(-gain) & 3]));
+  /* totalShift = quantizershift - accuShift + 1, with accuShift = 30 - e */
+  const __m128i shiftBase = _mm_set1_epi32(((-gain) >> 2) + 1 - 30 + 1);
+  const __m128i k = _mm_set1_epi32(FDKaacEnc_quantizeK(dZoneQuantEnable));
+  const __m128i tableE = _mm_setr_epi32(
+      FDKaacEnc_quantTableE[0], FDKaacEnc_quantTableE[1],
+      FDKaacEnc_quantTableE[2], FDKaacEnc_quantTableE[3]);
+  const __m128i byteSpread =
+      _mm_setr_epi8(0, 0, 0, 0, 4, 4, 4, 4, 8, 8, 8, 8, 12, 12, 12, 12);
+  const __m128i byteOffset = _mm_set1_epi32(0x03020100);
+  int line;
+
+  for (line = 0; line < n; line += 4) {
+    const __m128i spec =
+        _mm_loadu_si128((const __m128i *)(mdctSpectrum + line));
+    const __m128i accu = FDKaacEnc_mulHigh_sse41(spec, quantizer);
+
+    __m128i exponent, tabIndex;
+    FDKaacEnc_normalize_sse41(_mm_abs_epi32(accu), &exponent, &tabIndex);
+
+    const __m128i totalShift = _mm_add_epi32(shiftBase, exponent);
+
+    /* FDKaacEnc_quantTableE[totalShift & 3], with PSHUFB */
+    const __m128i eIndex = _mm_add_epi32(
+        _mm_shuffle_epi8(
+            _mm_slli_epi32(_mm_and_si128(totalShift, _mm_set1_epi32(3)), 2),
+            byteSpread),
+        byteOffset);
+    __m128i value = _mm_mullo_epi32(
+        FDKaacEnc_lookup_sse41(FDKaacEnc_mTab_3_4_x86, tabIndex),
+        _mm_shuffle_epi8(tableE, eIndex));
+
+    const __m128i e4 = _mm_srai_epi32(totalShift, 2);
+    __m128i shift = _mm_sub_epi32(
+        _mm_set1_epi32(16 - 4), _mm_add_epi32(e4, _mm_add_epi32(e4, e4)));
+    shift = _mm_and_si128(_mm_min_epi32(shift, _mm_set1_epi32(DFRACT_BITS - 1)),
+                          _mm_set1_epi32(31));
+    value = FDKaacEnc_srav_sse41(value, shift);
+
+    value = _mm_srai_epi32(_mm_add_epi32(k, value), DFRACT_BITS - 1 - 16);
+    value = _mm_sign_epi32(value, accu);
+
+    _mm_storel_epi64((__m128i *)(quaSpectrum + line),
+                     _mm_packs_epi32(value, value));
+  }
+
+  if (n < noOfLines) {
+    FDKaacEnc_quantizeLines(gain, noOfLines - n, mdctSpectrum + n,
+                            quaSpectrum + n, dZoneQuantEnable);
+  }
+}
+
+/*****************************************************************************
+    AVX2
+*****************************************************************************/
+
+__attribute__((target("avx2"))) static inline __m256i FDKaacEnc_mulHigh_avx2(
+    __m256i a, __m256i b) {
+  const __m256i even = _mm256_srli_epi64(_mm256_mul_epi32(a, b), 32);
+  const __m256i odd =
+      _mm256_mul_epi32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+  return _mm256_blend_epi32(even, odd, 0xAA);
+}
+
+__attribute__((target("avx2"))) static inline void FDKaacEnc_normalize_avx2(
+    __m256i a, __m256i *exponent, __m256i *tabIndex) {
+  const __m256i big = _mm256_cmpgt_epi32(a, _mm256_set1_epi32(0xFFFFFF));
+  const __m256i v = _mm256_blendv_epi8(a, _mm256_srli_epi32(a, 8), big);
+  const __m256i bits = _mm256_castps_si256(_mm256_cvtepi32_ps(v));
+
+  *exponent = _mm256_add_epi32(
+      _mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127)),
+      _mm256_and_si256(big, _mm256_set1_epi32(8)));
+  *tabIndex = _mm256_and_si256(_mm256_srli_epi32(bits, 23 - MANT_DIGITS),
+                               _mm256_set1_epi32(MANT_SIZE - 1));
+}
+
+__attribute__((target("avx2"))) static void FDKaacEnc_quantizeBand_avx2(
+    INT gain, INT noOfLines, const FIXP_DBL *mdctSpectrum, SHORT *quaSpectrum,
+    INT dZoneQuantEnable) {
+  const INT n = noOfLines & ~7;
+  const __m256i quantizer =
+      _mm256_set1_epi32(FX_SGL2FX_DBL(FDKaacEnc_quantTableQ[(-gain) & 3]));
+  const __m256i shiftBase = _mm256_set1_epi32(((-gain) >> 2) + 1 - 30 + 1);
+  const __m256i k = _mm256_set1_epi32(FDKaacEnc_quantizeK(dZoneQuantEnable));
+  const __m256i tableE = _mm256_setr_epi32(
+      FDKaacEnc_quantTableE[0], FDKaacEnc_quantTableE[1],
+      FDKaacEnc_quantTableE[2], FDKaacEnc_quantTableE[3],
+      FDKaacEnc_quantTableE[0], FDKaacEnc_quantTableE[1],
+      FDKaacEnc_quantTableE[2], FDKaacEnc_quantTableE[3]);
+  int line;
+
+  for (line = 0; line < n; line += 8) {
+    const __m256i spec =
+        _mm256_loadu_si256((const __m256i *)(mdctSpectrum + line));
+    const __m256i accu = FDKaacEnc_mulHigh_avx2(spec, quantizer);
+
+    __m256i exponent, tabIndex;
+    FDKaacEnc_normalize_avx2(_mm256_abs_epi32(accu), &exponent, &tabIndex);
+
+    const __m256i totalShift = _mm256_add_epi32(shiftBase, exponent);
+
+    __m256i value = _mm256_mullo_epi32(
+        _mm256_i32gather_epi32(FDKaacEnc_mTab_3_4_x86, tabIndex, 4),
+        _mm256_permutevar8x32_epi32(
+            tableE, _mm256_and_si256(totalShift, _mm256_set1_epi32(3))));
+
+    const __m256i e4 = _mm256_srai_epi32(totalShift, 2);
+    __m256i shift = _mm256_sub_epi32(
+        _mm256_set1_epi32(16 - 4),
+        _mm256_add_epi32(e4, _mm256_add_epi32(e4, e4)));
+    shift = _mm256_and_si256(
+        _mm256_min_epi32(shift, _mm256_set1_epi32(DFRACT_BITS - 1)),
+        _mm256_set1_epi32(31));
+    value = _mm256_srav_epi32(value, shift);
+
+    value =
+        _mm256_srai_epi32(_mm256_add_epi32(k, value), DFRACT_BITS - 1 - 16);
+    value = _mm256_sign_epi32(value, accu);
+
+    _mm_storeu_si128((__m128i *)(quaSpectrum + line),
+                     _mm_packs_epi32(_mm256_castsi256_si128(value),
+                                     _mm256_extracti128_si256(value, 1)));
+  }
+
+  /* bands of 4 lines are common, the SSE4.1 version handles them */
+  if (n < noOfLines) {
+    FDKaacEnc_quantizeBand_sse41(gain, noOfLines - n, mdctSpectrum + n,
+                                 quaSpectrum + n, dZoneQuantEnable);
+  }
+}
+
+/*****************************************************************************
+    Selection of the version, before main()
+*****************************************************************************/
+
+static void FDKaacEnc_addQuantizeBandKernel(const char *name,
+                                            QUANTIZE_BAND_FN quantizeBand) {
+  QUANTIZE_BAND_KERNEL *kernel =
+      &FDKaacEnc_quantizeBandKernels[FDKaacEnc_numQuantizeBandKernels++];
+  kernel->name = name;
+  kernel->quantizeBand = quantizeBand;
+}
+
+__attribute__((constructor)) static void FDKaacEnc_quantizeInit_x86(void) {
+  int i;
+
+  for (i = 0; i < MANT_SIZE; i++) {
+    FDKaacEnc_mTab_3_4_x86[i] = FDKaacEnc_mTab_3_4[i];
+  }
+
+  /* the AVX2 version uses the SSE4.1 version for the last lines */
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse4.1")) {
+    FDKaacEnc_addQuantizeBandKernel("sse4.1", FDKaacEnc_quantizeBand_sse41);
+    if (__builtin_cpu_supports("avx2")) {
+      FDKaacEnc_addQuantizeBandKernel("avx2", FDKaacEnc_quantizeBand_avx2);
+    }
+  }
+
+  /* the last one is the fastest */
+  FDKaacEnc_quantizeBandFn =
+      FDKaacEnc_quantizeBandKernels[FDKaacEnc_numQuantizeBandKernels - 1]
+          .quantizeBand;
+}
+
+static inline void FDKaacEnc_quantizeBand(INT gain, INT noOfLines,
+                                          const FIXP_DBL *mdctSpectrum,
+                                          SHORT *quaSpectrum,
+                                          INT dZoneQuantEnable) {
+  FDKaacEnc_quantizeBandFn(gain, noOfLines, mdctSpectrum, quaSpectrum,
+                           dZoneQuantEnable);
+}
+
+#endif /* #ifndef __INCLUDE_QUANTIZE_X86__ */
@@ -125,8 +125,9 @@ typedef struct {
  */
 typedef struct {
   CCrcRegData crcRegData[MAX_CRC_REGS]; /*!< Multiple crc region description. */
-  const USHORT*
-      pCrcLookup; /*!< Pointer to lookup table filled in FDK_crcInit(). */
+  INT (*pCalcCrcBytes)(USHORT *const pCrc, HANDLE_FDK_BITSTREAM hBs,
+                       INT nBytes); /*!< Byte-wise crc calculation of the
+                                       polynom, set in FDK_crcInit(). */
 
   USHORT crcPoly;    /*!< CRC generator polynom. */
   USHORT crcMask;    /*!< CRC mask. */
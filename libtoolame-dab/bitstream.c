@@ -35,11 +35,9 @@
 /* You must have one frame in memory if you are in DAB mode                 */
 /* in conformity of the norme ETS 300 401 http://www.etsi.org               */
 /* see toollame.c                                                           */
-int minimum = MINIMUM;
-
-void bs_set_minimum(int min)
+void bs_set_minimum(Bit_stream_struc * bs, int min)
 {
-    minimum = min;
+    bs->minimum = min;
 }
 
 /* empty the buffer to the output device when the buffer becomes full */
@@ -81,6 +79,7 @@ void open_bit_stream_w (Bit_stream_struc * bs, int size)
     bs->mode = WRITE_MODE;
     bs->eob = FALSE;
     bs->eobs = FALSE;
+    bs->minimum = MINIMUM;
 }
 
 /*close the device containing the bit stream after a write process*/
@@ -103,6 +102,7 @@ void alloc_buffer (Bit_stream_struc * bs, int size)
 void desalloc_buffer (Bit_stream_struc * bs)
 {
     free (bs->buf);
+    bs->buf = NULL;
 }
 
 const int putmask[9] = { 0x0, 0x1, 0x3, 0x7, 0xf, 0x1f, 0x3f, 0x7f, 0xff };
@@ -118,7 +118,7 @@ void put1bit (Bit_stream_struc * bs, int bit)
         bs->buf_bit_idx = 8;
         bs->buf_byte_idx--;
         if (bs->buf_byte_idx < 0)
-            empty_buffer (bs, minimum);
+            empty_buffer (bs, bs->minimum);
         bs->buf[bs->buf_byte_idx] = 0;
     }
 }
@@ -142,7 +142,7 @@ void putbits (Bit_stream_struc * bs, unsigned int val, int N)
             bs->buf_bit_idx = 8;
             bs->buf_byte_idx--;
             if (bs->buf_byte_idx < 0)
-                empty_buffer (bs, minimum);
+                empty_buffer (bs, bs->minimum);
             bs->buf[bs->buf_byte_idx] = 0;
         }
         j -= k;
@@ -137,6 +137,9 @@ typedef struct
   int nch;			/* num channels: 1 for mono, 2 for stereo */
   int jsbound;			/* first band of joint stereo coding */
   int sblimit;			/* total number of sub bands */
+  int tablenum;			/* bit allocation table used by encode_new.c */
+  int vbrstats[15];		/* VBR bitrate index histogram */
+  int vbrframes;		/* frames since the VBR stats were printed */
 }
 frame_info;
 
@@ -154,6 +157,7 @@ typedef struct bit_stream_struc
   int mode;			/* bit stream open in read or write mode */
   int eob;			/* end of buffer index */
   int eobs;			/* end of bit stream flag */
+  int minimum;			/* bytes kept back for the DAB SCF-CRC */
   char format;
 
   /* format of file in rd mode (BINARY/ASCII) */
@@ -2,6 +2,7 @@
 #include <string.h>
 #include "common.h"
 #include "crc.h"
+#include "../contrib/crc.h"
 
 /*****************************************************************************
 *
@@ -42,17 +43,7 @@ void CRC_calc (frame_info * frame, unsigned int bit_alloc[2][SBLIMIT],
 
 void update_CRC (unsigned int data, unsigned int length, unsigned int *crc)
 {
-  unsigned int masking, carry;
-
-  masking = 1 << length;
-
-  while ((masking >>= 1)) {
-    carry = *crc & 0x8000;
-    *crc <<= 1;
-    if (!carry ^ !(data & masking))
-      *crc ^= CRC16_POLYNOMIAL;
-  }
-  *crc &= 0xffff;
+  *crc = crc16_mpa_bits (*crc, data, length);
 }
 
 void
@@ -99,15 +90,5 @@ CRC_calcDAB (frame_info * frame,
 
 void update_CRCDAB (unsigned int data, unsigned int length, unsigned int *crc)
 {
-  unsigned int masking, carry;
-
-  masking = 1 << length;
-
-  while ((masking >>= 1)) {
-    carry = *crc & 0x80;
-    *crc <<= 1;
-    if (!carry ^ !(data & masking))
-      *crc ^= CRC8_POLYNOMIAL;
-  }
-  *crc &= 0xff;
+  *crc = crc8_scf_bits (*crc, data, length);
 }
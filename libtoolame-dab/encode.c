@@ -7,8 +7,6 @@
 #include "availbits.h"
 #include "encode.h"
 
-int vbrstats[15] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
-
 /*  This segment contains all the core routines of the encoder,           
     except for the psychoacoustic models.                                 
     
@@ -529,46 +527,11 @@ void main_bit_allocation (double perm_smr[2][SBLIMIT],
      /* 32 */ {10, 14}}
   };
 
-  static int init = 0;
-  static int lower = 10, upper = 10;
-  static int bitrateindextobits[15] =
+  int lower = 10, upper = 10;
+  int bitrateindextobits[15] =
     { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
   int guessindex = 0;
 
-  if (init == 0) {
-    int nch = 1;
-    int sfreq;
-    frame_header *header = frame->header;
-    init++;
-    if (header->version == 0) {
-      /* LSF: so can use any bitrate index from 1->15 */
-      lower = 1;
-      upper = 14;
-    } else {
-      if (frame->actual_mode == MPG_MD_MONO)
-	nch = 0;
-      sfreq = header->sampling_frequency;
-      lower = vbrlimits[nch][sfreq][0];
-      upper = vbrlimits[nch][sfreq][1];
-    }
-    if (glopts->verbosity > 2)
-      fprintf (stdout, "VBR bitrate index limits [%i -> %i]\n", lower, upper);
-
-    {				
-      /* set up a conversion table for bitrateindex->bits for this version/sampl freq 
-	 This will be used to find the best bitrate to cope with the number of bits that
-	 are needed (as determined by VBR_bits_for_nonoise) */
-      int brindex;
-      frame_header *header = frame->header;
-      for (brindex = lower; brindex <= upper; brindex++) {
-	bitrateindextobits[brindex] =
-	  (int) (1152.0 / s_freq[header->version][header->sampling_frequency]) *
-	  ((double) bitrate[header->version][brindex]);
-      }
-    }
-
-  }
-
   if ((mode = frame->actual_mode) == MPG_MD_JOINT_STEREO) {
     frame->header->mode = MPG_MD_STEREO;
     frame->header->mode_ext = 0;
@@ -593,6 +556,38 @@ void main_bit_allocation (double perm_smr[2][SBLIMIT],
     noisy_sbs = a_bit_allocation (perm_smr, scfsi, bit_alloc, adb, frame);
   } else {			
     /* do the VBR bit allocation method */
+    {
+      int nch = 1;
+      int sfreq;
+      frame_header *header = frame->header;
+      if (header->version == 0) {
+	/* LSF: so can use any bitrate index from 1->15 */
+	lower = 1;
+	upper = 14;
+      } else {
+	if (frame->actual_mode == MPG_MD_MONO)
+	  nch = 0;
+	sfreq = header->sampling_frequency;
+	lower = vbrlimits[nch][sfreq][0];
+	upper = vbrlimits[nch][sfreq][1];
+      }
+      if (glopts->verbosity > 2 && frame->vbrframes == 0)
+	fprintf (stdout, "VBR bitrate index limits [%i -> %i]\n", lower, upper);
+    }
+
+    {
+      /* set up a conversion table for bitrateindex->bits for this version/sampl freq 
+	 This will be used to find the best bitrate to cope with the number of bits that
+	 are needed (as determined by VBR_bits_for_nonoise) */
+      int brindex;
+      frame_header *header = frame->header;
+      for (brindex = lower; brindex <= upper; brindex++) {
+	bitrateindextobits[brindex] =
+	  (int) (1152.0 / s_freq[header->version][header->sampling_frequency]) *
+	  ((double) bitrate[header->version][brindex]);
+      }
+    }
+
     frame->header->bitrate_index = lower;
     *adb = available_bits (frame->header, glopts);
     {
@@ -627,15 +622,14 @@ void main_bit_allocation (double perm_smr[2][SBLIMIT],
     *adb = available_bits (frame->header, glopts);
 
     /* update the statistics */
-    vbrstats[frame->header->bitrate_index]++;
+    frame->vbrstats[frame->header->bitrate_index]++;
 
     if (glopts->verbosity > 2) {
       /* print out the VBR stats every 1000th frame */
-      static int count = 0;
       int i;
-      if ((count++ % 1000) == 0) {
+      if ((frame->vbrframes++ % 1000) == 0) {
 	for (i = 1; i < 15; i++)
-	  fprintf (stdout, "%4i ", vbrstats[i]);
+	  fprintf (stdout, "%4i ", frame->vbrstats[i]);
 	fprintf (stdout, "\n");
       }
 
@@ -697,15 +691,11 @@ VBR_bit_allocation (double perm_smr[2][SBLIMIT],
   int sblimit = frame->sblimit;
   int jsbound = frame->jsbound;
   al_table *alloc = frame->alloc;
-  static char init = 0;
-  static int banc = 32, berr = 0;
+  int banc = 32, berr = 0;
   static int sfsPerScfsi[] = { 3, 2, 1, 2 };	/* lookup # sfs per scfsi */
 
-  if (!init) {
-    init = 1;
-    if (frame->header->error_protection)
-      berr = 16;		/* added 92-08-11 shn */
-  }
+  if (frame->header->error_protection)
+    berr = 16;			/* added 92-08-11 shn */
 
   for (i = 0; i < jsbound; ++i)
     bbal += nch * (*alloc)[i][0].bits;
@@ -844,8 +834,7 @@ int a_bit_allocation (double perm_smr[2][SBLIMIT],
   int sblimit = frame->sblimit;
   int jsbound = frame->jsbound;
   al_table *alloc = frame->alloc;
-  static char init = 0;
-  static int banc = 32, berr = 0;
+  int banc = 32, berr = 0;
   static int sfsPerScfsi[] = { 3, 2, 1, 2 };	/* lookup # sfs per scfsi */
 
 #define CHECKITERx
@@ -853,11 +842,8 @@ int a_bit_allocation (double perm_smr[2][SBLIMIT],
   int count=0;
 #endif
 
-  if (!init) {
-    init = 1;
-    if (frame->header->error_protection)
-      berr = 16;		/* added 92-08-11 shn */
-  }
+  if (frame->header->error_protection)
+    berr = 16;			/* added 92-08-11 shn */
 
   for (i = 0; i < jsbound; ++i)
     bbal += nch * (*alloc)[i][0].bits;
@@ -8,7 +8,6 @@
 #include "encode_new.h"
 
 #define NUMTABLES 5
-int vbrstats_new[15] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
 
 /* There are really only 9 distinct lines in the allocation tables 
    each member of this table is an index into */
@@ -99,10 +98,8 @@ static double SNR[18] = { 0.00, 7.00, 11.00, 16.00, 20.84,
   80.03, 86.05, 92.01, 98.01
 };
 
-int tablenum=0;
-
 int encode_init(frame_info *frame) {
-  int ws, bsp, br_per_ch, sfrq;
+  int ws, bsp, br_per_ch, sfrq, tablenum;
 
   bsp = frame->header->bitrate_index;
   br_per_ch = bitrate[frame->header->version][bsp] / frame->nch;
@@ -122,6 +119,7 @@ int encode_init(frame_info *frame) {
   } else {                      /* MPEG-2 LSF */
     tablenum = 4;
   }
+  frame->tablenum = tablenum;
   fprintf(stderr,"toolame-dab encode_init(): using tablenum %i with sblimit %i\n",tablenum, table_sblimit[tablenum]);
 
 #define DUMPTABLESx
@@ -391,10 +389,10 @@ void write_bit_alloc (unsigned int bit_alloc[2][SBLIMIT],
   for (sb = 0; sb < sblimit; sb++) {
     if (sb < jsbound) {
       for (ch = 0; ch < ((sb < jsbound) ? nch : 1); ch++)
-        putbits (bs, bit_alloc[ch][sb], nbal[ line[tablenum][sb] ]); // (*alloc)[sb][0].bits);
+        putbits (bs, bit_alloc[ch][sb], nbal[ line[frame->tablenum][sb] ]); // (*alloc)[sb][0].bits);
     }
     else
-      putbits (bs, bit_alloc[0][sb], nbal[ line[tablenum][sb] ]); //(*alloc)[sb][0].bits);
+      putbits (bs, bit_alloc[0][sb], nbal[ line[frame->tablenum][sb] ]); //(*alloc)[sb][0].bits);
   }
 }
 
@@ -515,7 +513,7 @@ subband_quantization_new (unsigned int sf_index[2][3][SBLIMIT],
             
             {
               /* 'index' indicates which "step line" we are using */
-              int index = line[tablenum][sb];
+              int index = line[frame->tablenum][sb];
               
               /* Find the "step index" within that line */
               qnt_coeff_index = step_index[index][bit_alloc[ch][sb]];
@@ -573,7 +571,7 @@ void write_samples_new (unsigned int sbband[2][3][SCALE_BLOCK][SBLIMIT],
         for (ch = 0; ch < ((sb < jsbound) ? nch : 1); ch++)
 
           if (bit_alloc[ch][sb]) {
-            int thisline = line[tablenum][sb];
+            int thisline = line[frame->tablenum][sb];
             int thisstep_index = step_index[thisline][bit_alloc[ch][sb]];
             /* Check how many samples per codeword */
             if (group[thisstep_index] == 3) {
@@ -660,17 +658,17 @@ int bits_for_nonoise_new (double SMR[2][SBLIMIT],
      channels in each subband. If we're above the jsbound, then pretend we only
      have one channel */
   for (sb = 0; sb < jsbound; ++sb)
-    bbal += nch * nbal[ line[tablenum][sb] ]; //(*alloc)[sb][0].bits;
+    bbal += nch * nbal[ line[frame->tablenum][sb] ]; //(*alloc)[sb][0].bits;
   for (sb = jsbound; sb < sblimit; ++sb)
-    bbal += nbal[ line[tablenum][sb] ]; //(*alloc)[sb][0].bits;
+    bbal += nbal[ line[frame->tablenum][sb] ]; //(*alloc)[sb][0].bits;
   req_bits = banc + bbal + berr;
 
   for (sb = 0; sb < sblimit; ++sb)
     for (ch = 0; ch < ((sb < jsbound) ? nch : 1); ++ch) {
-      int thisline = line[tablenum][sb];
+      int thisline = line[frame->tablenum][sb];
       
       /* How many possible steps are there to choose from ? */
-      maxAlloc = (1 << nbal[ line[tablenum][sb] ]) -1; //(*alloc)[sb][0].bits) - 1;
+      maxAlloc = (1 << nbal[ line[frame->tablenum][sb] ]) -1; //(*alloc)[sb][0].bits) - 1;
       sel_bits = sc_bits = smp_bits = 0;
       /* Keep choosing the next number of steps (and hence our SNR value)
          until we have the required MNR value */
@@ -760,46 +758,11 @@ void main_bit_allocation_new (double SMR[2][SBLIMIT],
      /* 32 */ {10, 14}}
   };
 
-  static int init = 0;
-  static int lower = 10, upper = 10;
-  static int bitrateindextobits[15] =
+  int lower = 10, upper = 10;
+  int bitrateindextobits[15] =
     { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
   int guessindex = 0;
 
-  if (init == 0) {
-    int nch = 2;
-    int sfreq;
-    frame_header *header = frame->header;
-    init++;
-    if (header->version == 0) {
-      /* LSF: so can use any bitrate index from 1->15 */
-      lower = 1;
-      upper = 14;
-    } else {
-      if (frame->actual_mode == MPG_MD_MONO)
-        nch = 1;
-      sfreq = header->sampling_frequency;
-      lower = vbrlimits[nch-1][sfreq][0];
-      upper = vbrlimits[nch-1][sfreq][1];
-    }
-    if (glopts->verbosity > 2)
-      fprintf (stderr, "VBR bitrate index limits [%i -> %i]\n", lower, upper);
-
-    {                           
-      /* set up a conversion table for bitrateindex->bits for this version/sampl freq 
-         This will be used to find the best bitrate to cope with the number of bits that
-         are needed (as determined by VBR_bits_for_nonoise) */
-      int brindex;
-      frame_header *header = frame->header;
-      for (brindex = lower; brindex <= upper; brindex++) {
-        bitrateindextobits[brindex] =
-          (int) (1152.0 / s_freq[header->version][header->sampling_frequency]) *
-          ((double) bitrate[header->version][brindex]);
-      }
-    }
-
-  }
-
   if ((mode = frame->actual_mode) == MPG_MD_JOINT_STEREO) {
     frame->header->mode = MPG_MD_STEREO;
     frame->header->mode_ext = 0;
@@ -824,6 +787,38 @@ void main_bit_allocation_new (double SMR[2][SBLIMIT],
     noisy_sbs = a_bit_allocation_new (SMR, scfsi, bit_alloc, adb, frame);
   } else {                      
     /* do the VBR bit allocation method */
+    {
+      int nch = 2;
+      int sfreq;
+      frame_header *header = frame->header;
+      if (header->version == 0) {
+        /* LSF: so can use any bitrate index from 1->15 */
+        lower = 1;
+        upper = 14;
+      } else {
+        if (frame->actual_mode == MPG_MD_MONO)
+          nch = 1;
+        sfreq = header->sampling_frequency;
+        lower = vbrlimits[nch-1][sfreq][0];
+        upper = vbrlimits[nch-1][sfreq][1];
+      }
+      if (glopts->verbosity > 2 && frame->vbrframes == 0)
+        fprintf (stderr, "VBR bitrate index limits [%i -> %i]\n", lower, upper);
+    }
+
+    {
+      /* set up a conversion table for bitrateindex->bits for this version/sampl freq 
+         This will be used to find the best bitrate to cope with the number of bits that
+         are needed (as determined by VBR_bits_for_nonoise) */
+      int brindex;
+      frame_header *header = frame->header;
+      for (brindex = lower; brindex <= upper; brindex++) {
+        bitrateindextobits[brindex] =
+          (int) (1152.0 / s_freq[header->version][header->sampling_frequency]) *
+          ((double) bitrate[header->version][brindex]);
+      }
+    }
+
     frame->header->bitrate_index = lower;
     *adb = available_bits (frame->header, glopts);
     {
@@ -858,15 +853,14 @@ void main_bit_allocation_new (double SMR[2][SBLIMIT],
     *adb = available_bits (frame->header, glopts);
 
     /* update the statistics */
-    vbrstats_new[frame->header->bitrate_index]++;
+    frame->vbrstats[frame->header->bitrate_index]++;
 
     if (glopts->verbosity > 2) {
       /* print out the VBR stats every 1000th frame */
-      static int count = 0;
       int i;
-      if ((count++ % 1000) == 0) {
+      if ((frame->vbrframes++ % 1000) == 0) {
         for (i = 1; i < 15; i++)
-          fprintf (stderr, "%4i ", vbrstats_new[i]);
+          fprintf (stderr, "%4i ", frame->vbrstats[i]);
         fprintf (stderr, "\n");
       }
 
@@ -944,21 +938,17 @@ int VBR_bit_allocation_new (double SMR[2][SBLIMIT],
   int sblimit = frame->sblimit;
   int jsbound = frame->jsbound;
   //al_table *alloc = frame->alloc;
-  static char init = 0;
-  static int banc = 32, berr = 0;
+  int banc = 32, berr = 0;
   static int sfsPerScfsi[] = { 3, 2, 1, 2 };    /* lookup # sfs per scfsi */
 
   int thisstep_index;
 
-  if (!init) {
-    init = 1;
-    if (frame->header->error_protection)
-      berr = 16;                /* added 92-08-11 shn */
-  }
+  if (frame->header->error_protection)
+    berr = 16;                  /* added 92-08-11 shn */
 
   /* No need to worry about jsbound here as JS is disabled for VBR mode */
   for (sb = 0; sb < sblimit; sb++)
-    bbal += nch * nbal[ line[tablenum][sb] ]; 
+    bbal += nch * nbal[ line[frame->tablenum][sb] ]; 
   *adb -= bbal + berr + banc;
   ad = *adb;
 
@@ -975,7 +965,7 @@ int VBR_bit_allocation_new (double SMR[2][SBLIMIT],
     VBR_maxmnr_new (mnr, used, sblimit, nch, &min_sb, &min_ch, glopts);
 
     if (min_sb > -1) {          /* there was something to find */
-      int thisline = line[tablenum][min_sb]; {
+      int thisline = line[frame->tablenum][min_sb]; {
         /* find increase in bit allocation in subband [min] */
         int nextstep_index = step_index[thisline][bit_alloc[min_ch][min_sb]+1];                                   
         increment = SCALE_BLOCK * group[nextstep_index] * bits[nextstep_index];
@@ -1013,7 +1003,7 @@ int VBR_bit_allocation_new (double SMR[2][SBLIMIT],
         thisstep_index = step_index[thisline][ba];
         mnr[min_ch][min_sb] = SNR[thisstep_index] - SMR[min_ch][min_sb];
         /* Check if this min_sb subband has been fully allocated max bits */
-        if (ba >= (1 << nbal[ line[tablenum][min_sb] ]) -1 ) //(*alloc)[min_sb][0].bits) - 1)
+        if (ba >= (1 << nbal[ line[frame->tablenum][min_sb] ]) -1 ) //(*alloc)[min_sb][0].bits) - 1)
           used[min_ch][min_sb] = 2;     /* don't let this sb get any more bits */
       } else
         used[min_ch][min_sb] = 2;       /* can't increase this alloc */
@@ -1088,22 +1078,18 @@ int a_bit_allocation_new (double SMR[2][SBLIMIT],
   int sblimit = frame->sblimit;
   int jsbound = frame->jsbound;
   //al_table *alloc = frame->alloc;
-  static char init = 0;
-  static int banc = 32, berr = 0;
+  int banc = 32, berr = 0;
   static int sfsPerScfsi[] = { 3, 2, 1, 2 };    /* lookup # sfs per scfsi */
 
   int thisstep_index;
 
-  if (!init) {
-    init = 1;
-    if (frame->header->error_protection)
-      berr = 16;                /* added 92-08-11 shn */
-  }
+  if (frame->header->error_protection)
+    berr = 16;                  /* added 92-08-11 shn */
 
   for (sb = 0; sb < jsbound; sb++)
-    bbal += nch * nbal[ line[tablenum][sb] ]; //(*alloc)[sb][0].bits;
+    bbal += nch * nbal[ line[frame->tablenum][sb] ]; //(*alloc)[sb][0].bits;
   for (sb = jsbound; sb < sblimit; sb++)
-    bbal += nbal[ line[tablenum][sb] ]; //(*alloc)[sb][0].bits;
+    bbal += nbal[ line[frame->tablenum][sb] ]; //(*alloc)[sb][0].bits;
   *adb -= bbal + berr + banc;
   ad = *adb;
 
@@ -1120,7 +1106,7 @@ int a_bit_allocation_new (double SMR[2][SBLIMIT],
     maxmnr_new (mnr, used, sblimit, nch, &min_sb, &min_ch);
 
     if (min_sb > -1) {          /* there was something to find */
-      int thisline = line[tablenum][min_sb]; {
+      int thisline = line[frame->tablenum][min_sb]; {
         /* find increase in bit allocation in subband [min] */
         int nextstep_index = step_index[thisline][bit_alloc[min_ch][min_sb]+1];                                   
         increment = SCALE_BLOCK * group[nextstep_index] * bits[nextstep_index];
@@ -1158,7 +1144,7 @@ int a_bit_allocation_new (double SMR[2][SBLIMIT],
         thisstep_index = step_index[thisline][ba];
         mnr[min_ch][min_sb] = SNR[thisstep_index] - SMR[min_ch][min_sb];
         /* Check if this min_sb subband has been fully allocated max bits */
-        if (ba >= (1 << nbal[ line[tablenum][min_sb] ]) -1 ) //(*alloc)[min_sb][0].bits) - 1)
+        if (ba >= (1 << nbal[ line[frame->tablenum][min_sb] ]) -1 ) //(*alloc)[min_sb][0].bits) - 1)
           used[min_ch][min_sb] = 2;     /* don't let this sb get any more bits */
       } else
         used[min_ch][min_sb] = 2;       /* can't increase this alloc */
@@ -22,6 +22,5 @@ typedef struct
 }
 options;
 
-extern options glopts;
 #endif
 
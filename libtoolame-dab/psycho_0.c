@@ -3,8 +3,13 @@
 #include "common.h"
 #include "ath.h"
 #include "encoder.h"
+#include "mem.h"
 #include "psycho_0.h"
 
+struct psycho_0_mem_s {
+  FLOAT ath_min[SBLIMIT];
+};
+
 /* MFC Mar 03
    It's almost obscene how well this psycho model works for the amount of 
    computational effort that's put in.
@@ -24,28 +29,34 @@
    Feel free to make any sort of generic change you want. Add or subtract numbers, take
    logs, whatever. Fiddle with the numbers until we get a good SMR output */
 
-void psycho_0(double SMR[2][SBLIMIT], int nch, unsigned int scalar[2][3][SBLIMIT], FLOAT sfreq) {
+static psycho_0_mem *psycho_0_init(FLOAT sfreq) {
+  psycho_0_mem *mem;
+  FLOAT freqperline = sfreq/1024.0;
+  int i, sb;
+
+  mem = (psycho_0_mem *) mem_alloc (sizeof (psycho_0_mem), "psycho_0_mem");
+  for (sb=0;sb<SBLIMIT;sb++) {
+    mem->ath_min[sb] = 1000; /* set it huge */
+  }
+
+  /* Find the minimum ATH in each subband */
+  for (i=0;i<512;i++) {
+    FLOAT thisfreq = i * freqperline;
+    FLOAT ath_val = ATH_dB(thisfreq, 0);
+    if (ath_val < mem->ath_min[i>>4])
+      mem->ath_min[i>>4] = ath_val;
+  }
+  return mem;
+}
+
+void psycho_0(psycho_0_mem **mem, double SMR[2][SBLIMIT], int nch, unsigned int scalar[2][3][SBLIMIT], FLOAT sfreq) {
   int ch, sb, gr;
   int minscaleindex[2][SBLIMIT]; /* Smaller scale indexes mean bigger scalefactors */
-  static FLOAT ath_min[SBLIMIT];
-  int i;
-  static int init=0;
+  FLOAT *ath_min;
 
-  if (!init) {
-    FLOAT freqperline = sfreq/1024.0;
-    for (sb=0;sb<SBLIMIT;sb++) {
-      ath_min[sb] = 1000; /* set it huge */
-    }
-    
-    /* Find the minimum ATH in each subband */
-    for (i=0;i<512;i++) {
-      FLOAT thisfreq = i * freqperline;
-      FLOAT ath_val = ATH_dB(thisfreq, 0);
-      if (ath_val < ath_min[i>>4])
-	ath_min[i>>4] = ath_val;
-    }
-    init++;
-  }
+  if (*mem == NULL)
+    *mem = psycho_0_init(sfreq);
+  ath_min = (*mem)->ath_min;
 
   /* Find the minimum scalefactor index for each ch/sb */
   for (ch=0;ch<nch;ch++) 
@@ -67,3 +78,7 @@ void psycho_0(double SMR[2][SBLIMIT], int nch, unsigned int scalar[2][3][SBLIMIT
     for (sb=0;sb<SBLIMIT;sb++)
       SMR[ch][sb] = 2.0 * (30.0 - minscaleindex[ch][sb]) - ath_min[sb];
 }
+
+void psycho_0_deinit(psycho_0_mem **mem) {
+  mem_free ((void **) mem);
+}
@@ -1 +1,4 @@
-void psycho_0(double SMR[2][SBLIMIT], int nch, unsigned int scalar[2][3][SBLIMIT], FLOAT sfreq);
+typedef struct psycho_0_mem_s psycho_0_mem;
+
+void psycho_0(psycho_0_mem **mem, double SMR[2][SBLIMIT], int nch, unsigned int scalar[2][3][SBLIMIT], FLOAT sfreq);
+void psycho_0_deinit(psycho_0_mem **mem);
@@ -1,2 +1,4 @@
+typedef struct psycho_1_mem_s psycho_1_mem;
 
-void psycho_1 (short[2][1152], double[2][SBLIMIT], double[2][SBLIMIT], frame_info *);
+void psycho_1 (psycho_1_mem **, short[2][1152], double[2][SBLIMIT], double[2][SBLIMIT], frame_info *);
+void psycho_1_deinit (psycho_1_mem **);
@@ -8,13 +8,30 @@
 #include "fft.h"
 #include "psycho_2.h"
 
-/* The static variables "r", "phi_sav", "new", "old" and "oldest" have    */
+/* The variables "r", "phi_sav", "new", "old" and "oldest" have           */
 /* to be remembered for the unpredictability measure.  For "r" and        */
 /* "phi_sav", the first index from the left is the channel select and     */
 /* the second index is the "age" of the data.                             */
 
-static int new = 0, old = 1, oldest = 0;
-static int init = 0, flush, sync_flush, syncsize, sfreq_idx;
+struct psycho_2_mem_s {
+  int new, old, oldest;
+  int flush, sync_flush, syncsize, sfreq_idx;
+
+  FCB grouped_c, grouped_e, nb, cb, ecb, bc;
+  FBLK wsamp_r, phi, energy;
+  FHBLK c, fthr;
+  F2_32 snrtmp;
+
+  ICB numlines;
+  IHBLK partition;
+  FCB cbval, rnorm;
+  FBLK window;
+  FHBLK absthr;
+  DCB tmn;
+  FCBCB s;
+  F2HBLK lthr;
+  F22HBLK r, phi_sav;
+};
 
 /* The following static variables are constants.                           */
 
@@ -32,24 +49,9 @@ static FLOAT bmax[27] = { 20.0, 20.0, 20.0, 20.0, 20.0, 17.0, 15.0,
   4.5, 4.5, 4.5, 3.5, 3.5, 3.5
 };
 
-static FLOAT *grouped_c, *grouped_e, *nb, *cb, *ecb, *bc;
-static FLOAT *wsamp_r, *phi, *energy;
-static FLOAT *c, *fthr;
-static F32 *snrtmp;
-
-static int *numlines;
-static int *partition;
-static FLOAT *cbval, *rnorm;
-static FLOAT *window;
-static FLOAT *absthr;
-static double *tmn;
-static FCB *s;
-static FHBLK *lthr;
-static F2HBLK *r, *phi_sav;
-
-void psycho_2_init (double sfreq);
+static psycho_2_mem *psycho_2_init (double sfreq, options *glopts);
 
-void psycho_2 (short int *buffer, short int savebuf[1056], int chn,
+void psycho_2 (psycho_2_mem **pmem, short int *buffer, short int savebuf[1056], int chn,
 		double *smr, double sfreq, options *glopts)
 /* to match prototype : FLOAT args are always double */
 {
@@ -57,11 +59,24 @@ void psycho_2 (short int *buffer, short int savebuf[1056], int chn,
   FLOAT r_prime, phi_prime;
   FLOAT minthres, sum_energy;
   double tb, temp1, temp2, temp3;
-
-  if (init == 0) {
-    psycho_2_init (sfreq);
-    init++;
-  }
+  psycho_2_mem *mem;
+
+  if (*pmem == NULL)
+    *pmem = psycho_2_init (sfreq, glopts);
+  mem = *pmem;
+
+  FLOAT *grouped_c = mem->grouped_c, *grouped_e = mem->grouped_e;
+  FLOAT *nb = mem->nb, *cb = mem->cb, *ecb = mem->ecb, *bc = mem->bc;
+  FLOAT *wsamp_r = mem->wsamp_r, *phi = mem->phi, *energy = mem->energy;
+  FLOAT *c = mem->c, *fthr = mem->fthr;
+  F32 *snrtmp = mem->snrtmp;
+  int *numlines = mem->numlines, *partition = mem->partition;
+  FLOAT *cbval = mem->cbval, *rnorm = mem->rnorm;
+  FLOAT *window = mem->window, *absthr = mem->absthr;
+  double *tmn = mem->tmn;
+  FCB *s = mem->s;
+  FHBLK *lthr = mem->lthr;
+  F2HBLK *r = mem->r, *phi_sav = mem->phi_sav;
 
   for (i = 0; i < 2; i++) {
       /*****************************************************************************
@@ -77,7 +92,7 @@ void psycho_2 (short int *buffer, short int savebuf[1056], int chn,
        *****************************************************************************/
 
     for (j = 0; j < 480; j++) {
-      savebuf[j] = savebuf[j + flush];
+      savebuf[j] = savebuf[j + mem->flush];
       wsamp_r[j] = window[j] * ((FLOAT) savebuf[j]);
     }
     for (; j < 1024; j++) {
@@ -96,23 +111,23 @@ void psycho_2 (short int *buffer, short int savebuf[1056], int chn,
     /*for layer 1 computations, for the layer 2 double computations, the pointers */
     /*are reset automatically on the second pass                                 */
     {
-      if (new == 0) {
-	new = 1;
-	oldest = 1;
+      if (mem->new == 0) {
+	mem->new = 1;
+	mem->oldest = 1;
       } else {
-	new = 0;
-	oldest = 0;
+	mem->new = 0;
+	mem->oldest = 0;
       }
-      if (old == 0)
-	old = 1;
+      if (mem->old == 0)
+	mem->old = 1;
       else
-	old = 0;
+	mem->old = 0;
     }
     for (j = 0; j < HBLKSIZE; j++) {
-      r_prime = 2.0 * r[chn][old][j] - r[chn][oldest][j];
-      phi_prime = 2.0 * phi_sav[chn][old][j] - phi_sav[chn][oldest][j];
-      r[chn][new][j] = sqrt ((double) energy[j]);
-      phi_sav[chn][new][j] = phi[j];
+      r_prime = 2.0 * r[chn][mem->old][j] - r[chn][mem->oldest][j];
+      phi_prime = 2.0 * phi_sav[chn][mem->old][j] - phi_sav[chn][mem->oldest][j];
+      r[chn][mem->new][j] = sqrt ((double) energy[j]);
+      phi_sav[chn][mem->new][j] = phi[j];
 #ifdef SINCOS
       {
 	// 12% faster
@@ -120,19 +135,19 @@ void psycho_2 (short int *buffer, short int savebuf[1056], int chn,
 	double sphi, cphi, sprime, cprime;
 	__sincos ((double) phi[j], &sphi, &cphi);
 	__sincos ((double) phi_prime, &sprime, &cprime);
-	temp1 = r[chn][new][j] * cphi - r_prime * cprime;
-	temp2 = r[chn][new][j] * sphi - r_prime * sprime;
+	temp1 = r[chn][mem->new][j] * cphi - r_prime * cprime;
+	temp2 = r[chn][mem->new][j] * sphi - r_prime * sprime;
       }
 #else
       temp1 =
-	r[chn][new][j] * cos ((double) phi[j]) -
+	r[chn][mem->new][j] * cos ((double) phi[j]) -
 	r_prime * cos ((double) phi_prime);
       temp2 =
-	r[chn][new][j] * sin ((double) phi[j]) -
+	r[chn][mem->new][j] * sin ((double) phi[j]) -
 	r_prime * sin ((double) phi_prime);
 #endif
 
-      temp3 = r[chn][new][j] + fabs ((double) r_prime);
+      temp3 = r[chn][mem->new][j] + fabs ((double) r_prime);
       if (temp3 != 0)
 	c[j] = sqrt (temp1 * temp1 + temp2 * temp2) / temp3;
       else
@@ -256,62 +271,52 @@ void psycho_2 (short int *buffer, short int savebuf[1056], int chn,
 /********************************
  * init psycho model 2
  ********************************/
-void psycho_2_init (double sfreq)
+static psycho_2_mem *psycho_2_init (double sfreq, options *glopts)
 {
   int i, j;
   FLOAT freq_mult;
   double temp1, temp2, temp3;
   FLOAT bval_lo;
-
-  grouped_c = (FLOAT *) mem_alloc (sizeof (FCB), "grouped_c");
-  grouped_e = (FLOAT *) mem_alloc (sizeof (FCB), "grouped_e");
-  nb = (FLOAT *) mem_alloc (sizeof (FCB), "nb");
-  cb = (FLOAT *) mem_alloc (sizeof (FCB), "cb");
-  ecb = (FLOAT *) mem_alloc (sizeof (FCB), "ecb");
-  bc = (FLOAT *) mem_alloc (sizeof (FCB), "bc");
-  wsamp_r = (FLOAT *) mem_alloc (sizeof (FBLK), "wsamp_r");
-  phi = (FLOAT *) mem_alloc (sizeof (FBLK), "phi");
-  energy = (FLOAT *) mem_alloc (sizeof (FBLK), "energy");
-  c = (FLOAT *) mem_alloc (sizeof (FHBLK), "c");
-  fthr = (FLOAT *) mem_alloc (sizeof (FHBLK), "fthr");
-  snrtmp = (F32 *) mem_alloc (sizeof (F2_32), "snrtmp");
-
-  numlines = (int *) mem_alloc (sizeof (ICB), "numlines");
-  partition = (int *) mem_alloc (sizeof (IHBLK), "partition");
-  cbval = (FLOAT *) mem_alloc (sizeof (FCB), "cbval");
-  rnorm = (FLOAT *) mem_alloc (sizeof (FCB), "rnorm");
-  window = (FLOAT *) mem_alloc (sizeof (FBLK), "window");
-  absthr = (FLOAT *) mem_alloc (sizeof (FHBLK), "absthr");
-  tmn = (double *) mem_alloc (sizeof (DCB), "tmn");
-  s = (FCB *) mem_alloc (sizeof (FCBCB), "s");
-  lthr = (FHBLK *) mem_alloc (sizeof (F2HBLK), "lthr");
-  r = (F2HBLK *) mem_alloc (sizeof (F22HBLK), "r");
-  phi_sav = (F2HBLK *) mem_alloc (sizeof (F22HBLK), "phi_sav");
+  psycho_2_mem *mem;
+
+  mem = (psycho_2_mem *) mem_alloc (sizeof (psycho_2_mem), "psycho_2_mem");
+  mem->new = 0;
+  mem->old = 1;
+  mem->oldest = 0;
+
+  FLOAT *fthr = mem->fthr;
+  int *numlines = mem->numlines, *partition = mem->partition;
+  FLOAT *cbval = mem->cbval, *rnorm = mem->rnorm;
+  FLOAT *window = mem->window, *absthr = mem->absthr;
+  double *tmn = mem->tmn;
+  FCB *s = mem->s;
+  FHBLK *lthr = mem->lthr;
+  F2HBLK *r = mem->r, *phi_sav = mem->phi_sav;
 
   i = sfreq + 0.5;
   switch (i) {
   case 32000:
   case 16000:
-    sfreq_idx = 0;
+    mem->sfreq_idx = 0;
     break;
   case 44100:
   case 22050:
-    sfreq_idx = 1;
+    mem->sfreq_idx = 1;
     break;
   case 48000:
   case 24000:
-    sfreq_idx = 2;
+    mem->sfreq_idx = 2;
     break;
   default:
     fprintf (stderr, "error, invalid sampling frequency: %d Hz\n", i);
     exit (-1);
   }
-  fprintf (stderr, "absthr[][] sampling frequency index: %d\n", sfreq_idx);
-  psycho_2_read_absthr (absthr, sfreq_idx);
+  fprintf (stderr, "absthr[][] sampling frequency index: %d\n", mem->sfreq_idx);
+  psycho_2_read_absthr (absthr, mem->sfreq_idx);
 
-  flush = 384 * 3.0 / 2.0;
-  syncsize = 1056;
-  sync_flush = syncsize - flush;
+  mem->flush = 384 * 3.0 / 2.0;
+  mem->syncsize = 1056;
+  mem->sync_flush = mem->syncsize - mem->flush;
 
   /* calculate HANN window coefficients */
   /*   for(i=0;i<BLKSIZE;i++)window[i]=0.5*(1-cos(2.0*PI*i/(BLKSIZE-1.0))); */
@@ -404,7 +409,7 @@ void psycho_2_init (double sfreq)
     }
   }
 
-  if (glopts.verbosity > 10){
+  if (glopts->verbosity > 10){
     /* Dump All the Values to STDOUT and exit */
     int wlow, whigh=0;
     fprintf(stdout,"psy model 2 init\n");
@@ -417,6 +422,12 @@ void psycho_2_init (double sfreq)
     exit(0);
   }
 
+  return mem;
+}
+
+void psycho_2_deinit (psycho_2_mem **mem)
+{
+  mem_free ((void **) mem);
 }
 
 void psycho_2_read_absthr (absthr, table)
@@ -1,2 +1,5 @@
 void psycho_2_read_absthr (FLOAT *, int);
-void psycho_2 (short int *, short int[1056], int, double *snr32, double sfreq, options *glopts);
+typedef struct psycho_2_mem_s psycho_2_mem;
+
+void psycho_2 (psycho_2_mem **, short int *, short int[1056], int, double *snr32, double sfreq, options *glopts);
+void psycho_2_deinit (psycho_2_mem **);
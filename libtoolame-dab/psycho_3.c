@@ -20,28 +20,33 @@
    a tiny fraction slower than the dist10 code, and nothing has been optimized)
    MFC Feb 2003 */
 
-/* Keep a table to fudge the adding of dB */
 #define DBTAB 1000
-static double dbtable[DBTAB];
-
 #define CRITBANDMAX 32 /* this is much higher than it needs to be. really only about 24 */
-int cbands=0; /* How many critical bands there really are */
-int cbandindex[CRITBANDMAX]; /* The spectral line index of the start of
-				each critical band */
-
 #define SUBSIZE 136
-int freq_subset[SUBSIZE];
-FLOAT bark[HBLKSIZE], ath[HBLKSIZE];
 
-int *numlines;
-FLOAT *cbval;
-int partition[HBLKSIZE];
-static D1408 *fft_buf;
+struct psycho_3_mem_s {
+  int off[2];
+  D1408 fft_buf[2];
+  FLOAT window[BLKSIZE];
+
+  /* Keep a table to fudge the adding of dB */
+  double dbtable[DBTAB];
+
+  int cbands; /* How many critical bands there really are */
+  int cbandindex[CRITBANDMAX]; /* The spectral line index of the start of
+				  each critical band */
+
+  int freq_subset[SUBSIZE];
+  FLOAT bark[HBLKSIZE], ath[HBLKSIZE];
 
-frame_header *header;
+  int numlines[HBLKSIZE];
+  FLOAT cbval[HBLKSIZE];
+  int partition[HBLKSIZE];
+};
 
+static psycho_3_mem *psycho_3_init(frame_header *header, options *glopts);
 
-double psycho_3_add_db (double a, double b)
+double psycho_3_add_db (psycho_3_mem *mem, double a, double b)
 {
   /* MFC - if the difference between a and b is large (>99), then just return the
      largest one. (about 10% of the time)
@@ -62,20 +67,20 @@ double psycho_3_add_db (double a, double b)
 
   idiff = (int) fdiff;
   if (idiff >= 0) {
-    return (a + dbtable[idiff]);
+    return (a + mem->dbtable[idiff]);
   }
 
-  return (b + dbtable[-idiff]);
+  return (b + mem->dbtable[-idiff]);
 }
 
-void psycho_3 (short buffer[2][1152], double scale[2][SBLIMIT],
+void psycho_3 (psycho_3_mem **pmem, short buffer[2][1152], double scale[2][SBLIMIT],
 	       double ltmin[2][SBLIMIT], frame_info * frame, options *glopts)
 {
+  frame_header *header = frame->header;
   int nch = frame->nch;
   int sblimit = frame->sblimit;
   int k, i;
-  static char init = 0;
-  static int off[2] = { 256, 256 };
+  psycho_3_mem *mem;
   FLOAT sample[BLKSIZE];
 
   FLOAT energy[BLKSIZE];
@@ -85,13 +90,15 @@ void psycho_3 (short buffer[2][1152], double scale[2][SBLIMIT],
   FLOAT LTg[HBLKSIZE];
   double Lsb[SBLIMIT];
 
-  header = frame->header;
+  if (*pmem == NULL)
+    *pmem = psycho_3_init(header, glopts);
+  mem = *pmem;
+
+  int *off = mem->off;
+  D1408 *fft_buf = mem->fft_buf;
+  FLOAT *bark = mem->bark, *ath = mem->ath;
+  int *freq_subset = mem->freq_subset;
 
-  if (init==0) {		
-    psycho_3_init(glopts);
-    init++;
-  }
-  
 
   for (k = 0; k < nch; k++) {
     int ok = off[k] % 1408;
@@ -110,36 +117,26 @@ void psycho_3 (short buffer[2][1152], double scale[2][SBLIMIT],
     off[k] += 1152;
     off[k] %= 1408;
 
-    psycho_3_fft(sample, energy);
+    psycho_3_fft(mem, sample, energy);
     psycho_3_powerdensityspectrum(energy, power);    
     psycho_3_spl(Lsb, power, &scale[k][0]);
-    psycho_3_tonal_label (power, tonelabel, Xtm);
-    psycho_3_noise_label (power, energy, tonelabel, noiselabel, Xnm);
+    psycho_3_tonal_label (mem, power, tonelabel, Xtm);
+    psycho_3_noise_label (mem, power, energy, tonelabel, noiselabel, Xnm);
     if (glopts->verbosity > 20)
       psycho_3_dump(tonelabel, Xtm, noiselabel, Xnm);
     psycho_3_decimation(ath, tonelabel, Xtm, noiselabel, Xnm, bark);
-    psycho_3_threshold(LTg, tonelabel, Xtm, noiselabel, Xnm, bark, ath, bitrate[header->version][header->bitrate_index] / nch, freq_subset);
+    psycho_3_threshold(mem, LTg, tonelabel, Xtm, noiselabel, Xnm, bark, ath, bitrate[header->version][header->bitrate_index] / nch, freq_subset);
     psycho_3_minimummasking(LTg, &ltmin[k][0], freq_subset);
     psycho_3_smr(&ltmin[k][0], Lsb);
   }
 }
 
 /* ISO11172 Sec D.1 Step 1 - Window with HANN and then perform the FFT */
-void psycho_3_fft(FLOAT sample[BLKSIZE], FLOAT energy[BLKSIZE])
+void psycho_3_fft(psycho_3_mem *mem, FLOAT sample[BLKSIZE], FLOAT energy[BLKSIZE])
 {
   FLOAT x_real[BLKSIZE];
   int i;
-  static int init = 0;
-  static FLOAT *window;
-
-  if (!init) { /* calculate window function for the Fourier transform */
-    window = (FLOAT *) mem_alloc (sizeof (DFFT), "window");
-    register FLOAT sqrt_8_over_3 = pow (8.0 / 3.0, 0.5);
-    for (i = 0; i < BLKSIZE; i++) {
-      window[i] = sqrt_8_over_3 * 0.5 * (1 - cos (2.0 * PI * i / (BLKSIZE))) / BLKSIZE;
-    }
-    init++;
-  }
+  FLOAT *window = mem->window;
 
   /* convolve the samples with the hann window */
   for (i = 0; i < BLKSIZE; i++)
@@ -183,7 +180,7 @@ void psycho_3_spl(double *Lsb, FLOAT *power, double *scale) {
 }
 
 /* Sect D.1 Step 4 Label the Tonal Components */
-void psycho_3_tonal_label (FLOAT power[HBLKSIZE], int *tonelabel, FLOAT Xtm[HBLKSIZE])
+void psycho_3_tonal_label (psycho_3_mem *mem, FLOAT power[HBLKSIZE], int *tonelabel, FLOAT Xtm[HBLKSIZE])
 {
   int i;
   int maxima[HBLKSIZE];
@@ -209,10 +206,10 @@ void psycho_3_tonal_label (FLOAT power[HBLKSIZE], int *tonelabel, FLOAT Xtm[HBLK
        - once a tone is found, the neighbours are immediately set to -inf dB
     */
 
-    psycho_3_tonal_label_range(power, tonelabel, maxima, Xtm, 2, 63, 2);
-    psycho_3_tonal_label_range(power, tonelabel, maxima, Xtm, 63,127,3);
-    psycho_3_tonal_label_range(power, tonelabel, maxima, Xtm, 127,255,6);
-    psycho_3_tonal_label_range(power, tonelabel, maxima, Xtm, 255,500,12);
+    psycho_3_tonal_label_range(mem, power, tonelabel, maxima, Xtm, 2, 63, 2);
+    psycho_3_tonal_label_range(mem, power, tonelabel, maxima, Xtm, 63,127,3);
+    psycho_3_tonal_label_range(mem, power, tonelabel, maxima, Xtm, 127,255,6);
+    psycho_3_tonal_label_range(mem, power, tonelabel, maxima, Xtm, 255,500,12);
 
   }
 }
@@ -220,7 +217,7 @@ void psycho_3_tonal_label (FLOAT power[HBLKSIZE], int *tonelabel, FLOAT Xtm[HBLK
 /* Sect D.1 Step4b 
    A tone within the range (start -> end), must be 7.0 dB greater than
    all it's neighbours within +/- srange. Don't count its immediate neighbours. */
-void psycho_3_tonal_label_range(FLOAT *power, int *tonelabel, int *maxima, FLOAT *Xtm, int start, int end, int srange) {
+void psycho_3_tonal_label_range(psycho_3_mem *mem, FLOAT *power, int *tonelabel, int *maxima, FLOAT *Xtm, int start, int end, int srange) {
   int j,k;
 
   for (k=start;k<end;k++)  /* Search for all the maxima in this range */
@@ -235,8 +232,8 @@ void psycho_3_tonal_label_range(FLOAT *power, int *tonelabel, int *maxima, FLOAT
 	   the adjacent spectral lines
 	   Xtm[k] = 10 * log10( pow(10.0, 0.1*power[k-1]) + pow(10.0, 0.1*power[k]) 
 	                      + pow(10.0, 0.1*power[k+1]) ); */
-	double temp = psycho_3_add_db(power[k-1], power[k]);
-	Xtm[k] = psycho_3_add_db(temp, power[k+1]);
+	double temp = psycho_3_add_db(mem, power[k-1], power[k]);
+	Xtm[k] = psycho_3_add_db(mem, temp, power[k+1]);
 	
 	/* *ALL* spectral lines within +/- srange are set to -inf dB 
 	   So that when we do the noise calculate, they are not counted */
@@ -246,13 +243,13 @@ void psycho_3_tonal_label_range(FLOAT *power, int *tonelabel, int *maxima, FLOAT
     }
 }
 
-void psycho_3_init_add_db (void)
+void psycho_3_init_add_db (psycho_3_mem *mem)
 {
   int i;
   double x;
   for (i = 0; i < DBTAB; i++) {
     x = (double) i / 10.0;
-    dbtable[i] = 10 * log10 (1 + pow (10.0, x / 10.0)) - x;
+    mem->dbtable[i] = 10 * log10 (1 + pow (10.0, x / 10.0)) - x;
   }
 }
 
@@ -261,8 +258,10 @@ void psycho_3_init_add_db (void)
    during the tone labelling).
    Find the "geometric mean" of these energies - i.e. find the best spot to put the
    sum of energies within this critical band. */
-void psycho_3_noise_label (FLOAT power[HBLKSIZE], FLOAT energy[BLKSIZE], int *tonelabel, int *noiselabel, FLOAT Xnm[HBLKSIZE]) {
+void psycho_3_noise_label (psycho_3_mem *mem, FLOAT power[HBLKSIZE], FLOAT energy[BLKSIZE], int *tonelabel, int *noiselabel, FLOAT Xnm[HBLKSIZE]) {
   int i,j;
+  int cbands = mem->cbands;
+  int *cbandindex = mem->cbandindex;
   
   Xnm[0] = DBMIN;
   for (i=0;i<cbands;i++) {
@@ -277,7 +276,7 @@ void psycho_3_noise_label (FLOAT power[HBLKSIZE], FLOAT energy[BLKSIZE], int *to
 	 adding the energies. The tone energies have already been removed */
       if (power[j] != DBMIN) {
 	/* Found a noise energy, add it to the sum */
-	sum = psycho_3_add_db(power[j], sum);
+	sum = psycho_3_add_db(mem, power[j], sum);
 	
 	/* calculations for the geometric mean 
 	   FIXME MFC Feb 2003: Would it just be easier to
@@ -336,7 +335,7 @@ void psycho_3_decimation(FLOAT *ath, int *tonelabel, FLOAT *Xtm, int *noiselabel
    NOTE: Only a subset of other frequencies is checked. According to the 
    standard different subbands are subsampled to different amounts.
    See psycho_3_init and freq_subset */
-void psycho_3_threshold(FLOAT *LTg, int *tonelabel, FLOAT *Xtm, int *noiselabel, FLOAT *Xnm, FLOAT *bark, FLOAT *ath, int bit_rate, int *freq_subset) {
+void psycho_3_threshold(psycho_3_mem *mem, FLOAT *LTg, int *tonelabel, FLOAT *Xtm, int *noiselabel, FLOAT *Xnm, FLOAT *bark, FLOAT *ath, int bit_rate, int *freq_subset) {
   int i,j,k;
   FLOAT LTtm[SUBSIZE];
   FLOAT LTnm[SUBSIZE];
@@ -366,7 +365,7 @@ void psycho_3_threshold(FLOAT *LTg, int *tonelabel, FLOAT *Xtm, int *noiselabel,
 	    vf = (-17 * dz);
 	  else
 	    vf = -(dz - 1) * (17 - 0.15 * Xtm[k]) - 17;
-	  LTtm[j] = psycho_3_add_db (LTtm[j], av + vf);
+	  LTtm[j] = psycho_3_add_db (mem, LTtm[j], av + vf);
 	}    
       }
     }
@@ -388,7 +387,7 @@ void psycho_3_threshold(FLOAT *LTg, int *tonelabel, FLOAT *Xtm, int *noiselabel,
 	    vf = (-17 * dz);
 	  else
 	    vf = -(dz - 1) * (17 - 0.15 * Xnm[k]) - 17;
-	  LTnm[j] = psycho_3_add_db (LTnm[j], av + vf);
+	  LTnm[j] = psycho_3_add_db (mem, LTnm[j], av + vf);
 	}    
       }
     }
@@ -397,11 +396,11 @@ void psycho_3_threshold(FLOAT *LTg, int *tonelabel, FLOAT *Xtm, int *noiselabel,
   /* ISO11172 D.1 Step 7
      Calculate the global masking threhold */
   for (i=0;i<SUBSIZE;i++) {
-    LTg[i] = psycho_3_add_db(LTnm[i], LTtm[i]);
+    LTg[i] = psycho_3_add_db(mem, LTnm[i], LTtm[i]);
     if (bit_rate < 96)
-      LTg[i] = psycho_3_add_db(ath[freq_subset[i]], LTg[i]);
+      LTg[i] = psycho_3_add_db(mem, ath[freq_subset[i]], LTg[i]);
     else
-      LTg[i] = psycho_3_add_db(ath[freq_subset[i]]-12.0, LTg[i]);
+      LTg[i] = psycho_3_add_db(mem, ath[freq_subset[i]]-12.0, LTg[i]);
   }
 }
 
@@ -431,14 +430,29 @@ void psycho_3_smr(double *LTmin, double *Lsb) {
   }
 }
 
-void psycho_3_init(options *glopts) {
+static psycho_3_mem *psycho_3_init(frame_header *header, options *glopts) {
   int i;
   int cbase = 0; /* current base index for the bark range calculation */
+  psycho_3_mem *mem;
+
+  mem = (psycho_3_mem *) mem_alloc (sizeof (psycho_3_mem), "psycho_3_mem");
+  mem->off[0] = mem->off[1] = 256;
+
+  int *cbandindex = mem->cbandindex;
+  int *freq_subset = mem->freq_subset;
+  FLOAT *bark = mem->bark, *ath = mem->ath;
+  int *numlines = mem->numlines;
+  FLOAT *cbval = mem->cbval;
+  int *partition = mem->partition;
+
+  /* calculate window function for the Fourier transform */
+  register FLOAT sqrt_8_over_3 = pow (8.0 / 3.0, 0.5);
+  for (i = 0; i < BLKSIZE; i++) {
+    mem->window[i] = sqrt_8_over_3 * 0.5 * (1 - cos (2.0 * PI * i / (BLKSIZE))) / BLKSIZE;
+  }
 
-  fft_buf = (D1408 *) mem_alloc ((long) sizeof (D1408) * 2, "fft_buf");
-  
   /* Initialise the tables for the adding dB */
-  psycho_3_init_add_db();
+  psycho_3_init_add_db(mem);
   
   /* For each spectral line calculate the bark and the ATH (in dB) */
   FLOAT sfreq = (FLOAT) s_freq[header->version][header->sampling_frequency] * 1000;
@@ -453,8 +467,6 @@ void psycho_3_init(options *glopts) {
        bark are added to the same critical band. When a line is greater
        by 1.0 of a bark, start a new critical band.  */
     
-    numlines = (int *)calloc(HBLKSIZE, sizeof(int));
-    cbval = (FLOAT*)calloc(HBLKSIZE, sizeof(FLOAT));
     cbandindex[0] = 1;
     for (i=1;i<HBLKSIZE;i++) {
       if ((bark[i] - bark[cbase]) > 1.0) { /* 1 critical band? 1 bark? */
@@ -462,17 +474,17 @@ void psycho_3_init(options *glopts) {
 	   (in terms of the bark distance)
 	   so make this spectral line the first member of the next critical band */
 	cbase = i; /* Start the new critical band from this frequency line */
-	cbands++;
-	cbandindex[cbands] = cbase;
+	mem->cbands++;
+	cbandindex[mem->cbands] = cbase;
       } 
       /* partition[i] tells us which critical band the i'th frequency line is in */
-      partition[i] = cbands;
+      partition[i] = mem->cbands;
       /* keep a count of how many frequency lines are in each partition */
-      numlines[cbands]++;
+      numlines[mem->cbands]++;
     }
     
-    cbands++;
-    cbandindex[cbands] = 513; /* Set the top of the last critical band */
+    mem->cbands++;
+    cbandindex[mem->cbands] = 513; /* Set the top of the last critical band */
 
     /* For each crtical band calculate the average bark value 
        cbval [central bark value] */
@@ -512,13 +524,19 @@ void psycho_3_init(options *glopts) {
   }
 
   if (glopts->verbosity > 4) {
-    fprintf(stdout,"%i critical bands\n",cbands);
-    for (i=0;i<cbands;i++)
+    fprintf(stdout,"%i critical bands\n",mem->cbands);
+    for (i=0;i<mem->cbands;i++)
       fprintf(stdout,"cband %i spectral line index %i\n",i,cbandindex[i]);
     fprintf(stdout,"%i Subsampled spectral lines\n",SUBSIZE);
     for (i=0;i<SUBSIZE;i++) 
       fprintf(stdout,"%i Spectral line %i Bark %.2f\n",i,freq_subset[i], bark[freq_subset[i]]);
   }
+
+  return mem;
+}
+
+void psycho_3_deinit(psycho_3_mem **mem) {
+  mem_free ((void **) mem);
 }
 
 void psycho_3_dump(int *tonelabel, FLOAT *Xtm, int *noiselabel, FLOAT *Xnm) {
@@ -1,4 +1,5 @@
-void psycho_3 (short[2][1152], double[2][SBLIMIT],
-		      double[2][SBLIMIT], frame_info *, options *glopts);
+typedef struct psycho_3_mem_s psycho_3_mem;
 
-void psycho_3_init(options *glopts);
+void psycho_3 (psycho_3_mem **, short[2][1152], double[2][SBLIMIT],
+		      double[2][SBLIMIT], frame_info *, options *glopts);
+void psycho_3_deinit(psycho_3_mem **);
@@ -36,13 +36,34 @@ that much difference to the final SNR values, but it's something worth trying
 ****************************************************************/
 
 
-/* The static variables "r", "phi_sav", "new", "old" and "oldest" have    
+#define TRIGTABLESIZE 3142
+#define TRIGTABLESCALE 1000.0
+
+/* The variables "r", "phi_sav", "new", "old" and "oldest" have           
  to be remembered for the unpredictability measure.  For "r" and        
  "phi_sav", the first index from the left is the channel select and     
  the second index is the "age" of the data.                             */
 
-static int new = 0, old = 1, oldest = 0;
-static int init = 0;
+struct psycho_4_mem_s {
+  int new, old, oldest;
+
+  FCB grouped_c, grouped_e, nb, cb, tb, ecb, bc;
+  FBLK wsamp_r, phi, energy;
+  FHBLK c, bark, thr;
+  F2_32 snrtmp;
+
+  ICB numlines;
+  IHBLK partition;
+  FCB cbval, rnorm;
+  FBLK window;
+  FHBLK ath;
+  DCB tmn;
+  FCBCB s;
+  F22HBLK r, phi_sav;
+
+  FLOAT cos_table[TRIGTABLESIZE];
+  FLOAT sin_table[TRIGTABLESIZE];
+};
 
 /* NMT is a constant 5.5dB. ISO11172 Sec D.2.4.h */
 static double NMT = 5.5;
@@ -66,35 +87,16 @@ static FLOAT minval[27] = {
 };
 
 
-static FLOAT *grouped_c, *grouped_e, *nb, *cb, *tb, *ecb, *bc;
-static FLOAT *wsamp_r, *phi, *energy;
-static FLOAT *c, *bark, *thr;
-static F32 *snrtmp;
-
-static int *numlines;
-static int *partition;
-static FLOAT *cbval, *rnorm;
-static FLOAT *window;
-static FLOAT *ath;
-static double *tmn;
-static FCB *s;
-static FHBLK *lthr;
-static F2HBLK *r, *phi_sav;
-
-#define TRIGTABLESIZE 3142
-#define TRIGTABLESCALE 1000.0
-static FLOAT cos_table[TRIGTABLESIZE];
-static FLOAT sin_table[TRIGTABLESIZE];
-void psycho_4_trigtable_init(void) {
+void psycho_4_trigtable_init(psycho_4_mem *mem) {
 
   int i;
   for (i=0;i<TRIGTABLESIZE;i++) {
-    cos_table[i] = cos((double)i/TRIGTABLESCALE);
-    sin_table[i] = sin((double)i/TRIGTABLESCALE);
+    mem->cos_table[i] = cos((double)i/TRIGTABLESCALE);
+    mem->sin_table[i] = sin((double)i/TRIGTABLESCALE);
   }
 }
 
-FLOAT psycho_4_cos(FLOAT phi) {
+FLOAT psycho_4_cos(psycho_4_mem *mem, FLOAT phi) {
   int index;
   int sign=1;
 
@@ -103,10 +105,10 @@ FLOAT psycho_4_cos(FLOAT phi) {
     index -= TRIGTABLESIZE;
     sign*=-1;
   }
-  return(sign * cos_table[index]);
+  return(sign * mem->cos_table[index]);
 }
 
-FLOAT psycho_4_sin(FLOAT phi) {
+FLOAT psycho_4_sin(psycho_4_mem *mem, FLOAT phi) {
   int index;
   int sign=1;
 
@@ -116,23 +118,35 @@ FLOAT psycho_4_sin(FLOAT phi) {
     sign*=-1;
   }
   if (phi<0)
-    return(-1 * sign * sin_table[index]);
-  return(sign * sin_table[index]);
+    return(-1 * sign * mem->sin_table[index]);
+  return(sign * mem->sin_table[index]);
 }
 
 
-void psycho_4 (short int *buffer, short int savebuf[1056], int chn,
+void psycho_4 (psycho_4_mem **pmem, short int *buffer, short int savebuf[1056], int chn,
 		double *smr, double sfreq, options *glopts)
 /* to match prototype : FLOAT args are always double */
 {
   unsigned int run, i, j, k;
   FLOAT r_prime, phi_prime;
   FLOAT npart, epart;
-
-  if (init == 0) {
-    psycho_4_init (sfreq, glopts);
-    init++;
-  }
+  psycho_4_mem *mem;
+
+  if (*pmem == NULL)
+    *pmem = psycho_4_init (sfreq, glopts);
+  mem = *pmem;
+
+  FLOAT *grouped_c = mem->grouped_c, *grouped_e = mem->grouped_e;
+  FLOAT *nb = mem->nb, *cb = mem->cb, *tb = mem->tb, *ecb = mem->ecb, *bc = mem->bc;
+  FLOAT *wsamp_r = mem->wsamp_r, *phi = mem->phi, *energy = mem->energy;
+  FLOAT *c = mem->c, *thr = mem->thr;
+  F32 *snrtmp = mem->snrtmp;
+  int *numlines = mem->numlines, *partition = mem->partition;
+  FLOAT *cbval = mem->cbval, *rnorm = mem->rnorm;
+  FLOAT *window = mem->window, *ath = mem->ath;
+  double *tmn = mem->tmn;
+  FCB *s = mem->s;
+  F2HBLK *r = mem->r, *phi_sav = mem->phi_sav;
 
   for (run = 0; run < 2; run++) {
     /* Net offset is 480 samples (1056-576) for layer 2; this is because one must
@@ -162,62 +176,62 @@ void psycho_4 (short int *buffer, short int savebuf[1056], int chn,
     /* calculate the unpredictability measure, given energy[f] and phi[f] 
        (the age pointers [new/old/oldest] are reset automatically on the second pass */
     {
-      if (new == 0) {
-	new = 1;
-	oldest = 1;
+      if (mem->new == 0) {
+	mem->new = 1;
+	mem->oldest = 1;
       } else {
-	new = 0;
-	oldest = 0;
+	mem->new = 0;
+	mem->oldest = 0;
       }
-      if (old == 0)
-	old = 1;
+      if (mem->old == 0)
+	mem->old = 1;
       else
-	old = 0;
+	mem->old = 0;
     }
 
     for (j = 0; j < HBLKSIZE; j++) {
 #ifdef NEWATAN
       double temp1, temp2, temp3;
-      r_prime = 2.0 * r[chn][old][j] - r[chn][oldest][j];
-      phi_prime = 2.0 * phi_sav[chn][old][j] - phi_sav[chn][oldest][j];
+      r_prime = 2.0 * r[chn][mem->old][j] - r[chn][mem->oldest][j];
+      phi_prime = 2.0 * phi_sav[chn][mem->old][j] - phi_sav[chn][mem->oldest][j];
 
-      r[chn][new][j] = sqrt ((double) energy[j]);
-      phi_sav[chn][new][j] = phi[j];	
+      r[chn][mem->new][j] = sqrt ((double) energy[j]);
+      phi_sav[chn][mem->new][j] = phi[j];	
   
       {
 	temp1 =
-	  r[chn][new][j] * psycho_4_cos(phi[j]) -
-	  r_prime * psycho_4_cos(phi_prime);
+	  r[chn][mem->new][j] * psycho_4_cos(mem, phi[j]) -
+	  r_prime * psycho_4_cos(mem, phi_prime);
 	temp2 =
-	  r[chn][new][j] * psycho_4_sin(phi[j]) -
-	  r_prime * psycho_4_sin(phi_prime); 
+	  r[chn][mem->new][j] * psycho_4_sin(mem, phi[j]) -
+	  r_prime * psycho_4_sin(mem, phi_prime); 
 	//fprintf(stdout,"[%5.2f %5.2f] [%5.2f %5.2f]\n",temp1, mytemp1, temp2, mytemp2);
 
       }
 
 
-      temp3 = r[chn][new][j] + fabs ((double) r_prime);
+      temp3 = r[chn][mem->new][j] + fabs ((double) r_prime);
       if (temp3 != 0)
 	c[j] = sqrt (temp1 * temp1 + temp2 * temp2) / temp3;
       else
 	c[j] = 0;
 #else
       double temp1, temp2, temp3;
-      r_prime = 2.0 * r[chn][old][j] - r[chn][oldest][j];
-      phi_prime = 2.0 * phi_sav[chn][old][j] - phi_sav[chn][oldest][j];
+      r_prime = 2.0 * r[chn][mem->old][j] - r[chn][mem->oldest][j];
+      phi_prime = 2.0 * phi_sav[chn][mem->old][j] - phi_sav[chn][mem->oldest][j];
 
-      r[chn][new][j] = sqrt ((double) energy[j]);
-      phi_sav[chn][new][j] = phi[j];	
+      r[chn][mem->new][j] = sqrt ((double) energy[j]);
+      phi_sav[chn][mem->new][j] = phi[j];	
 
 
       temp1 =
-	r[chn][new][j] * cos ((double) phi[j]) -
+	r[chn][mem->new][j] * cos ((double) phi[j]) -
 	r_prime * cos ((double) phi_prime);
       temp2 =
-	r[chn][new][j] * sin ((double) phi[j]) -
+	r[chn][mem->new][j] * sin ((double) phi[j]) -
 	r_prime * sin ((double) phi_prime);      
 
-      temp3 = r[chn][new][j] + fabs ((double) r_prime);
+      temp3 = r[chn][mem->new][j] + fabs ((double) r_prime);
       if (temp3 != 0)
 	c[j] = sqrt (temp1 * temp1 + temp2 * temp2) / temp3;
       else
@@ -327,15 +341,26 @@ void psycho_4 (short int *buffer, short int savebuf[1056], int chn,
 /********************************
  * init psycho model 2
  ********************************/
-void psycho_4_init (double sfreq, options *glopts)
+psycho_4_mem *psycho_4_init (double sfreq, options *glopts)
 {
   int i, j;
+  psycho_4_mem *mem;
+
+  /* Allocate memory for all the state variables */
+  mem = (psycho_4_mem *) mem_alloc (sizeof (psycho_4_mem), "psycho_4_mem");
+  mem->new = 0;
+  mem->old = 1;
+  mem->oldest = 0;
 
-  /* Allocate memory for all the static variables */
-  psycho_4_allocmem();
+  FLOAT *bark = mem->bark, *ath = mem->ath;
+  int *numlines = mem->numlines, *partition = mem->partition;
+  FLOAT *cbval = mem->cbval, *rnorm = mem->rnorm;
+  FLOAT *window = mem->window;
+  double *tmn = mem->tmn;
+  FCB *s = mem->s;
 
   /* Set up the SIN/COS tables */
-  psycho_4_trigtable_init();
+  psycho_4_trigtable_init(mem);
 
   /* calculate HANN window coefficients */
   for (i = 0; i < BLKSIZE; i++)
@@ -425,6 +450,8 @@ void psycho_4_init (double sfreq, options *glopts)
     fprintf(stdout,"total lines %i\n",ntot);
     exit(0);
   }
+
+  return mem;
 }
 
 /* The spreading function.  Values returned in units of energy
@@ -471,37 +498,6 @@ FLOAT8 psycho_4_spreading_function(FLOAT8 bark) {
 
 }
 
-void psycho_4_allocmem() {
-  grouped_c = (FLOAT *) mem_alloc (sizeof (FCB), "grouped_c");
-  grouped_e = (FLOAT *) mem_alloc (sizeof (FCB), "grouped_e");
-  nb = (FLOAT *) mem_alloc (sizeof (FCB), "nb");
-  cb = (FLOAT *) mem_alloc (sizeof (FCB), "cb");
-  tb = (FLOAT *) mem_alloc (sizeof (FCB), "tb");
-  ecb = (FLOAT *) mem_alloc (sizeof (FCB), "ecb");
-  bc = (FLOAT *) mem_alloc (sizeof (FCB), "bc");
-  wsamp_r = (FLOAT *) mem_alloc (sizeof (FBLK), "wsamp_r");
-  phi = (FLOAT *) mem_alloc (sizeof (FBLK), "phi");
-  energy = (FLOAT *) mem_alloc (sizeof (FBLK), "energy");
-  c = (FLOAT *) mem_alloc (sizeof (FHBLK), "c");
-  bark = (FLOAT *) mem_alloc (sizeof (FHBLK), "bark");
-  thr = (FLOAT *) mem_alloc (sizeof (FHBLK), "thr");
-  snrtmp = (F32 *) mem_alloc (sizeof (F2_32), "snrtmp");
-
-  numlines = (int *) mem_alloc (sizeof (ICB), "numlines");
-  partition = (int *) mem_alloc (sizeof (IHBLK), "partition");
-  cbval = (FLOAT *) mem_alloc (sizeof (FCB), "cbval");
-  rnorm = (FLOAT *) mem_alloc (sizeof (FCB), "rnorm");
-  window = (FLOAT *) mem_alloc (sizeof (FBLK), "window");
-  ath = (FLOAT *) mem_alloc (sizeof (FHBLK), "ath");
-  tmn = (double *) mem_alloc (sizeof (DCB), "tmn");
-  s = (FCB *) mem_alloc (sizeof (FCBCB), "s");
-  lthr = (FHBLK *) mem_alloc (sizeof (F2HBLK), "lthr");
-  r = (F2HBLK *) mem_alloc (sizeof (F22HBLK), "r");
-  phi_sav = (F2HBLK *) mem_alloc (sizeof (F22HBLK), "phi_sav");
-
+void psycho_4_deinit(psycho_4_mem **mem) {
+  mem_free ((void **) mem);
 }
-
-
-
-
-
@@ -1,8 +1,10 @@
-void psycho_4 (short int *, short int[1056], int, double *smr, double sfeq, options *glopts);
-void psycho_4_init (double sfreq, options *glopts);
+typedef struct psycho_4_mem_s psycho_4_mem;
+
+void psycho_4 (psycho_4_mem **, short int *, short int[1056], int, double *smr, double sfeq, options *glopts);
+psycho_4_mem *psycho_4_init (double sfreq, options *glopts);
+void psycho_4_deinit(psycho_4_mem **);
 FLOAT8 psycho_4_spreading_function(FLOAT8 bark);
-void psycho_4_allocmem(void);
 
-void psycho_4_trigtable_init(void);
-FLOAT psycho_4_cos(FLOAT phi);
-FLOAT psycho_4_sin(FLOAT phi);
+void psycho_4_trigtable_init(psycho_4_mem *);
+FLOAT psycho_4_cos(psycho_4_mem *, FLOAT phi);
+FLOAT psycho_4_sin(psycho_4_mem *, FLOAT phi);
@@ -195,116 +195,258 @@ void window_subband12 (short **buffer, int ch)
 #endif /* NEWWS */
 
 
-//____________________________________________________________________________
-//____ WindowFilterSubband() _________________________________________
-//____ RS&A - Feb 2003 _______________________________________________________
-void WindowFilterSubband (short *pBuffer, int ch, double s[SBLIMIT])
+/************************************************************************
+*
+* Window and matrixing kernels for WindowFilterSubband()
+*
+* The SIMD variants work on several consecutive outputs at a time, but
+* every output is still accumulated in double precision and in exactly
+* the same order as the scalar code. All variants therefore produce
+* bit-identical subband samples, whatever the CPU the encoder runs on.
+*
+************************************************************************/
+
+static void window_c (const double *x, int pa, const double *enw, double *y)
 {
-  register int i, j;
-  int pa, pb, pc, pd, pe, pf, pg, ph;
-  double t;
-  double *dp, *dp2;
-  double *pEnw;
-  double y[64];
-  double yprime[32];
+  const double *xa = x + pa * 32;
+  const double *xb = x + ((pa + 1) & 7) * 32;
+  const double *xc = x + ((pa + 2) & 7) * 32;
+  const double *xd = x + ((pa + 3) & 7) * 32;
+  const double *xe = x + ((pa + 4) & 7) * 32;
+  const double *xf = x + ((pa + 5) & 7) * 32;
+  const double *xg = x + ((pa + 6) & 7) * 32;
+  const double *xh = x + ((pa + 7) & 7) * 32;
+  int i;
 
-  static double x[2][512];
-  static double m[16][32];
-  static int init = 0;
-  static int off[2];
-  static int half[2];
+  for (i = 0; i < 32; i++) {
+    double t = xa[i] * enw[i];
+    t += xb[i] * enw[i + 64];
+    t += xc[i] * enw[i + 128];
+    t += xd[i] * enw[i + 192];
+    t += xe[i] * enw[i + 256];
+    t += xf[i] * enw[i + 320];
+    t += xg[i] * enw[i + 384];
+    t += xh[i] * enw[i + 448];
+    y[i] = t;
+  }
+}
 
-  if (init == 0) {
-    init++;
-    off[0] = 0;
-    off[1] = 0;
-    half[0] = 0;
-    half[1] = 0;
-    for (i = 0; i < 2; i++)
-      for (j = 0; j < 512; j++)
-	x[i][j] = 0;
-    create_dct_matrix (m);
+static void matrix_c (const double *mt, const double *yprime, double *s)
+{
+  double s0[16], s1[16];
+  int i, j;
+
+  for (i = 0; i < 16; i++) {
+    s0[i] = 0.0 + mt[i] * yprime[0];
+    s1[i] = 0.0 + mt[16 + i] * yprime[1];
+  }
+  for (j = 2; j < 32; j += 2) {
+    const double *m0 = mt + j * 16;
+    const double *m1 = m0 + 16;
+    for (i = 0; i < 16; i++) {
+      s0[i] += m0[i] * yprime[j];
+      s1[i] += m1[i] * yprime[j + 1];
+    }
   }
+  for (i = 0; i < 16; i++) {
+    s[i] = s0[i] + s1[i];
+    s[31 - i] = s0[i] - s1[i];
+  }
+}
 
-  dp = x[ch] + off[ch] + half[ch] * 256;
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SUBBAND_X86
+#include <immintrin.h>
 
-  /* replace 32 oldest samples with 32 new samples */
-  for (i = 0; i < 32; i++)
-    dp[(31 - i) * 8] = (double) pBuffer[i] / SCALE;
-
-  // looks like "school example" but does faster ...
-  dp = (x[ch] + half[ch] * 256);
-  pa = off[ch];
-  pb = (pa + 1) % 8;
-  pc = (pa + 2) % 8;
-  pd = (pa + 3) % 8;
-  pe = (pa + 4) % 8;
-  pf = (pa + 5) % 8;
-  pg = (pa + 6) % 8;
-  ph = (pa + 7) % 8;
+__attribute__ ((target ("sse2")))
+static void window_sse2 (const double *x, int pa, const double *enw, double *y)
+{
+  int i, tap;
+
+  for (i = 0; i < 32; i += 2) {
+    __m128d t = _mm_mul_pd (_mm_loadu_pd (x + pa * 32 + i),
+                            _mm_loadu_pd (enw + i));
+    for (tap = 1; tap < 8; tap++)
+      t = _mm_add_pd (t, _mm_mul_pd (_mm_loadu_pd (x + ((pa + tap) & 7) * 32 + i),
+                                     _mm_loadu_pd (enw + i + 64 * tap)));
+    _mm_storeu_pd (y + i, t);
+  }
+}
 
-  for (i = 0; i < 32; i++) {
-    dp2 = dp + i * 8;
-    pEnw = enwindow + i;
-    t = dp2[pa] * pEnw[0];
-    t += dp2[pb] * pEnw[64];
-    t += dp2[pc] * pEnw[128];
-    t += dp2[pd] * pEnw[192];
-    t += dp2[pe] * pEnw[256];
-    t += dp2[pf] * pEnw[320];
-    t += dp2[pg] * pEnw[384];
-    t += dp2[ph] * pEnw[448];
-    y[i] = t;
+__attribute__ ((target ("sse2")))
+static void matrix_sse2 (const double *mt, const double *yprime, double *s)
+{
+  int i, j;
+
+  for (i = 0; i < 16; i += 2) {
+    __m128d s0 = _mm_setzero_pd ();
+    __m128d s1 = _mm_setzero_pd ();
+    for (j = 0; j < 32; j += 2) {
+      s0 = _mm_add_pd (s0, _mm_mul_pd (_mm_loadu_pd (mt + j * 16 + i),
+                                       _mm_set1_pd (yprime[j])));
+      s1 = _mm_add_pd (s1, _mm_mul_pd (_mm_loadu_pd (mt + (j + 1) * 16 + i),
+                                       _mm_set1_pd (yprime[j + 1])));
+    }
+    _mm_storeu_pd (s + i, _mm_add_pd (s0, s1));
+    /* s[31 - i] = s0 - s1, so the lanes go out in reverse order */
+    __m128d d = _mm_sub_pd (s0, s1);
+    _mm_storeu_pd (s + 30 - i, _mm_shuffle_pd (d, d, 1));
   }
+}
 
-  yprime[0] = y[16];		// Michael Chens dct filter
+__attribute__ ((target ("avx")))
+static void window_avx (const double *x, int pa, const double *enw, double *y)
+{
+  int i, tap;
+
+  for (i = 0; i < 32; i += 4) {
+    __m256d t = _mm256_mul_pd (_mm256_loadu_pd (x + pa * 32 + i),
+                               _mm256_loadu_pd (enw + i));
+    for (tap = 1; tap < 8; tap++)
+      t = _mm256_add_pd (t, _mm256_mul_pd (_mm256_loadu_pd (x + ((pa + tap) & 7) * 32 + i),
+                                           _mm256_loadu_pd (enw + i + 64 * tap)));
+    _mm256_storeu_pd (y + i, t);
+  }
+}
 
-  dp = half[ch] ? x[ch] : (x[ch] + 256);
-  pa = half[ch] ? (off[ch] + 1) & 7 : off[ch];
-  pb = (pa + 1) % 8;
-  pc = (pa + 2) % 8;
-  pd = (pa + 3) % 8;
-  pe = (pa + 4) % 8;
-  pf = (pa + 5) % 8;
-  pg = (pa + 6) % 8;
-  ph = (pa + 7) % 8;
+__attribute__ ((target ("avx")))
+static void matrix_avx (const double *mt, const double *yprime, double *s)
+{
+  int i, j;
+
+  for (i = 0; i < 16; i += 4) {
+    __m256d s0 = _mm256_setzero_pd ();
+    __m256d s1 = _mm256_setzero_pd ();
+    for (j = 0; j < 32; j += 2) {
+      s0 = _mm256_add_pd (s0, _mm256_mul_pd (_mm256_loadu_pd (mt + j * 16 + i),
+                                             _mm256_set1_pd (yprime[j])));
+      s1 = _mm256_add_pd (s1, _mm256_mul_pd (_mm256_loadu_pd (mt + (j + 1) * 16 + i),
+                                             _mm256_set1_pd (yprime[j + 1])));
+    }
+    _mm256_storeu_pd (s + i, _mm256_add_pd (s0, s1));
+    __m256d d = _mm256_sub_pd (s0, s1);
+    d = _mm256_permute2f128_pd (d, d, 1);
+    _mm256_storeu_pd (s + 28 - i, _mm256_permute_pd (d, 0x5));
+  }
+}
+#endif /* x86 */
 
-  for (i = 0; i < 32; i++) {
-    dp2 = dp + i * 8;
-    pEnw = enwindow + i + 32;
-    t = dp2[pa] * pEnw[0];
-    t += dp2[pb] * pEnw[64];
-    t += dp2[pc] * pEnw[128];
-    t += dp2[pd] * pEnw[192];
-    t += dp2[pe] * pEnw[256];
-    t += dp2[pf] * pEnw[320];
-    t += dp2[pg] * pEnw[384];
-    t += dp2[ph] * pEnw[448];
-    y[i + 32] = t;
-    // 1st pass on Michael Chens dct filter
-    if (i > 0 && i < 17)
-      yprime[i] = y[i + 16] + y[16 - i];
+#if defined(__aarch64__)
+#define SUBBAND_NEON
+#include <arm_neon.h>
+
+static void window_neon (const double *x, int pa, const double *enw, double *y)
+{
+  int i, tap;
+
+  for (i = 0; i < 32; i += 2) {
+    float64x2_t t = vmulq_f64 (vld1q_f64 (x + pa * 32 + i), vld1q_f64 (enw + i));
+    for (tap = 1; tap < 8; tap++)
+      t = vaddq_f64 (t, vmulq_f64 (vld1q_f64 (x + ((pa + tap) & 7) * 32 + i),
+                                   vld1q_f64 (enw + i + 64 * tap)));
+    vst1q_f64 (y + i, t);
+  }
+}
+
+static void matrix_neon (const double *mt, const double *yprime, double *s)
+{
+  int i, j;
+
+  for (i = 0; i < 16; i += 2) {
+    float64x2_t s0 = vdupq_n_f64 (0.0);
+    float64x2_t s1 = vdupq_n_f64 (0.0);
+    for (j = 0; j < 32; j += 2) {
+      s0 = vaddq_f64 (s0, vmulq_f64 (vld1q_f64 (mt + j * 16 + i),
+                                     vdupq_n_f64 (yprime[j])));
+      s1 = vaddq_f64 (s1, vmulq_f64 (vld1q_f64 (mt + (j + 1) * 16 + i),
+                                     vdupq_n_f64 (yprime[j + 1])));
+    }
+    vst1q_f64 (s + i, vaddq_f64 (s0, s1));
+    float64x2_t d = vsubq_f64 (s0, s1);
+    vst1q_f64 (s + 30 - i, vextq_f64 (d, d, 1));
+  }
+}
+#endif /* __aarch64__ */
+
+
+int subband_kernels (subband_kernel kernels[], int max)
+{
+  int n = 0;
+
+#define ADD_KERNEL(NAME, WINDOW, MATRIX) \
+  if (n < max) { \
+    kernels[n].name = NAME; \
+    kernels[n].window = WINDOW; \
+    kernels[n].matrix = MATRIX; \
+    n++; \
   }
 
-  // 2nd pass on Michael Chens dct filter
+  ADD_KERNEL ("c", window_c, matrix_c);
+#if defined(SUBBAND_X86)
+  __builtin_cpu_init ();
+  if (__builtin_cpu_supports ("sse2"))
+    ADD_KERNEL ("sse2", window_sse2, matrix_sse2);
+  if (__builtin_cpu_supports ("avx"))
+    ADD_KERNEL ("avx", window_avx, matrix_avx);
+#elif defined(SUBBAND_NEON)
+  ADD_KERNEL ("neon", window_neon, matrix_neon);
+#endif
+
+#undef ADD_KERNEL
+  return n;
+}
+
+/* Reset the filterbank history, build the DCT matrix and pick the
+   fastest kernels the CPU supports */
+void subband_init (subband_mem * smem)
+{
+  double m[16][32];
+  subband_kernel kernels[4];
+  int i, k, n;
+
+  memset (smem, 0, sizeof (subband_mem));
+
+  create_dct_matrix (m);
+  for (i = 0; i < 16; i++)
+    for (k = 0; k < 32; k++)
+      smem->mt[k][i] = m[i][k];
+
+  n = subband_kernels (kernels, 4);
+  smem->window = kernels[n - 1].window;
+  smem->matrix = kernels[n - 1].matrix;
+}
+
+//____________________________________________________________________________
+//____ WindowFilterSubband() _________________________________________
+//____ RS&A - Feb 2003 _______________________________________________________
+void WindowFilterSubband (subband_mem * smem, short *pBuffer, int ch, double s[SBLIMIT])
+{
+  int i;
+  double y[64];
+  double yprime[32];
+
+  const int half = smem->half[ch];
+  const int off = smem->off[ch];
+  double (*cur)[32] = smem->x[ch][half];
+  double (*prev)[32] = smem->x[ch][!half];
+
+  /* replace 32 oldest samples with 32 new samples */
+  for (i = 0; i < 32; i++)
+    cur[off][31 - i] = (double) pBuffer[i] / SCALE;
+
+  smem->window (&cur[0][0], off, enwindow, y);
+  smem->window (&prev[0][0], half ? (off + 1) & 7 : off, enwindow + 32, y + 32);
+
+  // Michael Chen's dct filter
+  yprime[0] = y[16];
+  for (i = 1; i < 17; i++)
+    yprime[i] = y[i + 16] + y[16 - i];
   for (i = 17; i < 32; i++)
     yprime[i] = y[i + 16] - y[80 - i];
 
-  for (i = 15; i >= 0; i--) {
-    register double s0 = 0.0, s1 = 0.0;
-    register double *mp = m[i];
-    register double *xinp = yprime;
-    for (j = 0; j < 8; j++) {
-      s0 += *mp++ * *xinp++;
-      s1 += *mp++ * *xinp++;
-      s0 += *mp++ * *xinp++;
-      s1 += *mp++ * *xinp++;
-    }
-    s[i] = s0 + s1;
-    s[31 - i] = s0 - s1;
-  }
+  smem->matrix (&smem->mt[0][0], yprime, s);
 
-  half[ch] = (half[ch] + 1) & 1;
-  if (half[ch] == 1)
-    off[ch] = (off[ch] + 7) & 7;
+  smem->half[ch] = (half + 1) & 1;
+  if (smem->half[ch] == 1)
+    smem->off[ch] = (off + 7) & 7;
 }
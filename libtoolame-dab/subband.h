@@ -1,6 +1,45 @@
+/* Polyphase filterbank state, one per encoder instance.
+ *
+ * The window history is stored tap-major: x[ch][half][tap][i] holds the
+ * sample for output i, so the window and matrixing kernels can process
+ * several consecutive outputs at once. The DCT matrix is kept transposed
+ * (mt[k][i] == m[i][k]) for the same reason. */
+typedef struct subband_mem_s subband_mem;
 
+/* y[i] = sum over the 8 taps of x[(pa + tap) & 7][i] * enw[i + 64 * tap] */
+typedef void (*subband_window_fn) (const double *x, int pa,
+                                   const double *enw, double *y);
+/* s[i] and s[31 - i] from the 16 rows of the DCT matrix and yprime */
+typedef void (*subband_matrix_fn) (const double *mt, const double *yprime,
+                                   double *s);
 
-void  WindowFilterSubband( short *pBuffer, int ch, double s[SBLIMIT] );
+struct subband_mem_s
+{
+  double x[2][2][8][32];
+  double mt[32][16];
+  int off[2];
+  int half[2];
+
+  /* Kernels selected for the running CPU by subband_init() */
+  subband_window_fn window;
+  subband_matrix_fn matrix;
+};
+
+/* One set of window and matrixing kernels */
+typedef struct
+{
+  const char *name;
+  subband_window_fn window;
+  subband_matrix_fn matrix;
+} subband_kernel;
+
+/* Fill kernels[] with the variants the running CPU supports, the portable
+   C kernels first and the fastest last, and return their number. All of
+   them give bit-identical results. */
+int subband_kernels (subband_kernel kernels[], int max);
+
+void subband_init (subband_mem * smem);
+void  WindowFilterSubband( subband_mem * smem, short *pBuffer, int ch, double s[SBLIMIT] );
 void create_dct_matrix (double filter[16][32]);
 
 #ifdef REFERENCECODE
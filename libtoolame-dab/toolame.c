@@ -21,25 +21,21 @@
 #include "utils.h"
 #include <assert.h>
 
-Bit_stream_struc bs;
-
-options glopts;
-
 const int FPAD_LENGTH=2;
 
 void smr_dump(double smr[2][SBLIMIT], int nch);
 
-void global_init (void)
+static void global_init (options *glopts)
 {
-    glopts.usepsy = TRUE;
-    glopts.usepadbit = TRUE;
-    glopts.quickmode = FALSE;
-    glopts.quickcount = 10;
-    glopts.byteswap = FALSE;
-    glopts.vbr = FALSE;
-    glopts.vbrlevel = 0;
-    glopts.athlevel = 0;
-    glopts.verbosity = 2;
+    glopts->usepsy = TRUE;
+    glopts->usepadbit = TRUE;
+    glopts->quickmode = FALSE;
+    glopts->quickcount = 10;
+    glopts->byteswap = FALSE;
+    glopts->vbr = FALSE;
+    glopts->vbrlevel = 0;
+    glopts->athlevel = 0;
+    glopts->verbosity = 2;
 }
 
 /************************************************************************
@@ -86,111 +82,152 @@ void global_init (void)
  *
  ************************************************************************/
 
-static frame_info frame;
-static frame_header header;
-static int frameNum;
-static int psycount;
-static int model;
-static unsigned int crc;
-
 typedef double SBS[2][3][SCALE_BLOCK][SBLIMIT];
 typedef double JSBS[3][SCALE_BLOCK][SBLIMIT];
 typedef unsigned int SUB[2][3][SCALE_BLOCK][SBLIMIT];
 
-static SBS *sb_sample;
-static JSBS *j_sample;
-static SUB *subband;
+/* All the state of one encoder instance. Nothing in the library is
+ * shared between contexts, so several of them can be used concurrently
+ * as long as each one is only used by one thread at a time. */
+struct toolame_context
+{
+    Bit_stream_struc bs;
+    options glopts;
+
+    frame_info frame;
+    frame_header header;
+    int frameNum;
+    int psycount;
+    int model;
+    unsigned int crc;
+    int encode_first_call;
+
+    SBS *sb_sample;
+    JSBS *j_sample;
+    SUB *subband;
+
+    unsigned int scalar[2][3][SBLIMIT];
+    unsigned int j_scale[3][SBLIMIT];
+
+    double smr[2][SBLIMIT];
+    double max_sc[2][SBLIMIT];
+    short sam[2][1344];
+
+    /* Used to keep the SNR values for the fast/quick psy models */
+    FLOAT smrdef[2][32];
+
+    unsigned int scfsi[2][SBLIMIT];
+    unsigned int bit_alloc[2][SBLIMIT];
+
+    subband_mem smem;
+    psycho_0_mem *p0mem;
+    psycho_1_mem *p1mem;
+    psycho_2_mem *p2mem;
+    psycho_3_mem *p3mem;
+    psycho_4_mem *p4mem;
+};
+
+toolame_context_t *toolame_create(void)
+{
+    toolame_context_t *ctx = calloc(1, sizeof(toolame_context_t));
+    if (ctx == NULL) {
+        return NULL;
+    }
+
+    ctx->frameNum = 0;
+    ctx->psycount = 0;
+    ctx->encode_first_call = 1;
+
+    ctx->frame.header = &ctx->header;
+    ctx->frame.tab_num = -1;		/* no table loaded */
+    ctx->frame.alloc = NULL;
+
+    ctx->sb_sample = (SBS *) mem_alloc (sizeof (SBS), "sb_sample");
+    ctx->j_sample = (JSBS *) mem_alloc (sizeof (JSBS), "j_sample");
+    ctx->subband = (SUB *) mem_alloc (sizeof (SUB), "subband");
 
-static unsigned int scalar[2][3][SBLIMIT];
-static unsigned int j_scale[3][SBLIMIT];
+    subband_init(&ctx->smem);
 
-static double smr[2][SBLIMIT];
-static double max_sc[2][SBLIMIT];
-static short sam[2][1344];
+    global_init(&ctx->glopts);
 
-/* Used to keep the SNR values for the fast/quick psy models */
-static FLOAT smrdef[2][32];
+    ctx->header.extension = 0;
+    ctx->header.version = MPEG_AUDIO_ID;	/* Default: MPEG-1 */
+    ctx->header.copyright = 0;
+    ctx->header.original = 0;
+    ctx->header.error_protection = TRUE;
+    ctx->header.dab_extension = 4;
+    ctx->header.lay = DFLT_LAY;
 
-static unsigned int scfsi[2][SBLIMIT];
-static unsigned int bit_alloc[2][SBLIMIT];
+    ctx->model = DFLT_PSY;
 
-static char* mot_file = NULL;
-static char* icy_file = NULL;
+    return ctx;
+}
 
-int toolame_init(void)
+void toolame_destroy(toolame_context_t *ctx)
 {
-    frameNum = 0;
-    psycount = 0;
-
-    frame.header = &header;
-    frame.tab_num = -1;		/* no table loaded */
-    frame.alloc = NULL;
-
-    sb_sample = (SBS *) mem_alloc (sizeof (SBS), "sb_sample");
-    j_sample = (JSBS *) mem_alloc (sizeof (JSBS), "j_sample");
-    subband = (SUB *) mem_alloc (sizeof (SUB), "subband");
-    memset ((char *) scalar, 0, sizeof (scalar));
-    memset ((char *) j_scale, 0, sizeof (j_scale));
-    memset ((char *) smr, 0, sizeof (smr));
-    memset ((char *) max_sc, 0, sizeof (max_sc));
-    memset ((char *) sam, 0, sizeof (sam));
-    memset ((char *) scfsi, 0, sizeof (scfsi));
-    memset ((char *) bit_alloc, 0, sizeof (bit_alloc));
-
-    global_init();
-
-    header.extension = 0;
-    header.version = MPEG_AUDIO_ID;	/* Default: MPEG-1 */
-    header.copyright = 0;
-    header.original = 0;
-    header.error_protection = TRUE;
-    header.dab_extension = 4;
-    header.lay = DFLT_LAY;
-
-    model = DFLT_PSY;
+    if (ctx == NULL) {
+        return;
+    }
 
-    return 0;
+    psycho_0_deinit(&ctx->p0mem);
+    psycho_1_deinit(&ctx->p1mem);
+    psycho_2_deinit(&ctx->p2mem);
+    psycho_3_deinit(&ctx->p3mem);
+    psycho_4_deinit(&ctx->p4mem);
+
+    mem_free((void **) &ctx->sb_sample);
+    mem_free((void **) &ctx->j_sample);
+    mem_free((void **) &ctx->subband);
+    mem_free((void **) &ctx->frame.alloc);
+    mem_free((void **) &ctx->bs.buf);
+
+    free(ctx);
 }
 
 int toolame_finish(
+        toolame_context_t *ctx,
         unsigned char *output_buffer,
         size_t output_buffer_size)
 {
-    bs.output_buffer = output_buffer;
-    bs.output_buffer_size = output_buffer_size;
-    bs.output_buffer_written = 0;
+    Bit_stream_struc *bs = &ctx->bs;
 
-    close_bit_stream_w(&bs);
+    bs->output_buffer = output_buffer;
+    bs->output_buffer_size = output_buffer_size;
+    bs->output_buffer_written = 0;
 
-    return bs.output_buffer_written;
+    close_bit_stream_w(bs);
+
+    return bs->output_buffer_written;
 }
 
-int toolame_enable_byteswap(void)
+int toolame_enable_byteswap(toolame_context_t *ctx)
 {
-    glopts.byteswap = TRUE;
+    ctx->glopts.byteswap = TRUE;
     return 0;
 }
 
-int toolame_set_channel_mode(const char mode)
+int toolame_set_channel_mode(toolame_context_t *ctx, const char mode)
 {
+    frame_header *header = &ctx->header;
+
     switch (mode) {
         case 's':
-            header.mode = MPG_MD_STEREO;
-            header.mode_ext = 0;
+            header->mode = MPG_MD_STEREO;
+            header->mode_ext = 0;
             break;
         case 'd':
-            header.mode = MPG_MD_DUAL_CHANNEL;
-            header.mode_ext = 0;
+            header->mode = MPG_MD_DUAL_CHANNEL;
+            header->mode_ext = 0;
             break;
-            /* in j-stereo mode, no default header.mode_ext was defined, gave error..
+            /* in j-stereo mode, no default header->mode_ext was defined, gave error..
                now  default = 2   added by MFC 14 Dec 1999.  */
         case 'j':
-            header.mode = MPG_MD_JOINT_STEREO;
-            header.mode_ext = 2;
+            header->mode = MPG_MD_JOINT_STEREO;
+            header->mode_ext = 2;
             break;
         case 'm':
-            header.mode = MPG_MD_MONO;
-            header.mode_ext = 0;
+            header->mode = MPG_MD_MONO;
+            header->mode_ext = 0;
             break;
         default:
             fprintf (stderr, "libtoolame-dab: Bad mode %c\n", mode);
@@ -199,55 +236,56 @@ int toolame_set_channel_mode(const char mode)
     return 0;
 }
 
-int toolame_set_psy_model(int new_model)
+int toolame_set_psy_model(toolame_context_t *ctx, int new_model)
 {
     if (new_model < 0 || new_model > 3) {
         fprintf(stderr, "libtoolame-dab: Invalid PSY model %d\n", new_model);
         return 1;
     }
-    model = new_model;
+    ctx->model = new_model;
     return 0;
 }
 
-int toolame_set_bitrate(int brate)
+int toolame_set_bitrate(toolame_context_t *ctx, int brate)
 {
+    frame_header *header = &ctx->header;
     int err = 0;
 
     /* check for a valid bitrate */
     if (brate == 0)
-        brate = bitrate[header.version][10];
+        brate = bitrate[header->version][10];
 
     /* Check to see we have a sane value for the bitrate for this version */
-    if ((header.bitrate_index = BitrateIndex (brate, header.version)) < 0) {
+    if ((header->bitrate_index = BitrateIndex (brate, header->version)) < 0) {
         err = 1;
     }
 
-    if (header.dab_extension) {
+    if (header->dab_extension) {
         /* in 48 kHz (= MPEG-1) */
         /* if the bit rate per channel is less then 56 kbit/s, we have 2 scf-crc */
         /* else we have 4 scf-crc */
         /* in 24 kHz (= MPEG-2), we have 4 scf-crc */
-        if (header.version == MPEG_AUDIO_ID && (brate / (header.mode == MPG_MD_MONO ? 1 : 2) < 56))
-            header.dab_extension = 2;
+        if (header->version == MPEG_AUDIO_ID && (brate / (header->mode == MPG_MD_MONO ? 1 : 2) < 56))
+            header->dab_extension = 2;
     }
 
-    open_bit_stream_w(&bs, BUFFER_SIZE);
+    open_bit_stream_w(&ctx->bs, BUFFER_SIZE);
 
     return err;
 }
 
-int toolame_set_samplerate(long sample_rate)
+int toolame_set_samplerate(toolame_context_t *ctx, long sample_rate)
 {
-    int s_freq = SmpFrqIndex(sample_rate, &header.version);
+    int s_freq = SmpFrqIndex(sample_rate, &ctx->header.version);
     if (s_freq < 0) {
         return s_freq;
     }
 
-    header.sampling_frequency = s_freq;
+    ctx->header.sampling_frequency = s_freq;
     return 0;
 }
 
-int toolame_set_pad(int pad_len)
+int toolame_set_pad(toolame_context_t *ctx, int pad_len)
 {
     if (pad_len < 0) {
         fprintf(stderr, "Invalid XPAD length specified\n");
@@ -255,50 +293,65 @@ int toolame_set_pad(int pad_len)
     }
 
     if (pad_len) {
-        header.dab_length = pad_len;
+        ctx->header.dab_length = pad_len;
     }
 
     return 0;
 }
 
-
-static int encode_first_call = 1;
-
 int toolame_encode_frame(
+        toolame_context_t *ctx,
         short buffer[2][1152],
         unsigned char *xpad_data,
         size_t xpad_len,
         unsigned char *output_buffer,
         size_t output_buffer_size)
 {
-    if (encode_first_call) {
-        hdr_to_frps(&frame);
-        encode_first_call = 0;
+    frame_info *frame = &ctx->frame;
+    frame_header *header = &ctx->header;
+    options *glopts = &ctx->glopts;
+    Bit_stream_struc *bs = &ctx->bs;
+
+    SBS *sb_sample = ctx->sb_sample;
+    JSBS *j_sample = ctx->j_sample;
+    SUB *subband = ctx->subband;
+    unsigned int (*scalar)[3][SBLIMIT] = ctx->scalar;
+    unsigned int (*j_scale)[SBLIMIT] = ctx->j_scale;
+    double (*smr)[SBLIMIT] = ctx->smr;
+    double (*max_sc)[SBLIMIT] = ctx->max_sc;
+    short (*sam)[1344] = ctx->sam;
+    unsigned int (*scfsi)[SBLIMIT] = ctx->scfsi;
+    unsigned int (*bit_alloc)[SBLIMIT] = ctx->bit_alloc;
+    const FLOAT sfreq = (FLOAT) s_freq[header->version][header->sampling_frequency] * 1000;
+
+    if (ctx->encode_first_call) {
+        hdr_to_frps(frame);
+        ctx->encode_first_call = 0;
     }
 
-    frameNum++;
+    const int frameNum = ++ctx->frameNum;
 
-    const int nch = frame.nch;
-    const int error_protection = header.error_protection;
+    const int nch = frame->nch;
+    const int error_protection = header->error_protection;
 
-    bs.output_buffer = output_buffer;
-    bs.output_buffer_size = output_buffer_size;
-    bs.output_buffer_written = 0;
+    bs->output_buffer = output_buffer;
+    bs->output_buffer_size = output_buffer_size;
+    bs->output_buffer_written = 0;
 
 #ifdef REFERENCECODE
     short *win_buf[2] = {&buffer[0][0], &buffer[1][0]};
 #endif
 
-    int adb = available_bits (&header, &glopts);
+    int adb = available_bits (header, glopts);
     int lg_frame = adb / 8;
-    if (header.dab_extension) {
+    if (header->dab_extension) {
         /* You must have one frame in memory if you are in DAB mode                 */
         /* in conformity of the norme ETS 300 401 http://www.etsi.org               */
         /* see bitstream.c            */
         if (frameNum == 1) {
-            bs_set_minimum(lg_frame + MINIMUM);
+            bs_set_minimum(bs, lg_frame + MINIMUM);
         }
-        adb -= header.dab_extension * 8 + (xpad_len ? xpad_len : FPAD_LENGTH) * 8;
+        adb -= header->dab_extension * 8 + (xpad_len ? xpad_len : FPAD_LENGTH) * 8;
     }
 
     {
@@ -308,7 +361,7 @@ int toolame_encode_frame(
         for( gr = 0; gr < 3; gr++ )
             for ( bl = 0; bl < 12; bl++ )
                 for ( ch = 0; ch < nch; ch++ )
-                    WindowFilterSubband( &buffer[ch][gr * 12 * 32 + 32 * bl], ch,
+                    WindowFilterSubband( &ctx->smem, &buffer[ch][gr * 12 * 32 + 32 * bl], ch,
                             &(*sb_sample)[ch][gr][bl][0] );
     }
 
@@ -327,109 +380,103 @@ int toolame_encode_frame(
 
 
 #ifdef NEWENCODE
-    scalefactor_calc_new(*sb_sample, scalar, nch, frame.sblimit);
-    find_sf_max (scalar, &frame, max_sc);
-    if (frame.actual_mode == MPG_MD_JOINT_STEREO) {
+    scalefactor_calc_new(*sb_sample, scalar, nch, frame->sblimit);
+    find_sf_max (scalar, frame, max_sc);
+    if (frame->actual_mode == MPG_MD_JOINT_STEREO) {
         /* this way we calculate more mono than we need */
         /* but it is cheap */
-        combine_LR_new (*sb_sample, *j_sample, frame.sblimit);
-        scalefactor_calc_new (j_sample, &j_scale, 1, frame.sblimit);
+        combine_LR_new (*sb_sample, *j_sample, frame->sblimit);
+        scalefactor_calc_new (j_sample, &ctx->j_scale, 1, frame->sblimit);
     }
 #else
-    scale_factor_calc (*sb_sample, scalar, nch, frame.sblimit);
-    pick_scale (scalar, &frame, max_sc);
-    if (frame.actual_mode == MPG_MD_JOINT_STEREO) {
+    scale_factor_calc (*sb_sample, scalar, nch, frame->sblimit);
+    pick_scale (scalar, frame, max_sc);
+    if (frame->actual_mode == MPG_MD_JOINT_STEREO) {
         /* this way we calculate more mono than we need */
         /* but it is cheap */
-        combine_LR (*sb_sample, *j_sample, frame.sblimit);
-        scale_factor_calc (j_sample, &j_scale, 1, frame.sblimit);
+        combine_LR (*sb_sample, *j_sample, frame->sblimit);
+        scale_factor_calc (j_sample, &ctx->j_scale, 1, frame->sblimit);
     }
 #endif
 
 
 
-    if ((glopts.quickmode == TRUE) && (++psycount % glopts.quickcount != 0)) {
+    if ((glopts->quickmode == TRUE) && (++ctx->psycount % glopts->quickcount != 0)) {
         /* We're using quick mode, so we're only calculating the model every
            'quickcount' frames. Otherwise, just copy the old ones across */
         for (int ch = 0; ch < nch; ch++) {
             for (int sb = 0; sb < SBLIMIT; sb++)
-                smr[ch][sb] = smrdef[ch][sb];
+                smr[ch][sb] = ctx->smrdef[ch][sb];
         }
     }
     else {
         /* calculate the psymodel */
-        switch (model) {
+        switch (ctx->model) {
             case -1:
                 psycho_n1 (smr, nch);
                 break;
             case 0:	/* Psy Model A */
-                psycho_0 (smr, nch, scalar, (FLOAT) s_freq[header.version][header.sampling_frequency] * 1000);
+                psycho_0 (&ctx->p0mem, smr, nch, scalar, sfreq);
                 break;
             case 1:
-                psycho_1 (buffer, max_sc, smr, &frame);
+                psycho_1 (&ctx->p1mem, buffer, max_sc, smr, frame);
                 break;
             case 2:
                 for (int ch = 0; ch < nch; ch++) {
-                    psycho_2 (&buffer[ch][0], &sam[ch][0], ch, &smr[ch][0], //snr32,
-                            (FLOAT) s_freq[header.version][header.sampling_frequency] *
-                            1000, &glopts);
+                    psycho_2 (&ctx->p2mem, &buffer[ch][0], &sam[ch][0], ch, &smr[ch][0], //snr32,
+                            sfreq, glopts);
                 }
                 break;
             case 3:
                 /* Modified psy model 1 */
-                psycho_3 (buffer, max_sc, smr, &frame, &glopts);
+                psycho_3 (&ctx->p3mem, buffer, max_sc, smr, frame, glopts);
                 break;
             case 4:
                 /* Modified Psycho Model 2 */
                 for (int ch = 0; ch < nch; ch++) {
-                    psycho_4 (&buffer[ch][0], &sam[ch][0], ch, &smr[ch][0], // snr32,
-                            (FLOAT) s_freq[header.version][header.sampling_frequency] *
-                            1000, &glopts);
+                    psycho_4 (&ctx->p4mem, &buffer[ch][0], &sam[ch][0], ch, &smr[ch][0], // snr32,
+                            sfreq, glopts);
                 }
                 break;	
             case 5:
                 /* Model 5 comparse model 1 and 3 */
-                psycho_1 (buffer, max_sc, smr, &frame);
+                psycho_1 (&ctx->p1mem, buffer, max_sc, smr, frame);
                 fprintf(stdout,"1 ");
                 smr_dump(smr,nch);
-                psycho_3 (buffer, max_sc, smr, &frame, &glopts);
+                psycho_3 (&ctx->p3mem, buffer, max_sc, smr, frame, glopts);
                 fprintf(stdout,"3 ");
                 smr_dump(smr,nch);
                 break;
             case 6:
                 /* Model 6 compares model 2 and 4 */
                 for (int ch = 0; ch < nch; ch++) 
-                    psycho_2 (&buffer[ch][0], &sam[ch][0], ch, &smr[ch][0], //snr32,
-                            (FLOAT) s_freq[header.version][header.sampling_frequency] *
-                            1000, &glopts);
+                    psycho_2 (&ctx->p2mem, &buffer[ch][0], &sam[ch][0], ch, &smr[ch][0], //snr32,
+                            sfreq, glopts);
                 fprintf(stdout,"2 ");
                 smr_dump(smr,nch);
                 for (int ch = 0; ch < nch; ch++) 
-                    psycho_4 (&buffer[ch][0], &sam[ch][0], ch, &smr[ch][0], // snr32,
-                            (FLOAT) s_freq[header.version][header.sampling_frequency] *
-                            1000, &glopts);
+                    psycho_4 (&ctx->p4mem, &buffer[ch][0], &sam[ch][0], ch, &smr[ch][0], // snr32,
+                            sfreq, glopts);
                 fprintf(stdout,"4 ");
                 smr_dump(smr,nch);
                 break;
             case 7:
                 fprintf(stdout,"Frame: %i\n",frameNum);
                 /* Dump the SMRs for all models */	
-                psycho_1 (buffer, max_sc, smr, &frame);
+                psycho_1 (&ctx->p1mem, buffer, max_sc, smr, frame);
                 fprintf(stdout,"1");
                 smr_dump(smr, nch);
-                psycho_3 (buffer, max_sc, smr, &frame, &glopts);
+                psycho_3 (&ctx->p3mem, buffer, max_sc, smr, frame, glopts);
                 fprintf(stdout,"3");
                 smr_dump(smr,nch);
                 for (int ch = 0; ch < nch; ch++) 
-                    psycho_2 (&buffer[ch][0], &sam[ch][0], ch, &smr[ch][0], //snr32,
-                            (FLOAT) s_freq[header.version][header.sampling_frequency] *
-                            1000, &glopts);
+                    psycho_2 (&ctx->p2mem, &buffer[ch][0], &sam[ch][0], ch, &smr[ch][0], //snr32,
+                            sfreq, glopts);
                 fprintf(stdout,"2");
                 smr_dump(smr,nch);
                 for (int ch = 0; ch < nch; ch++) 
-                    psycho_4 (&buffer[ch][0], &sam[ch][0], ch, &smr[ch][0], // snr32,
-                            (FLOAT) s_freq[header.version][header.sampling_frequency] *
-                            1000, &glopts);
+                    psycho_4 (&ctx->p4mem, &buffer[ch][0], &sam[ch][0], ch, &smr[ch][0], // snr32,
+                            sfreq, glopts);
                 fprintf(stdout,"4");
                 smr_dump(smr,nch);
                 break;
@@ -440,75 +487,74 @@ int toolame_encode_frame(
                 smr_dump(smr,nch);
 
                 for (int ch = 0; ch < nch; ch++) 
-                    psycho_4 (&buffer[ch][0], &sam[ch][0], ch, &smr[ch][0], // snr32,
-                            (FLOAT) s_freq[header.version][header.sampling_frequency] *
-                            1000, &glopts);
+                    psycho_4 (&ctx->p4mem, &buffer[ch][0], &sam[ch][0], ch, &smr[ch][0], // snr32,
+                            sfreq, glopts);
                 fprintf(stdout,"4");
                 smr_dump(smr,nch);
                 break;
             default:
-                fprintf (stderr, "Invalid psy model specification: %i\n", model);
+                fprintf (stderr, "Invalid psy model specification: %i\n", ctx->model);
                 exit (0);
         }
 
-        if (glopts.quickmode == TRUE) {
+        if (glopts->quickmode == TRUE) {
             /* copy the smr values and reuse them later */
             for (int ch = 0; ch < nch; ch++) {
                 for (int sb = 0; sb < SBLIMIT; sb++)
-                    smrdef[ch][sb] = smr[ch][sb];
+                    ctx->smrdef[ch][sb] = smr[ch][sb];
             }
         }
 
-        if (glopts.verbosity > 4) {
+        if (glopts->verbosity > 4) {
             smr_dump(smr, nch);
         }
     }
 
 #ifdef NEWENCODE
-    sf_transmission_pattern (scalar, scfsi, &frame);
-    main_bit_allocation_new (smr, scfsi, bit_alloc, &adb, &frame, &glopts);
-    //main_bit_allocation (smr, scfsi, bit_alloc, &adb, &frame, &glopts);
+    sf_transmission_pattern (scalar, scfsi, frame);
+    main_bit_allocation_new (smr, scfsi, bit_alloc, &adb, frame, glopts);
+    //main_bit_allocation (smr, scfsi, bit_alloc, &adb, frame, glopts);
 
     if (error_protection) {
-        CRC_calc (&frame, bit_alloc, scfsi, &crc);
+        CRC_calc (frame, bit_alloc, scfsi, &ctx->crc);
     }
 
-    write_header (&frame, &bs);
-    //encode_info (&frame, &bs);
+    write_header (frame, bs);
+    //encode_info (frame, bs);
     if (error_protection) {
-        putbits (&bs, crc, 16);
+        putbits (bs, ctx->crc, 16);
     }
-    write_bit_alloc (bit_alloc, &frame, &bs);
-    //encode_bit_alloc (bit_alloc, &frame, &bs);
-    write_scalefactors(bit_alloc, scfsi, scalar, &frame, &bs);
-    //encode_scale (bit_alloc, scfsi, scalar, &frame, &bs);
+    write_bit_alloc (bit_alloc, frame, bs);
+    //encode_bit_alloc (bit_alloc, frame, bs);
+    write_scalefactors(bit_alloc, scfsi, scalar, frame, bs);
+    //encode_scale (bit_alloc, scfsi, scalar, frame, bs);
     subband_quantization_new (scalar, *sb_sample, j_scale, *j_sample, bit_alloc,
-            *subband, &frame);
+            *subband, frame);
     //subband_quantization (scalar, *sb_sample, j_scale, *j_sample, bit_alloc,
-    //	  *subband, &frame);
-    write_samples_new(*subband, bit_alloc, &frame, &bs);
-    //sample_encoding (*subband, bit_alloc, &frame, &bs);
+    //	  *subband, frame);
+    write_samples_new(*subband, bit_alloc, frame, bs);
+    //sample_encoding (*subband, bit_alloc, frame, bs);
 #else
-    transmission_pattern (scalar, scfsi, &frame);
-    main_bit_allocation (smr, scfsi, bit_alloc, &adb, &frame, &glopts);
+    transmission_pattern (scalar, scfsi, frame);
+    main_bit_allocation (smr, scfsi, bit_alloc, &adb, frame, glopts);
     if (error_protection) {
-        CRC_calc (&frame, bit_alloc, scfsi, &crc);
+        CRC_calc (frame, bit_alloc, scfsi, &ctx->crc);
     }
-    encode_info (&frame, &bs);
+    encode_info (frame, bs);
     if (error_protection) {
-        encode_CRC (crc, &bs);
+        encode_CRC (ctx->crc, bs);
     }
-    encode_bit_alloc (bit_alloc, &frame, &bs);
-    encode_scale (bit_alloc, scfsi, scalar, &frame, &bs);
+    encode_bit_alloc (bit_alloc, frame, bs);
+    encode_scale (bit_alloc, scfsi, scalar, frame, bs);
     subband_quantization (scalar, *sb_sample, j_scale, *j_sample, bit_alloc,
-            *subband, &frame);
-    sample_encoding (*subband, bit_alloc, &frame, &bs);
+            *subband, frame);
+    sample_encoding (*subband, bit_alloc, frame, bs);
 #endif
 
 
     /* If not all the bits were used, write out a stack of zeros */
     for (int i = 0; i < adb; i++) {
-        put1bit (&bs, 0);
+        put1bit (bs, 0);
     }
 
 
@@ -516,41 +562,41 @@ int toolame_encode_frame(
         assert(xpad_len >= FPAD_LENGTH);
 
         // insert available X-PAD
-        for (int i = header.dab_length - xpad_len;
-                i < header.dab_length - FPAD_LENGTH;
+        for (int i = header->dab_length - xpad_len;
+                i < header->dab_length - FPAD_LENGTH;
                 i++) {
-            putbits (&bs, xpad_data[i], 8);
+            putbits (bs, xpad_data[i], 8);
         }
     }
 
 
-    for (int i = header.dab_extension - 1; i >= 0; i--) {
-        CRC_calcDAB (&frame, bit_alloc, scfsi, scalar, &crc, i);
+    for (int i = header->dab_extension - 1; i >= 0; i--) {
+        CRC_calcDAB (frame, bit_alloc, scfsi, scalar, &ctx->crc, i);
         /* this crc is for the previous frame in DAB mode  */
-        if (bs.buf_byte_idx + lg_frame < bs.buf_size) {
-            bs.buf[bs.buf_byte_idx + lg_frame] = crc;
+        if (bs->buf_byte_idx + lg_frame < bs->buf_size) {
+            bs->buf[bs->buf_byte_idx + lg_frame] = ctx->crc;
         }
         else {
             if (frameNum > 1) {
                 // frameNum 1 will always fail, because there is no previous frame
                 fprintf(stderr, "Error: Failed to insert SCF-CRC in frame %d, %d < %d\n",
-                        frameNum, bs.buf_byte_idx + lg_frame, bs.buf_size);
+                        frameNum, bs->buf_byte_idx + lg_frame, bs->buf_size);
             }
         }
         /* reserved 2 bytes for F-PAD in DAB mode  */
-        putbits (&bs, crc, 8);
+        putbits (bs, ctx->crc, 8);
     }
 
     if (xpad_len) {
         /* The F-PAD is also given us by ODR-PadEnc */
-        putbits (&bs, xpad_data[header.dab_length - 2], 8);
-        putbits (&bs, xpad_data[header.dab_length - 1], 8);
+        putbits (bs, xpad_data[header->dab_length - 2], 8);
+        putbits (bs, xpad_data[header->dab_length - 1], 8);
     }
     else {
-        putbits (&bs, 0, 16); // FPAD is all-zero
+        putbits (bs, 0, 16); // FPAD is all-zero
     }
 
-    return bs.output_buffer_written;
+    return bs->output_buffer_written;
 }
 
 // Dump function for psy model comparison
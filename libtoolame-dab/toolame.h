@@ -9,38 +9,51 @@
 /*! All exported functions shown here return zero
  * on success */
 
-/*! Initialise toolame encoding library. */
-int toolame_init(void);
+/*! Opaque encoder state. Each context is independent, so several
+ * encoders can run in the same process. A context must not be used
+ * from more than one thread at the same time. */
+typedef struct toolame_context toolame_context_t;
+
+/*! Create a new encoder context with default settings.
+ *
+ * \return the context, or NULL on allocation failure
+ */
+toolame_context_t *toolame_create(void);
+
+/*! Release all resources held by the context */
+void toolame_destroy(toolame_context_t *ctx);
 
 /*! Finish encoding the pending samples.
  *
  * \return number of bytes written to output_buffer
  */
 int toolame_finish(
+        toolame_context_t *ctx,
         unsigned char *output_buffer,
         size_t output_buffer_size);
 
-int toolame_enable_byteswap(void);
+int toolame_enable_byteswap(toolame_context_t *ctx);
 
 /*! Set channel mode. Allowed values:
  * s, d, j, and m
  */
-int toolame_set_channel_mode(const char mode);
+int toolame_set_channel_mode(toolame_context_t *ctx, const char mode);
 
 /*! Valid PSY models: 0 to 3 */
-int toolame_set_psy_model(int new_model);
+int toolame_set_psy_model(toolame_context_t *ctx, int new_model);
 
-int toolame_set_bitrate(int brate);
+int toolame_set_bitrate(toolame_context_t *ctx, int brate);
 
 /*! Set sample rate in Hz */
-int toolame_set_samplerate(long sample_rate);
+int toolame_set_samplerate(toolame_context_t *ctx, long sample_rate);
 
 /*! Enable PAD insertion from the specified file with length */
-int toolame_set_pad(int pad_len);
+int toolame_set_pad(toolame_context_t *ctx, int pad_len);
 
 /*! Encodes one frame. Returns number of bytes written to output_buffer
  */
 int toolame_encode_frame(
+        toolame_context_t *ctx,
         short buffer[2][1152],
         unsigned char *xpad_data,
         size_t xpad_len,
@@ -22,6 +22,7 @@
 
 #include "AlsaInput.h"
 #include <cstdio>
+#include <memory>
 #include <stdexcept>
 #include <string>
 #include <alsa/asoundlib.h>
@@ -82,8 +83,9 @@ void AlsaInput::m_init_alsa()
                 alsa_strerror(err) + ")");
     }
 
+    unsigned int device_rate = m_rate;
     if ((err = snd_pcm_hw_params_set_rate_near(m_alsa_handle,
-                hw_params, &m_rate, 0)) < 0) {
+                hw_params, &device_rate, 0)) < 0) {
         throw runtime_error("cannot set sample rate (" + alsa_strerror(err) + ")");
     }
 
@@ -99,6 +101,15 @@ void AlsaInput::m_init_alsa()
 
     snd_pcm_hw_params_free (hw_params);
 
+    if (device_rate != m_rate) {
+        m_resampler = make_unique<Resampler>(device_rate, m_rate, m_channels, m_src_quality);
+        fprintf(stderr, "ALSA device runs at %u Hz, resampling to %u Hz\n",
+                device_rate, m_rate);
+    }
+    else {
+        m_resampler.reset();
+    }
+
     if ((err = snd_pcm_prepare(m_alsa_handle)) < 0) {
         throw runtime_error("cannot prepare audio interface for use (" +
                 alsa_strerror(err) + ")");
@@ -126,6 +137,18 @@ ssize_t AlsaInput::m_read(uint8_t* buf, snd_pcm_uframes_t length)
     return err;
 }
 
+size_t AlsaInput::m_push(const uint8_t* buf, size_t num_frames)
+{
+    if (not m_resampler) {
+        m_queue.push(buf, BYTES_PER_SAMPLE * m_channels * num_frames);
+        return num_frames;
+    }
+
+    m_resampler->process((const int16_t*)buf, num_frames, m_resampled);
+    m_queue.push((const uint8_t*)m_resampled.data(), m_resampled.size() * sizeof(int16_t));
+    return m_resampled.size() / m_channels;
+}
+
 AlsaInputThreaded::~AlsaInputThreaded()
 {
     m_running = false;
@@ -169,7 +192,7 @@ void AlsaInputThreaded::process()
             break;
         }
 
-        m_queue.push(samplebuf, BYTES_PER_SAMPLE*m_channels*n);
+        m_push(samplebuf, n);
     }
 }
 
@@ -183,14 +206,37 @@ bool AlsaInputDirect::read_source(size_t num_bytes)
     const int bytes_per_frame = m_channels * BYTES_PER_SAMPLE;
     assert(num_bytes % bytes_per_frame == 0);
 
-    const size_t num_frames = num_bytes / bytes_per_frame;
-    vector<uint8_t> buf(num_bytes);
-    ssize_t ret = m_read(buf.data(), num_frames);
+    if (not m_resampler) {
+        const size_t num_frames = num_bytes / bytes_per_frame;
+        if (m_samplebuf.size() < num_bytes) {
+            m_samplebuf.resize(num_bytes);
+        }
+        ssize_t ret = m_read(m_samplebuf.data(), num_frames);
 
-    if (ret > 0) {
-        m_queue.push(buf.data(), ret * bytes_per_frame);
+        if (ret > 0) {
+            m_queue.push(m_samplebuf.data(), ret * bytes_per_frame);
+        }
+        return ret == (ssize_t)num_frames;
     }
-    return ret == (ssize_t)num_frames;
+
+    /* Read until the resampler gave at least as many frames as asked for.
+     * What it gives in excess is deducted from the next request. */
+    m_missing_frames += num_bytes / bytes_per_frame;
+    while (m_missing_frames > 0) {
+        const size_t num_frames = m_resampler->input_frames_for(m_missing_frames);
+        if (m_samplebuf.size() < num_frames * bytes_per_frame) {
+            m_samplebuf.resize(num_frames * bytes_per_frame);
+        }
+        ssize_t ret = m_read(m_samplebuf.data(), num_frames);
+
+        if (ret > 0) {
+            m_missing_frames -= m_push(m_samplebuf.data(), ret);
+        }
+        if (ret != (ssize_t)num_frames) {
+            return false;
+        }
+    }
+    return true;
 }
 
 #endif // HAVE_ALSA
@@ -29,18 +29,24 @@
 
 #include <cstdio>
 #include <string>
+#include <vector>
 #include <thread>
 #include <atomic>
+#include <memory>
 
 #include <alsa/asoundlib.h>
 
 #include "SampleQueue.h"
 #include "common.h"
 #include "InputInterface.h"
+#include "Resampler.h"
 
 /*! Common functionality for the direct alsa input and the
  * threaded alsa input. The threaded one is used for
  * drift compensation.
+ *
+ * If the device does not support the requested rate, it is opened
+ * at the nearest rate it supports, and the samples are resampled.
  */
 class AlsaInput : public InputInterface
 {
@@ -48,10 +54,12 @@ class AlsaInput : public InputInterface
         AlsaInput(const std::string& alsa_dev,
                 unsigned int channels,
                 unsigned int rate,
+                resampler_quality_t src_quality,
                 SampleQueue<uint8_t>& queue) :
             m_alsa_dev(alsa_dev),
             m_channels(channels),
             m_rate(rate),
+            m_src_quality(src_quality),
             m_queue(queue) { }
 
         AlsaInput(const AlsaInput& other) = delete;
@@ -68,12 +76,22 @@ class AlsaInput : public InputInterface
         /* Open the ALSA device and set it up */
         void m_init_alsa(void);
 
+        /* Push num_frames frames read from the device into the queue,
+         * through the resampler if there is one. Returns the number of
+         * frames pushed. */
+        size_t m_push(const uint8_t* buf, size_t num_frames);
+
         std::string m_alsa_dev;
         unsigned int m_channels;
         unsigned int m_rate;
+        resampler_quality_t m_src_quality;
 
         SampleQueue<uint8_t>& m_queue;
 
+        /* Set if the device runs at another rate than m_rate */
+        std::unique_ptr<Resampler> m_resampler;
+        std::vector<int16_t> m_resampled;
+
         snd_pcm_t *m_alsa_handle = nullptr;
 };
 
@@ -83,8 +101,9 @@ class AlsaInputDirect : public AlsaInput
         AlsaInputDirect(const std::string& alsa_dev,
                 unsigned int channels,
                 unsigned int rate,
+                resampler_quality_t src_quality,
                 SampleQueue<uint8_t>& queue) :
-            AlsaInput(alsa_dev, channels, rate, queue) { }
+            AlsaInput(alsa_dev, channels, rate, src_quality, queue) { }
 
         virtual void prepare(void) override;
 
@@ -98,6 +117,14 @@ class AlsaInputDirect : public AlsaInput
          * \return the number of bytes read.
          */
         ssize_t read(uint8_t* buf, size_t length);
+
+    private:
+        /* Reused by read_source() to avoid allocations */
+        std::vector<uint8_t> m_samplebuf;
+
+        /* Frames the encoder asked for and that were not yet pushed,
+         * when resampling */
+        ssize_t m_missing_frames = 0;
 };
 
 class AlsaInputThreaded : public AlsaInput
@@ -106,8 +133,9 @@ class AlsaInputThreaded : public AlsaInput
         AlsaInputThreaded(const std::string& alsa_dev,
                 unsigned int channels,
                 unsigned int rate,
+                resampler_quality_t src_quality,
                 SampleQueue<uint8_t>& queue) :
-            AlsaInput(alsa_dev, channels, rate, queue),
+            AlsaInput(alsa_dev, channels, rate, src_quality, queue),
             m_fault(false),
             m_running(false) { }
 
@@ -0,0 +1,96 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+
+#include "DriftCompensator.h"
+#include "common.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+
+/* Time constant of the averaging of the fill level, which removes the
+ * jitter caused by the size of the pushes and pops */
+static const double FILL_TIME_CONSTANT = 1.0;
+
+/* The controller is a second order loop with this natural frequency.
+ * A low frequency keeps the variations of the ratio, and therefore of
+ * the pitch, small and slow. The damping of 0.707 makes it slightly
+ * underdamped, like a Butterworth response: it settles faster than a
+ * critically damped loop, at the cost of some overshoot. */
+static const double LOOP_BANDWIDTH = 0.01; // Hz
+static const double LOOP_DAMPING = 0.707;
+
+static const double LOOP_OMEGA = 2.0 * M_PI * LOOP_BANDWIDTH;
+static const double KP = 2.0 * LOOP_DAMPING * LOOP_OMEGA;
+static const double KI = LOOP_OMEGA * LOOP_OMEGA;
+
+/* Largest clock difference the controller compensates */
+static const double MAX_DEVIATION = 5e-3;
+
+DriftCompensator::DriftCompensator(SampleQueue<uint8_t>& queue,
+        unsigned int sample_rate, unsigned int channels, size_t target_bytes,
+        resampler_quality_t quality) :
+    m_queue(queue),
+    m_sample_rate(sample_rate),
+    m_bytes_per_frame(channels * BYTES_PER_SAMPLE),
+    m_target_frames(target_bytes / (channels * BYTES_PER_SAMPLE)),
+    m_resampler(channels, quality)
+{
+}
+
+size_t DriftCompensator::read(uint8_t *buf, size_t len, size_t *overruns)
+{
+    const size_t out_frames = len / m_bytes_per_frame;
+    const size_t fill = m_queue.size() / m_bytes_per_frame;
+
+    if (not m_running) {
+        if (fill < m_target_frames) {
+            // Only collects the overrun counter
+            m_queue.pop(buf, 0, overruns);
+            memset(buf, 0, len);
+            return len;
+        }
+        m_running = true;
+        m_filtered_fill = m_target_frames;
+    }
+
+    const double dt = (double)out_frames / m_sample_rate;
+    m_filtered_fill += (fill - m_filtered_fill) * dt / (FILL_TIME_CONSTANT + dt);
+
+    // The error in seconds of audio, the ratio is dimensionless
+    const double error = (m_filtered_fill - m_target_frames) / m_sample_rate;
+    m_integral = std::clamp(m_integral + KI * error * dt, -MAX_DEVIATION, MAX_DEVIATION);
+    const double deviation = std::clamp(KP * error + m_integral, -MAX_DEVIATION, MAX_DEVIATION);
+    m_resampler.set_ratio(1.0 + deviation);
+
+    const size_t in_frames = m_resampler.input_frames_for(out_frames);
+    const size_t in_bytes = in_frames * m_bytes_per_frame;
+    m_input.resize(in_bytes / sizeof(int16_t));
+
+    // pop() replaces what is missing by silence
+    const size_t popped = m_queue.pop((uint8_t*)m_input.data(), in_bytes, overruns);
+    m_resampler.process(m_input.data(), in_frames, (int16_t*)buf, out_frames);
+
+    if (popped < in_bytes) {
+        // The source stopped, wait until the queue is filled again
+        m_running = false;
+        return std::min(len, in_bytes - popped);
+    }
+    return 0;
+}
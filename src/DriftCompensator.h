@@ -0,0 +1,88 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "SampleQueue.h"
+#include "Resampler.h"
+
+/*! \file DriftCompensator.h
+ *
+ * Compensation of the clock drift between a sound card (or any other
+ * source that delivers samples at its own pace) and the encoder, which
+ * consumes them at the nominal rate of the system clock.
+ *
+ * The input queue is kept at a target fill level by resampling its
+ * content with a ratio that a PI controller derives from the fill
+ * level. When the source runs fast, the queue fills up and the ratio
+ * increases slightly above one, so that more input is consumed for
+ * every output frame, and vice versa. In steady state, the integral
+ * term of the controller is the relative difference of the two clocks,
+ * which is published as the drift in ppm.
+ *
+ * No samples are dropped or repeated as long as the drift stays within
+ * the range of the controller. If the queue runs empty anyway, because
+ * the source stopped, the missing samples are replaced by silence, and
+ * the output stays silent until the queue has filled up to the target
+ * again.
+ */
+
+class DriftCompensator {
+    public:
+        /*! target_bytes is the queue fill level the controller aims for. It
+         * is also the latency the compensation adds. */
+        DriftCompensator(SampleQueue<uint8_t>& queue, unsigned int sample_rate,
+                unsigned int channels, size_t target_bytes,
+                resampler_quality_t quality);
+        DriftCompensator(const DriftCompensator& other) = delete;
+        DriftCompensator& operator=(const DriftCompensator& other) = delete;
+
+        /*! Fill buf with len bytes of audio at the nominal rate.
+         * overruns is set to the number of pushes the queue rejected
+         * since the last call.
+         *
+         * \return the number of bytes that were replaced by silence
+         */
+        size_t read(uint8_t *buf, size_t len, size_t *overruns);
+
+        /*! The measured drift of the source clock against the system
+         * clock, in ppm. Positive if the source is fast. */
+        double drift_ppm() const { return m_integral * 1e6; }
+
+    private:
+        SampleQueue<uint8_t>& m_queue;
+        const unsigned int m_sample_rate;
+        const size_t m_bytes_per_frame;
+        const size_t m_target_frames;
+
+        VariableResampler m_resampler;
+
+        /* Audio popped from the queue, reused to avoid allocations */
+        std::vector<int16_t> m_input;
+
+        /* False until the queue reached the target level */
+        bool m_running = false;
+
+        /* Fill level, averaged over about a second, in frames */
+        double m_filtered_fill = 0.0;
+
+        /* Integral term of the controller, as a relative rate difference */
+        double m_integral = 0.0;
+};
@@ -20,8 +20,10 @@
 #include "wavfile.h"
 #include <cstring>
 #include <cstdio>
+#include <memory>
 #include <stdexcept>
 #include <stdint.h>
+#include <vector>
 
 using namespace std;
 
@@ -67,41 +69,80 @@ void FileInput::prepare(void)
                     &bits_per_sample, nullptr)) {
             throw runtime_error("Bad wav file" + m_filename);
         }
-        if (wav_format != 1) {
-            throw runtime_error("Unsupported WAV format " + to_string(wav_format));
-        }
-        if (bits_per_sample != 16) {
-            throw runtime_error("Unsupported WAV sample depth " +
-                    to_string(bits_per_sample));
+        if (not wav_s16_supported(m_wav)) {
+            throw runtime_error("Unsupported WAV format " + to_string(wav_format) +
+                    " with sample depth " + to_string(bits_per_sample));
         }
         if ( !(channels == 1 or channels == 2)) {
             throw runtime_error("Unsupported WAV channels " + to_string(channels));
         }
+        m_channels = channels;
+
         if (m_sample_rate != sample_rate) {
-            throw runtime_error(
-                    "WAV sample rate " +
-                    to_string(sample_rate) +
-                    " doesn't correspond to desired sample rate " +
-                    to_string(m_sample_rate));
+            m_resampler = make_unique<Resampler>(sample_rate, m_sample_rate,
+                    m_channels, m_src_quality);
+            fprintf(stderr, "Resampling WAV file from %d Hz to %d Hz\n",
+                    sample_rate, m_sample_rate);
+        }
+    }
+}
+
+bool FileInput::read_resampled(size_t num_bytes)
+{
+    const size_t bytes_per_frame = m_channels * sizeof(int16_t);
+
+    /* Read until the resampler gave at least as many frames as asked for.
+     * What it gives in excess is deducted from the next request. */
+    m_missing_frames += num_bytes / bytes_per_frame;
+    while (m_missing_frames > 0) {
+        const size_t num_samples =
+            m_resampler->input_frames_for(m_missing_frames) * m_channels;
+        if (m_samplebuf.size() < num_samples * sizeof(int16_t)) {
+            m_samplebuf.resize(num_samples * sizeof(int16_t));
+        }
+
+        const int16_t *samples = (const int16_t*)m_samplebuf.data();
+        const int ret = wav_read_s16(m_wav, (int16_t*)samples, num_samples);
+        if (ret > 0) {
+            m_resampler->process(samples, ret / m_channels, m_resampled);
+            m_queue.push((const uint8_t*)m_resampled.data(),
+                    m_resampled.size() * sizeof(int16_t));
+            m_missing_frames -= m_resampled.size() / m_channels;
+        }
+
+        if (ret < (ssize_t)num_samples) {
+            return false;
         }
     }
+    return true;
 }
 
 bool FileInput::read_source(size_t num_bytes)
 {
-    vector<uint8_t> samplebuf(num_bytes);
+    if (m_resampler) {
+        return read_resampled(num_bytes);
+    }
+
+    if (m_samplebuf.size() < num_bytes) {
+        m_samplebuf.resize(num_bytes);
+    }
 
     ssize_t ret = 0;
 
     if (m_raw_input) {
-        ret = fread(samplebuf.data(), 1, num_bytes, m_in_fh);
+        ret = fread(m_samplebuf.data(), 1, num_bytes, m_in_fh);
     }
     else {
-        ret = wav_read_data(m_wav, samplebuf.data(), num_bytes);
+        // Converts to 16-bit directly from the mapped file
+        ret = wav_read_s16(m_wav, (int16_t*)m_samplebuf.data(),
+                num_bytes / sizeof(int16_t));
+        if (ret > 0) {
+            ret *= sizeof(int16_t);
+        }
     }
 
     if (ret > 0) {
-        m_queue.push(samplebuf.data(), ret);
+        m_queue.push(m_samplebuf.data(), ret);
     }
 
     if (ret < (ssize_t)num_bytes) {
@@ -22,17 +22,22 @@
  * The raw input needs to be signed 16-bit per sample data, with
  * the number of channels corresponding to the command line.
  *
- * The wav input must also correspond to the parameters on the command
- * line (number of channels, rate)
+ * The wav input must also correspond to the number of channels on the
+ * command line. Its samples can be 16, 24 or 32-bit integer or float,
+ * and are converted to 16-bit while reading. A wav file at another rate
+ * than the one on the command line is resampled.
  */
 
 #pragma once
 
 #include <stdint.h>
 #include <cstdio>
+#include <memory>
 #include <string>
+#include <vector>
 #include "SampleQueue.h"
 #include "InputInterface.h"
+#include "Resampler.h"
 
 class FileInput : public InputInterface
 {
@@ -40,11 +45,13 @@ class FileInput : public InputInterface
         FileInput(const std::string& filename,
                 bool raw_input,
                 int sample_rate,
+                resampler_quality_t src_quality,
                 bool continue_after_eof,
                 SampleQueue<uint8_t>& queue) :
             m_filename(filename),
             m_raw_input(raw_input),
             m_sample_rate(sample_rate),
+            m_src_quality(src_quality),
             m_continue_after_eof(continue_after_eof),
             m_queue(queue) {}
 
@@ -60,14 +67,29 @@ class FileInput : public InputInterface
         virtual bool read_source(size_t num_bytes) override;
 
     protected:
+        /*! read_source() for a wav file that is resampled */
+        bool read_resampled(size_t num_bytes);
+
         std::string m_filename;
         bool m_raw_input;
         int m_sample_rate;
+        resampler_quality_t m_src_quality;
         bool m_continue_after_eof;
         SampleQueue<uint8_t>& m_queue;
 
         /* handle to the wav reader */
         void *m_wav = nullptr;
         FILE* m_in_fh = nullptr;
+
+        /* Reused by read_source() to avoid allocations */
+        std::vector<uint8_t> m_samplebuf;
+
+        /* Set if the wav file has another rate than m_sample_rate */
+        std::unique_ptr<Resampler> m_resampler;
+        std::vector<int16_t> m_resampled;
+        unsigned int m_channels = 0;
+
+        /* Frames the encoder asked for and that were not yet pushed */
+        ssize_t m_missing_frames = 0;
 };
 
@@ -0,0 +1,336 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+
+#include "GainStage.h"
+#include "common.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define GAINSTAGE_X86
+#  include <immintrin.h>
+#endif
+
+using namespace std;
+
+/* The 4x oversampling filter of ITU-R BS.1770-4 Annex 2, one row of
+ * coefficients per phase */
+static const size_t TRUE_PEAK_TAPS = 12;
+static const float TRUE_PEAK_COEFS[4][TRUE_PEAK_TAPS] = {
+    {  0.0017089843750f,  0.0109863281250f, -0.0196533203125f,  0.0332031250000f,
+      -0.0594482421875f,  0.1373291015625f,  0.9721679687500f, -0.1022949218750f,
+       0.0476074218750f, -0.0266113281250f,  0.0148925781250f, -0.0083007812500f },
+    { -0.0291748046875f,  0.0292968750000f, -0.0517578125000f,  0.0891113281250f,
+      -0.1665039062500f,  0.4650878906250f,  0.7797851562500f, -0.2003173828125f,
+       0.1015625000000f, -0.0582275390625f,  0.0330810546875f, -0.0189208984375f },
+    { -0.0189208984375f,  0.0330810546875f, -0.0582275390625f,  0.1015625000000f,
+      -0.2003173828125f,  0.7797851562500f,  0.4650878906250f, -0.1665039062500f,
+       0.0891113281250f, -0.0517578125000f,  0.0292968750000f, -0.0291748046875f },
+    { -0.0083007812500f,  0.0148925781250f, -0.0266113281250f,  0.0476074218750f,
+      -0.1022949218750f,  0.9721679687500f,  0.1373291015625f, -0.0594482421875f,
+       0.0332031250000f, -0.0196533203125f,  0.0109863281250f,  0.0017089843750f },
+};
+
+/* The kernels add to peak and sum_squares, the values of the even samples
+ * go to index 0 and those of the odd samples to index 1. */
+static void kernel_scalar(int16_t *samples, size_t n, float gain,
+        bool apply_gain, bool sum, uint16_t peak[2], double sum_squares[2])
+{
+    for (size_t i = 0; i < n; i++) {
+        float x = samples[i];
+        if (apply_gain) {
+            x = std::min(std::max(x * gain, -32768.0f), 32767.0f);
+            samples[i] = lrintf(x);
+        }
+        if (sum) {
+            sum_squares[i & 1] += x * x;
+        }
+        const uint16_t a = abs(samples[i]);
+        peak[i & 1] = std::max(peak[i & 1], a);
+    }
+}
+
+/* Largest absolute value of the four phases of the oversampling filter,
+ * over num_frames outputs. x holds TRUE_PEAK_TAPS - 1 + num_frames samples */
+static float true_peak_scalar(const float *x, size_t num_frames)
+{
+    float peak = 0.0f;
+    for (size_t f = 0; f < num_frames; f++) {
+        for (const auto& coefs : TRUE_PEAK_COEFS) {
+            float y = 0.0f;
+            for (size_t t = 0; t < TRUE_PEAK_TAPS; t++) {
+                y += coefs[t] * x[f + t];
+            }
+            peak = std::max(peak, fabsf(y));
+        }
+    }
+    return peak;
+}
+
+#if defined(GAINSTAGE_X86)
+__attribute__((target("sse4.1")))
+static void kernel_sse41(int16_t *samples, size_t n, float gain,
+        bool apply_gain, bool sum, uint16_t peak[2], double sum_squares[2])
+{
+    const __m128 g = _mm_set1_ps(gain);
+    const __m128 min_value = _mm_set1_ps(-32768.0f);
+    const __m128 max_value = _mm_set1_ps(32767.0f);
+    __m128i vpeak = _mm_setzero_si128();
+    __m128 acc = _mm_setzero_ps();
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(samples + i));
+        if (apply_gain or sum) {
+            __m128 lo = _mm_cvtepi32_ps(_mm_cvtepi16_epi32(x));
+            __m128 hi = _mm_cvtepi32_ps(_mm_cvtepi16_epi32(_mm_srli_si128(x, 8)));
+            if (apply_gain) {
+                lo = _mm_min_ps(_mm_max_ps(_mm_mul_ps(lo, g), min_value), max_value);
+                hi = _mm_min_ps(_mm_max_ps(_mm_mul_ps(hi, g), min_value), max_value);
+                x = _mm_packs_epi32(_mm_cvtps_epi32(lo), _mm_cvtps_epi32(hi));
+                _mm_storeu_si128((__m128i*)(samples + i), x);
+            }
+            if (sum) {
+                acc = _mm_add_ps(acc, _mm_mul_ps(lo, lo));
+                acc = _mm_add_ps(acc, _mm_mul_ps(hi, hi));
+            }
+        }
+        vpeak = _mm_max_epu16(vpeak, _mm_abs_epi16(x));
+    }
+
+    alignas(16) uint16_t p[8];
+    alignas(16) float s[4];
+    _mm_store_si128((__m128i*)p, vpeak);
+    _mm_store_ps(s, acc);
+    for (size_t k = 0; k < 8; k++) {
+        peak[k & 1] = std::max(peak[k & 1], p[k]);
+    }
+    for (size_t k = 0; k < 4; k++) {
+        sum_squares[k & 1] += s[k];
+    }
+
+    // i is even, the parity of the remaining samples is unchanged
+    kernel_scalar(samples + i, n - i, gain, apply_gain, sum, peak, sum_squares);
+}
+
+__attribute__((target("avx2,fma")))
+static void kernel_avx2(int16_t *samples, size_t n, float gain,
+        bool apply_gain, bool sum, uint16_t peak[2], double sum_squares[2])
+{
+    const __m256 g = _mm256_set1_ps(gain);
+    const __m256 min_value = _mm256_set1_ps(-32768.0f);
+    const __m256 max_value = _mm256_set1_ps(32767.0f);
+    __m256i vpeak = _mm256_setzero_si256();
+    __m256 acc = _mm256_setzero_ps();
+
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(samples + i));
+        if (apply_gain or sum) {
+            __m256 lo = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_castsi256_si128(x)));
+            __m256 hi = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_extracti128_si256(x, 1)));
+            if (apply_gain) {
+                lo = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(lo, g), min_value), max_value);
+                hi = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(hi, g), min_value), max_value);
+                // packs works within 128-bit lanes, the permute restores the order
+                x = _mm256_packs_epi32(_mm256_cvtps_epi32(lo), _mm256_cvtps_epi32(hi));
+                x = _mm256_permute4x64_epi64(x, 0xD8);
+                _mm256_storeu_si256((__m256i*)(samples + i), x);
+            }
+            if (sum) {
+                acc = _mm256_fmadd_ps(lo, lo, acc);
+                acc = _mm256_fmadd_ps(hi, hi, acc);
+            }
+        }
+        vpeak = _mm256_max_epu16(vpeak, _mm256_abs_epi16(x));
+    }
+
+    alignas(32) uint16_t p[16];
+    alignas(32) float s[8];
+    _mm256_store_si256((__m256i*)p, vpeak);
+    _mm256_store_ps(s, acc);
+    for (size_t k = 0; k < 16; k++) {
+        peak[k & 1] = std::max(peak[k & 1], p[k]);
+    }
+    for (size_t k = 0; k < 8; k++) {
+        sum_squares[k & 1] += s[k];
+    }
+
+    kernel_scalar(samples + i, n - i, gain, apply_gain, sum, peak, sum_squares);
+}
+
+/* Eight outputs of every phase at a time */
+__attribute__((target("avx2,fma")))
+static float true_peak_avx2(const float *x, size_t num_frames)
+{
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    __m256 vpeak = _mm256_setzero_ps();
+
+    size_t f = 0;
+    for (; f + 8 <= num_frames; f += 8) {
+        for (const auto& coefs : TRUE_PEAK_COEFS) {
+            __m256 y = _mm256_setzero_ps();
+            for (size_t t = 0; t < TRUE_PEAK_TAPS; t++) {
+                y = _mm256_fmadd_ps(_mm256_set1_ps(coefs[t]), _mm256_loadu_ps(x + f + t), y);
+            }
+            vpeak = _mm256_max_ps(vpeak, _mm256_andnot_ps(sign, y));
+        }
+    }
+
+    alignas(32) float p[8];
+    _mm256_store_ps(p, vpeak);
+    float peak = true_peak_scalar(x + f, num_frames - f);
+    for (size_t k = 0; k < 8; k++) {
+        peak = std::max(peak, p[k]);
+    }
+    return peak;
+}
+#endif
+
+struct gain_kernels_t {
+    string name;
+    void (*kernel)(int16_t *samples, size_t n, float gain,
+            bool apply_gain, bool sum, uint16_t peak[2], double sum_squares[2]);
+    float (*true_peak_kernel)(const float *x, size_t num_frames);
+};
+
+/* The kernels the CPU supports, the scalar ones first and the fastest
+ * last. There is no SSE4.1 version of the true peak kernel. */
+static const vector<gain_kernels_t>& available_kernels()
+{
+    static const vector<gain_kernels_t> kernels = []() {
+        vector<gain_kernels_t> k;
+        k.push_back({"scalar", kernel_scalar, true_peak_scalar});
+#if defined(GAINSTAGE_X86)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("sse4.1")) {
+            k.push_back({"sse4.1", kernel_sse41, true_peak_scalar});
+        }
+        if (__builtin_cpu_supports("avx2") and __builtin_cpu_supports("fma")) {
+            k.push_back({"avx2", kernel_avx2, true_peak_avx2});
+        }
+#endif
+        return k;
+    }();
+    return kernels;
+}
+
+GainStage::GainStage(unsigned int channels, double gain_dB,
+        bool measure_rms, bool measure_true_peak) :
+    m_channels(channels),
+    m_gain(pow(10.0, gain_dB / 20.0)),
+    m_apply_gain(gain_dB != 0.0),
+    m_measure_rms(measure_rms),
+    m_measure_true_peak(measure_true_peak)
+{
+    if (channels != 1 and channels != 2) {
+        throw logic_error("GainStage supports one or two channels");
+    }
+
+    for (auto& history : m_history) {
+        history.assign(TRUE_PEAK_TAPS - 1, 0.0f);
+    }
+
+    const auto& kernels = available_kernels();
+    m_kernel = kernels.back().kernel;
+    m_true_peak_kernel = kernels.back().true_peak_kernel;
+}
+
+vector<string> GainStage::kernels()
+{
+    vector<string> names;
+    for (const auto& k : available_kernels()) {
+        names.push_back(k.name);
+    }
+    return names;
+}
+
+void GainStage::set_kernel(const string& name)
+{
+    for (const auto& k : available_kernels()) {
+        if (k.name == name) {
+            m_kernel = k.kernel;
+            m_true_peak_kernel = k.true_peak_kernel;
+            return;
+        }
+    }
+    throw invalid_argument("GainStage kernel " + name + " not supported");
+}
+
+float GainStage::true_peak(unsigned int channel, const int16_t *samples, size_t num_frames)
+{
+    auto& history = m_history[channel];
+    history.resize(TRUE_PEAK_TAPS - 1 + num_frames);
+    for (size_t f = 0; f < num_frames; f++) {
+        history[TRUE_PEAK_TAPS - 1 + f] = samples[f * m_channels + channel];
+    }
+
+    const float peak = m_true_peak_kernel(history.data(), num_frames);
+
+    // Keep the last samples for the next block. The capacity is kept
+    std::copy(history.end() - (TRUE_PEAK_TAPS - 1), history.end(), history.begin());
+    history.resize(TRUE_PEAK_TAPS - 1);
+    return peak;
+}
+
+void GainStage::process(uint8_t *buf, size_t len, audio_levels_t& levels)
+{
+    int16_t *samples = reinterpret_cast<int16_t*>(buf);
+    const size_t n = len / BYTES_PER_SAMPLE;
+    const size_t num_frames = n / m_channels;
+
+    uint16_t peak[2] = {0, 0};
+    double sum_squares[2] = {0.0, 0.0};
+    m_kernel(samples, n, m_gain, m_apply_gain, m_measure_rms, peak, sum_squares);
+
+    if (m_channels == 1) {
+        peak[0] = peak[1] = std::max(peak[0], peak[1]);
+        sum_squares[0] = sum_squares[1] = sum_squares[0] + sum_squares[1];
+    }
+
+    levels = audio_levels_t();
+    levels.peak_left = std::min<int>(peak[0], INT16_MAX);
+    levels.peak_right = std::min<int>(peak[1], INT16_MAX);
+    levels.rms_measured = m_measure_rms;
+    levels.true_peak_measured = m_measure_true_peak;
+
+    if (num_frames == 0) {
+        return;
+    }
+
+    if (m_measure_rms) {
+        levels.rms_left = sqrt(sum_squares[0] / num_frames) / 32768.0;
+        levels.rms_right = sqrt(sum_squares[1] / num_frames) / 32768.0;
+    }
+
+    if (m_measure_true_peak) {
+        // The filter does not go through the samples, so the sample peak
+        // is a lower bound
+        const float left = std::max<float>(true_peak(0, samples, num_frames), peak[0]);
+        const float right = (m_channels == 1) ? left :
+            std::max<float>(true_peak(1, samples, num_frames), peak[1]);
+
+        levels.true_peak_left = left / 32768.0;
+        levels.true_peak_right = right / 32768.0;
+        levels.peak_left = std::min<float>(lrintf(left), INT16_MAX);
+        levels.peak_right = std::min<float>(lrintf(right), INT16_MAX);
+    }
+}
@@ -0,0 +1,102 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/*! \file GainStage.h
+ *
+ * Gain correction and level metering of the captured audio, before it
+ * goes to the encoder.
+ *
+ * The gain is applied in float and the result is rounded and saturated
+ * to 16-bit, so that a positive gain clips instead of wrapping around.
+ * The same pass measures the sample peak of each channel, and if
+ * enabled their RMS level. The kernels use SSE4.1 or AVX2 when the CPU
+ * supports them, and give the same result as the scalar code.
+ *
+ * The true peak is measured on the signal oversampled four times with
+ * the interpolation filter given in ITU-R BS.1770-4 Annex 2, so that
+ * peaks between two samples, that clip in a DAC or in a lossy decoder,
+ * are visible.
+ *
+ * In mono, the left and right levels are those of the single channel.
+ */
+
+/*! The levels of one block of audio */
+struct audio_levels_t {
+    /*! The level sent in the ZMQ and EDI outputs: the sample peak, or the
+     * true peak if it is measured, saturated to 32767. */
+    int16_t peak_left = 0;
+    int16_t peak_right = 0;
+
+    /*! Linear levels relative to full scale, only set if enabled */
+    bool rms_measured = false;
+    double rms_left = 0.0;
+    double rms_right = 0.0;
+
+    bool true_peak_measured = false;
+    double true_peak_left = 0.0;
+    double true_peak_right = 0.0;
+};
+
+class GainStage {
+    public:
+        GainStage(unsigned int channels, double gain_dB,
+                bool measure_rms, bool measure_true_peak);
+        GainStage(const GainStage& other) = delete;
+        GainStage& operator=(const GainStage& other) = delete;
+
+        /*! Apply the gain to len bytes of interleaved 16-bit samples in
+         * place, and measure their levels. */
+        void process(uint8_t *buf, size_t len, audio_levels_t& levels);
+
+        /*! Names of the kernels the CPU supports, the scalar one first and
+         * the fastest last. */
+        static std::vector<std::string> kernels();
+
+        /*! Use the named kernel instead of the fastest one, for tests and
+         * benchmarks. Throws std::invalid_argument for unsupported kernels. */
+        void set_kernel(const std::string& name);
+
+    private:
+        /* Largest absolute value of the oversampled signal of one channel */
+        float true_peak(unsigned int channel, const int16_t *samples, size_t num_frames);
+
+        unsigned int m_channels;
+        float m_gain;
+        bool m_apply_gain;
+        bool m_measure_rms;
+        bool m_measure_true_peak;
+
+        /* Per channel, the last samples of the previous block followed by
+         * the current block, for the oversampling filter */
+        std::vector<float> m_history[2];
+
+        /* Kernel working on interleaved stereo or mono samples. peak and
+         * sum_squares get the values of the even and odd samples. */
+        using kernel_t = void (*)(int16_t *samples, size_t n, float gain,
+                bool apply_gain, bool sum, uint16_t peak[2], double sum_squares[2]);
+        kernel_t m_kernel = nullptr;
+
+        using true_peak_kernel_t = float (*)(const float *x, size_t num_frames);
+        true_peak_kernel_t m_true_peak_kernel = nullptr;
+};
@@ -18,6 +18,7 @@
  */
 
 #include <cstdio>
+#include <memory>
 #include <string>
 #include "config.h"
 
@@ -75,11 +76,17 @@ void JackInput::prepare()
        just decides to stop calling us. */
     jack_on_shutdown(m_client, shutdown_cb, this);
 
-    if (m_rate != jack_get_sample_rate(m_client)) {
-        throw runtime_error(
-                "JACK uses different sample_rate " +
-                to_string(jack_get_sample_rate(m_client)) +
-                " than requested (" + to_string(m_rate) + ")!");
+    const unsigned int jack_rate = jack_get_sample_rate(m_client);
+    if (m_rate != jack_rate) {
+        m_resampler = make_unique<Resampler>(jack_rate, m_rate, m_channels, m_src_quality);
+
+        // Avoid allocations in the real-time callback
+        const size_t max_frames =
+            (size_t)jack_get_buffer_size(m_client) * m_rate / jack_rate + 2;
+        m_resampled.reserve(max_frames * m_channels);
+
+        fprintf(stderr, "JACK runs at %u Hz, resampling to %u Hz\n",
+                jack_rate, m_rate);
     }
 
     /* create ports */
@@ -148,7 +155,13 @@ void JackInput::jack_process(jack_nframes_t nframes)
         }
     }
 
-    m_queue.push((uint8_t*)&buffer.front(), buffer.size() * sizeof(uint16_t));
+    if (m_resampler) {
+        m_resampler->process(buffer.data(), nframes, m_resampled);
+        m_queue.push((uint8_t*)m_resampled.data(), m_resampled.size() * sizeof(int16_t));
+    }
+    else {
+        m_queue.push((uint8_t*)&buffer.front(), buffer.size() * sizeof(uint16_t));
+    }
 }
 
 #endif // HAVE_JACK
@@ -34,8 +34,10 @@ extern "C" {
 #include <jack/jack.h>
 }
 
+#include <memory>
 #include "SampleQueue.h"
 #include "InputInterface.h"
+#include "Resampler.h"
 
 // 16 bits per sample is fine for now
 #define BYTES_PER_SAMPLE 2
@@ -46,11 +48,13 @@ class JackInput : public InputInterface
         JackInput(const std::string& jack_name,
                 unsigned int channels,
                 unsigned int samplerate,
+                resampler_quality_t src_quality,
                 SampleQueue<uint8_t>& queue) :
             m_client(NULL),
             m_jack_name(jack_name),
             m_channels(channels),
             m_rate(samplerate),
+            m_src_quality(src_quality),
             m_queue(queue) { }
 
         JackInput(const JackInput& other) = delete;
@@ -72,6 +76,11 @@ class JackInput : public InputInterface
         std::string m_jack_name;
         unsigned int m_channels;
         unsigned int m_rate;
+        resampler_quality_t m_src_quality;
+
+        // Set if the JACK server runs at another rate than m_rate
+        std::unique_ptr<Resampler> m_resampler;
+        std::vector<int16_t> m_resampled;
 
         // Callback for real-time JACK process
         void jack_process(jack_nframes_t nframes);
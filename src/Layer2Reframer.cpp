@@ -0,0 +1,53 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+
+#include "Layer2Reframer.h"
+#include <algorithm>
+#include <stdexcept>
+
+Layer2Reframer::Layer2Reframer(size_t frame_len, size_t max_input) :
+    m_frame_len(frame_len),
+    m_buffer(frame_len + max_input)
+{
+    if (frame_len == 0) {
+        throw std::invalid_argument("Layer2Reframer: invalid frame length");
+    }
+}
+
+size_t Layer2Reframer::push(const uint8_t *data, size_t len, uint8_t *out)
+{
+    if (m_fill + len > m_buffer.size()) {
+        throw std::logic_error("MPEG Layer II re-framing buffer overflow");
+    }
+    std::copy(data, data + len, m_buffer.begin() + m_fill);
+    m_fill += len;
+
+    size_t consumed = 0;
+    while (m_fill - consumed > m_frame_len) {
+        consumed += m_frame_len;
+    }
+
+    if (consumed > 0) {
+        std::copy(m_buffer.begin(), m_buffer.begin() + consumed, out);
+        std::copy(m_buffer.begin() + consumed, m_buffer.begin() + m_fill,
+                m_buffer.begin());
+        m_fill -= consumed;
+    }
+
+    return consumed / m_frame_len;
+}
@@ -0,0 +1,61 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+/*! \file Layer2Reframer.h
+ *
+ * Re-framing of the MPEG Layer II encoder output into the frames of
+ * 3*bitrate bytes ODR-DabMux expects.
+ *
+ * The output of libtoolame-dab is appended to a linear buffer allocated
+ * once. The complete frames are copied out of it, and the remainder is
+ * moved to the front. A ring buffer would need an extra copy to hand out
+ * contiguous frames.
+ */
+class Layer2Reframer {
+    public:
+        /*! \param frame_len size of the output frames, 3*bitrate
+         *  \param max_input largest output of one encoder call
+         */
+        Layer2Reframer(size_t frame_len, size_t max_input);
+
+        /*! Size of the output frames */
+        size_t frame_len() const { return m_frame_len; }
+
+        /*! Largest number of bytes push() writes to its output */
+        size_t max_output() const { return m_buffer.size(); }
+
+        /*! Append len bytes of encoder output, and copy the complete frames
+         * to out, which must hold max_output() bytes.
+         *
+         * \return the number of frames written to out
+         */
+        size_t push(const uint8_t *data, size_t len, uint8_t *out);
+
+    private:
+        const size_t m_frame_len;
+
+        /* Holds m_fill bytes, never more than one frame plus one output
+         * of the encoder */
+        std::vector<uint8_t> m_buffer;
+        size_t m_fill = 0;
+};
@@ -0,0 +1,243 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+
+#include "LoudnessMeter.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#endif
+
+using namespace std;
+
+static const size_t MOMENTARY_BLOCKS = 4;
+static const size_t SHORT_TERM_BLOCKS = 30;
+
+static const double ABSOLUTE_GATE = -70.0; // LUFS
+static const double RELATIVE_GATE = -10.0; // LU
+static const double HISTOGRAM_STEP = 0.1; // LU
+static const size_t HISTOGRAM_BINS = 800;
+
+static double power_to_lufs(double power)
+{
+    return power > 0.0 ? -0.691 + 10.0 * log10(power) : -INFINITY;
+}
+
+/* The K-weighting filter of BS.1770 is specified by its coefficients at
+ * 48kHz. These are the analog prototypes they come from, transformed to
+ * the sample rate with the bilinear transform. */
+static void k_weighting(double sample_rate, double shelf[5], double highpass[5])
+{
+    {
+        const double f0 = 1681.974450955533;
+        const double gain_dB = 3.999843853973347;
+        const double q = 0.7071752369554196;
+
+        const double k = tan(M_PI * f0 / sample_rate);
+        const double vh = pow(10.0, gain_dB / 20.0);
+        const double vb = pow(vh, 0.4996667741545416);
+        const double a0 = 1.0 + k / q + k * k;
+
+        shelf[0] = (vh + vb * k / q + k * k) / a0;
+        shelf[1] = 2.0 * (k * k - vh) / a0;
+        shelf[2] = (vh - vb * k / q + k * k) / a0;
+        shelf[3] = 2.0 * (k * k - 1.0) / a0;
+        shelf[4] = (1.0 - k / q + k * k) / a0;
+    }
+
+    {
+        const double f0 = 38.13547087602444;
+        const double q = 0.5003270373238773;
+
+        const double k = tan(M_PI * f0 / sample_rate);
+        const double a0 = 1.0 + k / q + k * k;
+
+        highpass[0] = 1.0;
+        highpass[1] = -2.0;
+        highpass[2] = 1.0;
+        highpass[3] = 2.0 * (k * k - 1.0) / a0;
+        highpass[4] = (1.0 - k / q + k * k) / a0;
+    }
+}
+
+LoudnessMeter::LoudnessMeter(unsigned int sample_rate, unsigned int channels) :
+    m_channels(channels),
+    m_block_frames(sample_rate / 10),
+    m_blocks(SHORT_TERM_BLOCKS, 0.0),
+    m_histogram_power(HISTOGRAM_BINS, 0.0),
+    m_histogram_count(HISTOGRAM_BINS, 0)
+{
+    if (channels != 1 and channels != 2) {
+        throw logic_error("LoudnessMeter supports one or two channels");
+    }
+    k_weighting(sample_rate, m_shelf, m_highpass);
+}
+
+void LoudnessMeter::process(const int16_t *samples, size_t num_frames)
+{
+    while (num_frames > 0) {
+        const size_t n = std::min(num_frames, m_block_frames - m_block_fill);
+        filter(samples, n);
+        samples += n * m_channels;
+        num_frames -= n;
+
+        m_block_fill += n;
+        if (m_block_fill == m_block_frames) {
+            finish_block();
+        }
+    }
+}
+
+void LoudnessMeter::filter(const int16_t *samples, size_t num_frames)
+{
+    const double scale = 1.0 / 32768.0;
+#if defined(__SSE2__)
+    // One lane per channel. In mono, the right lane stays at zero
+    const __m128d sb0 = _mm_set1_pd(m_shelf[0]);
+    const __m128d sb1 = _mm_set1_pd(m_shelf[1]);
+    const __m128d sb2 = _mm_set1_pd(m_shelf[2]);
+    const __m128d sa1 = _mm_set1_pd(m_shelf[3]);
+    const __m128d sa2 = _mm_set1_pd(m_shelf[4]);
+    const __m128d ha1 = _mm_set1_pd(m_highpass[3]);
+    const __m128d ha2 = _mm_set1_pd(m_highpass[4]);
+
+    __m128d z0 = _mm_loadu_pd(m_state[0]);
+    __m128d z1 = _mm_loadu_pd(m_state[1]);
+    __m128d z2 = _mm_loadu_pd(m_state[2]);
+    __m128d z3 = _mm_loadu_pd(m_state[3]);
+    __m128d sum = _mm_loadu_pd(m_sum);
+
+    for (size_t f = 0; f < num_frames; f++) {
+        const __m128d x = (m_channels == 2) ?
+            _mm_set_pd(samples[2 * f + 1] * scale, samples[2 * f] * scale) :
+            _mm_set_sd(samples[f] * scale);
+
+        const __m128d y = _mm_add_pd(_mm_mul_pd(sb0, x), z0);
+        z0 = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(sb1, x), _mm_mul_pd(sa1, y)), z1);
+        z1 = _mm_sub_pd(_mm_mul_pd(sb2, x), _mm_mul_pd(sa2, y));
+
+        // The high-pass has b0 = b2 = 1, b1 = -2
+        const __m128d w = _mm_add_pd(y, z2);
+        z2 = _mm_sub_pd(_mm_sub_pd(z3, _mm_add_pd(y, y)), _mm_mul_pd(ha1, w));
+        z3 = _mm_sub_pd(y, _mm_mul_pd(ha2, w));
+
+        sum = _mm_add_pd(sum, _mm_mul_pd(w, w));
+    }
+
+    _mm_storeu_pd(m_state[0], z0);
+    _mm_storeu_pd(m_state[1], z1);
+    _mm_storeu_pd(m_state[2], z2);
+    _mm_storeu_pd(m_state[3], z3);
+    _mm_storeu_pd(m_sum, sum);
+#else
+    for (unsigned int c = 0; c < m_channels; c++) {
+        double z0 = m_state[0][c];
+        double z1 = m_state[1][c];
+        double z2 = m_state[2][c];
+        double z3 = m_state[3][c];
+        double sum = m_sum[c];
+
+        for (size_t f = 0; f < num_frames; f++) {
+            const double x = samples[f * m_channels + c] * scale;
+
+            const double y = m_shelf[0] * x + z0;
+            z0 = m_shelf[1] * x - m_shelf[3] * y + z1;
+            z1 = m_shelf[2] * x - m_shelf[4] * y;
+
+            const double w = y + z2;
+            z2 = z3 - 2.0 * y - m_highpass[3] * w;
+            z3 = y - m_highpass[4] * w;
+
+            sum += w * w;
+        }
+
+        m_state[0][c] = z0;
+        m_state[1][c] = z1;
+        m_state[2][c] = z2;
+        m_state[3][c] = z3;
+        m_sum[c] = sum;
+    }
+#endif
+}
+
+void LoudnessMeter::finish_block()
+{
+    // The weights of the left and right channels are 1
+    m_blocks[m_blocks_done % m_blocks.size()] = (m_sum[0] + m_sum[1]) / m_block_frames;
+    m_blocks_done++;
+    m_sum[0] = m_sum[1] = 0.0;
+    m_block_fill = 0;
+
+    if (m_blocks_done < MOMENTARY_BLOCKS) {
+        return;
+    }
+
+    const double power = window_power(MOMENTARY_BLOCKS);
+    const double lufs = power_to_lufs(power);
+    if (lufs >= ABSOLUTE_GATE) {
+        const size_t bin = std::min<size_t>(
+                (lufs - ABSOLUTE_GATE) / HISTOGRAM_STEP, HISTOGRAM_BINS - 1);
+        m_histogram_power[bin] += power;
+        m_histogram_count[bin]++;
+    }
+}
+
+double LoudnessMeter::window_power(size_t num_blocks) const
+{
+    double sum = 0.0;
+    for (size_t i = 1; i <= num_blocks; i++) {
+        sum += m_blocks[(m_blocks_done - i) % m_blocks.size()];
+    }
+    return sum / num_blocks;
+}
+
+loudness_t LoudnessMeter::loudness() const
+{
+    loudness_t l;
+    l.momentary = (m_blocks_done >= MOMENTARY_BLOCKS) ?
+        power_to_lufs(window_power(MOMENTARY_BLOCKS)) : -INFINITY;
+    l.short_term = (m_blocks_done >= SHORT_TERM_BLOCKS) ?
+        power_to_lufs(window_power(SHORT_TERM_BLOCKS)) : -INFINITY;
+
+    double power = 0.0;
+    uint64_t count = 0;
+    for (size_t bin = 0; bin < HISTOGRAM_BINS; bin++) {
+        power += m_histogram_power[bin];
+        count += m_histogram_count[bin];
+    }
+
+    if (count == 0) {
+        l.integrated = -INFINITY;
+        return l;
+    }
+
+    // The bin that contains the relative gate is included
+    const double gate = power_to_lufs(power / count) + RELATIVE_GATE;
+    const size_t first_bin = std::max(0.0, floor((gate - ABSOLUTE_GATE) / HISTOGRAM_STEP));
+
+    power = 0.0;
+    count = 0;
+    for (size_t bin = first_bin; bin < HISTOGRAM_BINS; bin++) {
+        power += m_histogram_power[bin];
+        count += m_histogram_count[bin];
+    }
+    l.integrated = power_to_lufs(power / count);
+    return l;
+}
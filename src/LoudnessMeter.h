@@ -0,0 +1,98 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <vector>
+
+/*! \file LoudnessMeter.h
+ *
+ * Loudness measurement according to ITU-R BS.1770-4 and EBU Tech 3341,
+ * on the audio the encoder receives, after the gain correction.
+ *
+ * Each channel goes through the K-weighting filter, a high shelf and a
+ * high-pass biquad whose coefficients are derived for the actual sample
+ * rate. Both channels are filtered together in one SSE2 register. The
+ * mean square of the filtered signal is collected in blocks of 100ms.
+ *
+ * The momentary loudness covers the last 4 blocks, the short-term
+ * loudness the last 30. For the integrated loudness, every 400ms window
+ * is a gating block, and these are kept in a histogram of 0.1 LU bins
+ * between -70 and +10 LUFS, so that the memory does not grow with the
+ * duration of the measurement. The relative gate is applied with the
+ * resolution of these bins.
+ *
+ * Values that are not available yet, the loudness of digital silence,
+ * and the integrated loudness before any block passed the absolute gate
+ * are -infinity.
+ */
+
+/*! Loudness values in LUFS */
+struct loudness_t {
+    double momentary = -INFINITY;
+    double short_term = -INFINITY;
+    double integrated = -INFINITY;
+};
+
+class LoudnessMeter {
+    public:
+        LoudnessMeter(unsigned int sample_rate, unsigned int channels);
+        LoudnessMeter(const LoudnessMeter& other) = delete;
+        LoudnessMeter& operator=(const LoudnessMeter& other) = delete;
+
+        /*! Measure num_frames interleaved frames */
+        void process(const int16_t *samples, size_t num_frames);
+
+        loudness_t loudness() const;
+
+    private:
+        /* Filter and accumulate frames that all belong to the current
+         * block */
+        void filter(const int16_t *samples, size_t num_frames);
+        void finish_block();
+
+        /* Mean square of the last num_blocks blocks, summed over the
+         * channels */
+        double window_power(size_t num_blocks) const;
+
+        unsigned int m_channels;
+        size_t m_block_frames;
+
+        /* Coefficients of the two biquads, b0 b1 b2 a1 a2 */
+        double m_shelf[5];
+        double m_highpass[5];
+
+        /* Direct form II transposed state, two values per stage, for
+         * the left and right channel */
+        double m_state[4][2] = {};
+
+        /* Sum of squares of the current block, per channel */
+        double m_sum[2] = {};
+        size_t m_block_fill = 0;
+
+        /* Power of the last blocks, m_blocks_done modulo the size is the
+         * index of the next one */
+        std::vector<double> m_blocks;
+        size_t m_blocks_done = 0;
+
+        /* Gating blocks, by loudness */
+        std::vector<double> m_histogram_power;
+        std::vector<uint32_t> m_histogram_count;
+};
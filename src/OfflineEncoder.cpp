@@ -0,0 +1,342 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+
+#include "OfflineEncoder.h"
+#include "wavfile.h"
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <sys/stat.h>
+
+using namespace std;
+
+/*! Reads the audio data of the input file from any position. Every
+ * worker has its own, so that they do not share a file position. */
+class SegmentReader {
+    public:
+        SegmentReader(const string& filename, bool raw_input,
+                int sample_rate, int channels) :
+            m_raw_input(raw_input),
+            m_channels(channels)
+        {
+            if (filename == "-") {
+                throw runtime_error("Parallel encoding cannot read from stdin");
+            }
+
+            if (m_raw_input) {
+                m_in_fh = fopen(filename.c_str(), "rb");
+                if (m_in_fh == nullptr) {
+                    throw runtime_error("Can't open input file " + filename +
+                            ": " + strerror(errno));
+                }
+
+                struct stat st;
+                if (fstat(fileno(m_in_fh), &st) != 0 or not S_ISREG(st.st_mode)) {
+                    fclose(m_in_fh);
+                    throw runtime_error("Parallel encoding needs a regular input file");
+                }
+                m_data_length = st.st_size;
+                return;
+            }
+
+            m_wav = wav_read_open(filename.c_str());
+            if (m_wav == nullptr) {
+                throw runtime_error("Unable to open wav file " + filename);
+            }
+
+            int wav_format = 0;
+            int wav_channels = 0;
+            int wav_sample_rate = 0;
+            int bits_per_sample = 0;
+            uint64_t data_length = 0;
+            if (not wav_get_header(m_wav, &wav_format, &wav_channels,
+                        &wav_sample_rate, &bits_per_sample, &data_length)) {
+                wav_read_close(m_wav);
+                throw runtime_error("Bad wav file " + filename);
+            }
+
+            string error;
+            if (not wav_s16_supported(m_wav)) {
+                error = "Unsupported WAV format " + to_string(wav_format) +
+                    " with sample depth " + to_string(bits_per_sample);
+            }
+            else if (wav_channels != channels) {
+                error = "WAV channels " + to_string(wav_channels) +
+                    " doesn't correspond to desired channels " + to_string(channels);
+            }
+            else if (wav_sample_rate != sample_rate) {
+                error = "WAV sample rate " + to_string(wav_sample_rate) +
+                    " doesn't correspond to desired sample rate " + to_string(sample_rate);
+            }
+            else if (not wav_read_seek(m_wav, 0)) {
+                error = "Parallel encoding needs a seekable wav file";
+            }
+
+            if (not error.empty()) {
+                wav_read_close(m_wav);
+                throw runtime_error(error);
+            }
+            // The reader gives 16-bit samples whatever the format of the file
+            m_data_length = data_length / (bits_per_sample / 8) * sizeof(int16_t);
+        }
+
+        SegmentReader(const SegmentReader& other) = delete;
+        SegmentReader& operator=(const SegmentReader& other) = delete;
+
+        ~SegmentReader()
+        {
+            if (m_in_fh) {
+                fclose(m_in_fh);
+            }
+            else if (m_wav) {
+                wav_read_close(m_wav);
+            }
+        }
+
+        /*! Length of the audio data in bytes, as 16-bit samples */
+        size_t data_length() const { return m_data_length; }
+
+        void seek(size_t offset)
+        {
+            bool success = false;
+            if (m_raw_input) {
+                success = fseeko(m_in_fh, offset, SEEK_SET) == 0;
+            }
+            else {
+                success = wav_read_seek(m_wav, offset / (m_channels * sizeof(int16_t)));
+            }
+
+            if (not success) {
+                throw runtime_error("Failed to seek in input file");
+            }
+        }
+
+        /*! \return false if fewer than len bytes could be read */
+        bool read(uint8_t *buf, size_t len)
+        {
+            ssize_t ret = 0;
+            if (m_raw_input) {
+                ret = fread(buf, 1, len, m_in_fh);
+            }
+            else {
+                ret = wav_read_s16(m_wav, (int16_t*)buf, len / sizeof(int16_t));
+                if (ret > 0) {
+                    ret *= sizeof(int16_t);
+                }
+            }
+            return ret == (ssize_t)len;
+        }
+
+    private:
+        bool m_raw_input;
+        int m_channels;
+        void *m_wav = nullptr;
+        FILE *m_in_fh = nullptr;
+        size_t m_data_length = 0;
+};
+
+OfflineEncoder::OfflineEncoder(const offline_config_t& config, encoder_factory_t factory) :
+    m_config(config),
+    m_factory(factory)
+{
+    if (m_config.jobs == 0 or m_config.call_bytes == 0 or
+            m_config.calls_per_unit == 0 or m_config.unit_bytes == 0 or
+            m_config.segment_units == 0 or m_config.frame_len == 0) {
+        throw logic_error("Invalid parallel encoding configuration");
+    }
+}
+
+size_t OfflineEncoder::count_input_calls() const
+{
+    SegmentReader reader(m_config.infile, m_config.raw_input,
+            m_config.sample_rate, m_config.channels);
+    return reader.data_length() / m_config.call_bytes;
+}
+
+OfflineEncoder::segment_t OfflineEncoder::make_segment(size_t index, size_t num_calls) const
+{
+    const size_t segment_calls = m_config.segment_units * m_config.calls_per_unit;
+    const size_t start = index * segment_calls;
+    const size_t end = start + segment_calls;
+
+    segment_t s;
+    const size_t preroll_units = std::min(m_config.preroll_units, index * m_config.segment_units);
+    s.first_call = start - preroll_units * m_config.calls_per_unit;
+    s.keep_from = preroll_units * m_config.unit_bytes;
+
+    if (end >= num_calls) {
+        // The last segment ends with the input
+        s.end_call = num_calls;
+        s.keep_len = SIZE_MAX;
+    }
+    else {
+        s.end_call = std::min(num_calls,
+                end + m_config.postroll_units * m_config.calls_per_unit);
+        s.keep_len = m_config.segment_units * m_config.unit_bytes;
+    }
+    return s;
+}
+
+void OfflineEncoder::encode_segment(SegmentEncoder& encoder, const segment_t& segment,
+        vector<uint8_t>& audio, vector<uint8_t>& out) const
+{
+    SegmentReader reader(m_config.infile, m_config.raw_input,
+            m_config.sample_rate, m_config.channels);
+    reader.seek(segment.first_call * m_config.call_bytes);
+
+    vector<uint8_t> encoded;
+    for (size_t call = segment.first_call; call < segment.end_call; call++) {
+        if (not reader.read(audio.data(), audio.size())) {
+            throw runtime_error("Input file ended before the expected length");
+        }
+        encoder.encode(audio.data(), audio.size(), encoded);
+    }
+    encoder.finish(encoded);
+
+    if (segment.keep_from > encoded.size()) {
+        throw logic_error("Parallel encoding: preroll produced too little output");
+    }
+    const size_t available = encoded.size() - segment.keep_from;
+    if (segment.keep_len != SIZE_MAX and available < segment.keep_len) {
+        throw logic_error("Parallel encoding: segment produced too little output");
+    }
+    const size_t keep = std::min(available, segment.keep_len);
+
+    out.assign(encoded.begin() + segment.keep_from,
+            encoded.begin() + segment.keep_from + keep);
+}
+
+void OfflineEncoder::run(Output::File& output)
+{
+    const size_t num_calls = count_input_calls();
+    const size_t segment_calls = m_config.segment_units * m_config.calls_per_unit;
+    const size_t num_segments = std::max<size_t>(1,
+            (num_calls + segment_calls - 1) / segment_calls);
+    const unsigned jobs = std::min<size_t>(m_config.jobs, num_segments);
+
+    fprintf(stderr, "Parallel encoding of %zu segments with %u jobs\n",
+            num_segments, jobs);
+
+    /* The workers take the segments in order. A segment is only started
+     * if it is less than 2*jobs ahead of the one being written, which
+     * bounds the memory used by encoded segments waiting for output. */
+    const size_t max_ahead = 2 * jobs;
+
+    mutex mtx;
+    condition_variable cv;
+    size_t next_segment = 0;
+    size_t next_write = 0;
+    vector<vector<uint8_t> > results(num_segments);
+    vector<bool> done(num_segments, false);
+    string error;
+
+    auto worker = [&]() {
+        try {
+            vector<uint8_t> audio(m_config.call_bytes);
+
+            while (true) {
+                size_t index = 0;
+                {
+                    unique_lock<mutex> lock(mtx);
+                    cv.wait(lock, [&]() {
+                            return not error.empty() or
+                                next_segment >= num_segments or
+                                next_segment < next_write + max_ahead; });
+                    if (not error.empty() or next_segment >= num_segments) {
+                        return;
+                    }
+                    index = next_segment++;
+                }
+
+                // A new encoder for every segment makes the output independent
+                // of the order in which the workers take the segments
+                unique_ptr<SegmentEncoder> encoder = m_factory();
+                vector<uint8_t> out;
+                encode_segment(*encoder, make_segment(index, num_calls), audio, out);
+
+                lock_guard<mutex> lock(mtx);
+                results[index] = move(out);
+                done[index] = true;
+                cv.notify_all();
+            }
+        }
+        catch (const exception& e) {
+            lock_guard<mutex> lock(mtx);
+            if (error.empty()) {
+                error = e.what();
+            }
+            cv.notify_all();
+        }
+    };
+
+    vector<thread> workers;
+    for (unsigned i = 0; i < jobs; i++) {
+        workers.emplace_back(worker);
+    }
+
+    /* The segments are concatenated and cut into frames of frame_len.
+     * The remainder is kept for the next segment. */
+    vector<uint8_t> pending;
+    bool write_failed = false;
+
+    while (next_write < num_segments) {
+        vector<uint8_t> segment;
+        {
+            unique_lock<mutex> lock(mtx);
+            cv.wait(lock, [&]() { return not error.empty() or done[next_write]; });
+            if (not error.empty()) {
+                break;
+            }
+            segment = move(results[next_write]);
+            next_write++;
+            cv.notify_all();
+        }
+
+        pending.insert(pending.end(), segment.begin(), segment.end());
+
+        size_t consumed = 0;
+        while (pending.size() - consumed >= m_config.frame_len) {
+            if (not output.write_frame(pending.data() + consumed, m_config.frame_len)) {
+                write_failed = true;
+                break;
+            }
+            consumed += m_config.frame_len;
+        }
+        pending.erase(pending.begin(), pending.begin() + consumed);
+
+        if (write_failed) {
+            lock_guard<mutex> lock(mtx);
+            error = "Failed to write to output";
+            cv.notify_all();
+            break;
+        }
+    }
+
+    for (auto& t : workers) {
+        t.join();
+    }
+
+    if (not error.empty()) {
+        throw runtime_error(error);
+    }
+}
@@ -24,6 +24,8 @@
 #include <cstring>
 #include <cerrno>
 #include <cassert>
+#include <optional>
+#include <cmath>
 
 namespace Output {
 
@@ -62,8 +64,12 @@ bool File::write_frame(const uint8_t *buf, size_t len)
 }
 
 ZMQ::ZMQ() :
-    m_ctx(),
-    m_sock(m_ctx, ZMQ_PUB)
+    ZMQ(make_shared<zmq::context_t>())
+{ }
+
+ZMQ::ZMQ(shared_ptr<zmq::context_t> ctx) :
+    m_ctx(ctx),
+    m_sock(*m_ctx, ZMQ_PUB)
 {
     // Do not wait at teardown to send all data out
     int linger = 0;
@@ -138,7 +144,7 @@ bool ZMQ::write_frame(const uint8_t *buf, size_t len)
 }
 
 EDI::EDI() :
-    m_clock_tai({})
+    m_edi_tagpacket(m_edi_conf.tagpacket_alignment)
 { }
 
 EDI::~EDI() { }
@@ -180,23 +186,66 @@ void EDI::set_fec(int fec)
     m_edi_conf.fec = fec;
 }
 
+void EDI::set_udp_gso(bool gso)
+{
+    m_edi_conf.udp_gso = gso;
+}
+
+void EDI::set_udp_txtime(bool txtime)
+{
+    m_edi_conf.udp_txtime = txtime;
+}
+
 bool EDI::enabled() const
 {
     return not m_edi_conf.destinations.empty();
 }
 
+void EDI::update_loudness(const loudness_t& loudness)
+{
+    m_send_loudness = true;
+    m_loudness = loudness;
+}
+
+/* In 1/100 LU, values that do not fit are not available */
+static int16_t loudness_to_tag(double lufs)
+{
+    const double value = round(lufs * 100.0);
+    if (not (value > INT16_MIN and value <= INT16_MAX)) {
+        return INT16_MIN;
+    }
+    return value;
+}
+
 void EDI::set_tist(bool enable, uint32_t delay_ms)
 {
     m_tist = enable;
     m_delay_ms = delay_ms;
 }
 
+void EDI::set_clock_tai(shared_ptr<ClockTAI> clock_tai)
+{
+    m_clock_tai = clock_tai;
+}
+
+void EDI::set_udp_socket(shared_ptr<Socket::UDPSocket> udp_socket)
+{
+    if (m_edi_sender) {
+        throw logic_error("EDI UDP socket must be set before the first frame");
+    }
+    m_edi_conf.shared_udp_socket = udp_socket;
+}
+
 bool EDI::write_frame(const uint8_t *buf, size_t len)
 {
     if (not m_edi_sender) {
         m_edi_sender = make_shared<edi::Sender>(m_edi_conf);
     }
 
+    if (not m_clock_tai) {
+        m_clock_tai = make_shared<ClockTAI>(vector<string>{});
+    }
+
     if (m_edi_time == 0) {
         using Sec = chrono::seconds;
         const auto now = chrono::time_point_cast<Sec>(chrono::system_clock::now());
@@ -211,8 +260,6 @@ bool EDI::write_frame(const uint8_t *buf, size_t len)
         }
     }
 
-    edi::TagStarPTR edi_tagStarPtr("DSTI");
-
     m_edi_tagDSTI.stihf = false;
     m_edi_tagDSTI.atstf = m_tist;
 
@@ -224,7 +271,7 @@ bool EDI::write_frame(const uint8_t *buf, size_t len)
         m_num_seconds_sent++;
     }
 
-    m_edi_tagDSTI.set_edi_time(m_edi_time, m_clock_tai.get_offset());
+    m_edi_tagDSTI.set_edi_time(m_edi_time, m_clock_tai->get_offset());
     m_edi_tagDSTI.tsta = m_timestamp & 0xffffff;
 
     m_edi_tagDSTI.rfadf = false;
@@ -237,24 +284,33 @@ bool EDI::write_frame(const uint8_t *buf, size_t len)
 
     edi::TagODRAudioLevels edi_tagAudioLevels(m_audio_left, m_audio_right);
 
-    edi::TagODRVersion edi_tagVersion(m_odr_version_tag, m_num_seconds_sent);
-
-    // The above Tag Items will be assembled into a TAG Packet
-    edi::TagPacket edi_tagpacket(m_edi_conf.tagpacket_alignment);
+    optional<edi::TagODRLoudness> edi_tagLoudness;
+    if (m_send_loudness) {
+        edi_tagLoudness.emplace(
+                loudness_to_tag(m_loudness.momentary),
+                loudness_to_tag(m_loudness.short_term),
+                loudness_to_tag(m_loudness.integrated));
+    }
 
     // put tags *ptr, DETI and all subchannels into one TagPacket
-    edi_tagpacket.tag_items.push_back(&edi_tagStarPtr);
-    edi_tagpacket.tag_items.push_back(&m_edi_tagDSTI);
-    edi_tagpacket.tag_items.push_back(&edi_tagPayload);
-    edi_tagpacket.tag_items.push_back(&edi_tagAudioLevels);
+    m_edi_tagpacket.tag_items.clear();
+    m_edi_tagpacket.tag_items.push_back(&m_edi_tagStarPtr);
+    m_edi_tagpacket.tag_items.push_back(&m_edi_tagDSTI);
+    m_edi_tagpacket.tag_items.push_back(&edi_tagPayload);
+    m_edi_tagpacket.tag_items.push_back(&edi_tagAudioLevels);
+    if (edi_tagLoudness) {
+        m_edi_tagpacket.tag_items.push_back(&*edi_tagLoudness);
+    }
 
     // Send version information only every 10 seconds to save bandwidth
+    optional<edi::TagODRVersion> edi_tagVersion;
     if (m_send_version_at_time < m_edi_time) {
         m_send_version_at_time += 10;
-        edi_tagpacket.tag_items.push_back(&edi_tagVersion);
+        edi_tagVersion.emplace(m_odr_version_tag, m_num_seconds_sent);
+        m_edi_tagpacket.tag_items.push_back(&*edi_tagVersion);
     }
 
-    m_edi_sender->write(edi_tagpacket);
+    m_edi_sender->write(m_edi_tagpacket);
 
     // TODO Handle TCP disconnect
     return true;
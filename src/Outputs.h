@@ -22,9 +22,11 @@
 #include <cstdint>
 #include <cstddef>
 #include <cstdio>
+#include <memory>
 #include "common.h"
 #include "zmq.hpp"
 #include "ClockTAI.h"
+#include "LoudnessMeter.h"
 #include "edioutput/TagItems.h"
 #include "edioutput/TagPacket.h"
 #include "edioutput/AFPacket.h"
@@ -102,6 +104,10 @@ struct zmq_frame_header_t
 class ZMQ: public Base {
     public:
         ZMQ();
+
+        /*! Create a ZMQ output whose socket belongs to a context
+         * that is shared with other outputs in the same process */
+        ZMQ(std::shared_ptr<zmq::context_t> ctx);
         ZMQ(const ZMQ&) = delete;
         ZMQ& operator=(const ZMQ&) = delete;
         virtual ~ZMQ() override;
@@ -112,7 +118,7 @@ class ZMQ: public Base {
         virtual bool write_frame(const uint8_t *buf, size_t len) override;
 
     private:
-        zmq::context_t m_ctx;
+        std::shared_ptr<zmq::context_t> m_ctx;
         zmq::socket_t m_sock;
 
         int m_bitrate = 0;
@@ -140,15 +146,37 @@ class EDI: public Base {
         // Enables PFT layer and sets FEC
         void set_fec(int fec);
 
+        /*! Send PFT fragments that are due at the same time as one
+         * UDP GSO buffer, if the kernel supports it. */
+        void set_udp_gso(bool gso);
+
+        /*! Give PFT fragments to the kernel ahead of time with their
+         * transmit time (SO_TXTIME), to be paced by the fq qdisc. */
+        void set_udp_txtime(bool txtime);
+
         void set_tist(bool enable, uint32_t delay_ms);
 
+        /*! Use the given TAI clock instead of a private one, so that
+         * all EDI outputs of a process share one bulletin download. */
+        void set_clock_tai(std::shared_ptr<ClockTAI> clock_tai);
+
+        /*! Send to UDP destinations through a socket that is shared
+         * with other EDI outputs. Must be called before the first frame. */
+        void set_udp_socket(std::shared_ptr<Socket::UDPSocket> udp_socket);
+
         bool enabled() const;
 
+        /*! Send the loudness in an ODRl TAG along the following frames */
+        void update_loudness(const loudness_t& loudness);
+
         virtual bool write_frame(const uint8_t *buf, size_t len) override;
 
     private:
         std::string m_odr_version_tag;
 
+        bool m_send_loudness = false;
+        loudness_t m_loudness;
+
         edi::configuration_t m_edi_conf;
         std::shared_ptr<edi::Sender> m_edi_sender;
 
@@ -158,8 +186,13 @@ class EDI: public Base {
         std::time_t m_send_version_at_time = 0;
 
         edi::TagDSTI m_edi_tagDSTI;
+        edi::TagStarPTR m_edi_tagStarPtr{"DSTI"};
+
+        // Reused for every frame, so that its tag item list and the
+        // buffers in the sender keep their capacity
+        edi::TagPacket m_edi_tagpacket;
 
-        ClockTAI m_clock_tai;
+        std::shared_ptr<ClockTAI> m_clock_tai;
         bool m_tist = false;
         uint32_t m_delay_ms = 0;
 };
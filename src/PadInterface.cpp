@@ -67,8 +67,10 @@ void PadInterface::open(const std::string& pad_ident)
     }
 }
 
-vector<uint8_t> PadInterface::request(uint8_t padlen)
+void PadInterface::request(uint8_t padlen, vector<uint8_t>& pad_data)
 {
+    pad_data.clear();
+
     if (m_pad_ident.empty()) {
         throw logic_error("Uninitialised PadInterface::request() called");
     }
@@ -113,10 +115,8 @@ vector<uint8_t> PadInterface::request(uint8_t padlen)
         m_padenc_reachable = true;
     }
 
-    vector<uint8_t> buffer(2048);
-
     while (true) {
-        ret = ::recvfrom(m_sock, buffer.data(), buffer.size(), 0, nullptr, nullptr);
+        ret = ::recvfrom(m_sock, m_rx_buffer.data(), m_rx_buffer.size(), 0, nullptr, nullptr);
 
         if (ret == -1) {
             // This suppresses the -Wlogical-op warning
@@ -129,18 +129,15 @@ vector<uint8_t> PadInterface::request(uint8_t padlen)
                 throw runtime_error(string("Can't receive data: ") + strerror(errno));
             }
 
-            return {};
+            return;
         }
         else if (ret > 0) {
-            buffer.resize(ret);
-
             // We could check where the data comes from, but since we're using UNIX sockets
             // the source is anyway local to the machine.
 
-            if (buffer[0] == MESSAGE_PAD_DATA) {
-                vector<uint8_t> pad_data(buffer.size() - 1);
-                copy(buffer.begin() + 1, buffer.end(), pad_data.begin());
-                return pad_data;
+            if (m_rx_buffer[0] == MESSAGE_PAD_DATA) {
+                pad_data.assign(m_rx_buffer.begin() + 1, m_rx_buffer.begin() + ret);
+                return;
             }
             else {
                 continue;
@@ -35,9 +35,19 @@ class PadInterface {
          */
         void open(const std::string &pad_ident);
 
-        std::vector<uint8_t> request(uint8_t padlen);
+        /*! Send a request for padlen bytes of PAD to ODR-PadEnc, and
+         * receive the PAD it has sent, if any, into pad_data. pad_data is
+         * cleared if no PAD is available. It is not reallocated if its
+         * capacity is sufficient, so that a caller reusing the same vector
+         * does not allocate.
+         */
+        void request(uint8_t padlen, std::vector<uint8_t>& pad_data);
+
+        /*! Largest PAD message we can receive */
+        static constexpr size_t MAX_MESSAGE_SIZE = 2048;
 
     private:
+        std::vector<uint8_t> m_rx_buffer = std::vector<uint8_t>(MAX_MESSAGE_SIZE);
         std::string m_pad_ident;
         int m_sock = -1;
         bool m_padenc_reachable = true;
@@ -0,0 +1,226 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+
+#include "PcmConvert.h"
+#include <cmath>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define PCM_CONVERT_X86
+#  include <immintrin.h>
+#endif
+
+size_t pcm_sample_size(pcm_format_t format)
+{
+    switch (format) {
+        case pcm_format_t::S16: return 2;
+        case pcm_format_t::S24: return 3;
+        case pcm_format_t::S32: return 4;
+        case pcm_format_t::F32: return 4;
+        case pcm_format_t::F64: return 8;
+    }
+    return 0;
+}
+
+static inline int16_t saturate(int32_t v)
+{
+    if (v > 32767) return 32767;
+    if (v < -32768) return -32768;
+    return v;
+}
+
+/* Round an integer sample with the given number of bits below the 16
+ * we keep, adding one half of the 16-bit step */
+static inline int16_t round_int(int32_t v, int shift)
+{
+    return saturate((v >> shift) + ((v >> (shift - 1)) & 1));
+}
+
+/* The comparisons are written so that they behave like minps/maxps
+ * with NaN */
+static inline int16_t round_float(double v)
+{
+    v *= 32768.0;
+    v = (v < 32767.0) ? v : 32767.0;
+    v = (v > -32768.0) ? v : -32768.0;
+    return (int16_t)lrint(v);
+}
+
+static inline int16_t round_float(float v)
+{
+    v *= 32768.0f;
+    v = (v < 32767.0f) ? v : 32767.0f;
+    v = (v > -32768.0f) ? v : -32768.0f;
+    return (int16_t)lrintf(v);
+}
+
+void pcm_convert_to_s16_scalar(pcm_format_t format, const uint8_t *in,
+        int16_t *out, size_t num_samples)
+{
+    switch (format) {
+        case pcm_format_t::S16:
+            memcpy(out, in, num_samples * sizeof(int16_t));
+            break;
+        case pcm_format_t::S24:
+            for (size_t i = 0; i < num_samples; i++, in += 3) {
+                // Place the sample in the upper bytes to sign-extend it
+                const int32_t v = (int32_t)((uint32_t)in[0] << 8 |
+                        (uint32_t)in[1] << 16 | (uint32_t)in[2] << 24) >> 8;
+                out[i] = round_int(v, 8);
+            }
+            break;
+        case pcm_format_t::S32:
+            for (size_t i = 0; i < num_samples; i++, in += 4) {
+                int32_t v;
+                memcpy(&v, in, sizeof(v));
+                out[i] = round_int(v, 16);
+            }
+            break;
+        case pcm_format_t::F32:
+            for (size_t i = 0; i < num_samples; i++, in += 4) {
+                float v;
+                memcpy(&v, in, sizeof(v));
+                out[i] = round_float(v);
+            }
+            break;
+        case pcm_format_t::F64:
+            for (size_t i = 0; i < num_samples; i++, in += 8) {
+                double v;
+                memcpy(&v, in, sizeof(v));
+                out[i] = round_float(v);
+            }
+            break;
+    }
+}
+
+#if defined(PCM_CONVERT_X86)
+/* Eight 32-bit samples to 16-bit, with the rounding of round_int() */
+__attribute__((target("sse2")))
+static inline __m128i round_pack_sse2(__m128i a, __m128i b, int shift)
+{
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i ra = _mm_and_si128(_mm_srai_epi32(a, shift - 1), one);
+    const __m128i rb = _mm_and_si128(_mm_srai_epi32(b, shift - 1), one);
+    a = _mm_add_epi32(_mm_srai_epi32(a, shift), ra);
+    b = _mm_add_epi32(_mm_srai_epi32(b, shift), rb);
+    return _mm_packs_epi32(a, b);
+}
+
+__attribute__((target("sse2")))
+static size_t convert_s32_sse2(const uint8_t *in, int16_t *out, size_t num_samples)
+{
+    size_t i = 0;
+    for (; i + 8 <= num_samples; i += 8) {
+        const __m128i a = _mm_loadu_si128((const __m128i*)(in + 4 * i));
+        const __m128i b = _mm_loadu_si128((const __m128i*)(in + 4 * i + 16));
+        _mm_storeu_si128((__m128i*)(out + i), round_pack_sse2(a, b, 16));
+    }
+    return i;
+}
+
+__attribute__((target("sse2")))
+static size_t convert_f32_sse2(const uint8_t *in, int16_t *out, size_t num_samples)
+{
+    const __m128 scale = _mm_set1_ps(32768.0f);
+    const __m128 hi = _mm_set1_ps(32767.0f);
+    const __m128 lo = _mm_set1_ps(-32768.0f);
+
+    size_t i = 0;
+    for (; i + 8 <= num_samples; i += 8) {
+        __m128 a = _mm_mul_ps(_mm_loadu_ps((const float*)(in + 4 * i)), scale);
+        __m128 b = _mm_mul_ps(_mm_loadu_ps((const float*)(in + 4 * i + 16)), scale);
+        // minps returns the second operand if the first is NaN
+        a = _mm_max_ps(_mm_min_ps(a, hi), lo);
+        b = _mm_max_ps(_mm_min_ps(b, hi), lo);
+        // cvtps2dq rounds to nearest even, as lrintf does
+        _mm_storeu_si128((__m128i*)(out + i),
+                _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b)));
+    }
+    return i;
+}
+
+/* Four 24-bit samples from 12 bytes to the upper 24 bits of each lane */
+__attribute__((target("sse2,ssse3")))
+static size_t convert_s24_ssse3(const uint8_t *in, int16_t *out, size_t num_samples)
+{
+    const __m128i shuf = _mm_setr_epi8(
+            -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+
+    size_t i = 0;
+    // Each load reads 16 bytes of which 12 are used, stop before the
+    // load would read past the end
+    for (; i + 8 + 2 <= num_samples; i += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(in + 3 * i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(in + 3 * i + 12));
+        a = _mm_srai_epi32(_mm_shuffle_epi8(a, shuf), 8);
+        b = _mm_srai_epi32(_mm_shuffle_epi8(b, shuf), 8);
+        _mm_storeu_si128((__m128i*)(out + i), round_pack_sse2(a, b, 8));
+    }
+    return i;
+}
+
+struct cpu_features_t {
+    bool sse2 = false;
+    bool ssse3 = false;
+};
+
+static const cpu_features_t& cpu_features()
+{
+    static const cpu_features_t features = []() {
+        __builtin_cpu_init();
+        cpu_features_t f;
+        f.sse2 = __builtin_cpu_supports("sse2");
+        f.ssse3 = f.sse2 and __builtin_cpu_supports("ssse3");
+        return f;
+    }();
+    return features;
+}
+#endif
+
+void pcm_convert_to_s16(pcm_format_t format, const uint8_t *in,
+        int16_t *out, size_t num_samples)
+{
+    size_t done = 0;
+
+#if defined(PCM_CONVERT_X86)
+    const cpu_features_t& cpu = cpu_features();
+    switch (format) {
+        case pcm_format_t::S24:
+            if (cpu.ssse3) {
+                done = convert_s24_ssse3(in, out, num_samples);
+            }
+            break;
+        case pcm_format_t::S32:
+            if (cpu.sse2) {
+                done = convert_s32_sse2(in, out, num_samples);
+            }
+            break;
+        case pcm_format_t::F32:
+            if (cpu.sse2) {
+                done = convert_f32_sse2(in, out, num_samples);
+            }
+            break;
+        case pcm_format_t::S16:
+        case pcm_format_t::F64:
+            break;
+    }
+#endif
+
+    pcm_convert_to_s16_scalar(format, in + done * pcm_sample_size(format),
+            out + done, num_samples - done);
+}
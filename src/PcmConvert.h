@@ -0,0 +1,53 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+/*! \file PcmConvert.h
+ *
+ * Conversion of the little-endian sample formats found in wav files
+ * to the 16-bit samples the encoders take.
+ *
+ * Integer samples are rounded to the nearest 16-bit value, float samples
+ * are scaled by 32768 and rounded to nearest even. Both saturate at the
+ * 16-bit range, and a float NaN becomes the positive full scale.
+ *
+ * The 24-bit, 32-bit and float conversions use SSE2 and SSSE3 when the
+ * CPU supports them, and give the same result as the scalar code.
+ */
+
+enum class pcm_format_t {
+    S16,
+    S24,
+    S32,
+    F32,
+    F64,
+};
+
+/*! Size of one sample in bytes */
+size_t pcm_sample_size(pcm_format_t format);
+
+/*! Convert num_samples samples from in to 16-bit in out. */
+void pcm_convert_to_s16(pcm_format_t format, const uint8_t *in,
+        int16_t *out, size_t num_samples);
+
+/*! The scalar implementation, that handles any number of samples */
+void pcm_convert_to_s16_scalar(pcm_format_t format, const uint8_t *in,
+        int16_t *out, size_t num_samples);
@@ -0,0 +1,67 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+
+#include "Pipeline.h"
+#include <algorithm>
+
+using namespace std;
+
+void LatencyHistogram::record(chrono::steady_clock::duration d)
+{
+    const auto us_signed = chrono::duration_cast<chrono::microseconds>(d).count();
+    const uint64_t us = us_signed > 0 ? us_signed : 0;
+
+    size_t bucket = 0;
+    while (bucket < NUM_BUCKETS - 1 and us >= (1ull << bucket)) {
+        bucket++;
+    }
+
+    m_buckets[bucket]++;
+    m_count++;
+    m_sum_us += us;
+    m_max_us = std::max(m_max_us, us);
+}
+
+uint64_t LatencyHistogram::percentile(double p) const
+{
+    const uint64_t target = p * m_count;
+    uint64_t accumulated = 0;
+    for (size_t i = 0; i < NUM_BUCKETS; i++) {
+        accumulated += m_buckets[i];
+        if (accumulated > target) {
+            return (i == NUM_BUCKETS - 1) ? m_max_us : (1ull << i);
+        }
+    }
+    return m_max_us;
+}
+
+void LatencyHistogram::print(FILE *fd, const char *name) const
+{
+    if (m_count == 0) {
+        fprintf(fd, "%-18s no data\n", name);
+        return;
+    }
+
+    fprintf(fd, "%-18s n=%llu mean=%.0fus p50<%lluus p99<%lluus max=%lluus\n",
+            name,
+            (unsigned long long)m_count,
+            m_sum_us / m_count,
+            (unsigned long long)percentile(0.5),
+            (unsigned long long)percentile(0.99),
+            (unsigned long long)m_max_us);
+}
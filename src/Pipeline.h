@@ -0,0 +1,130 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+
+#pragma once
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+/*! \file Pipeline.h
+ *
+ * Building blocks for the encoder pipeline. AudioEnc::run() is split in
+ * three stages running on their own threads:
+ *
+ *  capture/preprocess -> encode -> protect+send
+ *
+ * Stages exchange preallocated frames through bounded FrameQueues. Every
+ * stage owns a pool of free frames, so that the number of frames in
+ * flight, and therefore the latency added by the pipeline, is bounded by
+ * the pool sizes.
+ */
+
+/*! A bounded blocking queue with a fixed capacity, meant to pass pointers
+ * to preallocated frames between two threads. It does not allocate after
+ * construction.
+ */
+template<typename T>
+class FrameQueue {
+    public:
+        FrameQueue(size_t capacity) : m_ring(capacity) {}
+        FrameQueue(const FrameQueue& other) = delete;
+        FrameQueue& operator=(const FrameQueue& other) = delete;
+
+        /*! Push an element, blocks while the queue is full.
+         *
+         * \return false if the queue was closed
+         */
+        bool push(T val)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_not_full.wait(lock, [&]{ return m_closed or m_count < m_ring.size(); });
+            if (m_closed) {
+                return false;
+            }
+            m_ring[(m_head + m_count) % m_ring.size()] = val;
+            m_count++;
+            lock.unlock();
+            m_not_empty.notify_one();
+            return true;
+        }
+
+        /*! Pop an element, blocks while the queue is empty.
+         *
+         * \return false if the queue was closed and is empty
+         */
+        bool pop(T& val)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_not_empty.wait(lock, [&]{ return m_closed or m_count > 0; });
+            if (m_count == 0) {
+                return false;
+            }
+            val = m_ring[m_head];
+            m_head = (m_head + 1) % m_ring.size();
+            m_count--;
+            lock.unlock();
+            m_not_full.notify_one();
+            return true;
+        }
+
+        /*! Wake up all waiting threads. Elements still in the queue
+         * can be popped, but no new ones can be pushed. */
+        void close()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_closed = true;
+            lock.unlock();
+            m_not_empty.notify_all();
+            m_not_full.notify_all();
+        }
+
+    private:
+        std::vector<T> m_ring;
+        size_t m_head = 0;
+        size_t m_count = 0;
+        bool m_closed = false;
+
+        std::mutex m_mutex;
+        std::condition_variable m_not_empty;
+        std::condition_variable m_not_full;
+};
+
+/*! Histogram of durations with power-of-two microsecond buckets.
+ * Not thread-safe, each pipeline stage keeps its own histograms. */
+class LatencyHistogram {
+    public:
+        void record(std::chrono::steady_clock::duration d);
+
+        /*! Print count, mean, maximum and approximate percentiles */
+        void print(FILE *fd, const char *name) const;
+
+    private:
+        /* Bucket i holds durations below 2^i us, the last one
+         * everything above */
+        static constexpr size_t NUM_BUCKETS = 25;
+        std::array<uint64_t, NUM_BUCKETS> m_buckets = {};
+        uint64_t m_count = 0;
+        uint64_t m_max_us = 0;
+        double m_sum_us = 0;
+
+        uint64_t percentile(double p) const;
+};
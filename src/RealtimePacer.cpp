@@ -0,0 +1,172 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+
+#include "RealtimePacer.h"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <pthread.h>
+#include <sched.h>
+
+using namespace std;
+
+static const int64_t NS_PER_SECOND = 1000000000;
+
+RealtimePacer::RealtimePacer(unsigned int sample_rate, bool use_tai) :
+    m_clock(CLOCK_MONOTONIC),
+    m_sample_rate(sample_rate)
+{
+    if (use_tai) {
+#if defined(CLOCK_TAI)
+        m_clock = CLOCK_TAI;
+#else
+        fprintf(stderr, "CLOCK_TAI not available, pacing the encoder on CLOCK_MONOTONIC\n");
+#endif
+    }
+}
+
+int64_t RealtimePacer::now_ns() const
+{
+    struct timespec ts;
+    if (clock_gettime(m_clock, &ts) != 0) {
+        throw runtime_error(string("clock_gettime failed: ") + strerror(errno));
+    }
+    return ts.tv_sec * NS_PER_SECOND + ts.tv_nsec;
+}
+
+void RealtimePacer::start()
+{
+    m_start_ns = now_ns();
+    m_frames = 0;
+}
+
+void RealtimePacer::wait(size_t num_frames)
+{
+    m_frames += num_frames;
+
+    // Split to avoid overflowing when multiplying by NS_PER_SECOND
+    const uint64_t seconds = m_frames / m_sample_rate;
+    const uint64_t remainder = m_frames % m_sample_rate;
+    const int64_t deadline = m_start_ns + seconds * NS_PER_SECOND +
+        remainder * NS_PER_SECOND / m_sample_rate;
+
+    int64_t now = now_ns();
+
+    // Too far behind, or the clock jumped backwards
+    if (now - deadline > RESYNC_THRESHOLD_NS or
+            deadline - now > RESYNC_THRESHOLD_NS) {
+        fprintf(stderr, "Encoder is %.3fs off its pace, restarting pacing\n",
+                (double)(now - deadline) / NS_PER_SECOND);
+        m_resyncs++;
+        m_start_ns = now;
+        m_frames = 0;
+        return;
+    }
+
+    if (now < deadline) {
+        struct timespec ts;
+        ts.tv_sec = deadline / NS_PER_SECOND;
+        ts.tv_nsec = deadline % NS_PER_SECOND;
+
+        int ret = 0;
+        do {
+            ret = clock_nanosleep(m_clock, TIMER_ABSTIME, &ts, nullptr);
+        } while (ret == EINTR);
+
+        if (ret != 0) {
+            throw runtime_error(string("clock_nanosleep failed: ") + strerror(ret));
+        }
+        now = now_ns();
+    }
+
+    m_late_wakeups.record(chrono::nanoseconds(now - deadline));
+}
+
+void RealtimePacer::print_stats(FILE *fd) const
+{
+    m_late_wakeups.print(fd, "late wakeup");
+    fprintf(fd, "%-18s %zu\n", "pacing restarts", m_resyncs);
+}
+
+void set_realtime_priority(int priority)
+{
+    const int min = sched_get_priority_min(SCHED_FIFO);
+    const int max = sched_get_priority_max(SCHED_FIFO);
+    if (priority < min or priority > max) {
+        throw runtime_error("Real-time priority must be between " +
+                to_string(min) + " and " + to_string(max));
+    }
+
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = priority;
+
+    const int ret = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (ret != 0) {
+        throw runtime_error(string("Cannot set real-time priority: ") + strerror(ret));
+    }
+}
+
+void set_cpu_affinity(const string& cpu_list)
+{
+#if defined(__linux__)
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+
+    size_t pos = 0;
+    while (pos < cpu_list.size()) {
+        size_t end = cpu_list.find(',', pos);
+        if (end == string::npos) {
+            end = cpu_list.size();
+        }
+        const string item = cpu_list.substr(pos, end - pos);
+        pos = end + 1;
+
+        int first = 0;
+        int last = 0;
+        char dash = 0;
+        char extra = 0;
+        const int n = sscanf(item.c_str(), "%d%c%d%c", &first, &dash, &last, &extra);
+        if (n == 1) {
+            last = first;
+        }
+        else if (not (n == 3 and dash == '-')) {
+            throw runtime_error("Invalid CPU list '" + cpu_list + "'");
+        }
+
+        if (first < 0 or last < first or last >= CPU_SETSIZE) {
+            throw runtime_error("Invalid CPU range '" + item + "'");
+        }
+        for (int cpu = first; cpu <= last; cpu++) {
+            CPU_SET(cpu, &cpus);
+        }
+    }
+
+    if (CPU_COUNT(&cpus) == 0) {
+        throw runtime_error("Empty CPU list");
+    }
+
+    const int ret = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    if (ret != 0) {
+        throw runtime_error(string("Cannot set CPU affinity: ") + strerror(ret));
+    }
+#else
+    throw runtime_error("CPU affinity is not supported on this system");
+#endif
+}
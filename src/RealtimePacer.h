@@ -0,0 +1,83 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <time.h>
+#include "Pipeline.h"
+
+/*! \file RealtimePacer.h
+ *
+ * Pacing of the encoder at the nominal sample rate, for the inputs that
+ * do not block (drift compensation).
+ *
+ * The deadline of every frame is computed from the start time and the
+ * total number of frames, and the pacer sleeps until it with an absolute
+ * clock_nanosleep(). Wakeups that are late therefore do not accumulate,
+ * and the next deadline is reached earlier instead. The lateness of every
+ * wakeup goes into a histogram.
+ *
+ * The clock is CLOCK_MONOTONIC, or CLOCK_TAI when the EDI output carries
+ * timestamps, so that the encoder follows the clock the timestamps are
+ * derived from.
+ *
+ * If the encoder falls more than RESYNC_THRESHOLD_NS behind, or the clock
+ * jumps, the pacer starts again from the current time instead of trying
+ * to catch up.
+ */
+
+class RealtimePacer {
+    public:
+        RealtimePacer(unsigned int sample_rate, bool use_tai);
+        RealtimePacer(const RealtimePacer& other) = delete;
+        RealtimePacer& operator=(const RealtimePacer& other) = delete;
+
+        /*! Take the current time as the start of the first frame */
+        void start();
+
+        /*! Sleep until the end of the next num_frames frames */
+        void wait(size_t num_frames);
+
+        /*! Print the late wakeup histogram and the number of restarts */
+        void print_stats(FILE *fd) const;
+
+        static constexpr int64_t RESYNC_THRESHOLD_NS = 1000000000;
+
+    private:
+        int64_t now_ns() const;
+
+        clockid_t m_clock;
+        unsigned int m_sample_rate;
+
+        int64_t m_start_ns = 0;
+        uint64_t m_frames = 0;
+
+        LatencyHistogram m_late_wakeups;
+        size_t m_resyncs = 0;
+};
+
+/*! Run the calling thread with SCHED_FIFO at the given priority.
+ * Throws a runtime_error on failure. */
+void set_realtime_priority(int priority);
+
+/*! Restrict the calling thread to the CPUs in the list, given like
+ * "1,3" or "2-5". Throws a runtime_error on failure. */
+void set_cpu_affinity(const std::string& cpu_list);
@@ -0,0 +1,421 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+
+#include "Resampler.h"
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define RESAMPLER_X86
+#  include <immintrin.h>
+#endif
+
+using namespace std;
+
+/* Above this number of phases, the coefficient table gets too large
+ * for the cache. This still covers all ratios between the usual rates. */
+static const unsigned MAX_PHASES = 1024;
+
+/* Phases of the VariableResampler, between which it interpolates */
+static const unsigned VARIABLE_PHASES = 256;
+
+struct quality_params_t {
+    /* Stopband attenuation in dB */
+    double attenuation;
+    /* End of the passband, as a fraction of the lower rate. The stopband
+     * always starts at one half of the lower rate. */
+    double passband;
+};
+
+static quality_params_t quality_params(resampler_quality_t quality)
+{
+    switch (quality) {
+        case resampler_quality_t::Fast:   return {70.0, 0.40};
+        case resampler_quality_t::Medium: return {96.0, 0.43};
+        case resampler_quality_t::Best:   return {120.0, 0.455};
+    }
+    throw logic_error("Invalid resampler quality");
+}
+
+bool resampler_parse_quality(const string& s, resampler_quality_t& quality)
+{
+    if (s == "fast") {
+        quality = resampler_quality_t::Fast;
+    }
+    else if (s == "medium") {
+        quality = resampler_quality_t::Medium;
+    }
+    else if (s == "best") {
+        quality = resampler_quality_t::Best;
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+static float dot_scalar(const float *a, const float *b, size_t n)
+{
+    float sum = 0.0f;
+    for (size_t i = 0; i < n; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+#if defined(RESAMPLER_X86)
+/* The kernels require n to be a multiple of 8 */
+__attribute__((target("sse")))
+static float dot_sse(const float *a, const float *b, size_t n)
+{
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    for (size_t i = 0; i < n; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    acc0 = _mm_add_ps(acc0, acc1);
+    acc0 = _mm_add_ps(acc0, _mm_movehl_ps(acc0, acc0));
+    acc0 = _mm_add_ss(acc0, _mm_shuffle_ps(acc0, acc0, 1));
+    return _mm_cvtss_f32(acc0);
+}
+
+__attribute__((target("avx2,fma")))
+static float dot_avx2(const float *a, const float *b, size_t n)
+{
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+    }
+    if (i < n) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+    }
+    acc0 = _mm256_add_ps(acc0, acc1);
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(acc0), _mm256_extractf128_ps(acc0, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    return _mm_cvtss_f32(s);
+}
+#endif
+
+/* Zeroth order modified Bessel function of the first kind, for the
+ * Kaiser window */
+static double bessel_i0(double x)
+{
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 50; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < sum * 1e-17) {
+            break;
+        }
+    }
+    return sum;
+}
+
+using dot_function_t = float (*)(const float *a, const float *b, size_t n);
+
+/* The kernels the CPU supports, the scalar one first and the fastest last */
+static vector<pair<string, dot_function_t> > available_dots()
+{
+    vector<pair<string, dot_function_t> > dots;
+    dots.emplace_back("scalar", dot_scalar);
+#if defined(RESAMPLER_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse")) {
+        dots.emplace_back("sse", dot_sse);
+    }
+    if (__builtin_cpu_supports("avx2") and __builtin_cpu_supports("fma")) {
+        dots.emplace_back("avx2", dot_avx2);
+    }
+#endif
+    return dots;
+}
+
+static dot_function_t select_dot()
+{
+    return available_dots().back().second;
+}
+
+static dot_function_t select_dot(const string& name)
+{
+    for (const auto& d : available_dots()) {
+        if (d.first == name) {
+            return d.second;
+        }
+    }
+    throw invalid_argument("Resampler kernel " + name + " not supported");
+}
+
+/* Kaiser's estimate of the filter length for the attenuation and the
+ * transition band, in samples at the lower rate, converted to input
+ * samples and rounded up to a multiple of 8 for the kernels */
+static size_t filter_taps(const quality_params_t& q, double in_rate, double low_rate)
+{
+    const double transition = 0.5 - q.passband;
+    const double length = (q.attenuation - 7.95) / (14.36 * transition);
+    const size_t taps = ceil(length * in_rate / low_rate);
+    return (taps + 7) / 8 * 8;
+}
+
+/* Compute num_tables phases of taps coefficients each, in the order they
+ * multiply the history, oldest sample first. The prototype lowpass runs
+ * at phases times the input rate. Its cutoff, relative to the input rate,
+ * lies in the middle of the transition band. With num_tables = phases + 1,
+ * the last table is the first one shifted by one input sample. */
+static vector<float> design_polyphase(const quality_params_t& q, double cutoff,
+        size_t taps, size_t phases, size_t num_tables)
+{
+    const double beta = 0.1102 * (q.attenuation - 8.7);
+
+    const size_t proto_len = taps * phases + 1;
+    const double centre = taps * phases / 2.0;
+    const double proto_cutoff = cutoff / phases;
+
+    vector<double> proto(proto_len);
+    double sum = 0.0;
+    for (size_t m = 0; m < proto_len; m++) {
+        const double x = m - centre;
+        const double arg = 2.0 * M_PI * proto_cutoff * x;
+        const double sinc = (x == 0.0) ? 1.0 : sin(arg) / arg;
+        const double r = x / centre;
+        const double window = bessel_i0(beta * sqrt(std::max(0.0, 1.0 - r * r))) /
+            bessel_i0(beta);
+        proto[m] = sinc * window;
+        if (m + 1 < proto_len) {
+            sum += proto[m];
+        }
+    }
+
+    // Every phase sums to about one, which gives unity gain
+    const double gain = phases / sum;
+
+    vector<float> coefs(num_tables * taps);
+    for (size_t p = 0; p < num_tables; p++) {
+        for (size_t j = 0; j < taps; j++) {
+            const size_t k = taps - 1 - j;
+            coefs[p * taps + j] = proto[p + k * phases] * gain;
+        }
+    }
+    return coefs;
+}
+
+/* Append num_frames interleaved frames to the per-channel histories */
+static void append_history(vector<vector<float> >& history,
+        const int16_t *in, size_t num_frames)
+{
+    const size_t channels = history.size();
+    for (size_t ch = 0; ch < channels; ch++) {
+        vector<float>& h = history[ch];
+        const size_t start = h.size();
+        h.resize(start + num_frames);
+        for (size_t i = 0; i < num_frames; i++) {
+            h[start + i] = in[i * channels + ch];
+        }
+    }
+}
+
+/* Remove the samples before the first one the output at index needs */
+static void trim_history(vector<vector<float> >& history, size_t& index, size_t taps)
+{
+    const size_t drop = std::min(index + 1 - taps, history[0].size());
+    for (auto& h : history) {
+        h.erase(h.begin(), h.begin() + drop);
+    }
+    index -= drop;
+}
+
+static inline int16_t round_saturate(float v)
+{
+    v = (v < 32767.0f) ? v : 32767.0f;
+    v = (v > -32768.0f) ? v : -32768.0f;
+    return (int16_t)lrintf(v);
+}
+
+Resampler::Resampler(unsigned in_rate, unsigned out_rate, unsigned channels,
+        resampler_quality_t quality) :
+    m_in_rate(in_rate),
+    m_out_rate(out_rate),
+    m_channels(channels)
+{
+    if (in_rate == 0 or out_rate == 0 or channels == 0) {
+        throw logic_error("Invalid resampler configuration");
+    }
+
+    const unsigned g = gcd(in_rate, out_rate);
+    m_up = out_rate / g;
+    m_down = in_rate / g;
+
+    if (m_up > MAX_PHASES) {
+        throw runtime_error("Cannot resample from " + to_string(in_rate) +
+                " to " + to_string(out_rate) + " Hz");
+    }
+
+    const quality_params_t q = quality_params(quality);
+    const double low_rate = std::min(m_in_rate, m_out_rate);
+    m_taps = filter_taps(q, m_in_rate, low_rate);
+    m_coefs = design_polyphase(q, (q.passband + 0.5) / 2.0 * low_rate / m_in_rate,
+            m_taps, m_up, m_up);
+
+    /* Start with half a filter of silence, which places the centre of the
+     * filter on the first input sample. The output is then aligned with
+     * the input, and the delay is the half filter the converter has to
+     * wait for. */
+    m_history.resize(m_channels);
+    for (auto& h : m_history) {
+        h.assign(m_taps / 2, 0.0f);
+    }
+    m_index = m_taps;
+    m_phase = 0;
+
+    m_dot = select_dot();
+}
+
+void Resampler::process(const int16_t *in, size_t num_frames, vector<int16_t>& out)
+{
+    append_history(m_history, in, num_frames);
+
+    const size_t available = m_history[0].size();
+
+    out.clear();
+    while (m_index < available) {
+        const float *coefs = &m_coefs[m_phase * m_taps];
+        const size_t first = m_index + 1 - m_taps;
+        for (unsigned ch = 0; ch < m_channels; ch++) {
+            out.push_back(round_saturate(m_dot(coefs, &m_history[ch][first], m_taps)));
+        }
+
+        m_phase += m_down;
+        m_index += m_phase / m_up;
+        m_phase %= m_up;
+    }
+
+    // Keep the samples the next output needs
+    trim_history(m_history, m_index, m_taps);
+}
+
+vector<string> Resampler::kernels()
+{
+    vector<string> names;
+    for (const auto& d : available_dots()) {
+        names.push_back(d.first);
+    }
+    return names;
+}
+
+void Resampler::set_kernel(const string& name)
+{
+    m_dot = select_dot(name);
+}
+
+size_t Resampler::input_frames_for(size_t num_frames) const
+{
+    return (num_frames * m_down + m_up - 1) / m_up;
+}
+
+double Resampler::delay() const
+{
+    return (m_taps / 2) / (double)m_in_rate;
+}
+
+VariableResampler::VariableResampler(unsigned channels, resampler_quality_t quality) :
+    m_channels(channels)
+{
+    if (channels == 0) {
+        throw logic_error("Invalid resampler configuration");
+    }
+
+    const quality_params_t q = quality_params(quality);
+    m_taps = filter_taps(q, 1.0, 1.0);
+    m_coefs = design_polyphase(q, (q.passband + 0.5) / 2.0,
+            m_taps, VARIABLE_PHASES, VARIABLE_PHASES + 1);
+
+    // See Resampler::Resampler()
+    m_history.resize(m_channels);
+    for (auto& h : m_history) {
+        h.assign(m_taps / 2, 0.0f);
+    }
+    m_index = m_taps;
+    m_frac = 0.0;
+
+    m_dot = select_dot();
+}
+
+void VariableResampler::set_kernel(const string& name)
+{
+    m_dot = select_dot(name);
+}
+
+size_t VariableResampler::input_frames_for(size_t num_frames) const
+{
+    if (num_frames == 0) {
+        return 0;
+    }
+
+    // Step like process() does, to get the same rounding
+    size_t index = m_index;
+    double frac = m_frac;
+    for (size_t i = 1; i < num_frames; i++) {
+        frac += m_ratio;
+        const double whole = floor(frac);
+        index += whole;
+        frac -= whole;
+    }
+
+    const size_t available = m_history[0].size();
+    return (index < available) ? 0 : index + 1 - available;
+}
+
+void VariableResampler::process(const int16_t *in, size_t num_in,
+        int16_t *out, size_t num_out)
+{
+    append_history(m_history, in, num_in);
+
+    for (size_t n = 0; n < num_out; n++) {
+        if (m_index >= m_history[0].size()) {
+            throw logic_error("VariableResampler: not enough input");
+        }
+
+        const double phase = m_frac * VARIABLE_PHASES;
+        const size_t p = phase;
+        const float t = phase - p;
+        const float *coefs0 = &m_coefs[p * m_taps];
+        const float *coefs1 = coefs0 + m_taps;
+        const size_t first = m_index + 1 - m_taps;
+
+        for (unsigned ch = 0; ch < m_channels; ch++) {
+            const float *h = &m_history[ch][first];
+            const float y0 = m_dot(coefs0, h, m_taps);
+            const float y1 = m_dot(coefs1, h, m_taps);
+            out[n * m_channels + ch] = round_saturate(y0 + t * (y1 - y0));
+        }
+
+        m_frac += m_ratio;
+        const double whole = floor(m_frac);
+        m_index += whole;
+        m_frac -= whole;
+    }
+
+    trim_history(m_history, m_index, m_taps);
+}
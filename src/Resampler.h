@@ -0,0 +1,157 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/*! \file Resampler.h
+ *
+ * Sample-rate conversion for the inputs that cannot deliver the rate
+ * the encoder needs, e.g. a 44.1kHz wav file or a JACK server running
+ * at 96kHz.
+ *
+ * The converter is a polyphase FIR filter for the rational ratio
+ * out_rate/in_rate. The prototype lowpass is a Kaiser-windowed sinc
+ * whose stopband starts at the Nyquist frequency of the lower of the
+ * two rates, so that nothing aliases. The quality setting chooses the
+ * stopband attenuation and the width of the transition band, which
+ * sets the length of the filter and therefore the delay and the CPU
+ * time.
+ *
+ * The VariableResampler converts between two rates that are nominally
+ * equal but whose ratio is only known at run time and changes slowly,
+ * for the drift compensation. Its filter has a fixed number of phases,
+ * and it interpolates linearly between the two nearest ones.
+ *
+ * The filters are computed in float, with SSE or AVX2 kernels when the
+ * CPU supports them. The output is rounded and saturated to 16-bit.
+ */
+
+enum class resampler_quality_t {
+    Fast,
+    Medium,
+    Best,
+};
+
+/*! Parse fast, medium or best. \return false if the string is not valid */
+bool resampler_parse_quality(const std::string& s, resampler_quality_t& quality);
+
+class Resampler {
+    public:
+        /*! Throws a runtime_error if the ratio of the two rates cannot be
+         * implemented with a reasonable number of filter phases. */
+        Resampler(unsigned in_rate, unsigned out_rate, unsigned channels,
+                resampler_quality_t quality);
+        Resampler(const Resampler& other) = delete;
+        Resampler& operator=(const Resampler& other) = delete;
+
+        /*! Resample num_frames interleaved frames from in. The output
+         * replaces the content of out, and holds all frames the input
+         * given so far allows to compute. */
+        void process(const int16_t *in, size_t num_frames, std::vector<int16_t>& out);
+
+        /*! Number of input frames needed to produce about num_frames
+         * output frames. */
+        size_t input_frames_for(size_t num_frames) const;
+
+        /*! Delay between the input and the output, in seconds */
+        double delay() const;
+
+        unsigned in_rate() const { return m_in_rate; }
+        unsigned out_rate() const { return m_out_rate; }
+
+        /*! Names of the dot product kernels the CPU supports, the scalar
+         * one first and the fastest last. */
+        static std::vector<std::string> kernels();
+
+        /*! Use the named kernel instead of the fastest one, for tests and
+         * benchmarks. Throws std::invalid_argument for unsupported kernels. */
+        void set_kernel(const std::string& name);
+
+    private:
+        unsigned m_in_rate;
+        unsigned m_out_rate;
+        unsigned m_channels;
+
+        /* The ratio out_rate/in_rate is m_up/m_down */
+        unsigned m_up = 1;
+        unsigned m_down = 1;
+
+        /* Taps per phase, a multiple of 8 */
+        size_t m_taps = 0;
+
+        /* m_up phases of m_taps coefficients each, in the order they
+         * multiply the history, oldest sample first */
+        std::vector<float> m_coefs;
+
+        /* One history per channel, oldest sample first */
+        std::vector<std::vector<float> > m_history;
+
+        /* Position of the next output in the history, in input samples
+         * (m_index) and 1/m_up fractions of it (m_phase) */
+        size_t m_index = 0;
+        unsigned m_phase = 0;
+
+        using dot_function_t = float (*)(const float *a, const float *b, size_t n);
+        dot_function_t m_dot = nullptr;
+};
+
+class VariableResampler {
+    public:
+        VariableResampler(unsigned channels, resampler_quality_t quality);
+        VariableResampler(const VariableResampler& other) = delete;
+        VariableResampler& operator=(const VariableResampler& other) = delete;
+
+        /*! Set the number of input frames consumed per output frame */
+        void set_ratio(double ratio) { m_ratio = ratio; }
+        double ratio() const { return m_ratio; }
+
+        /*! Number of input frames process() needs to produce num_frames
+         * output frames at the current ratio. */
+        size_t input_frames_for(size_t num_frames) const;
+
+        /*! Append num_in interleaved input frames, which must be at least
+         * input_frames_for(num_out), and write num_out frames to out. */
+        void process(const int16_t *in, size_t num_in, int16_t *out, size_t num_out);
+
+        /*! See Resampler::set_kernel() */
+        void set_kernel(const std::string& name);
+
+    private:
+        unsigned m_channels;
+
+        size_t m_taps = 0;
+
+        /* VARIABLE_PHASES + 1 phases of m_taps coefficients each */
+        std::vector<float> m_coefs;
+
+        std::vector<std::vector<float> > m_history;
+
+        /* Position of the next output in the history, in input samples
+         * and a fraction of one */
+        size_t m_index = 0;
+        double m_frac = 0.0;
+
+        double m_ratio = 1.0;
+
+        using dot_function_t = float (*)(const float *a, const float *b, size_t n);
+        dot_function_t m_dot = nullptr;
+};
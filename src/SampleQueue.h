@@ -19,7 +19,7 @@
 
 /*!
  * \file SampleQueue.h
- * \brief An implementation for a threadsafe queue using the C++11 thread library
+ * \brief A lock-free single-producer single-consumer ring buffer
  * for audio samples.
  */
 
@@ -28,19 +28,109 @@
 
 #define DEBUG_SAMPLE_QUEUE 0
 
+#include <atomic>
 #include <mutex>
 #include <thread>
 #include <chrono>
 #include <condition_variable>
-#include <queue>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <algorithm>
 #include <cassert>
-#include <sstream>
+#include <cstring>
+#include <cstdint>
 #include <cstdio>
 #include <cmath>
+#include <climits>
+
+#if defined(__linux__)
+#  include <linux/futex.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#  include <time.h>
+#endif
+
+/*! Size we pad the producer and consumer indices to, so that they
+ * do not share a cache line */
+constexpr size_t SAMPLE_QUEUE_CACHELINE_SIZE = 64;
+
+/*! A wakeup primitive for the SampleQueue. The side that has to wait
+ * registers itself with begin_wait(), checks its condition again, and only
+ * then calls wait(). notify() is a simple atomic load as long as nobody is
+ * waiting, and only issues a futex wakeup (or a condition variable
+ * notification on systems without futexes) if there is a waiter.
+ */
+class SampleQueueEvent
+{
+public:
+    uint32_t begin_wait()
+    {
+        m_waiters.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return m_seq.load();
+    }
+
+    void end_wait()
+    {
+        m_waiters.fetch_sub(1);
+    }
+
+    /*! Block until notify() is called or timeout expires. Returns
+     * immediately if a notification arrived since begin_wait() */
+    void wait(uint32_t ticket, std::chrono::nanoseconds timeout)
+    {
+        if (timeout.count() <= 0) {
+            return;
+        }
+#if defined(__linux__)
+        static_assert(sizeof(m_seq) == sizeof(uint32_t),
+                "futex requires a plain 32-bit word");
+        struct timespec ts;
+        ts.tv_sec = timeout.count() / 1000000000;
+        ts.tv_nsec = timeout.count() % 1000000000;
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&m_seq),
+                FUTEX_WAIT_PRIVATE, ticket, &ts, nullptr, 0);
+#else
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait_for(lock, timeout, [&]{ return m_seq.load() != ticket; });
+#endif
+    }
+
+    bool has_waiters() const
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return m_waiters.load() > 0;
+    }
+
+    void notify()
+    {
+        if (not has_waiters()) {
+            return;
+        }
+
+        m_seq.fetch_add(1);
+#if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&m_seq),
+                FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#else
+        { std::lock_guard<std::mutex> lock(m_mutex); }
+        m_cv.notify_all();
+#endif
+    }
+
+private:
+    std::atomic<uint32_t> m_seq = ATOMIC_VAR_INIT(0);
+    std::atomic<uint32_t> m_waiters = ATOMIC_VAR_INIT(0);
+#if !defined(__linux__)
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+#endif
+};
 
 /*! This queue is meant to be used by two threads. One producer
  * that pushes elements into the queue, and one consumer that
- * retrieves the elements.
+ * retrieves the elements. clear() belongs to the consumer side.
  *
  * This queue should contain audio sample data, interleaved L/R
  * form, 2bytes per sample. Therefore, the push and pop functions
@@ -53,6 +143,12 @@
  * If pop() is called but there is not enough data in the queue,
  * the missing samples are replaced by zeros. pop() will always
  * write the requested length.
+ *
+ * The storage is a fixed-capacity ring buffer allocated in configure(),
+ * with a capacity of at least twice the maximum size so that a push
+ * accepted below the maximum size always fits. Data is copied in bulk,
+ * and the producer and consumer only touch the other side's index, never
+ * a common lock.
  */
 
 
@@ -62,15 +158,34 @@
 template<typename T>
 class SampleQueue
 {
+    static_assert(std::is_trivially_copyable<T>::value,
+            "SampleQueue copies elements with memcpy");
+
 public:
     SampleQueue(unsigned int bytes_per_sample) :
         m_bytes_per_sample(bytes_per_sample) {}
 
+    SampleQueue(const SampleQueue& other) = delete;
+    SampleQueue& operator=(const SampleQueue& other) = delete;
+
+    /*! Set the queue parameters and allocate the ring buffer. Must
+     * be called before the producer thread is started.
+     */
     void configure(size_t max_size, bool push_block, unsigned int channels)
     {
         m_max_size = max_size;
         m_push_block = push_block;
         m_channels = channels;
+
+        size_t capacity = 1;
+        while (capacity < 2 * max_size) {
+            capacity <<= 1;
+        }
+
+        m_buffer.reset(new T[capacity]);
+        m_capacity = capacity;
+        m_head.store(0);
+        m_tail.store(0);
     }
 
 
@@ -80,58 +195,65 @@ public:
      */
     size_t push(const T *val, size_t len)
     {
-        size_t new_size = 0;
-
-        {
-            std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_capacity == 0) {
+            throw std::logic_error("SampleQueue used before configure()");
+        }
 
-            assert(len % (m_channels * m_bytes_per_sample) == 0);
+        assert(len % (m_channels * m_bytes_per_sample) == 0);
 
 #if DEBUG_SAMPLE_QUEUE
-            fprintf(stdout, "######## push %s %zu, %zu >= %zu\n",
-                    (m_queue.size() >= m_max_size) ? "overrun" : "ok",
-                    len / 4,
-                    m_queue.size() / 4,
-                    m_max_size / 4);
+        fprintf(stdout, "######## push %s %zu, %zu >= %zu\n",
+                (size() >= m_max_size) ? "overrun" : "ok",
+                len / 4,
+                size() / 4,
+                m_max_size / 4);
 #endif
 
-            if (m_push_block) {
-                while (len) {
-                    const size_t available = m_max_size - m_queue.size();
-                    const size_t copy_len = std::min(available, len);
+        if (m_push_block) {
+            while (len) {
+                const size_t used = size();
+                const size_t available = (used < m_max_size) ? m_max_size - used : 0;
+                const size_t copy_len = std::min(available, len);
 
-                    if (copy_len > 0) {
-                        std::copy(val, val + copy_len, std::back_inserter(m_queue));
-                        len -= copy_len;
-                        val += copy_len;
-                    }
-                    else {
-                        const auto wait_timeout = std::chrono::milliseconds(100);
-                        m_pop_notification.wait_for(lock, wait_timeout);
+                if (copy_len > 0) {
+                    write(val, copy_len);
+                    len -= copy_len;
+                    val += copy_len;
+                }
+                else {
+                    const auto wait_timeout = std::chrono::milliseconds(100);
+                    const uint32_t ticket = m_pop_event.begin_wait();
+                    if (size() >= m_max_size) {
+                        m_pop_event.wait(ticket, wait_timeout);
                     }
+                    m_pop_event.end_wait();
                 }
             }
+        }
+        else {
+            const size_t used = size();
+            if (used < m_max_size and len <= m_capacity - used) {
+                write(val, len);
+            }
             else {
-                if (m_queue.size() < m_max_size) {
-                    std::copy(val, val + len, std::back_inserter(m_queue));
-                }
-                else {
-                    m_overruns++;
-                }
+                m_overruns.fetch_add(1);
             }
-
-            new_size = m_queue.size();
         }
 
-        m_push_notification.notify_all();
+        const size_t new_size = size();
+
+        if (new_size >= m_pop_wait_len.load()) {
+            m_push_event.notify();
+        }
 
         return new_size;
     }
 
     size_t size() const
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        return m_queue.size();
+        const size_t head = m_head.load(std::memory_order_acquire);
+        const size_t tail = m_tail.load(std::memory_order_acquire);
+        return tail - head;
     }
 
     /*! Wait until len elements in the queue are available,
@@ -149,50 +271,46 @@ public:
 #if DEBUG_SAMPLE_QUEUE
         fprintf(stdout, "######## pop_wait %zu\n", len);
 #endif
-        std::unique_lock<std::mutex> lock(m_mutex);
 
         if (overruns) {
-            *overruns = m_overruns;
-            m_overruns = 0;
+            *overruns = m_overruns.exchange(0);
         }
 
-        auto time_start = std::chrono::steady_clock::now();
-        const auto timeout = std::chrono::milliseconds(timeout_ms);
-
-        do {
-            const auto wait_timeout = std::chrono::milliseconds(10);
-            m_push_notification.wait_for(lock, wait_timeout);
+        const auto deadline = std::chrono::steady_clock::now() +
+            std::chrono::milliseconds(timeout_ms);
 
-#if DEBUG_SAMPLE_QUEUE
-                fprintf(stdout, "######## pop_wait %zu need %zu\n",
-                        m_queue.size(), len);
-#endif
+        m_pop_wait_len.store(len);
 
-            if (std::chrono::steady_clock::now() - time_start > timeout) {
+        while (size() < len) {
+            const auto now = std::chrono::steady_clock::now();
+            if (now >= deadline) {
 #if DEBUG_SAMPLE_QUEUE
                 fprintf(stdout, "######## pop_wait timeout\n");
 #endif
                 break;
             }
-        } while (m_queue.size() < len);
 
-        size_t num_to_copy = (m_queue.size() < len) ?
-            m_queue.size() : len;
+            const uint32_t ticket = m_push_event.begin_wait();
+            if (size() < len) {
+                m_push_event.wait(ticket, deadline - now);
+            }
+            m_push_event.end_wait();
 
-        std::copy(
-                m_queue.begin(),
-                m_queue.begin() + num_to_copy,
-                buf);
+#if DEBUG_SAMPLE_QUEUE
+            fprintf(stdout, "######## pop_wait %zu need %zu\n", size(), len);
+#endif
+        }
 
-        m_queue.erase(m_queue.begin(), m_queue.begin() + num_to_copy);
+        m_pop_wait_len.store(0);
 
-        lock.unlock();
+        const size_t num_to_copy = std::min(size(), len);
+        read(buf, num_to_copy);
 
 #if DEBUG_SAMPLE_QUEUE
         fprintf(stdout, "######## pop_wait returns %zu\n", num_to_copy);
 #endif
 
-        m_pop_notification.notify_all();
+        m_pop_event.notify();
         return num_to_copy;
     }
 
@@ -204,7 +322,7 @@ public:
     size_t pop(T* buf, size_t len)
     {
         size_t ovr;
-        return pop(buf, len, ovr);
+        return pop(buf, len, &ovr);
     }
 
     /*! Get up to len elements, place them into the buf array.
@@ -216,92 +334,100 @@ public:
      */
     size_t pop(T* buf, size_t len, size_t* overruns)
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
-
         assert(len % (m_channels * m_bytes_per_sample) == 0);
 
+        *overruns = m_overruns.exchange(0);
+
+        const size_t available = size();
+
 #if DEBUG_SAMPLE_QUEUE
-        fprintf(stdout, "######## pop %zu (%zu), %zu overruns: ",
+        fprintf(stdout, "######## pop %zu (%zu), %zu overruns\n",
                 len / 4,
-                m_queue.size() / 4,
-                m_overruns);
+                available / 4,
+                *overruns);
 #endif
-        *overruns = m_overruns;
-        m_overruns = 0;
 
         size_t ret = 0;
 
-        if (m_queue.size() < len) {
+        if (available < len) {
             /* Not enough data in queue, fill with zeros */
-
-            size_t i;
-            for (i = 0; i < m_queue.size(); i++) {
-                buf[i] = m_queue[i];
-            }
-
-            ret = i;
-
-            for (; i < len; i++) {
-                buf[i] = 0;
-            }
-
-            m_queue.resize(0);
-
-#if DEBUG_SAMPLE_QUEUE
-            fprintf(stdout, "after short pop %zu (%zu)\n",
-                len / 4,
-                m_queue.size() / 4);
-#endif
+            read(buf, available);
+            std::fill(buf + available, buf + len, T());
+            ret = available;
         }
         else {
             /* Queue contains enough data */
-
-            for (size_t i = 0; i < len; i++) {
-                buf[i] = m_queue[i];
-            }
-
+            read(buf, len);
             ret = len;
-
-            m_queue.erase(m_queue.begin(), m_queue.begin() + len);
-
-#if DEBUG_SAMPLE_QUEUE
-            fprintf(stdout, "after ok pop %zu (%zu)\n",
-                len / 4,
-                m_queue.size() / 4);
-#endif
         }
 
-        m_pop_notification.notify_all();
+        m_pop_event.notify();
         return ret;
     }
 
     void clear()
     {
-        {
-            std::lock_guard<std::mutex> lock(m_mutex);
-            m_queue.clear();
+        m_head.store(m_tail.load(std::memory_order_acquire),
+                std::memory_order_release);
 #if DEBUG_SAMPLE_QUEUE
-            fprintf(stdout, "clear\n");
+        fprintf(stdout, "clear\n");
 #endif
-        }
-        m_pop_notification.notify_all();
+        m_pop_event.notify();
     }
 
 private:
-    std::deque<T> m_queue;
-    mutable std::mutex m_mutex;
-    std::condition_variable m_push_notification;
-    std::condition_variable m_pop_notification;
+    /*! Producer side: copy len elements at the write index */
+    void write(const T *val, size_t len)
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        const size_t offset = tail & (m_capacity - 1);
+        const size_t first = std::min(len, m_capacity - offset);
 
-    unsigned int m_bytes_per_sample;
-    unsigned int m_channels = 2;
-    size_t m_max_size = 1;
-    bool m_push_block = true;
+        memcpy(m_buffer.get() + offset, val, first * sizeof(T));
+        memcpy(m_buffer.get(), val + first, (len - first) * sizeof(T));
+
+        m_tail.store(tail + len, std::memory_order_release);
+    }
+
+    /*! Consumer side: copy len elements from the read index */
+    void read(T *buf, size_t len)
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        const size_t offset = head & (m_capacity - 1);
+        const size_t first = std::min(len, m_capacity - offset);
+
+        memcpy(buf, m_buffer.get() + offset, first * sizeof(T));
+        memcpy(buf + first, m_buffer.get(), (len - first) * sizeof(T));
+
+        m_head.store(head + len, std::memory_order_release);
+    }
+
+    /*! Read index, only written by the consumer */
+    alignas(SAMPLE_QUEUE_CACHELINE_SIZE) std::atomic<size_t> m_head = ATOMIC_VAR_INIT(0);
+
+    /*! Write index, only written by the producer */
+    alignas(SAMPLE_QUEUE_CACHELINE_SIZE) std::atomic<size_t> m_tail = ATOMIC_VAR_INIT(0);
 
     /*! Counter to keep track of number of overruns between calls
      * to pop()
      */
-    size_t m_overruns = 0;
+    alignas(SAMPLE_QUEUE_CACHELINE_SIZE) std::atomic<size_t> m_overruns = ATOMIC_VAR_INIT(0);
+
+    /*! Number of elements the consumer waits for in pop_wait(), so that
+     * the producer only wakes it up once enough data is available
+     */
+    std::atomic<size_t> m_pop_wait_len = ATOMIC_VAR_INIT(0);
+
+    SampleQueueEvent m_push_event;
+    SampleQueueEvent m_pop_event;
+
+    std::unique_ptr<T[]> m_buffer;
+    size_t m_capacity = 0;
+
+    unsigned int m_bytes_per_sample;
+    unsigned int m_channels = 2;
+    size_t m_max_size = 1;
+    bool m_push_block = true;
 };
 
 #endif
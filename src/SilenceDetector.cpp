@@ -0,0 +1,179 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+
+#include "SilenceDetector.h"
+#include "common.h"
+#include "wavfile.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+using namespace std;
+
+SilenceDetector::SilenceDetector(unsigned int sample_rate, const silence_config_t& config) :
+    m_sample_rate(sample_rate),
+    m_config(config),
+    m_duration_frames(llround(config.duration * sample_rate)),
+    m_release_frames(llround(config.release * sample_rate))
+{
+}
+
+silence_event_t SilenceDetector::update(const audio_levels_t& levels, size_t num_frames)
+{
+    const double linear = m_config.use_rms ?
+        std::max(levels.rms_left, levels.rms_right) :
+        std::max(levels.peak_left, levels.peak_right) / 32768.0;
+    const double level_dBFS = linear > 0.0 ? 20.0 * log10(linear) : -INFINITY;
+
+    const double threshold = m_quiet ?
+        m_config.level_dBFS + m_config.hysteresis_dB :
+        m_config.level_dBFS;
+    m_quiet = level_dBFS < threshold;
+
+    if (m_quiet) {
+        m_quiet_frames += num_frames;
+        m_present_frames = 0;
+    }
+    else {
+        m_present_frames += num_frames;
+        m_quiet_frames = 0;
+    }
+
+    if (not m_active and m_quiet and m_quiet_frames >= m_duration_frames) {
+        m_active = true;
+        return silence_event_t::Started;
+    }
+    else if (m_active and not m_quiet and m_present_frames >= m_release_frames) {
+        m_active = false;
+        return silence_event_t::Ended;
+    }
+    return silence_event_t::None;
+}
+
+double SilenceDetector::quiet_duration() const
+{
+    return (double)m_quiet_frames / m_sample_rate;
+}
+
+FallbackWavAction::FallbackWavAction(const string& filename,
+        unsigned int sample_rate, unsigned int channels,
+        resampler_quality_t src_quality) :
+    m_filename(filename)
+{
+    void *wav = wav_read_open(filename.c_str());
+    if (wav == nullptr) {
+        throw runtime_error("Unable to open fallback wav file " + filename);
+    }
+
+    int format = 0;
+    int file_channels = 0;
+    int file_rate = 0;
+    int bits_per_sample = 0;
+    if (not wav_get_header(wav, &format, &file_channels, &file_rate,
+                &bits_per_sample, nullptr) or not wav_s16_supported(wav)) {
+        wav_read_close(wav);
+        throw runtime_error("Unsupported fallback wav file " + filename);
+    }
+
+    if ((unsigned int)file_channels != channels) {
+        wav_read_close(wav);
+        throw runtime_error("Fallback wav file " + filename + " has " +
+                to_string(file_channels) + " channels instead of " + to_string(channels));
+    }
+
+    vector<int16_t> samples;
+    int16_t chunk[4096];
+    int ret = 0;
+    while ((ret = wav_read_s16(wav, chunk, 4096)) > 0) {
+        samples.insert(samples.end(), chunk, chunk + ret);
+    }
+    wav_read_close(wav);
+
+    if (ret < 0) {
+        throw runtime_error("Error reading fallback wav file " + filename);
+    }
+
+    if ((unsigned int)file_rate != sample_rate) {
+        Resampler resampler(file_rate, sample_rate, channels, src_quality);
+        vector<int16_t> resampled;
+        resampler.process(samples.data(), samples.size() / channels, resampled);
+        samples.swap(resampled);
+    }
+
+    const size_t bytes_per_frame = channels * BYTES_PER_SAMPLE;
+    m_audio.resize(samples.size() / channels * bytes_per_frame);
+    if (m_audio.empty()) {
+        throw runtime_error("Fallback wav file " + filename + " is empty");
+    }
+    memcpy(m_audio.data(), samples.data(), m_audio.size());
+}
+
+void FallbackWavAction::process(uint8_t *buf, size_t len, bool active)
+{
+    if (not active) {
+        return;
+    }
+
+    size_t done = 0;
+    while (done < len) {
+        const size_t n = std::min(len - done, m_audio.size() - m_position);
+        memcpy(buf + done, m_audio.data() + m_position, n);
+        done += n;
+        m_position = (m_position + n) % m_audio.size();
+    }
+}
+
+string FallbackWavAction::name() const
+{
+    return "fallback file " + m_filename;
+}
+
+BackupInputAction::BackupInputAction(const string& description,
+        shared_ptr<InputInterface> input,
+        unique_ptr<SampleQueue<uint8_t> > queue) :
+    m_description(description),
+    m_queue(std::move(queue)),
+    m_input(input)
+{
+}
+
+void BackupInputAction::process(uint8_t *buf, size_t len, bool active)
+{
+    if (not m_input->read_source(len) or m_input->fault_detected()) {
+        if (active) {
+            memset(buf, 0, len);
+        }
+        return;
+    }
+
+    if (active) {
+        // pop() replaces what is missing by silence
+        m_queue->pop(buf, len);
+    }
+    else {
+        // Keep the queue current, so that the backup starts with recent audio
+        m_discard.resize(len);
+        m_queue->pop(m_discard.data(), len);
+    }
+}
+
+string BackupInputAction::name() const
+{
+    return "backup input " + m_description;
+}
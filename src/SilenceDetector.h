@@ -0,0 +1,155 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#include "GainStage.h"
+#include "InputInterface.h"
+#include "Resampler.h"
+#include "SampleQueue.h"
+
+/*! \file SilenceDetector.h
+ *
+ * Detection of silence or loss of signal on the input, and the actions
+ * taken while it lasts.
+ *
+ * The detector compares the peak or the RMS level of every block the
+ * GainStage measured against a threshold. Once the input is considered
+ * quiet, it must rise above the threshold plus the hysteresis to be
+ * considered present again, so that a level that hovers around the
+ * threshold does not toggle the state. Silence is declared after the
+ * input was quiet for the configured duration, and ends when the signal
+ * was present for the release time.
+ *
+ * While the silence lasts, a SilenceAction can replace the audio given
+ * to the encoder, which keeps running. The abort on silence (-s) uses
+ * the same detector.
+ */
+
+struct silence_config_t {
+    /*! Compare the RMS level instead of the peak level */
+    bool use_rms = false;
+
+    /*! The default only considers digital silence as quiet */
+    double level_dBFS = -96.0;
+    double hysteresis_dB = 3.0;
+
+    /*! Time the input must be quiet before silence is declared, and time
+     * the signal must be back before it ends, in seconds. */
+    double duration = 10.0;
+    double release = 1.0;
+};
+
+enum class silence_event_t {
+    None,
+    Started,
+    Ended,
+};
+
+class SilenceDetector {
+    public:
+        SilenceDetector(unsigned int sample_rate, const silence_config_t& config);
+
+        /*! Take into account the levels of a block of num_frames frames.
+         * \return whether the silence started or ended with this block */
+        silence_event_t update(const audio_levels_t& levels, size_t num_frames);
+
+        bool active() const { return m_active; }
+
+        /*! How long the input has been quiet without interruption, in
+         * seconds */
+        double quiet_duration() const;
+
+    private:
+        unsigned int m_sample_rate;
+        silence_config_t m_config;
+        uint64_t m_duration_frames;
+        uint64_t m_release_frames;
+
+        bool m_quiet = false;
+        bool m_active = false;
+        uint64_t m_quiet_frames = 0;
+        uint64_t m_present_frames = 0;
+};
+
+/*! What to do while the input is silent */
+class SilenceAction {
+    public:
+        virtual ~SilenceAction() {}
+
+        /*! Called for every block. If active, replace the len bytes in buf
+         * by the audio to encode instead of the input. Actions whose
+         * source runs all the time also consume it while inactive. */
+        virtual void process(uint8_t *buf, size_t len, bool active) = 0;
+
+        /*! Called when the silence starts and ends */
+        virtual void activate() {}
+        virtual void deactivate() {}
+
+        /*! Description for the log */
+        virtual std::string name() const = 0;
+};
+
+/*! Plays a wav file in a loop. The file is read into memory at startup,
+ * converted to 16-bit and resampled to the encoder rate if needed. It must
+ * have the number of channels of the encoder. */
+class FallbackWavAction : public SilenceAction {
+    public:
+        FallbackWavAction(const std::string& filename, unsigned int sample_rate,
+                unsigned int channels, resampler_quality_t src_quality);
+
+        virtual void process(uint8_t *buf, size_t len, bool active) override;
+
+        /*! Start the loop from the beginning every time */
+        virtual void activate() override { m_position = 0; }
+
+        virtual std::string name() const override;
+
+    private:
+        std::string m_filename;
+        std::vector<uint8_t> m_audio;
+        size_t m_position = 0;
+};
+
+/*! Switches to a second input. It runs all the time so that it is ready
+ * when it is needed, and fills its own queue from its own thread.
+ * Missing samples are replaced by silence. */
+class BackupInputAction : public SilenceAction {
+    public:
+        BackupInputAction(const std::string& description,
+                std::shared_ptr<InputInterface> input,
+                std::unique_ptr<SampleQueue<uint8_t> > queue);
+
+        virtual void process(uint8_t *buf, size_t len, bool active) override;
+
+        virtual std::string name() const override;
+
+    private:
+        std::string m_description;
+
+        /* The input pushes into the queue, and is destroyed first */
+        std::unique_ptr<SampleQueue<uint8_t> > m_queue;
+        std::shared_ptr<InputInterface> m_input;
+
+        /* Audio of the backup that is discarded while inactive */
+        std::vector<uint8_t> m_discard;
+};
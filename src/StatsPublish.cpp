@@ -19,10 +19,11 @@
 #include "config.h"
 #include "StatsPublish.h"
 #include <stdexcept>
-#include <sstream>
 #include <cstring>
 #include <cerrno>
 #include <cassert>
+#include <cmath>
+#include <algorithm>
 #include <sys/socket.h>
 #include <sys/un.h>
 #include <unistd.h>
@@ -70,48 +71,136 @@ StatsPublisher::~StatsPublisher()
     }
 }
 
-void StatsPublisher::update_audio_levels(int16_t audiolevel_left, int16_t audiolevel_right)
+void StatsPublisher::update_audio_levels(const audio_levels_t& levels)
 {
-    m_audio_left = audiolevel_left;
-    m_audio_right = audiolevel_right;
+    lock_guard<mutex> lock(m_mutex);
+    m_levels = levels;
+    m_rms_measured |= levels.rms_measured;
+    m_true_peak_measured |= levels.true_peak_measured;
+}
+
+/* Digital silence is shown at the level of the smallest 24-bit sample */
+static double to_dBFS(double linear)
+{
+    return 20.0 * log10(std::max(linear, 1.0 / (1 << 23)));
+}
+
+/* Loudness values that are not available are null */
+static void format_lufs(char *buf, size_t len, double lufs)
+{
+    if (std::isfinite(lufs)) {
+        snprintf(buf, len, "%.1f", lufs);
+    }
+    else {
+        snprintf(buf, len, "null");
+    }
+}
+
+void StatsPublisher::update_loudness(const loudness_t& loudness)
+{
+    lock_guard<mutex> lock(m_mutex);
+    m_loudness = loudness;
+    m_loudness_measured = true;
+}
+
+void StatsPublisher::update_silence(bool active, double quiet_seconds)
+{
+    lock_guard<mutex> lock(m_mutex);
+    m_silence_detection = true;
+    m_silence_active = active;
+    m_quiet_seconds = quiet_seconds;
 }
 
 void StatsPublisher::notify_underrun()
 {
+    lock_guard<mutex> lock(m_mutex);
     m_num_underruns++;
 }
 
 void StatsPublisher::notify_overrun()
 {
+    lock_guard<mutex> lock(m_mutex);
     m_num_overruns++;
 }
 
+void StatsPublisher::update_drift(double drift_ppm)
+{
+    lock_guard<mutex> lock(m_mutex);
+    m_drift_ppm = drift_ppm;
+}
+
 void StatsPublisher::send_stats()
 {
     // Manually build JSON. We can be certain that
-    // our fields don't contain quotes
-    stringstream json;
-    json << "{ ";
-    json << "\"program\": \"" << PACKAGE_NAME << "\", ";
-    json << "\"version\": \"" <<
+    // our fields don't contain quotes. This is called for every frame, so
+    // it is formatted into a fixed buffer instead of allocating.
+    char json[1024];
+    unique_lock<mutex> lock(m_mutex);
+
+    char rms[96] = "";
+    if (m_rms_measured) {
+        snprintf(rms, sizeof(rms), ", \"rms_left\": %.1f, \"rms_right\": %.1f",
+                to_dBFS(m_levels.rms_left), to_dBFS(m_levels.rms_right));
+    }
+
+    char true_peak[96] = "";
+    if (m_true_peak_measured) {
+        snprintf(true_peak, sizeof(true_peak),
+                ", \"truepeak_left\": %.1f, \"truepeak_right\": %.1f",
+                to_dBFS(m_levels.true_peak_left), to_dBFS(m_levels.true_peak_right));
+    }
+
+    char loudness[128] = "";
+    if (m_loudness_measured) {
+        char momentary[16];
+        char short_term[16];
+        char integrated[16];
+        format_lufs(momentary, sizeof(momentary), m_loudness.momentary);
+        format_lufs(short_term, sizeof(short_term), m_loudness.short_term);
+        format_lufs(integrated, sizeof(integrated), m_loudness.integrated);
+        snprintf(loudness, sizeof(loudness),
+                "\"loudness\": { \"momentary\": %s, \"shortterm\": %s, \"integrated\": %s}, ",
+                momentary, short_term, integrated);
+    }
+
+    char silence[64] = "";
+    if (m_silence_detection) {
+        snprintf(silence, sizeof(silence),
+                "\"silence\": { \"active\": %s, \"quiet\": %.1f}, ",
+                m_silence_active ? "true" : "false", m_quiet_seconds);
+    }
+
+    const int json_len = snprintf(json, sizeof(json),
+            "{ "
+            "\"program\": \"%s\", "
+            "\"version\": \"%s\", "
+            "\"audiolevels\": { \"left\": %d, \"right\": %d%s%s}, "
+            "%s%s"
+            "\"driftcompensation\": { \"underruns\": %zu, \"overruns\": %zu, "
+            "\"drift_ppm\": %.2f} "
+            "}",
+            PACKAGE_NAME,
 #if defined(GITVERSION)
-            GITVERSION
+            GITVERSION,
 #else
-            PACKAGE_VERSION
+            PACKAGE_VERSION,
 #endif
-        << "\", ";
-    json << "\"audiolevels\": { \"left\": " << m_audio_left << ", \"right\": " << m_audio_right << "}, ";
-    json << "\"driftcompensation\": { \"underruns\": " << m_num_underruns << ", \"overruns\": " << m_num_overruns << "} ";
-    json << "}";
+            m_levels.peak_left, m_levels.peak_right, rms, true_peak, loudness, silence,
+            m_num_underruns, m_num_overruns, m_drift_ppm);
 
-    const auto jsonstr = json.str();
+    if (json_len < 0 or (size_t)json_len >= sizeof(json)) {
+        throw logic_error("Statistics JSON too long");
+    }
+
+    m_levels = audio_levels_t();
+    lock.unlock();
 
     struct sockaddr_un claddr;
     memset(&claddr, 0, sizeof(struct sockaddr_un));
     claddr.sun_family = AF_UNIX;
     snprintf(claddr.sun_path, sizeof(claddr.sun_path), "%s", m_socket_path.c_str());
 
-    int ret = ::sendto(m_sock, jsonstr.data(), jsonstr.size(), 0,
+    int ret = ::sendto(m_sock, json, json_len, 0,
             (struct sockaddr *) &claddr, sizeof(struct sockaddr_un));
     if (ret == -1) {
         // This suppresses the -Wlogical-op warning
@@ -130,15 +219,12 @@ void StatsPublisher::send_stats()
             fprintf(stderr, "Statistics send failed: %s\n", strerror(errno));
         }
     }
-    else if (ret != (ssize_t)jsonstr.size()) {
-        fprintf(stderr, "Statistics send incorrect length: %d bytes of %zu transmitted\n",
-                ret, jsonstr.size());
+    else if (ret != json_len) {
+        fprintf(stderr, "Statistics send incorrect length: %d bytes of %d transmitted\n",
+                ret, json_len);
     }
     else if (not m_destination_available) {
         fprintf(stderr, "Stats destination is now available at %s\n", m_socket_path.c_str());
         m_destination_available = true;
     }
-
-    m_audio_left = 0;
-    m_audio_right = 0;
 }
@@ -21,15 +21,22 @@
 #include <cstdint>
 #include <cstddef>
 #include <cstdio>
+#include <mutex>
+#include "GainStage.h"
+#include "LoudnessMeter.h"
 
 /*! \file StatsPublish.h
  *
  * Collects and sends some stats to a UNIX DGRAM socket so that an external tool
  * like ODR-EncoderManager can display it.
  *
- * Currently, only audio levels are collected.
+ * Audio levels, loudness, the state of the silence detector and of the
+ * drift compensation are collected.
  *
  * Output is formatted in JSON
+ *
+ * The update and notify functions may be called from another thread
+ * than send_stats().
  */
 class StatsPublisher {
     public:
@@ -38,8 +45,16 @@ class StatsPublisher {
         StatsPublisher& operator=(const StatsPublisher& other) = delete;
         ~StatsPublisher();
 
-        /*! Update peak audio level information */
-        void update_audio_levels(int16_t audiolevel_left, int16_t audiolevel_right);
+        /*! Update audio level information. The RMS and true peak levels
+         * are sent, in dBFS, once they have been measured. */
+        void update_audio_levels(const audio_levels_t& levels);
+
+        /*! Update the loudness, which is sent once it has been set */
+        void update_loudness(const loudness_t& loudness);
+
+        /*! Update the state of the silence detector, which is sent once it
+         * has been set. quiet_seconds is the time the input has been quiet. */
+        void update_silence(bool active, double quiet_seconds);
 
         /*! Increments the underrun counter */
         void notify_underrun();
@@ -47,6 +62,9 @@ class StatsPublisher {
         /*! Increments the overrun counter */
         void notify_overrun();
 
+        /*! Update the clock drift measured by the drift compensation */
+        void update_drift(double drift_ppm);
+
         /*! Send the collected stats to the socket, doesn't block. If the socket is
          * not connected, the data is lost.
          *
@@ -57,12 +75,25 @@ class StatsPublisher {
         std::string m_socket_path;
         int m_sock = -1;
 
-        int16_t m_audio_left = 0;
-        int16_t m_audio_right = 0;
+        /* Protects the collected stats below */
+        std::mutex m_mutex;
+
+        audio_levels_t m_levels;
+        bool m_rms_measured = false;
+        bool m_true_peak_measured = false;
+
+        bool m_loudness_measured = false;
+        loudness_t m_loudness;
+
+        bool m_silence_detection = false;
+        bool m_silence_active = false;
+        double m_quiet_seconds = 0.0;
 
         size_t m_num_underruns = 0;
         size_t m_num_overruns = 0;
 
+        double m_drift_ppm = 0.0;
+
         bool m_destination_available = true;
 };
 
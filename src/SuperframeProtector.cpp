@@ -0,0 +1,41 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+
+#include "SuperframeProtector.h"
+#include <stdexcept>
+#include <string>
+
+SuperframeProtector::SuperframeProtector(int subchannel_index) :
+    m_subchannel_index(subchannel_index)
+{
+    if (subchannel_index < 1 or subchannel_index > 24) {
+        throw std::invalid_argument("Invalid DAB+ subchannel index " +
+                std::to_string(subchannel_index));
+    }
+}
+
+void SuperframeProtector::protect(uint8_t *superframe, size_t len)
+{
+    if (len < superframe_size()) {
+        throw std::logic_error("Superframe buffer too small: " +
+                std::to_string(len) + " < " + std::to_string(superframe_size()));
+    }
+
+    m_rs.encodeInterleaved(superframe, superframe + data_size(),
+            m_subchannel_index);
+}
@@ -0,0 +1,63 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include "ReedSolomon.h"
+
+/*! \file SuperframeProtector.h
+ *
+ * Reed-Solomon protection of a DAB+ superframe, as specified in
+ * ETSI TS 102 563 Clause 6.
+ *
+ * The superframe of 110 * s bytes, with s = bitrate/8 the subchannel
+ * index, is read as s rows of 110 bytes in virtual interleaving:
+ * byte col of row r is at offset s * col + r. Each row gets 10 bytes of
+ * RS(120, 110) parity, appended in the same interleaved layout.
+ *
+ * Because the superframe is already byte-interleaved, all rows are
+ * encoded in one batched pass directly in the superframe buffer,
+ * without transposing to a row-major scratch buffer and back.
+ */
+class SuperframeProtector {
+    public:
+        /*! \param subchannel_index s = bitrate/8, between 1 and 24 */
+        SuperframeProtector(int subchannel_index);
+        SuperframeProtector(const SuperframeProtector& other) = delete;
+        SuperframeProtector& operator=(const SuperframeProtector& other) = delete;
+
+        /*! Size of the protected superframe, including parity */
+        size_t superframe_size() const { return 120 * m_subchannel_index; }
+
+        /*! Size of the audio super frame the encoder has to fill */
+        size_t data_size() const { return 110 * m_subchannel_index; }
+
+        /*! Compute and write the parity of all RS rows.
+         *
+         * \param superframe buffer of at least superframe_size() bytes,
+         *        whose first data_size() bytes contain the audio super frame.
+         */
+        void protect(uint8_t *superframe, size_t len);
+
+    private:
+        const size_t m_subchannel_index;
+
+        /* gfpoly=0x11d, fcr=0, prim=1, i.e. nroots=10, pad=135 */
+        ReedSolomon m_rs{120, 110};
+};
@@ -70,10 +70,15 @@ extern "C" {
 
 #include <algorithm>
 #include <vector>
-#include <deque>
 #include <chrono>
 #include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include <fstream>
 #include <string>
+#include <cctype>
 #include <getopt.h>
 #include <cstdio>
 #include <stdint.h>
@@ -85,9 +90,18 @@ extern "C" {
 #include <fcntl.h>
 
 #include "aacenc_lib.h"
+#include "SuperframeProtector.h"
+#include "Layer2Reframer.h"
+#include "Pipeline.h"
+#include "OfflineEncoder.h"
+#include "Resampler.h"
+#include "DriftCompensator.h"
+#include "RealtimePacer.h"
+#include "GainStage.h"
+#include "SilenceDetector.h"
+#include "LoudnessMeter.h"
 
 extern "C" {
-#include "fec/fec.h"
 #include "libtoolame-dab/toolame.h"
 }
 
@@ -112,14 +126,15 @@ static void usage(const char* name)
     "would drift off slowly. ODR-DabMux cannot handle such drift\n"
     "because it would have to throw away or insert complete encoded audio frames,\n"
     "which would create audible artifacts. This drift compensation can\n"
-    "make sure that the encoding rate is correct by inserting or deleting\n"
-    "audio samples. It can be used for both ALSA and VLC inputs and requires\n"
-    "a system clock synchronised using NTP.\n"
+    "make sure that the encoding rate is correct by resampling the audio\n"
+    "by a ratio that follows the drift. It can be used for both ALSA and VLC\n"
+    "inputs and requires a system clock synchronised using NTP. It adds a\n"
+    "latency of four encoder frames, and the measured drift is sent with\n"
+    "the statistics.\n"
     "\n"
     "When this option is enabled, you will see U and O printed in the\n"
-    "console. These correspond to audio underruns and overruns caused\n"
-    "by sound card clock drift. When sparse, they should not create audible\n"
-    "artifacts.\n"
+    "console. These correspond to audio underruns and overruns, that only\n"
+    "happen if the source stops or the drift exceeds 5000ppm.\n"
     "\n"
     "This encoder is able to insert PAD (DLS and MOT Slideshow)\n"
     "generated by ODR-PadEnc, and communicates using a UNIX socket.\n"
@@ -141,6 +156,8 @@ static void usage(const char* name)
     "   For the file input:\n"
     "     -i, --input=FILENAME                 Input filename (use -i - for stdin).\n"
     "     -f, --format={ wav, raw }            Set input file format (default: wav).\n"
+    "                                          wav files can be 16, 24 or 32-bit PCM or float, and RF64.\n"
+    "                                          raw files must be 16-bit PCM.\n"
     "         --fifo-silence                   Input file is fifo and encoder generates silence when fifo is empty. Ignore EOF.\n"
     "   For the JACK input:\n"
 #if HAVE_JACK
@@ -172,10 +189,21 @@ static void usage(const char* name)
     "     -W, --write-icy-text-dl-plus         When writing the ICY Text into the file, add DL Plus information.\n"
     "   Drift compensation\n"
     "     -D, --drift-comp                     Enable ALSA/VLC sound card drift compensation.\n"
+    "                                          The encoder is paced on CLOCK_MONOTONIC, or on CLOCK_TAI with --timestamp-delay.\n"
+    "         --realtime-priority=PRIO         Run the capture thread with SCHED_FIFO at this priority (1-99).\n"
+    "         --cpu-affinity=LIST              Run the capture thread on these CPUs only, e.g. 2 or 0,2-3.\n"
     "   Encoder parameters:\n"
     "     -b, --bitrate={ 8, 16, ..., 192 }    Output bitrate in kbps. Must be a multiple of 8.\n"
     "     -c, --channels={ 1, 2 }              Nb of input channels (default: 2).\n"
-    "     -r, --rate={ 24000, 32000, 48000 }   Input sample rate (default: 48000).\n"
+    "     -r, --rate={ 24000, 32000, 48000 }   Encoder sample rate (default: 48000).\n"
+    "                                          The file, JACK and ALSA inputs resample sources at other rates.\n"
+    "         --src-quality={ fast, medium, best }\n"
+    "                                          Quality of that resampler and of the drift compensation\n"
+    "                                          (default: medium).\n"
+    "                                          fast:   70dB stopband, passband to 40%% of the lower rate.\n"
+    "                                          medium: 96dB stopband, passband to 43%% of the lower rate.\n"
+    "                                          best:   120dB stopband, passband to 45.5%% of the lower rate.\n"
+    "                                          The delay is 0.5-1ms, 1-2ms and 2-4ms respectively.\n"
     "     -g, --audio-gain=dB                  Apply audio gain correction in dB to source, negative values allowed.\n"
     "                                          Use this as a workaround to correct the gain for streams that are\n"
     "                                          much too loud.\n"
@@ -191,6 +219,26 @@ static void usage(const char* name)
     "         --sbr                            Force the usage of SBR (HE-AAC)\n"
     "         --ps                             Force the usage of SBR and PS (HE-AACv2)\n"
     "     -B, --bandwidth=VALUE                Set the AAC encoder bandwidth to VALUE [Hz].\n"
+    "         --parallel-channels              Run the per-channel analysis of a stereo encode in two threads.\n"
+    "                                          The output is unchanged. Off by default: this only helps with two\n"
+    "                                          or more CPUs, measure the gain with bench/psy_bench before using it.\n"
+    "         --scf-cache                      Let the afterburner start from the scale factors of the previous\n"
+    "                                          frame. The output changes slightly. AAC-LC only, it is ignored with\n"
+    "                                          SBR and PS, where it costs as much CPU as it saves. Saves 1 to 8%%\n"
+    "                                          of the encode time at 96 kbps and 7 to 20%% at 128 kbps, for a segSNR\n"
+    "                                          up to 0.3 dB lower at 96 kbps and 0.7 dB lower at 128 kbps. Measure\n"
+    "                                          it on your material with bench/scf_cache_bench.\n"
+    "         --complexity=LEVEL               Reduce the CPU load of the AAC encoder at the expense of quality.\n"
+    "                                          Each level includes the ones below. Encode time and segSNR against\n"
+    "                                          level 0, at 96 kbps AAC-LC:\n"
+    "                                          0: full complexity (default).\n"
+    "                                          1: no last afterburner assimilation pass, long-block TNS order 8,\n"
+    "                                             tonality only in PNS bands: -14 to -21%% time, +-0.2 dB.\n"
+    "                                          2: the afterburner only refines single bands: -15 to -30%% time,\n"
+    "                                             -1.1 to 0 dB.\n"
+    "                                          3: no PNS and no spectral flatness weighting, long-block TNS\n"
+    "                                             order 4: -26 to -45%% time, -1.7 to +1.2 dB.\n"
+    "                                          With HE-AAC, the time saved is about half. See README.md.\n"
     "         --decode=FILE                    Decode the AAC back to a wav file (loopback test).\n"
     "   Output and PAD parameters:\n"
     "         --identifier=ID                  An identifier string that is sent in the ODRv EDI TAG. Max 32 characters length.\n"
@@ -202,6 +250,8 @@ static void usage(const char* name)
     "     -e, --edi=URI                        EDI output uri, (e.g. 'tcp://localhost:7000')\n"
     "         --fec=FEC                        Set EDI output FEC\n"
     "         --edi-verbose                    Enable verbose mode for EDI output.\n"
+    "         --edi-gso                        Let the kernel segment EDI fragments that are sent together (UDP GSO).\n"
+    "         --edi-txtime                     Let the kernel pace EDI fragments (SO_TXTIME), requires the fq qdisc.\n"
     "     -T, --timestamp-delay=DELAY_MS       Enabled timestamps in EDI (requires TAI clock bulletin download) and\n"
     "                                          add a delay (in milliseconds) to the timestamps carried in EDI\n"
     "         --startup-check=SCRIPT_PATH      Before starting, run the given script, and only start if it returns 0.\n"
@@ -209,16 +259,51 @@ static void usage(const char* name)
     "     -p, --pad=BYTES                      Enable PAD insertion and set PAD size in bytes.\n"
     "     -P, --pad-socket=IDENTIFIER          Use the given identifier to communicate with ODR-PadEnc.\n"
     "     -l, --level                          Show peak audio level indication.\n"
+    "         --level-rms                      Also measure the RMS level of each channel, sent in the stats.\n"
+    "         --level-true-peak                Measure the 4x oversampled true peak (ITU-R BS.1770) instead\n"
+    "                                          of the sample peak, for the level indication, the stats and\n"
+    "                                          the levels sent in the ZMQ and EDI outputs.\n"
+    "         --loudness                       Measure the momentary, short-term and integrated loudness\n"
+    "                                          (ITU-R BS.1770, in LUFS), sent in the stats and in the EDI output.\n"
     "     -S, --stats=SOCKET_NAME              Connect to the specified UNIX Datagram socket and send statistics.\n"
     "                                          This allows external tools to collect audio and drift compensation stats.\n"
     "     -s, --silence=TIMEOUT                Abort encoding after TIMEOUT seconds of silence.\n"
+    "         --silence-level=DBFS             Level below which the input is quiet (default: -96, digital silence).\n"
+    "         --silence-rms                    Compare the RMS level instead of the peak level.\n"
+    "         --silence-hysteresis=DB          A quiet input must rise this much above the level to be present\n"
+    "                                          again (default: 3).\n"
+    "         --silence-after=SECONDS          Declare silence after the input is quiet for SECONDS, log it and\n"
+    "                                          send it in the stats, and replace the input by the backup below.\n"
+    "         --silence-release=SECONDS        End the silence once the input is present for SECONDS (default: 1).\n"
+    "         --silence-backup=SOURCE          Encode this source during silence: alsa:DEVICE, jack:NAME,\n"
+    "                                          vlc:URI, gst:URI or file:FILENAME. It runs all the time.\n"
+    "         --silence-fallback=FILE          Encode this wav file in a loop during silence.\n"
+    "         --pipeline-depth=N               Number of frames each stage of the capture, encode and output\n"
+    "                                          pipeline can hold (default: 2). Bounds the added latency.\n"
+    "         --latency-stats                  Print the latency histograms of the pipeline stages, and with\n"
+    "                                          drift compensation of the late wakeups of the pacing, at exit.\n"
+    "   Faster than real-time encoding of files:\n"
+    "         --jobs=N                         Encode the input file in segments of 30 seconds on N threads.\n"
+    "                                          Requires a seekable wav or raw input file at the encoder rate and\n"
+    "                                          a file output, and cannot be combined with PAD, EDI, drift\n"
+    "                                          compensation, --decode, --silence or --stats. DAB output is\n"
+    "                                          identical to a sequential encode, and also contains the last\n"
+    "                                          frames. DAB+ output is a valid stream, but differs from a\n"
+    "                                          sequential encode after each seam, because the rate control of\n"
+    "                                          each segment starts afresh. The SNR against the input stays within\n"
+    "                                          0.7 dB of a sequential encode in the 40 ms after a seam, and within\n"
+    "                                          0.3 dB elsewhere.\n"
+    "   Multiple services in one process:\n"
+    "         --services=FILE                  Encode all services listed in FILE. Each line contains the options\n"
+    "                                          of one service, as they would be given on the command line.\n"
+    "                                          Empty lines and lines starting with # are ignored.\n"
     "         --version                        Show version and quit.\n"
     "\n"
     );
 
 }
 
-/*! Setup the FDK AAC encoder
+/*! Setup the FDK AAC encoder. If verbose is false, only errors are printed.
  *
  * \return 0 on success
  */
@@ -228,8 +313,12 @@ static int prepare_aac_encoder(
         int channels,
         int sample_rate,
         int afterburner,
+        bool parallel_channels,
+        bool scf_cache,
+        int complexity,
         uint32_t bandwidth,
-        int *aot)
+        int *aot,
+        bool verbose)
 {
     CHANNEL_MODE mode;
     switch (channels) {
@@ -260,12 +349,14 @@ static int prepare_aac_encoder(
         }
     }
 
-    fprintf(stderr, "Using %d subchannels. AAC type: %s%s%s. channels=%d, sample_rate=%d\n",
-            subchannel_index,
-            *aot == AOT_DABPLUS_PS ? "HE-AAC v2" : "",
-            *aot == AOT_DABPLUS_SBR ? "HE-AAC" : "",
-            *aot == AOT_DABPLUS_AAC_LC ? "AAC-LC" : "",
-            channels, sample_rate);
+    if (verbose) {
+        fprintf(stderr, "Using %d subchannels. AAC type: %s%s%s. channels=%d, sample_rate=%d\n",
+                subchannel_index,
+                *aot == AOT_DABPLUS_PS ? "HE-AAC v2" : "",
+                *aot == AOT_DABPLUS_SBR ? "HE-AAC" : "",
+                *aot == AOT_DABPLUS_AAC_LC ? "AAC-LC" : "",
+                channels, sample_rate);
+    }
 
     if (aacEncoder_SetParam(*encoder, AACENC_AOT, *aot) != AACENC_OK) {
         fprintf(stderr, "Unable to set the AOT\n");
@@ -299,7 +390,9 @@ static int prepare_aac_encoder(
     }*/
 
 
-    fprintf(stderr, "AAC bitrate set to: %d\n", subchannel_index*8000);
+    if (verbose) {
+        fprintf(stderr, "AAC bitrate set to: %d\n", subchannel_index*8000);
+    }
     if (aacEncoder_SetParam(*encoder, AACENC_BITRATE, subchannel_index*8000) != AACENC_OK) {
         fprintf(stderr, "Unable to set the bitrate\n");
         return 1;
@@ -308,12 +401,26 @@ static int prepare_aac_encoder(
         fprintf(stderr, "Unable to set the afterburner mode\n");
         return 1;
     }
-    if (!afterburner) {
+    if (!afterburner and verbose) {
         fprintf(stderr, "Warning: Afterburned disabled!\n");
     }
+    if (aacEncoder_SetParam(*encoder, AACENC_PARALLEL_PSY, parallel_channels ? 1 : 0) != AACENC_OK) {
+        fprintf(stderr, "Unable to set the parallel channel processing\n");
+        return 1;
+    }
+    if (aacEncoder_SetParam(*encoder, AACENC_SCF_CACHE, scf_cache ? 1 : 0) != AACENC_OK) {
+        fprintf(stderr, "Unable to set the scale factor cache\n");
+        return 1;
+    }
+    if (aacEncoder_SetParam(*encoder, AACENC_COMPLEXITY, complexity) != AACENC_OK) {
+        fprintf(stderr, "Unable to set the encoder complexity\n");
+        return 1;
+    }
 
     if (bandwidth > 0) {
-        fprintf(stderr, "Setting bandwidth is %d\n", bandwidth);
+        if (verbose) {
+            fprintf(stderr, "Setting bandwidth is %d\n", bandwidth);
+        }
         if (aacEncoder_SetParam(*encoder, AACENC_BANDWIDTH, bandwidth) != AACENC_OK) {
             fprintf(stderr, "Unable to set bandwidth mode\n");
             return 1;
@@ -324,87 +431,338 @@ static int prepare_aac_encoder(
         return 1;
     }
 
-    const uint32_t bw = aacEncoder_GetParam(*encoder, AACENC_BANDWIDTH);
-    fprintf(stderr, "Bandwidth is %d\n", bw);
+    if (verbose) {
+        const uint32_t bw = aacEncoder_GetParam(*encoder, AACENC_BANDWIDTH);
+        fprintf(stderr, "Bandwidth is %d\n", bw);
+    }
 
     return 0;
 }
 
-chrono::steady_clock::time_point timepoint_last_compensation;
-
-/*! Do drift compensation by distributing the missing samples over
- *  the whole input buffer instead of having a bunch of missing samples
- *  at the end only.
+/*! Setup the libtoolame-dab encoder
  *
- *  This expands (in time) the received samples over the whole duration
- *  of the buffer.
+ * \return 0 on success
  */
-static void expand_missing_samples(vec_u8& buf, int channels, size_t valid_bytes)
+static int prepare_toolame_encoder(
+        toolame_context_t **toolame,
+        int sample_rate,
+        int psy_model,
+        char channel_mode,
+        int bitrate,
+        int padlen)
 {
-    const size_t bytes_per_sample = BYTES_PER_SAMPLE * channels;
-    assert(buf.size() % bytes_per_sample == 0);
-    assert(buf.size() > valid_bytes);
-    const size_t valid_samples = valid_bytes / bytes_per_sample;
-    const size_t missing_samples =
-        (buf.size() / bytes_per_sample) - valid_samples;
+    *toolame = toolame_create();
+    if (*toolame == nullptr) {
+        fprintf(stderr, "libtoolame-dab init failed\n");
+        return 1;
+    }
 
-    // We only fix up to 10% missing samples
-    if (missing_samples * bytes_per_sample > buf.size() / 10) {
-        for (size_t i = valid_samples * bytes_per_sample; i < buf.size(); i++) {
-            buf[i] = 0;
-        }
+    int err = 0;
+
+    if (err == 0) {
+        err = toolame_set_samplerate(*toolame, sample_rate);
     }
-    else {
-        const vec_u8 source_buf(buf);
-        size_t source_ix = 0;
 
-        for (size_t i = 0; i < buf.size() / bytes_per_sample; i++) {
-            for (size_t j = 0; j < bytes_per_sample; j++) {
-                buf.at(bytes_per_sample*i + j) = source_buf.at(source_ix + j);
+    if (err == 0) {
+        err = toolame_set_psy_model(*toolame, psy_model);
+    }
+
+    if (err == 0) {
+        err = toolame_set_channel_mode(*toolame, channel_mode);
+    }
+
+    // setting the ScF-CRC len here depends on set sample rate/channel mode
+    if (err == 0) {
+        err = toolame_set_bitrate(*toolame, bitrate);
+    }
+
+    if (err == 0) {
+        err = toolame_set_pad(*toolame, padlen);
+    }
+
+    if (err) {
+        fprintf(stderr, "libtoolame-dab init failed: %d\n", err);
+    }
+    return err;
+}
+
+/*! Encodes a segment of the input with the FDK AAC encoder, for the
+ * OfflineEncoder. Every call to encode() takes one AAC frame. */
+class FDKSegmentEncoder : public SegmentEncoder {
+    public:
+        FDKSegmentEncoder(int subchannel_index, int channels, int sample_rate,
+                int afterburner, bool scf_cache, int complexity,
+                uint32_t bandwidth, int aot, double gain_dB) :
+            m_protector(subchannel_index),
+            m_outbuf(24*120),
+            m_gain_stage(channels, gain_dB, false, false)
+        {
+            if (prepare_aac_encoder(&m_encoder, subchannel_index, channels,
+                        sample_rate, afterburner, false, scf_cache, complexity,
+                        bandwidth, &aot, false) != 0) {
+                if (m_encoder) {
+                    aacEncClose(&m_encoder);
+                }
+                throw runtime_error("Encoder preparation failed");
+            }
+        }
+
+        FDKSegmentEncoder(const FDKSegmentEncoder&) = delete;
+        FDKSegmentEncoder& operator=(const FDKSegmentEncoder&) = delete;
+
+        virtual ~FDKSegmentEncoder() {
+            aacEncClose(&m_encoder);
+        }
+
+        virtual void encode(uint8_t *audio, size_t len, vec_u8& out) override {
+            audio_levels_t levels;
+            m_gain_stage.process(audio, len, levels);
+
+            AACENC_BufDesc in_buf = { 0 }, out_buf = { 0 };
+            AACENC_InArgs in_args = { 0 };
+            AACENC_OutArgs out_args = { 0 };
+
+            int in_identifier = IN_AUDIO_DATA;
+            int out_identifier = OUT_BITSTREAM_DATA;
+            void *in_ptr = audio;
+            void *out_ptr = m_outbuf.data();
+            int in_size = len;
+            int in_elem_size = BYTES_PER_SAMPLE;
+            int out_size = m_outbuf.size();
+            int out_elem_size = 1;
+
+            in_args.numInSamples = len/BYTES_PER_SAMPLE;
+            in_buf.numBufs = 1;
+            in_buf.bufs = &in_ptr;
+            in_buf.bufferIdentifiers = &in_identifier;
+            in_buf.bufSizes = &in_size;
+            in_buf.bufElSizes = &in_elem_size;
+
+            out_buf.numBufs = 1;
+            out_buf.bufs = &out_ptr;
+            out_buf.bufferIdentifiers = &out_identifier;
+            out_buf.bufSizes = &out_size;
+            out_buf.bufElSizes = &out_elem_size;
+
+            std::fill(m_outbuf.begin(), m_outbuf.end(), 0);
+
+            AACENC_ERROR err = aacEncEncode(m_encoder, &in_buf, &out_buf, &in_args, &out_args);
+            if (err != AACENC_OK) {
+                throw runtime_error("Encoding failed (" + to_string(err) + ")");
             }
 
-            // Do not advance the source index if the sample index is
-            // at the spots where we want to duplicate the source sample
-            if (not (i > 0 and (i % (valid_samples / missing_samples) == 0))) {
-                source_ix += bytes_per_sample;
+            if (out_args.numOutBytes > 0) {
+                m_protector.protect(m_outbuf.data(), m_outbuf.size());
+                out.insert(out.end(), m_outbuf.begin(),
+                        m_outbuf.begin() + m_protector.superframe_size());
             }
         }
-    }
-}
 
-/*! Wait the proper amount of time to throttle down to nominal encoding
- * rate, if drift compensation is enabled.
- */
-static void drift_compensation_delay(int sample_rate, int channels, size_t bytes)
-{
-    const size_t bytes_per_second = sample_rate * BYTES_PER_SAMPLE * channels;
+        /* Like the live encoder, the audio still in the encoder at the
+         * end of the input is not flushed */
+        virtual void finish(vec_u8&) override { }
+
+    private:
+        HANDLE_AACENCODER m_encoder = nullptr;
+        SuperframeProtector m_protector;
+        vec_u8 m_outbuf;
+        GainStage m_gain_stage;
+};
 
-    size_t bytes_compensate = bytes;
-    const auto wait_time = std::chrono::milliseconds(1000ul * bytes_compensate / bytes_per_second);
-    assert(1000ul * bytes_compensate % bytes_per_second == 0);
+/*! Encodes a segment of the input with libtoolame-dab, for the
+ * OfflineEncoder. Every call to encode() takes one MPEG frame. */
+class ToolameSegmentEncoder : public SegmentEncoder {
+    public:
+        ToolameSegmentEncoder(int sample_rate, int channels, int psy_model,
+                char channel_mode, int bitrate,
+                double gain_dB) :
+            m_channels(channels),
+            m_outbuf(4092),
+            m_gain_stage(channels, gain_dB, false, false)
+        {
+            if (prepare_toolame_encoder(&m_toolame, sample_rate, psy_model,
+                        channel_mode, bitrate, 0) != 0) {
+                toolame_destroy(m_toolame);
+                throw runtime_error("libtoolame-dab init failed");
+            }
+        }
 
-    const auto curTime = std::chrono::steady_clock::now();
+        ToolameSegmentEncoder(const ToolameSegmentEncoder&) = delete;
+        ToolameSegmentEncoder& operator=(const ToolameSegmentEncoder&) = delete;
 
-    const auto diff = curTime - timepoint_last_compensation;
+        virtual ~ToolameSegmentEncoder() {
+            toolame_destroy(m_toolame);
+        }
 
-    if (diff < wait_time) {
-        auto waiting = wait_time - diff;
-        std::this_thread::sleep_for(waiting);
-    }
+        virtual void encode(uint8_t *audio, size_t len, vec_u8& out) override {
+            audio_levels_t levels;
+            m_gain_stage.process(audio, len, levels);
 
-    timepoint_last_compensation += wait_time;
-}
+            short input_buffers[2][1152];
+            if (m_channels == 1) {
+                memcpy(input_buffers[0], audio, 1152 * BYTES_PER_SAMPLE);
+            }
+            else {
+                for (int i = 0; i < 1152; i++) {
+                    input_buffers[0][i] = audio[4*i]   | (audio[4*i+1] << 8);
+                    input_buffers[1][i] = audio[4*i+2] | (audio[4*i+3] << 8);
+                }
+            }
+
+            const int numOutBytes = toolame_encode_frame(m_toolame, input_buffers,
+                    nullptr, 0, m_outbuf.data(), m_outbuf.size());
+            if (numOutBytes < 0) {
+                throw runtime_error("libtoolame-dab encoding failed");
+            }
+            out.insert(out.end(), m_outbuf.begin(), m_outbuf.begin() + numOutBytes);
+        }
 
+        virtual void finish(vec_u8& out) override {
+            const int numOutBytes = toolame_finish(m_toolame, m_outbuf.data(), m_outbuf.size());
+            if (numOutBytes > 0) {
+                out.insert(out.end(), m_outbuf.begin(), m_outbuf.begin() + numOutBytes);
+            }
+        }
 
+    private:
+        int m_channels;
+        toolame_context_t *m_toolame = nullptr;
+        vec_u8 m_outbuf;
+        GainStage m_gain_stage;
+};
 
 #define no_argument 0
 #define required_argument 1
 #define optional_argument 2
 
+/* Queue fill level the drift compensation aims for, in encoder calls */
+#define DRIFT_COMPENSATION_TARGET_CALLS 4
+
 #define STATUS_PAD_INSERTED 0x1
 #define STATUS_OVERRUN 0x2
 #define STATUS_UNDERRUN 0x4
 
+/*! Audio read by the capture stage, with the PAD to insert along it */
+struct CapturedFrame {
+    vec_u8 audio;
+    ssize_t read_bytes = 0;
+    vec_u8 pad;
+    int calculated_padlen = 0;
+
+    /* See the above STATUS macros */
+    int status = 0;
+    int16_t peak_left = 0;
+    int16_t peak_right = 0;
+    loudness_t loudness;
+
+    chrono::steady_clock::time_point captured;
+};
+
+/*! Output of the encode stage: num_frames frames of frame_len bytes each,
+ * ready to be sent. */
+struct EncodedFrame {
+    vec_u8 data;
+    size_t num_frames = 0;
+    size_t frame_len = 0;
+
+    /* Accumulated status of all captured frames that went into this one */
+    int status = 0;
+    int16_t peak_left = 0;
+    int16_t peak_right = 0;
+    loudness_t loudness;
+
+    /* Capture time of the most recent audio contained in this frame */
+    chrono::steady_clock::time_point captured;
+    chrono::steady_clock::time_point encoded;
+};
+
+/*! State shared between the three stages of AudioEnc::run().
+ *
+ * Each frame type circulates between a free queue and a full queue, so at
+ * most depth frames of each type are in flight. This bounds the latency
+ * added by the pipeline to 2*depth encoder frames.
+ */
+struct EncoderPipeline {
+    EncoderPipeline(size_t depth) :
+        captured_frames(depth), encoded_frames(depth),
+        free_captured(depth), captured(depth),
+        free_encoded(depth), encoded(depth) {}
+
+    vector<CapturedFrame> captured_frames;
+    vector<EncodedFrame> encoded_frames;
+
+    FrameQueue<CapturedFrame*> free_captured;
+    FrameQueue<CapturedFrame*> captured;
+    FrameQueue<EncodedFrame*> free_encoded;
+    FrameQueue<EncodedFrame*> encoded;
+
+    /* Set by a stage that fails, all stages stop as soon as possible */
+    std::atomic<bool> aborted = ATOMIC_VAR_INIT(false);
+    std::atomic<int> retval = ATOMIC_VAR_INIT(0);
+
+    /* First exception thrown by the encode or output stage, rethrown
+     * by run() after the threads have been joined */
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    std::thread encode_thread;
+    std::thread output_thread;
+
+    ~EncoderPipeline() {
+        // Only when the capture stage threw
+        if (encode_thread.joinable() or output_thread.joinable()) {
+            abort(1);
+            join();
+        }
+    }
+
+    void abort(int ret) {
+        if (not aborted.exchange(true)) {
+            retval = ret;
+        }
+        free_captured.close();
+        captured.close();
+        free_encoded.close();
+        encoded.close();
+    }
+
+    template<typename F>
+    std::thread start_stage(F stage) {
+        return std::thread([this, stage]() {
+                try {
+                    stage();
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (not error) {
+                        error = std::current_exception();
+                    }
+                    abort(1);
+                }
+            });
+    }
+
+    void join() {
+        if (encode_thread.joinable()) {
+            encode_thread.join();
+        }
+        if (output_thread.joinable()) {
+            output_thread.join();
+        }
+    }
+
+    /* Each histogram is only written by one stage. capture_wait is the
+     * time the capture stage waits for a free frame, the other wait
+     * histograms the time a frame spends in a queue. */
+    LatencyHistogram preprocess;
+    LatencyHistogram capture_wait;
+    LatencyHistogram encode_wait;
+    LatencyHistogram encode;
+    LatencyHistogram output_wait;
+    LatencyHistogram send;
+    LatencyHistogram end_to_end;
+};
+
 struct AudioEnc {
 public:
     int sample_rate=48000;
@@ -437,8 +795,15 @@ public:
 
     bool drift_compensation = false;
 
+    /* Scheduling of the capture thread, unchanged if 0 or empty */
+    int realtime_priority = 0;
+    string cpu_affinity;
+
     encoder_selection_t selected_encoder = encoder_selection_t::fdk_dabplus;
     bool afterburner = true;
+    bool parallel_channels = false;
+    bool scf_cache = false;
+    int complexity = 0;
     uint32_t bandwidth = 0;
     int bitrate = 0; // 0 means default bitrate
 
@@ -447,11 +812,22 @@ public:
     bool restart_on_fault = false;
     int fault_counter = 0;
 
-    std::deque<uint8_t> toolame_buffer;
+    /* Encoder output buffer and the size of one output frame.
+     * Only used by the encode stage. */
+    vec_u8 outbuf;
+    int outbuf_size = 0;
+    int enc_calls_per_output = 0;
+
+    /* Re-framing of the MPEG Layer II output into frames of 3*bitrate
+     * bytes, created in run() */
+    unique_ptr<Layer2Reframer> layer2_reframer;
 
     shared_ptr<Output::File> file_output;
     shared_ptr<Output::ZMQ> zmq_output;
     Output::EDI edi_output;
+
+    /* In multi-service mode, all ZMQ outputs share this context */
+    shared_ptr<zmq::context_t> zmq_context;
     string identifier;
 
     bool tist_enabled = false;
@@ -460,7 +836,7 @@ public:
     vector<string> output_uris;
     vector<string> edi_output_uris;
 
-    void *rs_handler = nullptr;
+    unique_ptr<SuperframeProtector> superframe_protector;
     AACENC_InfoStruct info = { 0 };
     int aot = AOT_NONE;
 
@@ -471,29 +847,56 @@ public:
     /* On silence, die after the silence_timeout expires */
     bool die_on_silence = false;
     int silence_timeout = 0;
-    int measured_silence_ms = 0;
+
+    /* With silence_after, the SilenceDetector declares silence after that
+     * many seconds, and the backup input or the fallback file replace the
+     * input until it ends. */
+    silence_config_t silence_config;
+    double silence_after = 0.0;
+    string silence_backup;
+    string silence_fallback;
 
     /* For MOT Slideshow and DLS insertion */
     string pad_ident = "";
     PadInterface pad_intf;
     int padlen = 6;
 
-    /* Encoder status, see the above STATUS macros */
-    int status = 0;
+    /* Number of frames each pipeline stage can hold */
+    size_t pipeline_depth = 2;
+    bool show_latency_stats = false;
+
+    /* If not zero, encode the input file in segments on this many
+     * threads instead of using the pipeline. See OfflineEncoder */
+    unsigned offline_jobs = 0;
+
+    /* Quality of the resampler of the file, JACK and ALSA inputs, used
+     * if the source does not have the encoder sample rate */
+    resampler_quality_t src_quality = resampler_quality_t::Medium;
 
     /* Whether to show the 'sox'-like measurement */
     int show_level = 0;
 
+    /* Additional level measurements, see GainStage */
+    bool level_rms = false;
+    bool level_true_peak = false;
+
+    /* Measure the loudness for the stats and the EDI output */
+    bool measure_loudness = false;
+
     /* If not empty, send stats over UNIX DGRAM socket */
     string send_stats_to = "";
 
     /* Data for ZMQ CURVE authentication */
-    char* keyfile = nullptr;
+    string keyfile;
     char secretkey[CURVE_KEYLEN+1];
 
     SampleQueue<uint8_t> queue;
 
+    /* Set from another thread to make run() return after the current frame */
+    std::atomic<bool> stop_requested = ATOMIC_VAR_INIT(false);
+
     HANDLE_AACENCODER encoder = nullptr;
+    toolame_context_t *toolame = nullptr;
     unique_ptr<AACDecoder> decoder;
     unique_ptr<StatsPublisher> stats_publisher;
 
@@ -503,8 +906,13 @@ public:
     ~AudioEnc();
 
     int run();
-    bool send_frame(const uint8_t *buf, size_t len, int16_t peak_left, int16_t peak_right);
+    int run_offline();
+    void encode_stage(EncoderPipeline& p);
+    void output_stage(EncoderPipeline& p);
+    bool send_frame(const uint8_t *buf, size_t len, int16_t peak_left, int16_t peak_right,
+            const loudness_t& loudness);
     shared_ptr<InputInterface> initialise_input();
+    unique_ptr<SilenceAction> initialise_silence_action(size_t max_size);
 };
 
 int AudioEnc::run()
@@ -573,6 +981,32 @@ int AudioEnc::run()
         return 1;
     }
 
+    if (offline_jobs > 0) {
+        if (infile.empty() or infile == "-") {
+            fprintf(stderr, "--jobs requires an input file\n");
+            return 1;
+        }
+
+        if (continue_after_eof or drift_compensation or die_on_silence or
+                silence_after > 0 or
+                not pad_ident.empty() or not decode_wavfilename.empty() or
+                not send_stats_to.empty() or not edi_output_uris.empty()) {
+            fprintf(stderr, "--jobs cannot be combined with PAD, EDI, drift compensation, "
+                    "--decode, --silence, --stats or --fifo-silence\n");
+            return 1;
+        }
+    }
+
+    if ((not silence_backup.empty() or not silence_fallback.empty()) and silence_after <= 0) {
+        fprintf(stderr, "--silence-backup and --silence-fallback require --silence-after\n");
+        return 1;
+    }
+
+    if (not silence_backup.empty() and not silence_fallback.empty()) {
+        fprintf(stderr, "--silence-backup and --silence-fallback cannot be combined\n");
+        return 1;
+    }
+
     for (const auto& uri : output_uris) {
         if (uri == "-") {
             if (file_output) {
@@ -587,10 +1021,13 @@ int AudioEnc::run()
                 (uri.compare(0, 6, "ipc://") == 0)) {
 
             if (not zmq_output) {
-                zmq_output = make_shared<Output::ZMQ>();
+                zmq_output = zmq_context ?
+                    make_shared<Output::ZMQ>(zmq_context) :
+                    make_shared<Output::ZMQ>();
             }
 
-            zmq_output->connect(uri.c_str(), keyfile);
+            zmq_output->connect(uri.c_str(),
+                    keyfile.empty() ? nullptr : keyfile.c_str());
         }
         else { // We assume it's a file name
             if (file_output) {
@@ -661,7 +1098,8 @@ int AudioEnc::run()
     if (selected_encoder == encoder_selection_t::fdk_dabplus) {
         int subchannel_index = bitrate / 8;
         if (prepare_aac_encoder(&encoder, subchannel_index, channels,
-                    sample_rate, afterburner, bandwidth, &aot) != 0) {
+                    sample_rate, afterburner, parallel_channels, scf_cache,
+                    complexity, bandwidth, &aot, true) != 0) {
             fprintf(stderr, "Encoder preparation failed\n");
             return 1;
         }
@@ -684,16 +1122,6 @@ int AudioEnc::run()
         }
     }
     else if (selected_encoder == encoder_selection_t::toolame_dab) {
-        int err = toolame_init();
-
-        if (err == 0) {
-            err = toolame_set_samplerate(sample_rate);
-        }
-
-        if (err == 0) {
-            err = toolame_set_psy_model(dab_psy_model);
-        }
-
         if (dab_channel_mode.empty()) {
             if (channels == 2) {
                 dab_channel_mode = 'j'; // Default to joint-stereo
@@ -708,21 +1136,9 @@ int AudioEnc::run()
             }
         }
 
-        if (err == 0) {
-            err = toolame_set_channel_mode(dab_channel_mode.c_str()[0]);
-        }
-
-        // setting the ScF-CRC len here depends on set sample rate/channel mode
-        if (err == 0) {
-            err = toolame_set_bitrate(bitrate);
-        }
-
-        if (err == 0) {
-            err = toolame_set_pad(padlen);
-        }
-
+        int err = prepare_toolame_encoder(&toolame, sample_rate,
+                dab_psy_model, dab_channel_mode.c_str()[0], bitrate, padlen);
         if (err) {
-            fprintf(stderr, "libtoolame-dab init failed: %d\n", err);
             return err;
         }
 
@@ -754,10 +1170,14 @@ int AudioEnc::run()
      * frame. This information is used when the alsa drift compensation
      * is active. This is only valid for FDK-AAC.
      */
-    const int enc_calls_per_output = (aot == AOT_DABPLUS_AAC_LC) ?
+    enc_calls_per_output = (aot == AOT_DABPLUS_AAC_LC) ?
         sample_rate / 8000 :
         sample_rate / 16000;
 
+    if (offline_jobs > 0) {
+        return run_offline();
+    }
+
     int max_size = 32*input_buf.size() + NUM_SAMPLES_PER_CALL;
 
     /*! The SampleQueue \c queue is given to the inputs, so that they
@@ -765,13 +1185,6 @@ int AudioEnc::run()
      */
     queue.configure(max_size, not drift_compensation, channels);
 
-    /* symsize=8, gfpoly=0x11d, fcr=0, prim=1, nroots=10, pad=135 */
-    rs_handler = init_rs_char(8, 0x11d, 0, 1, 10, 135);
-    if (rs_handler == nullptr) {
-        perror("init_rs_char failed");
-        return 1;
-    }
-
     shared_ptr<InputInterface> input;
     try {
         input = initialise_input();
@@ -785,22 +1198,87 @@ int AudioEnc::run()
         zmq_output->set_encoder_type(selected_encoder, bitrate);
     }
 
-    int outbuf_size = 0;
-    vec_u8 outbuf;
-
     switch (selected_encoder) {
         case encoder_selection_t::fdk_dabplus:
-            outbuf_size = bitrate/8*120;
+            superframe_protector = make_unique<SuperframeProtector>(bitrate/8);
+            outbuf_size = superframe_protector->superframe_size();
             outbuf.resize(24*120);
             break;
         case encoder_selection_t::toolame_dab:
             outbuf_size = 4092;
             outbuf.resize(outbuf_size);
             fprintf(stderr, "Setting outbuf size to %zu\n", outbuf.size());
+            layer2_reframer = make_unique<Layer2Reframer>(3 * bitrate, outbuf_size);
             break;
     }
 
+    /* All buffers used in the main loop are allocated here, so that the
+     * steady state does not allocate. */
     vector<uint8_t> pad_buf(padlen + 1);
+    vector<uint8_t> pad_data;
+    pad_data.reserve(PadInterface::MAX_MESSAGE_SIZE);
+
+    /*! With drift compensation, the inputs that have their own clock are
+     * read through the DriftCompensator. With --fifo-silence, the file
+     * input is read synchronously, and pop() inserts silence when the
+     * fifo is empty. */
+    unique_ptr<DriftCompensator> drift_compensator;
+    if (drift_compensation and infile.empty()) {
+        drift_compensator = make_unique<DriftCompensator>(queue, sample_rate,
+                channels, DRIFT_COMPENSATION_TARGET_CALLS * input_buf.size(),
+                src_quality);
+    }
+
+    /*! The silence detector also works for -s alone. The action, if
+     * any, replaces the input during silence, and the second GainStage
+     * measures the levels of what replaces it. */
+    unique_ptr<SilenceDetector> silence_detector;
+    unique_ptr<SilenceAction> silence_action;
+    unique_ptr<GainStage> silence_gain_stage;
+    if (die_on_silence or silence_after > 0) {
+        silence_config.duration = (silence_after > 0) ? silence_after : silence_timeout;
+        silence_detector = make_unique<SilenceDetector>(sample_rate, silence_config);
+
+        try {
+            silence_action = initialise_silence_action(max_size);
+        }
+        catch (const runtime_error& e) {
+            fprintf(stderr, "Initialising silence action triggered exception: %s\n", e.what());
+            return 1;
+        }
+
+        if (silence_action) {
+            silence_gain_stage = make_unique<GainStage>(channels, 0.0,
+                    level_rms or silence_config.use_rms, level_true_peak);
+        }
+    }
+
+    GainStage gain_stage(channels, gain_dB,
+            level_rms or silence_config.use_rms, level_true_peak);
+
+    unique_ptr<LoudnessMeter> loudness_meter;
+    if (measure_loudness) {
+        loudness_meter = make_unique<LoudnessMeter>(sample_rate, channels);
+    }
+
+    /*! With drift compensation, nothing blocks the capture, and the
+     * RealtimePacer throttles it to the nominal rate. */
+    unique_ptr<RealtimePacer> pacer;
+    if (drift_compensation) {
+        pacer = make_unique<RealtimePacer>(sample_rate, tist_enabled);
+    }
+
+    EncoderPipeline pipeline(pipeline_depth);
+    for (auto& frame : pipeline.captured_frames) {
+        frame.audio.resize(input_buf.size());
+        frame.pad.resize(pad_buf.size());
+        pipeline.free_captured.push(&frame);
+    }
+    for (auto& frame : pipeline.encoded_frames) {
+        frame.data.resize(std::max(outbuf.size(),
+                    layer2_reframer ? layer2_reframer->max_output() : 0));
+        pipeline.free_encoded.push(&frame);
+    }
 
     if (restart_on_fault) {
         fprintf(stderr, "Autorestart has been deprecated and will be removed in the future!\n");
@@ -809,19 +1287,41 @@ int AudioEnc::run()
 
     fprintf(stderr, "Starting encoding\n");
 
+    /*! \section Pipeline
+     * This thread captures and preprocesses the audio, encoding and
+     * sending run in their own threads. See EncoderPipeline.
+     */
+    pipeline.encode_thread = pipeline.start_stage([&]() { encode_stage(pipeline); });
+    pipeline.output_thread = pipeline.start_stage([&]() { output_stage(pipeline); });
+
+    /* The encode and output threads keep the default scheduling, only
+     * the capture has to meet deadlines. */
+    if (not cpu_affinity.empty()) {
+        set_cpu_affinity(cpu_affinity);
+    }
+    if (realtime_priority != 0) {
+        set_realtime_priority(realtime_priority);
+    }
+
     int retval = 0;
-    int send_error_count = 0;
-    timepoint_last_compensation = chrono::steady_clock::now();
+    if (pacer) {
+        pacer->start();
+    }
     auto timepoint_last_received_sample = chrono::steady_clock::now();
 
-    int calls = 0; // for checking
     ssize_t read_bytes = 0;
     do {
+        if (pipeline.aborted) {
+            break;
+        }
+
+        int status = 0;
+
         // --------------- Read data from the PAD socket
         int calculated_padlen = 0;
 
         if (padlen != 0) {
-            vector<uint8_t> pad_data = pad_intf.request(padlen);
+            pad_intf.request(padlen, pad_data);
 
             if (pad_data.empty()) {
                 /* no PAD available */
@@ -857,9 +1357,6 @@ int AudioEnc::run()
 
 
         // -------------- Read Data
-        memset(outbuf.data(), 0x00, outbuf_size);
-        memset(input_buf.data(), 0x00, input_buf.size());
-
         /*! \section DataInput
          * We read data input either in a blocking way (file input, VLC or ALSA
          * without drift compensation) or in a non-blocking way (VLC or ALSA
@@ -869,7 +1366,8 @@ int AudioEnc::run()
          * \c pop_wait() depending on if it's blocking or not
          *
          * In non-blocking, the \c queue makes the data available without delay, and the
-         * \c drift_compensation_delay() function handles rate throttling.
+         * \c RealtimePacer handles rate throttling. The
+         * \c DriftCompensator resamples the input so that it matches this rate.
          */
 
         if (input->fault_detected()) {
@@ -909,14 +1407,22 @@ int AudioEnc::run()
 
         if (drift_compensation) {
             size_t overruns = 0;
-            size_t bytes_from_queue = queue.pop(input_buf.data(), input_buf.size(), &overruns); // returns bytes
-            if (bytes_from_queue != input_buf.size()) {
-                expand_missing_samples(input_buf, channels, bytes_from_queue);
+            size_t missing_bytes = 0;
+            if (drift_compensator) {
+                missing_bytes = drift_compensator->read(input_buf.data(), input_buf.size(), &overruns);
+            }
+            else {
+                missing_bytes = input_buf.size() -
+                    queue.pop(input_buf.data(), input_buf.size(), &overruns);
             }
             read_bytes = input_buf.size();
-            drift_compensation_delay(sample_rate, channels, read_bytes);
+            pacer->wait(read_bytes / (BYTES_PER_SAMPLE * channels));
+
+            if (drift_compensator and stats_publisher) {
+                stats_publisher->update_drift(drift_compensator->drift_ppm());
+            }
 
-            if (bytes_from_queue != input_buf.size()) {
+            if (missing_bytes > 0) {
                 status |= STATUS_UNDERRUN;
                 if (stats_publisher) {
                     stats_publisher->notify_underrun();
@@ -925,9 +1431,12 @@ int AudioEnc::run()
                 const auto now = chrono::steady_clock::now();
                 const auto elapsed = chrono::duration_cast<chrono::seconds>(
                         now - timepoint_last_received_sample);
-                if (elapsed.count() > 60) {
+                // While a silence action replaces the input, keep waiting for it
+                const bool replaced = silence_action and silence_detector->active();
+                if (elapsed.count() > 60 and not replaced) {
                     fprintf(stderr, "Underruns for 60s, aborting!\n");
-                    return 1;
+                    retval = 1;
+                    break;
                 }
             }
             else {
@@ -973,7 +1482,8 @@ int AudioEnc::run()
                     }
                     catch (const runtime_error& e) {
                         fprintf(stderr, "Initialising input triggered exception: %s\n", e.what());
-                        return 1;
+                        retval = 1;
+                        break;
                     }
 
                     continue;
@@ -985,6 +1495,8 @@ int AudioEnc::run()
             }
         }
 
+        const auto timepoint_input = chrono::steady_clock::now();
+
         /*! \section MetadataFromSource
          * The VLC input is the only input that can also give us metadata, which
          * we can hand over to ODR-PadEnc.
@@ -1019,114 +1531,297 @@ int AudioEnc::run()
         }
 
         /*! \section AudioLevel
-         * Audio level measurement is always done assuming we have two
-         * channels, and is formally wrong in mono, but still gives
-         * numbers one can use.
-         *
-         * At the same time, we apply gain correction.
-         *
-         * \todo fix level measurement in mono
+         * The GainStage applies the gain correction and measures the
+         * levels of each channel. The peaks go to the ZMQ and EDI outputs,
+         * the RMS and true peak levels, if enabled, to the stats.
          */
-        int16_t peak_left  = 0;
-        int16_t peak_right = 0;
+        audio_levels_t levels;
+        gain_stage.process(input_buf.data(), read_bytes, levels);
 
-        const double linear_gain_correction = pow(10.0, gain_dB / 20.0);
-
-        for (int i = 0; i < read_bytes; i+=4) {
-            int16_t l = input_buf[i] | (input_buf[i+1] << 8);
-            int16_t r = input_buf[i+2] | (input_buf[i+3] << 8);
+        /*! \section SilenceDetection
+         * The SilenceDetector compares the level of the input against a
+         * threshold with hysteresis. By default, only digital silence is
+         * quiet, which guards against connection issues rather than against
+         * source level issues. While the silence lasts, the SilenceAction
+         * replaces the input, and the encoder keeps running. With -s, the
+         * encoder aborts once the input is quiet for silence_timeout,
+         * even if the action replaces it.
+         */
+        if (silence_detector) {
+            const size_t num_frames = read_bytes / (BYTES_PER_SAMPLE * channels);
+            const auto event = silence_detector->update(levels, num_frames);
+
+            // With -s alone, only the abort below is logged
+            if (event == silence_event_t::Started and silence_after > 0) {
+                fprintf(stderr, "Silence detected for %.1f seconds%s%s\n",
+                        silence_detector->quiet_duration(),
+                        silence_action ? ", switching to " : "",
+                        silence_action ? silence_action->name().c_str() : "");
+                if (silence_action) {
+                    silence_action->activate();
+                }
+            }
+            else if (event == silence_event_t::Ended and silence_after > 0) {
+                fprintf(stderr, "Silence ended%s\n",
+                        silence_action ? ", switching back to the input" : "");
+                if (silence_action) {
+                    silence_action->deactivate();
+                }
+            }
 
-            if (linear_gain_correction != 1.0) {
-                l *= linear_gain_correction;
-                r *= linear_gain_correction;
+            if (die_on_silence and silence_detector->quiet_duration() > silence_timeout) {
+                fprintf(stderr, "Silence detected for %d seconds, aborting.\n",
+                        silence_timeout);
+                retval = 2;
+                break;
+            }
 
-                input_buf[i] = l & 0x00FF;
-                input_buf[i+1] = (l & 0xFF00) >> 8;
-                input_buf[i+2] = r & 0x00FF;
-                input_buf[i+3] = (r & 0xFF00) >> 8;
+            if (silence_action) {
+                const bool active = silence_detector->active();
+                silence_action->process(input_buf.data(), read_bytes, active);
+                if (active) {
+                    silence_gain_stage->process(input_buf.data(), read_bytes, levels);
+                }
             }
 
-            peak_left  = std::max(peak_left,  l);
-            peak_right = std::max(peak_right, r);
+            if (stats_publisher) {
+                stats_publisher->update_silence(silence_detector->active(),
+                        silence_detector->quiet_duration());
+            }
         }
 
+        const int16_t peak_left = levels.peak_left;
+        const int16_t peak_right = levels.peak_right;
+
         if (stats_publisher) {
-            stats_publisher->update_audio_levels(peak_left, peak_right);
+            stats_publisher->update_audio_levels(levels);
         }
 
-        /*! \section SilenceDetection
-         * Silence detection looks at the audio level and is
-         * only useful if the connection dropped, or if no data is available. It is not
-         * useful if the source is nearly silent (some noise present), because the
-         * threshold is 0, and not configurable. The rationale is that we want to
-         * guard against connection issues, not source level issues.
-         */
-        if (die_on_silence && std::max(peak_left, peak_right) == 0) {
-            const unsigned int frame_time_msec = 1000ul *
-                read_bytes / (BYTES_PER_SAMPLE * channels * sample_rate);
-
-            measured_silence_ms += frame_time_msec;
+        loudness_t loudness;
+        if (loudness_meter) {
+            loudness_meter->process((const int16_t*)input_buf.data(),
+                    read_bytes / (BYTES_PER_SAMPLE * channels));
+            loudness = loudness_meter->loudness();
 
-            if (measured_silence_ms > 1000*silence_timeout) {
-                fprintf(stderr, "Silence detected for %d seconds, aborting.\n",
-                        silence_timeout);
-                retval = 2;
-                break;
+            if (stats_publisher) {
+                stats_publisher->update_loudness(loudness);
             }
         }
-        else {
-            measured_silence_ms = 0;
+
+        // -------------- Hand over to the encode stage
+        const auto timepoint_preprocessed = chrono::steady_clock::now();
+        pipeline.preprocess.record(timepoint_preprocessed - timepoint_input);
+
+        CapturedFrame *frame = nullptr;
+        if (not pipeline.free_captured.pop(frame)) {
+            break;
         }
 
-        int numOutBytes = 0;
-        if (read_bytes and
-                selected_encoder == encoder_selection_t::fdk_dabplus) {
-            AACENC_BufDesc in_buf = { 0 }, out_buf = { 0 };
-            AACENC_InArgs in_args = { 0 };
-            AACENC_OutArgs out_args = { 0 };
-            // -------------- AAC Encoding
-            //
-            int in_identifier[] = {IN_AUDIO_DATA, IN_ANCILLRY_DATA};
-            int out_identifier = OUT_BITSTREAM_DATA;
+        /* Swapping keeps input_buf at its size, and avoids a copy */
+        std::swap(input_buf, frame->audio);
+        std::copy(pad_buf.begin(), pad_buf.end(), frame->pad.begin());
+        frame->read_bytes = read_bytes;
+        frame->calculated_padlen = calculated_padlen;
+        frame->status = status;
+        frame->peak_left = peak_left;
+        frame->peak_right = peak_right;
+        frame->loudness = loudness;
+        frame->captured = chrono::steady_clock::now();
 
-            void *in_ptr[2], *out_ptr;
-            int in_size[2], in_elem_size[2];
-            int out_size, out_elem_size;
+        pipeline.capture_wait.record(frame->captured - timepoint_preprocessed);
 
-            in_ptr[0] = input_buf.data();
-            in_ptr[1] = pad_buf.data() + (padlen - calculated_padlen); // offset due to unused PAD bytes
-            in_size[0] = read_bytes;
-            in_size[1] = calculated_padlen;
-            in_elem_size[0] = BYTES_PER_SAMPLE;
-            in_elem_size[1] = sizeof(uint8_t);
-            in_args.numInSamples = input_buf.size()/BYTES_PER_SAMPLE;
-            in_args.numAncBytes = calculated_padlen;
+        if (not pipeline.captured.push(frame)) {
+            break;
+        }
+    } while (read_bytes > 0 and not stop_requested);
 
-            in_buf.numBufs = calculated_padlen ? 2 : 1;    // Samples + Data / Samples
-            in_buf.bufs = (void**)&in_ptr;
-            in_buf.bufferIdentifiers = in_identifier;
-            in_buf.bufSizes = in_size;
-            in_buf.bufElSizes = in_elem_size;
+    // Let the other stages drain the frames already captured
+    pipeline.captured.close();
+    pipeline.join();
 
-            out_ptr = outbuf.data();
-            out_size = outbuf.size();
-            out_elem_size = 1;
-            out_buf.numBufs = 1;
-            out_buf.bufs = &out_ptr;
-            out_buf.bufferIdentifiers = &out_identifier;
-            out_buf.bufSizes = &out_size;
-            out_buf.bufElSizes = &out_elem_size;
+    if (pipeline.error) {
+        rethrow_exception(pipeline.error);
+    }
 
-            AACENC_ERROR err;
-            if ((err = aacEncEncode(encoder, &in_buf, &out_buf, &in_args, &out_args))
-                    != AACENC_OK) {
+    if (retval == 0) {
+        retval = pipeline.retval;
+    }
+
+    fprintf(stderr, "\n");
+
+    if (show_latency_stats) {
+        fprintf(stderr, "Pipeline latencies (depth %zu):\n", pipeline_depth);
+        pipeline.preprocess.print(stderr, "preprocess");
+        pipeline.capture_wait.print(stderr, "capture wait");
+        pipeline.encode_wait.print(stderr, "encode wait");
+        pipeline.encode.print(stderr, "encode");
+        pipeline.output_wait.print(stderr, "output wait");
+        pipeline.send.print(stderr, "send");
+        pipeline.end_to_end.print(stderr, "capture to sent");
+        if (pacer) {
+            pacer->print_stats(stderr);
+        }
+    }
+
+    return retval;
+}
+
+/*! \section OfflineEncoding
+ * With --jobs, the input file is encoded by the OfflineEncoder in
+ * segments of 30 seconds. The DAB+ segments start with two superframes
+ * of preroll, which is long enough for the block switching and the
+ * SBR to settle. The DAB segments start with two MPEG frames of preroll
+ * for the filterbank, and end with one frame of postroll, because the
+ * ScF-CRC of each frame is carried in the frame before it.
+ */
+int AudioEnc::run_offline()
+{
+    if (not file_output or zmq_output) {
+        fprintf(stderr, "--jobs requires a file output\n");
+        return 1;
+    }
+
+    constexpr int segment_seconds = 30;
+
+    offline_config_t config;
+    config.infile = infile;
+    config.raw_input = raw_input;
+    config.sample_rate = sample_rate;
+    config.channels = channels;
+    config.jobs = offline_jobs;
+
+    OfflineEncoder::encoder_factory_t factory;
+
+    switch (selected_encoder) {
+        case encoder_selection_t::fdk_dabplus:
+            {
+                const int subchannel_index = bitrate / 8;
+                config.call_bytes = channels * BYTES_PER_SAMPLE * info.frameLength;
+                config.calls_per_unit = enc_calls_per_output;
+                config.unit_bytes = 120 * subchannel_index;
+                config.frame_len = config.unit_bytes;
+                // One superframe is 120ms
+                config.segment_units = segment_seconds * 1000 / 120;
+                config.preroll_units = 2;
+                config.postroll_units = 0;
+
+                const int fdk_aot = aot;
+                factory = [=]() {
+                    return make_unique<FDKSegmentEncoder>(subchannel_index,
+                            channels, sample_rate, afterburner, scf_cache,
+                            complexity, bandwidth, fdk_aot, gain_dB);
+                };
+            }
+            break;
+        case encoder_selection_t::toolame_dab:
+            {
+                config.call_bytes = channels * BYTES_PER_SAMPLE * 1152;
+                config.calls_per_unit = 1;
+                // 1152 samples at bitrate kbps, without padding at the DAB rates
+                config.unit_bytes = 144000 * bitrate / sample_rate;
+                config.frame_len = 3 * bitrate;
+                config.segment_units = segment_seconds * sample_rate / 1152;
+                config.preroll_units = 2;
+                config.postroll_units = 1;
+
+                const char channel_mode = dab_channel_mode.c_str()[0];
+                factory = [=]() {
+                    return make_unique<ToolameSegmentEncoder>(sample_rate,
+                            channels, dab_psy_model, channel_mode, bitrate,
+                            gain_dB);
+                };
+            }
+            break;
+    }
+
+    try {
+        OfflineEncoder offline_encoder(config, factory);
+        offline_encoder.run(*file_output);
+    }
+    catch (const runtime_error& e) {
+        fprintf(stderr, "Parallel encoding failed: %s\n", e.what());
+        return 1;
+    }
+
+    fprintf(stderr, "End of input reached\n");
+    return 0;
+}
+
+void AudioEnc::encode_stage(EncoderPipeline& p)
+{
+    int calls = 0; // for checking
+
+    /* Accumulated over all captured frames until the encoder gives us
+     * output, see the STATUS macros */
+    int status = 0;
+
+    CapturedFrame *frame = nullptr;
+    while (p.captured.pop(frame)) {
+        const auto timepoint_start = chrono::steady_clock::now();
+        p.encode_wait.record(timepoint_start - frame->captured);
+
+        status |= frame->status;
+
+        /* outbuf is only partially overwritten by the encoder. Only the
+         * DAB+ superframe needs clearing before it is given to it. */
+        if (selected_encoder == encoder_selection_t::fdk_dabplus) {
+            memset(outbuf.data(), 0x00, outbuf_size);
+        }
+
+        const vec_u8& input_buf = frame->audio;
+        const ssize_t read_bytes = frame->read_bytes;
+        const int calculated_padlen = frame->calculated_padlen;
+
+        int numOutBytes = 0;
+        if (read_bytes and
+                selected_encoder == encoder_selection_t::fdk_dabplus) {
+            AACENC_BufDesc in_buf = { 0 }, out_buf = { 0 };
+            AACENC_InArgs in_args = { 0 };
+            AACENC_OutArgs out_args = { 0 };
+            // -------------- AAC Encoding
+            //
+            int in_identifier[] = {IN_AUDIO_DATA, IN_ANCILLRY_DATA};
+            int out_identifier = OUT_BITSTREAM_DATA;
+
+            void *in_ptr[2], *out_ptr;
+            int in_size[2], in_elem_size[2];
+            int out_size, out_elem_size;
+
+            in_ptr[0] = frame->audio.data();
+            in_ptr[1] = frame->pad.data() + (padlen - calculated_padlen); // offset due to unused PAD bytes
+            in_size[0] = read_bytes;
+            in_size[1] = calculated_padlen;
+            in_elem_size[0] = BYTES_PER_SAMPLE;
+            in_elem_size[1] = sizeof(uint8_t);
+            in_args.numInSamples = input_buf.size()/BYTES_PER_SAMPLE;
+            in_args.numAncBytes = calculated_padlen;
+
+            in_buf.numBufs = calculated_padlen ? 2 : 1;    // Samples + Data / Samples
+            in_buf.bufs = (void**)&in_ptr;
+            in_buf.bufferIdentifiers = in_identifier;
+            in_buf.bufSizes = in_size;
+            in_buf.bufElSizes = in_elem_size;
+
+            out_ptr = outbuf.data();
+            out_size = outbuf.size();
+            out_elem_size = 1;
+            out_buf.numBufs = 1;
+            out_buf.bufs = &out_ptr;
+            out_buf.bufferIdentifiers = &out_identifier;
+            out_buf.bufSizes = &out_size;
+            out_buf.bufElSizes = &out_elem_size;
+
+            AACENC_ERROR err;
+            if ((err = aacEncEncode(encoder, &in_buf, &out_buf, &in_args, &out_args))
+                    != AACENC_OK) {
                 if (err == AACENC_ENCODE_EOF) {
                     fprintf(stderr, "encoder error: EOF reached\n");
-                    break;
+                    p.abort(0);
+                    return;
                 }
                 fprintf(stderr, "Encoding failed (%d)\n", err);
-                retval = 3;
-                break;
+                p.abort(3);
+                return;
             }
             calls++;
 
@@ -1155,29 +1850,50 @@ int AudioEnc::run()
             }
 
             if (read_bytes) {
-                numOutBytes = toolame_encode_frame(input_buffers, pad_buf.data(), calculated_padlen, outbuf.data(), outbuf.size());
+                numOutBytes = toolame_encode_frame(toolame, input_buffers, frame->pad.data(), calculated_padlen, outbuf.data(), outbuf.size());
             }
             else {
-                numOutBytes = toolame_finish(outbuf.data(), outbuf.size());
+                numOutBytes = toolame_finish(toolame, outbuf.data(), outbuf.size());
             }
         }
 
+        p.encode.record(chrono::steady_clock::now() - timepoint_start);
+
+        const int16_t peak_left = frame->peak_left;
+        const int16_t peak_right = frame->peak_right;
+        const loudness_t loudness = frame->loudness;
+        const auto timepoint_captured = frame->captured;
+
+        // The audio is not needed anymore, give the frame back to the capture stage
+        p.free_captured.push(frame);
+
         if (numOutBytes != 0 and decoder) {
             try {
                 decoder->decode_frame(outbuf.data(), numOutBytes);
             }
             catch (runtime_error &e) {
                 fprintf(stderr, "Decoding failed with: %s\n", e.what());
-                return 1;
+                p.abort(1);
+                return;
             }
         }
 
+        if (numOutBytes <= 0) {
+            continue;
+        }
+
+        EncodedFrame *encoded = nullptr;
+        if (not p.free_encoded.pop(encoded)) {
+            return;
+        }
+
+        encoded->num_frames = 0;
+
         /* Check if the encoder has generated output data.
          * DAB+ requires RS encoding, which is not done in ODR-DabMux and not necessary
          * for DAB.
          */
-        if (numOutBytes != 0 and
-            selected_encoder == encoder_selection_t::fdk_dabplus) {
+        if (selected_encoder == encoder_selection_t::fdk_dabplus) {
 
             // Our timing code depends on this
             if (calls != enc_calls_per_output) {
@@ -1186,100 +1902,108 @@ int AudioEnc::run()
             }
             calls = 0;
 
-            int row, col;
-            unsigned char buf_to_rs_enc[110];
-            unsigned char rs_enc[10];
-            const int subchannel_index = bitrate / 8;
-            for(row=0; row < subchannel_index; row++) {
-                for(col=0;col < 110; col++) {
-                    buf_to_rs_enc[col] = outbuf[subchannel_index * col + row];
-                }
+            superframe_protector->protect(outbuf.data(), outbuf.size());
 
-                encode_rs_char(rs_handler, buf_to_rs_enc, rs_enc);
+            std::copy(outbuf.begin(), outbuf.begin() + outbuf_size,
+                    encoded->data.begin());
+            encoded->num_frames = 1;
+            encoded->frame_len = outbuf_size;
+        }
+        else if (selected_encoder == encoder_selection_t::toolame_dab) {
+            // ODR-DabMux expects frames of length 3*bitrate
+            encoded->num_frames = layer2_reframer->push(outbuf.data(),
+                    numOutBytes, encoded->data.data());
+            encoded->frame_len = layer2_reframer->frame_len();
+        }
 
-                for(col=110; col<120; col++) {
-                    outbuf.at(subchannel_index * col + row) = rs_enc[col-110];
-                }
-            }
+        encoded->status = status;
+        encoded->peak_left = peak_left;
+        encoded->peak_right = peak_right;
+        encoded->loudness = loudness;
+        encoded->captured = timepoint_captured;
+        encoded->encoded = chrono::steady_clock::now();
+        status = 0;
 
-            numOutBytes = outbuf_size;
+        if (not p.encoded.push(encoded)) {
+            return;
         }
+    }
 
-        if (numOutBytes > 0 and selected_encoder == encoder_selection_t::toolame_dab) {
-            toolame_buffer.insert(toolame_buffer.end(), outbuf.begin(), outbuf.begin() + numOutBytes);
+    p.encoded.close();
+}
 
-            // ODR-DabMux expects frames of length 3*bitrate
-            const size_t frame_len = 3 * bitrate;
-            while (toolame_buffer.size() > frame_len) {
-                vec_u8 frame(frame_len);
-                // this is probably not very efficient
-                std::copy(toolame_buffer.begin(), toolame_buffer.begin() + frame_len, frame.begin());
-                toolame_buffer.erase(toolame_buffer.begin(), toolame_buffer.begin() + frame_len);
-
-                bool success = send_frame(frame.data(), frame.size(), peak_left, peak_right);
-                if (not success) {
-                    fprintf(stderr, "Send error !\n");
-                    send_error_count ++;
-                }
-            }
-        }
-        else if (numOutBytes > 0 and selected_encoder == encoder_selection_t::fdk_dabplus) {
-            bool success = send_frame(outbuf.data(), numOutBytes, peak_left, peak_right);
+void AudioEnc::output_stage(EncoderPipeline& p)
+{
+    int send_error_count = 0;
+
+    EncodedFrame *encoded = nullptr;
+    while (p.encoded.pop(encoded)) {
+        const auto timepoint_start = chrono::steady_clock::now();
+        p.output_wait.record(timepoint_start - encoded->encoded);
+
+        const int status = encoded->status;
+        const int16_t peak_left = encoded->peak_left;
+        const int16_t peak_right = encoded->peak_right;
+
+        for (size_t i = 0; i < encoded->num_frames; i++) {
+            bool success = send_frame(
+                    encoded->data.data() + i * encoded->frame_len,
+                    encoded->frame_len, peak_left, peak_right, encoded->loudness);
             if (not success) {
                 fprintf(stderr, "Send error !\n");
                 send_error_count ++;
             }
         }
 
+        const auto timepoint_sent = chrono::steady_clock::now();
+        p.send.record(timepoint_sent - timepoint_start);
+        p.end_to_end.record(timepoint_sent - encoded->captured);
+
+        p.free_encoded.push(encoded);
+
         if (send_error_count > 10) {
             fprintf(stderr, "Send failed ten times, aborting!\n");
-            retval = 4;
-            break;
+            p.abort(4);
+            return;
         }
 
-        if (numOutBytes != 0) {
-            if (show_level) {
-                if (channels == 1) {
-                    fprintf(stderr, "\rIn: [%-6s] %1s %1s %1s",
-                            level(1, std::max(peak_right, peak_left)),
-                            status & STATUS_PAD_INSERTED ? "P" : " ",
-                            status & STATUS_UNDERRUN ? "U" : " ",
-                            status & STATUS_OVERRUN ? "O" : " ");
-                }
-                else if (channels == 2) {
-                    fprintf(stderr, "\rIn: [%6s|%-6s] %1s %1s %1s",
-                            level(0, peak_left),
-                            level(1, peak_right),
-                            status & STATUS_PAD_INSERTED ? "P" : " ",
-                            status & STATUS_UNDERRUN ? "U" : " ",
-                            status & STATUS_OVERRUN ? "O" : " ");
-                }
+        if (show_level) {
+            if (channels == 1) {
+                fprintf(stderr, "\rIn: [%-6s] %1s %1s %1s",
+                        level(1, std::max(peak_right, peak_left)),
+                        status & STATUS_PAD_INSERTED ? "P" : " ",
+                        status & STATUS_UNDERRUN ? "U" : " ",
+                        status & STATUS_OVERRUN ? "O" : " ");
             }
-            else {
-                if (status & STATUS_OVERRUN) {
-                    fprintf(stderr, "O");
-                }
-
-                if (status & STATUS_UNDERRUN) {
-                    fprintf(stderr, "U");
-                }
+            else if (channels == 2) {
+                fprintf(stderr, "\rIn: [%6s|%-6s] %1s %1s %1s",
+                        level(0, peak_left),
+                        level(1, peak_right),
+                        status & STATUS_PAD_INSERTED ? "P" : " ",
+                        status & STATUS_UNDERRUN ? "U" : " ",
+                        status & STATUS_OVERRUN ? "O" : " ");
+            }
+        }
+        else {
+            if (status & STATUS_OVERRUN) {
+                fprintf(stderr, "O");
             }
 
-            if (stats_publisher) {
-                stats_publisher->send_stats();
+            if (status & STATUS_UNDERRUN) {
+                fprintf(stderr, "U");
             }
+        }
 
-            status = 0;
+        if (stats_publisher) {
+            stats_publisher->send_stats();
         }
 
         fflush(stdout);
-    } while (read_bytes > 0);
-
-    fprintf(stderr, "\n");
-    return retval;
+    }
 }
 
-bool AudioEnc::send_frame(const uint8_t *buf, size_t len, int16_t peak_left, int16_t peak_right)
+bool AudioEnc::send_frame(const uint8_t *buf, size_t len, int16_t peak_left, int16_t peak_right,
+        const loudness_t& loudness)
 {
     // The file output is mutually exclusive to the other outputs
     if (file_output) {
@@ -1295,6 +2019,9 @@ bool AudioEnc::send_frame(const uint8_t *buf, size_t len, int16_t peak_left, int
 
     if (edi_output.enabled()) {
         edi_output.update_audio_levels(peak_left, peak_right);
+        if (measure_loudness) {
+            edi_output.update_loudness(loudness);
+        }
         switch (selected_encoder) {
             case encoder_selection_t::fdk_dabplus:
                 {
@@ -1326,13 +2053,11 @@ AudioEnc::~AudioEnc()
     file_output.reset();
     zmq_output.reset();
 
-    if (rs_handler != nullptr) {
-        free_rs_char(rs_handler);
-    }
-
     if (encoder != nullptr and selected_encoder == encoder_selection_t::fdk_dabplus) {
         aacEncClose(&encoder);
     }
+
+    toolame_destroy(toolame);
 }
 
 shared_ptr<InputInterface> AudioEnc::initialise_input()
@@ -1340,11 +2065,12 @@ shared_ptr<InputInterface> AudioEnc::initialise_input()
     shared_ptr<InputInterface> input;
 
     if (not infile.empty()) {
-        input = make_shared<FileInput>(infile, raw_input, sample_rate, continue_after_eof, queue);
+        input = make_shared<FileInput>(infile, raw_input, sample_rate, src_quality,
+                continue_after_eof, queue);
     }
 #if HAVE_JACK
     else if (not jack_name.empty()) {
-        input = make_shared<JackInput>(jack_name, channels, sample_rate, queue);
+        input = make_shared<JackInput>(jack_name, channels, sample_rate, src_quality, queue);
     }
 #endif
 #if HAVE_VLC
@@ -1360,10 +2086,12 @@ shared_ptr<InputInterface> AudioEnc::initialise_input()
 #endif
 #if HAVE_ALSA
     else if (drift_compensation) {
-        input = make_shared<AlsaInputThreaded>(alsa_device, channels, sample_rate, queue);
+        input = make_shared<AlsaInputThreaded>(alsa_device, channels, sample_rate,
+                src_quality, queue);
     }
     else {
-        input = make_shared<AlsaInputDirect>(alsa_device, channels, sample_rate, queue);
+        input = make_shared<AlsaInputDirect>(alsa_device, channels, sample_rate,
+                src_quality, queue);
     }
 #endif
 
@@ -1376,7 +2104,83 @@ shared_ptr<InputInterface> AudioEnc::initialise_input()
     return input;
 }
 
-int main(int argc, char *argv[])
+/*! The backup input has its own queue, and does not go through the
+ * DriftCompensator. Missing samples are replaced by silence, and samples
+ * that do not fit in its queue of max_size bytes are dropped. */
+unique_ptr<SilenceAction> AudioEnc::initialise_silence_action(size_t max_size)
+{
+    if (not silence_fallback.empty()) {
+        return make_unique<FallbackWavAction>(silence_fallback, sample_rate,
+                channels, src_quality);
+    }
+    else if (silence_backup.empty()) {
+        return nullptr;
+    }
+
+    const size_t sep = silence_backup.find(':');
+    if (sep == string::npos) {
+        throw runtime_error("Invalid silence backup " + silence_backup);
+    }
+    const string type = silence_backup.substr(0, sep);
+    const string source = silence_backup.substr(sep + 1);
+
+    auto backup_queue = make_unique<SampleQueue<uint8_t> >(BYTES_PER_SAMPLE);
+    backup_queue->configure(max_size, false, channels);
+
+    shared_ptr<InputInterface> input;
+    if (type == "file") {
+        input = make_shared<FileInput>(source, raw_input, sample_rate, src_quality,
+                false, *backup_queue);
+    }
+#if HAVE_JACK
+    else if (type == "jack") {
+        input = make_shared<JackInput>(source, channels, sample_rate, src_quality,
+                *backup_queue);
+    }
+#endif
+#if HAVE_VLC
+    else if (type == "vlc") {
+        input = make_shared<VLCInput>(source, sample_rate, channels, verbosity,
+                vlc_cache, vlc_additional_opts, *backup_queue);
+    }
+#endif
+#if HAVE_GST
+    else if (type == "gst") {
+        input = make_shared<GSTInput>(source, "", sample_rate, channels, *backup_queue);
+    }
+#endif
+#if HAVE_ALSA
+    else if (type == "alsa") {
+        input = make_shared<AlsaInputThreaded>(source, channels, sample_rate,
+                src_quality, *backup_queue);
+    }
+#endif
+    else {
+        throw runtime_error("Unsupported silence backup " + silence_backup);
+    }
+
+    input->prepare();
+
+    return make_unique<BackupInputAction>(silence_backup, input, std::move(backup_queue));
+}
+
+/*! Options that apply to the whole process and cannot be
+ * given for individual services */
+struct process_options_t {
+    std::string startupcheck;
+    std::string services_file;
+
+    /* Whether options that configure an encoder were given */
+    bool service_options_given = false;
+};
+
+/*! Parse the options of one encoder into audio_enc. process_opts is
+ * nullptr when the options come from a line of the services file.
+ *
+ * \return true on success
+ */
+static bool parse_options(AudioEnc& audio_enc, int argc, char *argv[],
+        process_options_t *process_opts)
 {
     const struct option longopts[] = {
         {"bitrate",                required_argument,  0, 'b'},
@@ -1397,11 +2201,28 @@ int main(int argc, char *argv[])
         {"identifier",             required_argument,  0,  7 },
         {"input",                  required_argument,  0, 'i'},
         {"jack",                   required_argument,  0, 'j'},
+        {"jobs",                   required_argument,  0, 19 },
+        {"src-quality",            required_argument,  0, 20 },
+        {"realtime-priority",      required_argument,  0, 21 },
+        {"cpu-affinity",           required_argument,  0, 22 },
+        {"level-rms",              no_argument,        0, 23 },
+        {"level-true-peak",        no_argument,        0, 24 },
+        {"loudness",               no_argument,        0, 25 },
+        {"silence-level",          required_argument,  0, 26 },
+        {"silence-rms",            no_argument,        0, 27 },
+        {"silence-hysteresis",     required_argument,  0, 28 },
+        {"silence-after",          required_argument,  0, 29 },
+        {"silence-release",        required_argument,  0, 30 },
+        {"silence-backup",         required_argument,  0, 31 },
+        {"silence-fallback",       required_argument,  0, 32 },
+        {"complexity",             required_argument,  0, 34 },
         {"output",                 required_argument,  0, 'o'},
         {"pad",                    required_argument,  0, 'p'},
         {"pad-socket",             required_argument,  0, 'P'},
         {"rate",                   required_argument,  0, 'r'},
+        {"pipeline-depth",         required_argument,  0, 14 },
         {"secret-key",             required_argument,  0, 'k'},
+        {"services",               required_argument,  0, 13 },
         {"silence",                required_argument,  0, 's'},
         {"startup-check",          required_argument,  0,  9 },
         {"stats",                  required_argument,  0, 'S'},
@@ -1413,55 +2234,35 @@ int main(int argc, char *argv[])
         {"aaclc",                  no_argument,        0,  0 },
         {"dab",                    no_argument,        0, 'a'},
         {"drift-comp",             no_argument,        0, 'D'},
+        {"edi-gso",                no_argument,        0, 16 },
+        {"edi-txtime",             no_argument,        0, 17 },
         {"edi-verbose",            no_argument,        0, 12 },
         {"fifo-silence",           no_argument,        0,  3 },
         {"help",                   no_argument,        0, 'h'},
+        {"latency-stats",          no_argument,        0, 15 },
         {"level",                  no_argument,        0, 'l'},
         {"no-afterburner",         no_argument,        0, 'A'},
+        {"parallel-channels",      no_argument,        0, 18 },
         {"ps",                     no_argument,        0,  2 },
         {"restart",                no_argument,        0, 'R'},
         {"sbr",                    no_argument,        0,  1 },
+        {"scf-cache",              no_argument,        0, 33 },
         {"verbosity",              no_argument,        0, 'V'},
         {0, 0, 0, 0},
     };
 
-    if (argc == 2 and strcmp(argv[1], "--version") == 0) {
-        fprintf(stdout, "%s\n",
-#if defined(GITVERSION)
-                GITVERSION
-#else
-                PACKAGE_VERSION
-#endif
-               );
-        return 0;
-    }
-
-    fprintf(stderr,
-            "Welcome to %s %s, compiled at %s, %s",
-            PACKAGE_NAME,
-#if defined(GITVERSION)
-            GITVERSION,
-#else
-            PACKAGE_VERSION,
-#endif
-            __DATE__, __TIME__);
-    fprintf(stderr, "\n");
-    fprintf(stderr, "  http://opendigitalradio.org\n\n");
-
-
-    if (argc < 2) {
-        usage(argv[0]);
-        return 1;
-    }
-
-    AudioEnc audio_enc;
-
-    std::string startupcheck;
+    // Restart scanning, parse_options() is called once per service
+    optind = 0;
 
     int ch=0;
     int index;
     while(ch != -1) {
         ch = getopt_long(argc, argv, "aAhDlRVb:B:c:e:f:G:i:j:k:L:o:r:d:p:P:s:S:T:v:w:Wg:C:", longopts, &index);
+
+        if (process_opts and ch != -1 and ch != 9 and ch != 13) {
+            process_opts->service_options_given = true;
+        }
+
         switch (ch) {
         case 0: // AAC-LC
             audio_enc.aot = AOT_DABPLUS_AAC_LC;
@@ -1485,7 +2286,7 @@ int main(int argc, char *argv[])
                         audio_enc.dab_channel_mode == "m")) {
                 fprintf(stderr, "Invalid DAB channel mode\n");
                 usage(argv[0]);
-                return 1;
+                return false;
             }
             break;
         case 5: // DAB psy model
@@ -1501,7 +2302,7 @@ int main(int argc, char *argv[])
             if (audio_enc.identifier.size() > 32) {
                 fprintf(stderr, "Output Identifier too long!\n");
                 usage(argv[0]);
-                return 1;
+                return false;
             }
             break;
         case 8: // EDI output FEC
@@ -1510,8 +2311,123 @@ int main(int argc, char *argv[])
         case 12: // --edi-verbose
             audio_enc.edi_output.set_verbose(true);
             break;
+        case 16: // --edi-gso
+            audio_enc.edi_output.set_udp_gso(true);
+            break;
+        case 17: // --edi-txtime
+            audio_enc.edi_output.set_udp_txtime(true);
+            break;
         case 9: // --startup-check
-            startupcheck = optarg;
+            if (process_opts == nullptr) {
+                fprintf(stderr, "--startup-check can only be given on the command line\n");
+                return false;
+            }
+            process_opts->startupcheck = optarg;
+            break;
+        case 13: // --services
+            if (process_opts == nullptr) {
+                fprintf(stderr, "--services can only be given on the command line\n");
+                return false;
+            }
+            process_opts->services_file = optarg;
+            break;
+        case 14: // --pipeline-depth
+            {
+                const int depth = std::stoi(optarg);
+                if (depth < 1 or depth > 64) {
+                    fprintf(stderr, "Invalid pipeline depth (%d) given!\n", depth);
+                    return false;
+                }
+                audio_enc.pipeline_depth = depth;
+            }
+            break;
+        case 15: // --latency-stats
+            audio_enc.show_latency_stats = true;
+            break;
+        case 18: // --parallel-channels
+            audio_enc.parallel_channels = true;
+            break;
+        case 19: // --jobs
+            {
+                const int jobs = std::stoi(optarg);
+                if (jobs < 1 or jobs > 256) {
+                    fprintf(stderr, "Invalid number of jobs (%d) given!\n", jobs);
+                    return false;
+                }
+                audio_enc.offline_jobs = jobs;
+            }
+            break;
+        case 20: // --src-quality
+            if (not resampler_parse_quality(optarg, audio_enc.src_quality)) {
+                fprintf(stderr, "Invalid resampler quality '%s' given!\n", optarg);
+                return false;
+            }
+            break;
+        case 21: // --realtime-priority
+            audio_enc.realtime_priority = std::stoi(optarg);
+            if (audio_enc.realtime_priority < 1 or audio_enc.realtime_priority > 99) {
+                fprintf(stderr, "Invalid real-time priority (%d) given!\n", audio_enc.realtime_priority);
+                return false;
+            }
+            break;
+        case 22: // --cpu-affinity
+            audio_enc.cpu_affinity = optarg;
+            break;
+        case 23: // --level-rms
+            audio_enc.level_rms = true;
+            break;
+        case 24: // --level-true-peak
+            audio_enc.level_true_peak = true;
+            break;
+        case 25: // --loudness
+            audio_enc.measure_loudness = true;
+            break;
+        case 26: // --silence-level
+            audio_enc.silence_config.level_dBFS = std::stod(optarg);
+            if (audio_enc.silence_config.level_dBFS >= 0) {
+                fprintf(stderr, "Invalid silence level (%s) given!\n", optarg);
+                return false;
+            }
+            break;
+        case 27: // --silence-rms
+            audio_enc.silence_config.use_rms = true;
+            break;
+        case 28: // --silence-hysteresis
+            audio_enc.silence_config.hysteresis_dB = std::stod(optarg);
+            if (audio_enc.silence_config.hysteresis_dB < 0) {
+                fprintf(stderr, "Invalid silence hysteresis (%s) given!\n", optarg);
+                return false;
+            }
+            break;
+        case 29: // --silence-after
+            audio_enc.silence_after = std::stod(optarg);
+            if (not (audio_enc.silence_after > 0 and audio_enc.silence_after < 3600*24*30)) {
+                fprintf(stderr, "Invalid silence duration (%s) given!\n", optarg);
+                return false;
+            }
+            break;
+        case 30: // --silence-release
+            audio_enc.silence_config.release = std::stod(optarg);
+            if (not (audio_enc.silence_config.release >= 0)) {
+                fprintf(stderr, "Invalid silence release (%s) given!\n", optarg);
+                return false;
+            }
+            break;
+        case 31: // --silence-backup
+            audio_enc.silence_backup = optarg;
+            break;
+        case 32: // --silence-fallback
+            audio_enc.silence_fallback = optarg;
+            break;
+        case 33: // --scf-cache
+            audio_enc.scf_cache = true;
+            break;
+        case 34: // --complexity
+            audio_enc.complexity = std::stoi(optarg);
+            if (audio_enc.complexity < 0 or audio_enc.complexity > 3) {
+                fprintf(stderr, "Invalid complexity level (%s) given!\n", optarg);
+                return false;
+            }
             break;
         case 'a':
             audio_enc.selected_encoder = encoder_selection_t::toolame_dab;
@@ -1547,7 +2463,7 @@ int main(int argc, char *argv[])
             }
             else if (strcmp(optarg, "wav") != 0) {
                 usage(argv[0]);
-                return 1;
+                return false;
             }
             break;
         case 10:
@@ -1572,7 +2488,7 @@ int main(int argc, char *argv[])
             audio_enc.jack_name = optarg;
 #else
             fprintf(stderr, "JACK disabled at compile time!\n");
-            return 1;
+            return false;
 #endif
             break;
         case 'k':
@@ -1603,7 +2519,7 @@ int main(int argc, char *argv[])
             }
             else {
                 fprintf(stderr, "Invalid silence timeout (%d) given!\n", audio_enc.silence_timeout);
-                return 1;
+                return false;
             }
 
             break;
@@ -1629,7 +2545,7 @@ int main(int argc, char *argv[])
 #else
         case 'v':
             fprintf(stderr, "VLC input not enabled at compile time!\n");
-            return 1;
+            return false;
 #endif
         case 'V':
             audio_enc.verbosity++;
@@ -1637,13 +2553,224 @@ int main(int argc, char *argv[])
         case '?':
         case 'h':
             usage(argv[0]);
+            return false;
+        }
+    }
+
+    if (process_opts == nullptr and optind < argc) {
+        fprintf(stderr, "Unexpected argument '%s'\n", argv[optind]);
+        return false;
+    }
+
+    return true;
+}
+
+/*! Split one line of the services file into arguments. Arguments are
+ * separated by whitespace and can be quoted with single or double quotes.
+ * A # at the start of an argument begins a comment.
+ */
+static vector<string> split_services_line(const string& line)
+{
+    vector<string> args;
+    string current;
+    bool in_arg = false;
+    char quote = 0;
+
+    for (const char c : line) {
+        if (quote) {
+            if (c == quote) {
+                quote = 0;
+            }
+            else {
+                current += c;
+            }
+        }
+        else if (c == '"' or c == '\'') {
+            quote = c;
+            in_arg = true;
+        }
+        else if (isspace(c)) {
+            if (in_arg) {
+                args.push_back(current);
+                current.clear();
+                in_arg = false;
+            }
+        }
+        else if (c == '#' and not in_arg) {
+            break;
+        }
+        else {
+            current += c;
+            in_arg = true;
+        }
+    }
+
+    if (quote) {
+        throw runtime_error("unterminated quote");
+    }
+
+    if (in_arg) {
+        args.push_back(current);
+    }
+
+    return args;
+}
+
+/*! Encode all services listed in the services file, one encoder per line,
+ * each running in its own thread. The ZMQ context, the TAI clock and the
+ * EDI UDP socket are shared between all of them.
+ *
+ * When one service stops with an error, all others are stopped too, and the
+ * error is returned, so that the process supervisor can restart us.
+ */
+static int run_services(const string& services_file, char *progname)
+{
+    ifstream services_fd(services_file);
+    if (not services_fd) {
+        fprintf(stderr, "Failed to open services file '%s'\n", services_file.c_str());
+        return 1;
+    }
+
+    auto zmq_context = make_shared<zmq::context_t>();
+    auto clock_tai = make_shared<ClockTAI>(vector<string>{});
+    auto udp_socket = make_shared<Socket::UDPSocket>();
+
+    vector<unique_ptr<AudioEnc> > services;
+    vector<int> service_lines;
+
+    string line;
+    int line_nr = 0;
+    while (getline(services_fd, line)) {
+        line_nr++;
+
+        vector<string> args;
+        try {
+            args = split_services_line(line);
+        }
+        catch (const runtime_error& e) {
+            fprintf(stderr, "Services file line %d: %s\n", line_nr, e.what());
+            return 1;
+        }
+
+        if (args.empty()) {
+            continue;
+        }
+
+        vector<char*> service_argv;
+        service_argv.push_back(progname);
+        for (auto& arg : args) {
+            service_argv.push_back(&arg[0]);
+        }
+        service_argv.push_back(nullptr);
+
+        unique_ptr<AudioEnc> audio_enc(new AudioEnc());
+        if (not parse_options(*audio_enc, service_argv.size() - 1, service_argv.data(), nullptr)) {
+            fprintf(stderr, "Services file line %d: invalid options\n", line_nr);
             return 1;
         }
+
+        audio_enc->zmq_context = zmq_context;
+        audio_enc->edi_output.set_clock_tai(clock_tai);
+        audio_enc->edi_output.set_udp_socket(udp_socket);
+
+        services.push_back(move(audio_enc));
+        service_lines.push_back(line_nr);
+    }
+
+    if (services.empty()) {
+        fprintf(stderr, "No services defined in '%s'\n", services_file.c_str());
+        return 1;
     }
 
-    if (not startupcheck.empty()) {
-        etiLog.level(info) << "Running startup check '" << startupcheck << "'";
-        int wstatus = system(startupcheck.c_str());
+    fprintf(stderr, "Starting %zu services\n", services.size());
+
+    mutex finished_mutex;
+    condition_variable finished_cv;
+    size_t num_finished = 0;
+    int retval = 0;
+
+    vector<thread> threads;
+    for (size_t i = 0; i < services.size(); i++) {
+        threads.emplace_back([&, i]() {
+                int ret = 1;
+                try {
+                    ret = services[i]->run();
+                }
+                catch (const runtime_error& e) {
+                    fprintf(stderr, "Service on line %d failed: %s\n",
+                            service_lines[i], e.what());
+                }
+
+                fprintf(stderr, "Service on line %d stopped with %d\n",
+                        service_lines[i], ret);
+
+                lock_guard<mutex> lock(finished_mutex);
+                num_finished++;
+                if (retval == 0) {
+                    retval = ret;
+                }
+                finished_cv.notify_one();
+            });
+    }
+
+    {
+        unique_lock<mutex> lock(finished_mutex);
+        finished_cv.wait(lock, [&]() {
+                return retval != 0 or num_finished == services.size(); });
+    }
+
+    for (auto& audio_enc : services) {
+        audio_enc->stop_requested = true;
+    }
+
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    return retval;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc == 2 and strcmp(argv[1], "--version") == 0) {
+        fprintf(stdout, "%s\n",
+#if defined(GITVERSION)
+                GITVERSION
+#else
+                PACKAGE_VERSION
+#endif
+               );
+        return 0;
+    }
+
+    fprintf(stderr,
+            "Welcome to %s %s, compiled at %s, %s",
+            PACKAGE_NAME,
+#if defined(GITVERSION)
+            GITVERSION,
+#else
+            PACKAGE_VERSION,
+#endif
+            __DATE__, __TIME__);
+    fprintf(stderr, "\n");
+    fprintf(stderr, "  http://opendigitalradio.org\n\n");
+
+
+    if (argc < 2) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    AudioEnc audio_enc;
+    process_options_t process_opts;
+
+    if (not parse_options(audio_enc, argc, argv, &process_opts)) {
+        return 1;
+    }
+
+    if (not process_opts.startupcheck.empty()) {
+        etiLog.level(info) << "Running startup check '" << process_opts.startupcheck << "'";
+        int wstatus = system(process_opts.startupcheck.c_str());
 
         if (WIFEXITED(wstatus)) {
             if (WEXITSTATUS(wstatus) == 0) {
@@ -1660,6 +2787,15 @@ int main(int argc, char *argv[])
         }
     }
 
+    if (not process_opts.services_file.empty()) {
+        if (process_opts.service_options_given) {
+            fprintf(stderr, "With --services, all encoder options must be given in the services file\n");
+            return 1;
+        }
+
+        return run_services(process_opts.services_file, argv[0]);
+    }
+
     try {
         return audio_enc.run();
     }
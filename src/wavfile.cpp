@@ -17,27 +17,57 @@
  * -------------------------------------------------------------------
  */
 
+#include "config.h"
 #include "wavfile.h"
+#include "PcmConvert.h"
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <cstdint>
 #include <stdexcept>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #define TAG(a, b, c, d) (((a) << 24) | ((b) << 16) | ((c) << 8) | (d))
 
+/* When reading from a memory mapping, the pages that have been read are
+ * given back to the kernel in blocks of this size, so that the resident
+ * size does not grow with the file. */
+#define WAV_RELEASE_BLOCK (16 * 1024 * 1024)
+
 struct wav_reader {
-    FILE *wav;
-    uint32_t data_length;
+    FILE *wav = nullptr;
+
+    /* The whole file, if it could be mapped. The audio data is then
+     * read from the mapping instead of wav. */
+    const uint8_t *map = nullptr;
+    size_t map_size = 0;
+    /* Start of the part of the mapping that was not released yet */
+    uint64_t map_released = 0;
+
+    /* Position and size of the data chunk. For a streamed file, the
+     * size is unknown and data_size is UINT64_MAX. */
+    uint64_t data_pos = 0;
+    uint64_t data_size = 0;
+    /* Read position relative to data_pos */
+    uint64_t read_pos = 0;
 
-    int format;
-    int sample_rate;
-    int bits_per_sample;
-    int channels;
-    int byte_rate;
-    int block_align;
+    int format = 0;
+    int sample_rate = 0;
+    int bits_per_sample = 0;
+    int channels = 0;
+    int byte_rate = 0;
+    int block_align = 0;
 
-    int streamed;
+    int streamed = 0;
+    int found_data = 0;
+    /* Regular files can be mapped and seeked in */
+    int seekable = 0;
+
+    /* For wav_read_s16() on unmapped files */
+    std::vector<uint8_t> convert_buf;
 };
 
 static uint32_t read_tag(struct wav_reader* wr) {
@@ -58,6 +88,12 @@ static uint32_t read_int32(struct wav_reader* wr) {
     return value;
 }
 
+static uint64_t read_int64(struct wav_reader* wr) {
+    uint64_t value = read_int32(wr);
+    value |= (uint64_t)read_int32(wr) << 32;
+    return value;
+}
+
 static uint16_t read_int16(struct wav_reader* wr) {
     uint16_t value = 0;
     value |= fgetc(wr->wav) << 0;
@@ -65,108 +101,180 @@ static uint16_t read_int16(struct wav_reader* wr) {
     return value;
 }
 
-static void skip(FILE *f, int n) {
-    int i;
-    for (i = 0; i < n; i++)
-        fgetc(f);
+static void skip(struct wav_reader* wr, uint64_t n) {
+    if (!wr->seekable) {
+        for (uint64_t i = 0; i < n; i++)
+            fgetc(wr->wav);
+    }
+    else {
+        fseeko(wr->wav, n, SEEK_CUR);
+    }
+}
+
+/* Parse the chunks of a RIFF or RF64 file, up to the data chunk.
+ * length is the size of the RIFF chunk after the WAVE tag. */
+static void read_riff_chunks(struct wav_reader* wr, uint64_t length, int rf64) {
+    uint64_t ds64_data_size = 0;
+
+    while (length >= 8) {
+        uint32_t subtag, sublength32;
+        uint64_t sublength;
+        subtag = read_tag(wr);
+        if (feof(wr->wav))
+            break;
+        sublength32 = read_int32(wr);
+        sublength = sublength32;
+        length -= 8;
+        if (subtag == TAG('d', 'a', 't', 'a') && rf64 && sublength32 == 0xffffffff)
+            sublength = ds64_data_size;
+        if (length < sublength && !wr->streamed)
+            break;
+        if (subtag == TAG('d', 's', '6', '4') && rf64) {
+            if (sublength < 24)
+                break;
+            read_int64(wr); // RIFF size
+            ds64_data_size = read_int64(wr);
+            read_int64(wr); // sample count
+            skip(wr, sublength - 24);
+        } else if (subtag == TAG('f', 'm', 't', ' ')) {
+            if (sublength < 16) {
+                // Insufficient data for 'fmt '
+                break;
+            }
+            wr->format          = read_int16(wr);
+            wr->channels        = read_int16(wr);
+            wr->sample_rate     = read_int32(wr);
+            wr->byte_rate       = read_int32(wr);
+            wr->block_align     = read_int16(wr);
+            wr->bits_per_sample = read_int16(wr);
+            if (wr->format == 0xfffe) {
+                if (sublength < 28) {
+                    // Insufficient data for waveformatex
+                    break;
+                }
+                skip(wr, 8);
+                wr->format = read_int32(wr);
+                skip(wr, sublength - 28);
+            } else {
+                skip(wr, sublength - 16);
+            }
+        } else if (subtag == TAG('d', 'a', 't', 'a')) {
+            wr->found_data = 1;
+            wr->data_size = sublength;
+            if (!sublength || wr->streamed) {
+                wr->streamed = 1;
+                wr->data_size = UINT64_MAX;
+            }
+            if (wr->streamed || !wr->seekable) {
+                // Start reading the audio data right here
+                return;
+            }
+            wr->data_pos = ftello(wr->wav);
+            skip(wr, sublength);
+        } else {
+            skip(wr, sublength);
+        }
+        // Chunks are aligned to two bytes
+        if (sublength & 1) {
+            skip(wr, 1);
+            sublength++;
+        }
+        length = (length > sublength) ? length - sublength : 0;
+    }
+}
+
+/* Map the file, if it is a regular file. A streamed header is replaced
+ * by the size of the file, and a truncated file is handled like a shorter
+ * one. */
+static void map_file(struct wav_reader* wr) {
+    struct stat st;
+    if (fstat(fileno(wr->wav), &st) != 0)
+        return;
+
+    const uint64_t file_size = st.st_size;
+    if (wr->data_pos > file_size)
+        return;
+    wr->data_size = std::min(wr->data_size, file_size - wr->data_pos);
+    wr->streamed = 0;
+
+    if (file_size == 0 || file_size > SIZE_MAX)
+        return;
+
+    void *map = mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fileno(wr->wav), 0);
+    if (map == MAP_FAILED) {
+        // For instance if the address space is too small, read with stdio
+        return;
+    }
+    madvise(map, file_size, MADV_SEQUENTIAL);
+    wr->map = (const uint8_t*)map;
+    wr->map_size = file_size;
 }
 
 void* wav_read_open(const char *filename) {
-    struct wav_reader* wr = (struct wav_reader*) malloc(sizeof(*wr));
-    long data_pos = 0;
-    memset(wr, 0, sizeof(*wr));
+    struct wav_reader* wr = new wav_reader();
 
     if (!strcmp(filename, "-"))
         wr->wav = stdin;
     else
         wr->wav = fopen(filename, "rb");
     if (wr->wav == NULL) {
-        free(wr);
+        delete wr;
         return NULL;
     }
 
+    struct stat st;
+    wr->seekable = fstat(fileno(wr->wav), &st) == 0 && S_ISREG(st.st_mode);
+
     while (1) {
         uint32_t tag, tag2, length;
         tag = read_tag(wr);
         if (feof(wr->wav))
             break;
         length = read_int32(wr);
-        if (!length || length >= 0x7fff0000) {
+        const int rf64 = (tag == TAG('R', 'F', '6', '4'));
+        if (rf64) {
+            // The real size is in the ds64 chunk
+            length = 0xffffffff;
+        }
+        else if (!length || length >= 0x7fff0000) {
             wr->streamed = 1;
             length = ~0;
         }
-        if (tag != TAG('R', 'I', 'F', 'F') || length < 4) {
-            fseek(wr->wav, length, SEEK_CUR);
+        if ((tag != TAG('R', 'I', 'F', 'F') && !rf64) || length < 4) {
+            skip(wr, length);
             continue;
         }
         tag2 = read_tag(wr);
         length -= 4;
         if (tag2 != TAG('W', 'A', 'V', 'E')) {
-            fseek(wr->wav, length, SEEK_CUR);
+            skip(wr, length);
             continue;
         }
-        // RIFF chunk found, iterate through it
-        while (length >= 8) {
-            uint32_t subtag, sublength;
-            subtag = read_tag(wr);
-            if (feof(wr->wav))
-                break;
-            sublength = read_int32(wr);
-            length -= 8;
-            if (length < sublength)
-                break;
-            if (subtag == TAG('f', 'm', 't', ' ')) {
-                if (sublength < 16) {
-                    // Insufficient data for 'fmt '
-                    break;
-                }
-                wr->format          = read_int16(wr);
-                wr->channels        = read_int16(wr);
-                wr->sample_rate     = read_int32(wr);
-                wr->byte_rate       = read_int32(wr);
-                wr->block_align     = read_int16(wr);
-                wr->bits_per_sample = read_int16(wr);
-                if (wr->format == 0xfffe) {
-                    if (sublength < 28) {
-                        // Insufficient data for waveformatex
-                        break;
-                    }
-                    skip(wr->wav, 8);
-                    wr->format = read_int32(wr);
-                    skip(wr->wav, sublength - 28);
-                } else {
-                    skip(wr->wav, sublength - 16);
-                }
-            } else if (subtag == TAG('d', 'a', 't', 'a')) {
-                data_pos = ftell(wr->wav);
-                wr->data_length = sublength;
-                if (!wr->data_length || wr->streamed) {
-                    wr->streamed = 1;
-                    return wr;
-                }
-                fseek(wr->wav, sublength, SEEK_CUR);
-            } else {
-                skip(wr->wav, sublength);
-            }
-            length -= sublength;
-        }
-        if (length > 0) {
-            // Bad chunk?
-            fseek(wr->wav, length, SEEK_CUR);
-        }
+        read_riff_chunks(wr, rf64 ? UINT64_MAX : length, rf64);
+        break;
     }
-    fseek(wr->wav, data_pos, SEEK_SET);
+
+    if (!wr->found_data || !wr->seekable)
+        return wr;
+
+    if (wr->streamed)
+        wr->data_pos = ftello(wr->wav);
+    map_file(wr);
+    if (!wr->map)
+        fseeko(wr->wav, wr->data_pos, SEEK_SET);
     return wr;
 }
 
 void wav_read_close(void* obj) {
     struct wav_reader* wr = (struct wav_reader*) obj;
+    if (wr->map)
+        munmap((void*)wr->map, wr->map_size);
     if (wr->wav != stdin)
         fclose(wr->wav);
-    free(wr);
+    delete wr;
 }
 
-int wav_get_header(void* obj, int* format, int* channels, int* sample_rate, int* bits_per_sample, unsigned int* data_length) {
+int wav_get_header(void* obj, int* format, int* channels, int* sample_rate, int* bits_per_sample, uint64_t* data_length) {
     struct wav_reader* wr = (struct wav_reader*) obj;
     if (format)
         *format = wr->format;
@@ -177,22 +285,115 @@ int wav_get_header(void* obj, int* format, int* channels, int* sample_rate, int*
     if (bits_per_sample)
         *bits_per_sample = wr->bits_per_sample;
     if (data_length)
-        *data_length = wr->data_length;
+        *data_length = wr->data_size;
     return wr->format && wr->sample_rate;
 }
 
+/* Bytes that can still be read, limited to length */
+static uint64_t available(struct wav_reader* wr, uint64_t length) {
+    if (wr->streamed)
+        return length;
+    return std::min(length, wr->data_size - wr->read_pos);
+}
+
+/* Give the pages before the read position back to the kernel */
+static void release_pages(struct wav_reader* wr) {
+    const uint64_t pos = wr->data_pos + wr->read_pos;
+    if (pos < wr->map_released + WAV_RELEASE_BLOCK)
+        return;
+    const uint64_t end = pos & ~(uint64_t)(WAV_RELEASE_BLOCK - 1);
+    madvise((void*)(wr->map + wr->map_released), end - wr->map_released, MADV_DONTNEED);
+    wr->map_released = end;
+}
+
 int wav_read_data(void* obj, unsigned char* data, unsigned int length) {
     struct wav_reader* wr = (struct wav_reader*) obj;
-    int n;
     if (wr->wav == NULL)
         return -1;
-    if (length > wr->data_length && !wr->streamed)
-        length = wr->data_length;
-    n = fread(data, 1, length, wr->wav);
-    wr->data_length -= length;
+    const uint64_t n = available(wr, length);
+    if (wr->map) {
+        memcpy(data, wr->map + wr->data_pos + wr->read_pos, n);
+        wr->read_pos += n;
+        release_pages(wr);
+        return n;
+    }
+    const size_t ret = fread(data, 1, n, wr->wav);
+    wr->read_pos += ret;
+    return ret;
+}
+
+static int get_pcm_format(struct wav_reader* wr, pcm_format_t* pcm_format) {
+    if (wr->format == 1) {
+        switch (wr->bits_per_sample) {
+            case 16: *pcm_format = pcm_format_t::S16; return 1;
+            case 24: *pcm_format = pcm_format_t::S24; return 1;
+            case 32: *pcm_format = pcm_format_t::S32; return 1;
+        }
+    }
+    else if (wr->format == 3) {
+        switch (wr->bits_per_sample) {
+            case 32: *pcm_format = pcm_format_t::F32; return 1;
+            case 64: *pcm_format = pcm_format_t::F64; return 1;
+        }
+    }
+    return 0;
+}
+
+int wav_s16_supported(void* obj) {
+    struct wav_reader* wr = (struct wav_reader*) obj;
+    pcm_format_t pcm_format;
+    return get_pcm_format(wr, &pcm_format) &&
+        wr->block_align == wr->channels * wr->bits_per_sample / 8;
+}
+
+int wav_read_s16(void* obj, int16_t* data, unsigned int num_samples) {
+    struct wav_reader* wr = (struct wav_reader*) obj;
+    pcm_format_t pcm_format;
+    if (wr->wav == NULL || !get_pcm_format(wr, &pcm_format))
+        return -1;
+    const size_t sample_size = pcm_sample_size(pcm_format);
+
+    if (wr->map) {
+        const uint64_t n = available(wr, (uint64_t)num_samples * sample_size) / sample_size;
+        pcm_convert_to_s16(pcm_format, wr->map + wr->data_pos + wr->read_pos, data, n);
+        wr->read_pos += n * sample_size;
+        release_pages(wr);
+        return n;
+    }
+
+    if (pcm_format == pcm_format_t::S16) {
+        const int ret = wav_read_data(obj, (unsigned char*)data, num_samples * sample_size);
+        return ret < 0 ? ret : ret / 2;
+    }
+
+    wr->convert_buf.resize(num_samples * sample_size);
+    const int ret = wav_read_data(obj, wr->convert_buf.data(), wr->convert_buf.size());
+    if (ret < 0)
+        return ret;
+    const size_t n = ret / sample_size;
+    pcm_convert_to_s16(pcm_format, wr->convert_buf.data(), data, n);
     return n;
 }
 
+int wav_read_seek(void* obj, uint64_t frame) {
+    struct wav_reader* wr = (struct wav_reader*) obj;
+    if (wr->wav == NULL || !wr->seekable || wr->streamed || wr->block_align <= 0)
+        return 0;
+    const uint64_t offset = frame * wr->block_align;
+    if (offset > wr->data_size)
+        return 0;
+    if (wr->map) {
+        // Pages that were released are read again from the page cache
+        wr->map_released = std::min(wr->map_released,
+                (wr->data_pos + offset) & ~(uint64_t)(WAV_RELEASE_BLOCK - 1));
+    }
+    else if (fseeko(wr->wav, wr->data_pos + offset, SEEK_SET) != 0) {
+        return 0;
+    }
+    wr->read_pos = offset;
+    return 1;
+}
+
 //============== WAV writer functions
 
 struct wavfile_header {
@@ -22,12 +22,31 @@
 #include <cstdio>
 #include <cstdint>
 
+/* The reader maps regular files in memory, and reads other files, like
+ * stdin, with stdio. RIFF and RF64 files are supported. The data length
+ * of a RIFF file that was written without knowing its final size is taken
+ * from the size of the file. */
 void* wav_read_open(const char *filename);
 void wav_read_close(void* obj);
 
-int wav_get_header(void* obj, int* format, int* channels, int* sample_rate, int* bits_per_sample, unsigned int* data_length);
+/* data_length is in bytes, and UINT64_MAX if unknown */
+int wav_get_header(void* obj, int* format, int* channels, int* sample_rate, int* bits_per_sample, uint64_t* data_length);
+
+/* Read up to length bytes of audio data, in the format of the file */
 int wav_read_data(void* obj, unsigned char* data, unsigned int length);
 
+/* Returns 1 if wav_read_s16() can convert the format of the file. These
+ * are 16, 24 and 32-bit integer PCM, and 32 and 64-bit float. */
+int wav_s16_supported(void* obj);
+
+/* Read up to num_samples samples, converted to 16-bit. Returns the number
+ * of samples read, or -1 on error. */
+int wav_read_s16(void* obj, int16_t* data, unsigned int num_samples);
+
+/* Move to the given sample frame. Only possible for files that are not
+ * streamed. Returns 1 on success. */
+int wav_read_seek(void* obj, uint64_t frame);
+
 class WavWriter {
     public:
         WavWriter(const char *filename);
@@ -0,0 +1,306 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+
+/* Checks that the steady-state paths of the main loop do not allocate.
+ *
+ * The global operator new and operator delete are replaced by counting
+ * versions, and on glibc malloc() too, so that the allocations of the C
+ * code in libtoolame-dab are seen as well. For every input, the test
+ * runs the PAD request, FileInput::read_source(), the Layer II encoder
+ * and the re-framing for some frames of warm-up, and then asserts that
+ * the following frames do not allocate at all. */
+
+#include "test.h"
+#include "PadInterface.h"
+#include "FileInput.h"
+#include "Layer2Reframer.h"
+#include "SampleQueue.h"
+#include "common.h"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+extern "C" {
+#include "libtoolame-dab/toolame.h"
+}
+
+using namespace std;
+
+static atomic<bool> counting(false);
+static atomic<size_t> num_new(0);
+static atomic<size_t> num_malloc(0);
+
+#if defined(__GLIBC__)
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t nmemb, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void __libc_free(void *ptr);
+
+void *malloc(size_t size) noexcept
+{
+    if (counting) num_malloc++;
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size) noexcept
+{
+    if (counting) num_malloc++;
+    return __libc_calloc(nmemb, size);
+}
+
+void *realloc(void *ptr, size_t size) noexcept
+{
+    if (counting) num_malloc++;
+    return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr) noexcept
+{
+    __libc_free(ptr);
+}
+}
+
+/* operator new is counted on its own, not as a malloc() */
+static void *raw_alloc(size_t size) { return __libc_malloc(size ? size : 1); }
+#else
+static void *raw_alloc(size_t size) { return std::malloc(size ? size : 1); }
+#endif
+
+void *operator new(size_t size)
+{
+    if (counting) num_new++;
+    void *p = raw_alloc(size);
+    if (p == nullptr) {
+        throw bad_alloc();
+    }
+    return p;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(size_t size, const nothrow_t&) noexcept
+{
+    if (counting) num_new++;
+    return raw_alloc(size);
+}
+
+void *operator new[](size_t size, const nothrow_t&) noexcept
+{
+    return operator new(size, nothrow);
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+void operator delete[](void *p, size_t) noexcept { std::free(p); }
+
+static const int sample_rate = 48000;
+static const int channels = 2;
+static const int bitrate = 128;
+static const int padlen = 58;
+static const size_t frame_bytes = 1152 * channels * BYTES_PER_SAMPLE;
+
+static const int warmup_frames = 50;
+static const int counted_frames = 500;
+
+#define MESSAGE_REQUEST 1
+#define MESSAGE_PAD_DATA 2
+
+/* Stands in for ODR-PadEnc: answers every request with padlen bytes */
+class FakePadEnc {
+    public:
+        FakePadEnc(const string& pad_ident)
+        {
+            m_sock = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+            memset(&m_addr, 0, sizeof(m_addr));
+            m_addr.sun_family = AF_UNIX;
+            snprintf(m_addr.sun_path, sizeof(m_addr.sun_path), "/tmp/%s.padenc",
+                    pad_ident.c_str());
+            unlink(m_addr.sun_path);
+            if (::bind(m_sock, (const struct sockaddr*)&m_addr, sizeof(m_addr)) == -1) {
+                throw runtime_error("FakePadEnc bind failed");
+            }
+
+            memset(&m_encoder_addr, 0, sizeof(m_encoder_addr));
+            m_encoder_addr.sun_family = AF_UNIX;
+            snprintf(m_encoder_addr.sun_path, sizeof(m_encoder_addr.sun_path),
+                    "/tmp/%s.audioenc", pad_ident.c_str());
+        }
+
+        ~FakePadEnc()
+        {
+            ::close(m_sock);
+            unlink(m_addr.sun_path);
+            unlink(m_encoder_addr.sun_path);
+        }
+
+        /* Queue one PAD message for the encoder, and drop the requests */
+        void send_pad(uint8_t counter)
+        {
+            uint8_t request[2];
+            while (::recv(m_sock, request, sizeof(request), MSG_DONTWAIT) > 0) {
+            }
+
+            uint8_t message[padlen + 2];
+            message[0] = MESSAGE_PAD_DATA;
+            memset(message + 1, counter, padlen);
+            message[padlen + 1] = padlen; // X-PAD length
+            ::sendto(m_sock, message, sizeof(message), 0,
+                    (const struct sockaddr*)&m_encoder_addr, sizeof(m_encoder_addr));
+        }
+
+    private:
+        int m_sock = -1;
+        struct sockaddr_un m_addr;
+        struct sockaddr_un m_encoder_addr;
+};
+
+static void write_le(FILE *fd, uint32_t value, int bytes)
+{
+    for (int i = 0; i < bytes; i++) {
+        fputc((value >> (8 * i)) & 0xFF, fd);
+    }
+}
+
+/* Write a 16-bit stereo file of random samples, with a wav header unless
+ * raw is set */
+static void write_input(const string& filename, bool raw, int rate, size_t frames)
+{
+    FILE *fd = fopen(filename.c_str(), "wb");
+    if (fd == nullptr) {
+        throw runtime_error("Cannot create " + filename);
+    }
+
+    const uint32_t data_len = frames * channels * BYTES_PER_SAMPLE;
+    if (not raw) {
+        fwrite("RIFF", 1, 4, fd);
+        write_le(fd, 36 + data_len, 4);
+        fwrite("WAVEfmt ", 1, 8, fd);
+        write_le(fd, 16, 4);
+        write_le(fd, 1, 2); // PCM
+        write_le(fd, channels, 2);
+        write_le(fd, rate, 4);
+        write_le(fd, rate * channels * BYTES_PER_SAMPLE, 4);
+        write_le(fd, channels * BYTES_PER_SAMPLE, 2);
+        write_le(fd, 16, 2);
+        fwrite("data", 1, 4, fd);
+        write_le(fd, data_len, 4);
+    }
+
+    mt19937 gen(42);
+    uniform_int_distribution<int> dist(-8000, 8000);
+    for (size_t i = 0; i < frames * channels; i++) {
+        write_le(fd, (uint16_t)dist(gen), 2);
+    }
+    fclose(fd);
+}
+
+static void run(const char *title, const string& filename, bool raw, int file_rate)
+{
+    const int total_frames = warmup_frames + counted_frames;
+    write_input(filename, raw, file_rate,
+            (size_t)total_frames * 1152 * file_rate / sample_rate + 4096);
+
+    const string pad_ident = "odr-audioenc-alloc-test-" + to_string(getpid());
+    FakePadEnc padenc(pad_ident);
+    PadInterface pad_intf;
+    pad_intf.open(pad_ident);
+
+    SampleQueue<uint8_t> queue(BYTES_PER_SAMPLE);
+    queue.configure(4 * frame_bytes, false, channels);
+
+    FileInput input(filename, raw, sample_rate, resampler_quality_t::Medium,
+            false, queue);
+    input.prepare();
+
+    toolame_context_t *toolame = toolame_create();
+    CHECK(toolame != nullptr);
+    CHECK(toolame_set_samplerate(toolame, sample_rate) == 0);
+    CHECK(toolame_set_psy_model(toolame, 1) == 0);
+    CHECK(toolame_set_channel_mode(toolame, 'j') == 0);
+    CHECK(toolame_set_bitrate(toolame, bitrate) == 0);
+    CHECK(toolame_set_pad(toolame, padlen) == 0);
+
+    const size_t outbuf_size = 4092;
+    vector<uint8_t> outbuf(outbuf_size);
+    Layer2Reframer reframer(3 * bitrate, outbuf_size);
+    vector<uint8_t> frames(reframer.max_output());
+
+    vector<uint8_t> pad_data(padlen + 1);
+    vector<uint8_t> input_buf(frame_bytes);
+    size_t num_output_frames = 0;
+
+    for (int frame = 0; frame < total_frames; frame++) {
+        if (frame == warmup_frames) {
+            num_new = 0;
+            num_malloc = 0;
+            counting = true;
+        }
+
+        padenc.send_pad(frame);
+        pad_intf.request(padlen, pad_data);
+        CHECK(pad_data.size() == padlen + 1u);
+
+        CHECK(input.read_source(frame_bytes));
+        CHECK(queue.pop(input_buf.data(), frame_bytes) == frame_bytes);
+
+        short input_buffers[2][1152];
+        for (int i = 0; i < 1152; i++) {
+            input_buffers[0][i] = input_buf[4*i]   | (input_buf[4*i+1] << 8);
+            input_buffers[1][i] = input_buf[4*i+2] | (input_buf[4*i+3] << 8);
+        }
+
+        const int num_out_bytes = toolame_encode_frame(toolame, input_buffers,
+                pad_data.data(), pad_data[padlen], outbuf.data(), outbuf.size());
+        CHECK(num_out_bytes >= 0);
+        if (num_out_bytes > 0) {
+            num_output_frames += reframer.push(outbuf.data(), num_out_bytes,
+                    frames.data());
+        }
+    }
+    counting = false;
+
+    printf("%-24s %zu frames out, %zu new, %zu malloc in %d frames\n",
+            title, num_output_frames, num_new.load(), num_malloc.load(),
+            counted_frames);
+    CHECK(num_output_frames > 0);
+    CHECK(num_new == 0);
+    CHECK(num_malloc == 0);
+
+    toolame_destroy(toolame);
+    unlink(filename.c_str());
+}
+
+int main()
+{
+    const string prefix = "/tmp/odr-audioenc-alloc-test-" + to_string(getpid());
+    run("raw file", prefix + ".raw", true, sample_rate);
+    run("wav file", prefix + ".wav", false, sample_rate);
+    run("resampled wav file", prefix + "-44k.wav", false, 44100);
+
+    return test::result();
+}
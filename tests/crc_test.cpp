@@ -0,0 +1,321 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+
+/* Checks the table-driven CRC code against the code it replaced:
+ *
+ *  - the byte-wise table loops of contrib/crc.c, for crc8, crc16 (EDI) and
+ *    crc32, through the slicing-by-8 and the PCLMULQDQ paths;
+ *  - the bit-wise loops of toolame's update_CRC() and update_CRCDAB(), for
+ *    all field widths;
+ *  - FDKcrcStartReg() and FDKcrcEndReg() of fdk-aac, which generates its
+ *    own slicing-by-8 tables, for all its polynomials. The table of the
+ *    DAB+ firecode holds 0x782f although it is set up with 0x782d. */
+
+#include "test.h"
+#include "crc.h"
+#include "CrcEngine.h"
+#include "FDK_crc.h"
+#include <array>
+
+extern "C" {
+void update_CRC(unsigned int data, unsigned int length, unsigned int *crc);
+void update_CRCDAB(unsigned int data, unsigned int length, unsigned int *crc);
+}
+
+using namespace std;
+
+/* The tables the removed code held as constants */
+template<typename T>
+static array<T, 256> make_table(T poly)
+{
+    const unsigned width = 8 * sizeof(T);
+    const T top = (T)1 << (width - 1);
+    array<T, 256> table;
+    for (unsigned i = 0; i < 256; i++) {
+        T c = (T)(i << (width - 8));
+        for (int j = 0; j < 8; j++) {
+            c = (c & top) ? (T)((c << 1) ^ poly) : (T)(c << 1);
+        }
+        table[i] = c;
+    }
+    return table;
+}
+
+static const auto crc8tab = make_table<uint8_t>(0x07);
+static const auto crc16tab = make_table<uint16_t>(0x1021);
+static const auto crc32tab = make_table<uint32_t>(0x04c11db7);
+
+/* The loops of the removed contrib/crc.c */
+static uint8_t crc8_reference(uint8_t l_crc, const void *lp_data, unsigned l_nb)
+{
+    const uint8_t* data = (const uint8_t*)lp_data;
+    while (l_nb--) {
+        l_crc = crc8tab[l_crc ^ *(data++)];
+    }
+    return (l_crc);
+}
+
+static uint16_t crc16_reference(uint16_t l_crc, const void *lp_data, unsigned l_nb)
+{
+    const uint8_t* data = (const uint8_t*)lp_data;
+    while (l_nb--) {
+        l_crc =
+            (l_crc << 8) ^ crc16tab[(l_crc >> 8) ^ *(data++)];
+    }
+    return (l_crc);
+}
+
+static uint32_t crc32_reference(uint32_t l_crc, const void *lp_data, unsigned l_nb)
+{
+    const uint8_t* data = (const uint8_t*)lp_data;
+    while (l_nb--) {
+        l_crc =
+            (l_crc << 8) ^ crc32tab[((l_crc >> 24) ^ *(data++)) & 0xff];
+    }
+    return (l_crc);
+}
+
+/* The removed bodies of toolame's update_CRC() and update_CRCDAB() */
+static void update_CRC_reference(unsigned int data, unsigned int length,
+        unsigned int *crc)
+{
+    unsigned int masking, carry;
+
+    masking = 1 << length;
+
+    while ((masking >>= 1)) {
+        carry = *crc & 0x8000;
+        *crc <<= 1;
+        if (!carry ^ !(data & masking))
+            *crc ^= 0x8005;
+    }
+    *crc &= 0xffff;
+}
+
+static void update_CRCDAB_reference(unsigned int data, unsigned int length,
+        unsigned int *crc)
+{
+    unsigned int masking, carry;
+
+    masking = 1 << length;
+
+    while ((masking >>= 1)) {
+        carry = *crc & 0x80;
+        *crc <<= 1;
+        if (!carry ^ !(data & masking))
+            *crc ^= 0x1d;
+    }
+    *crc &= 0xff;
+}
+
+template<typename T, typename Engine, typename Ref>
+static void check_bytes(const char *name, Ref reference, mt19937& gen)
+{
+    uniform_int_distribution<uint32_t> dist;
+    const auto data = test::random_bytes(gen, 1100 + 8);
+
+    int mismatches = 0;
+    for (size_t len = 0; len <= 1100; len++) {
+        for (size_t offset = 0; offset < 8; offset += 3) {
+            const T reg = (T)dist(gen);
+            const uint8_t *p = data.data() + offset;
+            const T expected = reference(reg, p, len);
+
+            if (Engine::updateTable(reg, p, len) != expected) mismatches++;
+            if (Engine::update(reg, p, len) != expected) mismatches++;
+#if defined(CRC_ENGINE_PCLMUL)
+            if (Engine::haveClmul() and len >= 16 and
+                    Engine::updateClmul(reg, p, len) != expected) {
+                mismatches++;
+            }
+#endif
+        }
+    }
+
+    printf("%-8s %d mismatches%s\n", name, mismatches,
+            Engine::haveClmul() ? "" : " (no PCLMULQDQ on this CPU)");
+    CHECK(mismatches == 0);
+}
+
+static void check_bits(mt19937& gen)
+{
+    uniform_int_distribution<uint32_t> dist;
+
+    int mismatches = 0;
+    for (unsigned length = 1; length <= 16; length++) {
+        for (int i = 0; i < 2000; i++) {
+            const unsigned int data = dist(gen);
+            const unsigned int reg = dist(gen);
+
+            unsigned int crc = reg & 0xffff, expected = reg & 0xffff;
+            update_CRC(data, length, &crc);
+            update_CRC_reference(data, length, &expected);
+            if (crc != expected) mismatches++;
+
+            crc = reg & 0xff;
+            expected = reg & 0xff;
+            update_CRCDAB(data, length, &crc);
+            update_CRCDAB_reference(data, length, &expected);
+            if (crc != expected) mismatches++;
+        }
+    }
+
+    printf("%-8s %d mismatches\n", "toolame", mismatches);
+    CHECK(mismatches == 0);
+}
+
+/* One shift register step of the removed calcCrc_Bits() */
+static uint16_t fdk_bit(uint16_t crc, uint16_t mask, uint16_t poly, int bit)
+{
+    uint16_t tmp = bit ^ ((crc & mask) ? 1 : 0);
+    return (uint16_t)(crc << 1) ^ (tmp ? poly : 0);
+}
+
+/* The removed crcCalc() of FDK_crc.cpp, over the bits of buf from
+ * position start. The table of a polynomial gives eight steps of the bit
+ * loop with table_poly, which differs from poly for the firecode only. */
+static uint16_t fdk_reference(uint16_t poly, uint16_t table_poly,
+        uint16_t start_value, const vector<uint8_t>& buf, int start,
+        int cnt_bits, int max_bits)
+{
+    const uint16_t mask = 0x8000;
+    auto bit_at = [&](int pos) { return (buf[pos >> 3] >> (7 - (pos & 7))) & 1; };
+
+    uint16_t crc = start_value;
+    int rBits = (max_bits >= 0) ? max_bits : -max_bits;
+    int bits;
+    if ((max_bits > 0) && ((cnt_bits >> 3 << 3) < rBits)) {
+        bits = cnt_bits;
+    }
+    else {
+        bits = rBits;
+    }
+
+    int pos = start;
+    for (int i = 0; i < (bits >> 3) * 8; i++) {
+        crc = fdk_bit(crc, mask, table_poly, bit_at(pos++));
+    }
+    for (int i = 0; i < (bits & 7); i++) {
+        crc = fdk_bit(crc, mask, poly, bit_at(pos++));
+    }
+    rBits -= bits;
+
+    if (rBits > 8) {
+        for (int i = 0; i < (rBits >> 3) * 8; i++) {
+            crc = fdk_bit(crc, mask, table_poly, 0);
+        }
+        rBits &= 7;
+    }
+    for (int i = 0; i < rBits; i++) {
+        crc = fdk_bit(crc, mask, poly, 0);
+    }
+    return crc;
+}
+
+static void check_fdk(mt19937& gen)
+{
+    struct {
+        UINT poly;
+        uint16_t table_poly;
+        UINT start_value;
+    } setups[] = {
+        { 0x1021, 0x1021, 0xFFFF },
+        { 0x8005, 0x8005, 0xFFFF },
+        { 0x8021, 0x8021, 0xFFFF },
+        { 0x782d, 0x782f, 0 },
+    };
+
+    const size_t buf_size = 1024;
+    uniform_int_distribution<int> offset_dist(0, 200);
+    uniform_int_distribution<int> len_dist(0, 4000);
+    uniform_int_distribution<int> pad_dist(0, 40);
+
+    int mismatches = 0;
+    for (const auto& s : setups) {
+        for (int i = 0; i < 2000; i++) {
+            auto buf = test::random_bytes(gen, buf_size);
+            const int offset = offset_dist(gen);
+            const int cnt_bits = len_dist(gen);
+            int max_bits = 0;
+            switch (i % 4) {
+                case 0: max_bits = 0; break;
+                case 1: max_bits = cnt_bits + pad_dist(gen); break;
+                case 2: max_bits = -(cnt_bits + pad_dist(gen)); break;
+                case 3: max_bits = 72; break; // the firecode region
+            }
+            // FDKcrcEndReg() replaces a maxBits of 0 by the region length
+            const uint16_t expected = fdk_reference(s.poly, s.table_poly,
+                    s.start_value, buf, offset, cnt_bits,
+                    (max_bits == 0) ? cnt_bits : max_bits);
+
+            for (const auto config : {BS_WRITER, BS_READER}) {
+                FDK_CRCINFO crcInfo;
+                FDKcrcInit(&crcInfo, s.poly, s.start_value, 16);
+
+                FDK_BITSTREAM bs;
+                FDKinitBitStream(&bs, buf.data(), buf_size,
+                        (config == BS_READER) ? 8 * buf_size : 0, config);
+                FDKpushFor(&bs, offset);
+                const INT reg = FDKcrcStartReg(&crcInfo, &bs, max_bits);
+                FDKpushFor(&bs, cnt_bits);
+                if (config == BS_WRITER) {
+                    FDKsyncCache(&bs);
+                }
+                FDKcrcEndReg(&crcInfo, &bs, reg);
+
+                if (FDKcrcGetCRC(&crcInfo) != expected) {
+                    if (mismatches == 0) {
+                        fprintf(stderr, "FDK poly %04x offset %d bits %d "
+                                "max %d: %04x, expected %04x\n",
+                                s.poly, offset, cnt_bits, max_bits,
+                                FDKcrcGetCRC(&crcInfo), expected);
+                    }
+                    mismatches++;
+                }
+            }
+        }
+    }
+
+    printf("%-8s %d mismatches\n", "FDK_crc", mismatches);
+    CHECK(mismatches == 0);
+}
+
+int main()
+{
+    // Spot checks of the generated tables against the removed constants
+    CHECK(crc8tab[1] == 0x07 and crc8tab[255] == 0xf3);
+    CHECK(crc16tab[1] == 0x1021 and crc16tab[255] == 0x1ef0);
+    CHECK(crc32tab[1] == 0x04c11db7 and crc32tab[255] == 0xb1f740b4);
+    CHECK(make_table<uint16_t>(0x782f)[1] == 0x782f and
+            make_table<uint16_t>(0x782f)[2] == 0xf05e);
+
+    mt19937 gen(42);
+    check_bytes<uint8_t, Crc8_07>("crc8", crc8_reference, gen);
+    check_bytes<uint16_t, CrcCCITT>("crc16", crc16_reference, gen);
+    check_bytes<uint32_t, Crc32_04C11DB7>("crc32", crc32_reference, gen);
+
+    // The C API used by EDI
+    const auto data = test::random_bytes(gen, 1000);
+    CHECK(crc16(0xffff, data.data(), data.size()) ==
+            crc16_reference(0xffff, data.data(), data.size()));
+
+    check_bits(gen);
+    check_fdk(gen);
+
+    return test::result();
+}
@@ -0,0 +1,82 @@
+/* Checks that the SIMD window and matrixing kernels of the Layer II
+ * polyphase filterbank give bit-identical results to the portable C
+ * kernels, on random input. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "common.h"
+#include "subband.h"
+
+#define ITERATIONS 20000
+
+extern double enwindow[512];
+
+static double random_sample (void)
+{
+  /* Full 16-bit range after the division by SCALE, and some values
+     with a small exponent so that rounding differences would show */
+  double v = (double) (rand () - RAND_MAX / 2) / (RAND_MAX / 2);
+  if (rand () % 8 == 0)
+    v *= 1e-6;
+  return v;
+}
+
+int main (void)
+{
+  subband_kernel kernels[4];
+  const int n = subband_kernels (kernels, 4);
+  int failures = 0;
+  int it, k, i;
+
+  srand (42);
+
+  for (k = 0; k < n; k++)
+    printf ("kernel %s\n", kernels[k].name);
+
+  for (it = 0; it < ITERATIONS; it++) {
+    double x[8 * 32], enw[512], mt[32 * 16], yprime[32];
+    double y_ref[32], s_ref[32];
+    const int pa = rand () & 7;
+    /* Alternate between the real analysis window and random taps */
+    const double *window = (it & 1) ? enwindow : enw;
+
+    for (i = 0; i < 8 * 32; i++)
+      x[i] = random_sample ();
+    for (i = 0; i < 512; i++)
+      enw[i] = random_sample ();
+    for (i = 0; i < 32 * 16; i++)
+      mt[i] = random_sample ();
+    for (i = 0; i < 32; i++)
+      yprime[i] = random_sample ();
+
+    kernels[0].window (x, pa, window + 32 * (it & 1), y_ref);
+    kernels[0].matrix (mt, yprime, s_ref);
+
+    for (k = 1; k < n; k++) {
+      double y[32], s[32];
+
+      kernels[k].window (x, pa, window + 32 * (it & 1), y);
+      kernels[k].matrix (mt, yprime, s);
+
+      if (memcmp (y, y_ref, sizeof (y)) != 0) {
+        fprintf (stderr, "window_%s differs from window_c, iteration %d\n",
+                 kernels[k].name, it);
+        failures++;
+      }
+      if (memcmp (s, s_ref, sizeof (s)) != 0) {
+        fprintf (stderr, "matrix_%s differs from matrix_c, iteration %d\n",
+                 kernels[k].name, it);
+        failures++;
+      }
+    }
+
+    if (failures > 10)
+      break;
+  }
+
+  if (n == 1)
+    printf ("No SIMD kernel available on this CPU, nothing to compare\n");
+
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,106 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+
+/* Checks SuperframeProtector against the strided encode_rs_char() loop
+ * the encoder used before, for every subchannel index. */
+
+#include "test.h"
+#include "SuperframeProtector.h"
+#include <stdexcept>
+
+extern "C" {
+#include "fec/fec.h"
+}
+
+using namespace std;
+
+/* The RS protection loop of the encoder main loop, as it was before
+ * SuperframeProtector: gather each row, encode it, scatter the parity */
+static void protect_reference(void *rs_handler, vector<uint8_t>& outbuf,
+        int subchannel_index)
+{
+    int row, col;
+    unsigned char buf_to_rs_enc[110];
+    unsigned char rs_enc[10];
+    for(row=0; row < subchannel_index; row++) {
+        for(col=0;col < 110; col++) {
+            buf_to_rs_enc[col] = outbuf[subchannel_index * col + row];
+        }
+
+        encode_rs_char(rs_handler, buf_to_rs_enc, rs_enc);
+
+        for(col=110; col<120; col++) {
+            outbuf.at(subchannel_index * col + row) = rs_enc[col-110];
+        }
+    }
+}
+
+int main()
+{
+    mt19937 gen(42);
+    void *rs_handler = init_rs_char(8, 0x11d, 0, 1, 10, 135);
+    CHECK(rs_handler != nullptr);
+
+    for (int s = 1; s <= 24; s++) {
+        SuperframeProtector protector(s);
+        CHECK(protector.data_size() == 110u * s);
+        CHECK(protector.superframe_size() == 120u * s);
+
+        for (int i = 0; i < 50; i++) {
+            auto superframe = test::random_bytes(gen, 120 * s);
+            if (i == 0) {
+                // All zero data must give all zero parity
+                fill(superframe.begin(), superframe.end(), 0);
+            }
+
+            auto expected = superframe;
+            protect_reference(rs_handler, expected, s);
+
+            protector.protect(superframe.data(), superframe.size());
+            if (superframe != expected) {
+                fprintf(stderr, "Mismatch for subchannel index %d, superframe %d\n",
+                        s, i);
+                test::failures()++;
+            }
+        }
+    }
+
+    free_rs_char(rs_handler);
+
+    bool thrown = false;
+    try {
+        SuperframeProtector protector(25);
+    }
+    catch (const invalid_argument&) {
+        thrown = true;
+    }
+    CHECK(thrown);
+
+    thrown = false;
+    try {
+        SuperframeProtector protector(4);
+        vector<uint8_t> superframe(protector.superframe_size() - 1);
+        protector.protect(superframe.data(), superframe.size());
+    }
+    catch (const logic_error&) {
+        thrown = true;
+    }
+    CHECK(thrown);
+
+    return test::result();
+}
@@ -0,0 +1,67 @@
+/* ------------------------------------------------------------------
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ * -------------------------------------------------------------------
+ */
+
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+/*! \file test.h
+ *
+ * Minimal helpers for the unit tests in tests/. Every test is a program
+ * that returns 0 on success, as expected by the automake test driver.
+ */
+
+namespace test {
+
+inline int& failures()
+{
+    static int count = 0;
+    return count;
+}
+
+/*! Exit code for main() */
+inline int result()
+{
+    if (failures() > 0) {
+        fprintf(stderr, "%d check(s) failed\n", failures());
+        return 1;
+    }
+    return 0;
+}
+
+inline std::vector<uint8_t> random_bytes(std::mt19937& gen, size_t len)
+{
+    std::uniform_int_distribution<int> dist(0, 255);
+    std::vector<uint8_t> v(len);
+    for (auto& b : v) {
+        b = dist(gen);
+    }
+    return v;
+}
+
+} // namespace test
+
+/*! Record a failure, with its location, when cond is false */
+#define CHECK(cond) do { \
+    if (not (cond)) { \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        test::failures()++; \
+    } \
+} while (0)